@@ -30,4 +30,9 @@ void SEE_PrintTraceback(struct SEE_interpreter *i, FILE *f);
 void SEE_PrintContextTraceback(struct SEE_interpreter *i, 
 		volatile struct SEE_try_context *context, FILE *f);
 
+/* Prints the allocations profiled since SEE_alloc_profile(1) */
+void SEE_PrintAllocProfile(FILE *f, int format);
+#define SEE_ALLOC_PROFILE_TEXT	0	/* sorted report */
+#define SEE_ALLOC_PROFILE_PPROF	1	/* heap profile for pprof */
+
 #endif /* _SEE_h_debug_ */
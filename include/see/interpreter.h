@@ -14,6 +14,7 @@ struct SEE_scope;
 struct SEE_traceback;
 struct SEE_regex_engine;
 struct SEE_interpreter_state;
+struct SEE_memstats;
 
 enum SEE_trace_event {
 	SEE_TRACE_CALL,
@@ -79,8 +80,45 @@ struct SEE_interpreter {
 
 	/* Regex implementation used by Regex object (experimental) */
 	const struct SEE_regex_engine *regex_engine;
+
+	void *string_cache;		/* small integer and char strings */
+	int regex_backtrack_limit;	/* per match attempt; -1 no limit */
+	void *regex_cache;		/* recently compiled regexs */
+	int regex_jit_threshold;	/* matches before jit; -1 never */
+	unsigned int regex_backtrack_peak; /* deepest backtrack stack seen */
+	SEE_size_t mem_soft_limit;	/* live bytes; 0 means no limit */
+	SEE_size_t mem_hard_limit;	/* live bytes; 0 means no limit */
+	int mem_category;		/* SEE_MEM_* charged by SEE_malloc() */
+	void *mem_account;		/* allocation accounting */
+	void *arena;			/* storage, if not the heap */
+	void *frame_stack;		/* activations that cannot escape */
+	int builtins_pending;		/* SEE_BUILTIN_* not yet initialised */
 };
 
+/*
+ * Built-in objects that are initialised when first used. Until then
+ * their fields above point to uninitialised storage, so use the
+ * SEE_INTERP_*() macros to read them.
+ */
+#define SEE_BUILTIN_DATE	(1<< 0) /* Date, Date_prototype */
+#define SEE_BUILTIN_REGEXP	(1<< 1) /* RegExp, RegExp_prototype */
+#define SEE_BUILTIN_MATH	(1<< 2) /* Math */
+
+#define SEE_INTERP_BUILTIN(i, field, b) \
+	(((i)->builtins_pending & (b)) \
+	    ? (SEE_interpreter_init_builtins(i, b), (i)->field) \
+	    : (i)->field)
+#define SEE_INTERP_DATE(i) \
+	SEE_INTERP_BUILTIN(i, Date, SEE_BUILTIN_DATE)
+#define SEE_INTERP_DATE_PROTOTYPE(i) \
+	SEE_INTERP_BUILTIN(i, Date_prototype, SEE_BUILTIN_DATE)
+#define SEE_INTERP_REGEXP(i) \
+	SEE_INTERP_BUILTIN(i, RegExp, SEE_BUILTIN_REGEXP)
+#define SEE_INTERP_REGEXP_PROTOTYPE(i) \
+	SEE_INTERP_BUILTIN(i, RegExp_prototype, SEE_BUILTIN_REGEXP)
+#define SEE_INTERP_MATH(i) \
+	SEE_INTERP_BUILTIN(i, Math, SEE_BUILTIN_MATH)
+
 /* Compatibility flags */
 #define SEE_COMPAT_STRICT       0x0000  /* Strict ECMA-262 3rd ed. */
 #define SEE_COMPAT_262_3B       (1<< 1) /* ECMA-262 3rd ed. Annex B */
@@ -122,6 +160,19 @@ void SEE_interpreter_init(struct SEE_interpreter *i);
 /* Initialises an interpreter with specific behaviour */
 void SEE_interpreter_init_compat(struct SEE_interpreter *i, int compat_flags);
 
+/* Initialises an interpreter whose memory is released when destroyed */
+void SEE_interpreter_init_arena(struct SEE_interpreter *i, int compat_flags);
+
+/* Initialises built-in objects now, rather than on first use */
+void SEE_interpreter_init_builtins(struct SEE_interpreter *i, int builtins);
+
+/* Releases an interpreter */
+void SEE_interpreter_destroy(struct SEE_interpreter *i);
+
+/* Reports the interpreter's memory use (see <see/mem.h>) */
+void SEE_interpreter_memstats(struct SEE_interpreter *i,
+	struct SEE_memstats *stats);
+
 /* Saves interpreter state for concurrent access */
 struct SEE_interpreter_state *SEE_interpreter_save_state(
 	struct SEE_interpreter *i);
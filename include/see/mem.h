@@ -7,6 +7,7 @@
 #include <see/type.h>
 
 struct SEE_interpreter;
+struct SEE_value;
 
 void *	SEE_malloc(struct SEE_interpreter *i, SEE_size_t sz) 
 		_SEE__malloc;
@@ -19,6 +20,58 @@ void *	SEE_malloc_finalize(struct SEE_interpreter *i, SEE_size_t sz,
 void  	SEE_free(struct SEE_interpreter *i, void **memp);
 void  	SEE_gcollect(struct SEE_interpreter *i);
 
+/* Accounting categories (see SEE_interpreter_memstats()) */
+#define SEE_MEM_OBJECT		0	/* objects, and anything else */
+#define SEE_MEM_STRING		1	/* strings and other atomic data */
+#define SEE_MEM_CODE		2	/* parsed and compiled code */
+#define SEE_MEM_PROPERTY	3	/* object properties */
+#define SEE_MEM_NCATEGORIES	4
+
+void *	SEE_malloc_category(struct SEE_interpreter *i, SEE_size_t sz,
+		int category) _SEE__malloc;
+
+struct SEE_memstats {
+	SEE_size_t	bytes[SEE_MEM_NCATEGORIES];	/* live bytes */
+	unsigned long	blocks[SEE_MEM_NCATEGORIES];	/* live allocations */
+	SEE_size_t	total_bytes;	/* sum of bytes[] */
+	unsigned long	total_blocks;	/* sum of blocks[] */
+	SEE_size_t	peak_bytes;	/* greatest total_bytes */
+	unsigned long	soft_exceeded;	/* times the soft limit was passed */
+	unsigned long	hard_exceeded;	/* allocations refused */
+};
+
+/* Starts (discarding any earlier profile) or stops profiling allocations */
+void	SEE_alloc_profile(int enable);
+
+/* For object class trace hooks (see SEE_objectclass) */
+void	SEE_gc_mark(const void *p);
+void	SEE_gc_mark_value(const struct SEE_value *v);
+
+/* For hosts that store pointers into a struct SEE_native's own fields */
+void	SEE_gc_write_barrier(const void *p);
+
+/* For hosts that keep SEE storage only in static variables */
+void	SEE_gc_add_root(void *p, SEE_size_t size);
+void	SEE_gc_remove_root(void *p);
+
+/* Incremental collection (see SEE_system.gc_pause_budget) */
+struct SEE_gc_stats {
+	unsigned long	collections;	/* completed, including minor ones */
+	unsigned long	cycles;		/* incremental collections begun */
+	unsigned long	slices;		/* incremental slices */
+	unsigned long	pauses;		/* slices and whole collections */
+	unsigned long	pause_last;	/* microseconds */
+	unsigned long	pause_max;	/* microseconds */
+	unsigned long	pause_total;	/* microseconds */
+	SEE_size_t	live_bytes;	/* reachable after the last full GC */
+	SEE_size_t	heap_bytes;	/* held by the collector */
+	int		collecting;	/* incremental collection in progress */
+	unsigned long	finalizers;	/* registered and not yet run */
+};
+int	SEE_gc_step(struct SEE_interpreter *i);
+void	SEE_gc_request(struct SEE_interpreter *i);
+void	SEE_gc_stats(struct SEE_gc_stats *stats);
+
 /* Debugging variants */
 void *	_SEE_malloc_debug(struct SEE_interpreter *i, SEE_size_t sz, 
 		const char *file, int line);
@@ -28,6 +81,8 @@ void *	_SEE_malloc_finalize_debug(struct SEE_interpreter *i, SEE_size_t sz,
 		void (*finalizefn)(struct SEE_interpreter *i, void *p,
 			void *closure), void *closure, 
 			const char *file, int line);
+void *	_SEE_malloc_category_debug(struct SEE_interpreter *i, SEE_size_t sz,
+		int category, const char *file, int line);
 void 	_SEE_free_debug(struct SEE_interpreter *i, void **memp,
 		const char *file, int line);
 #ifndef NDEBUG
@@ -37,6 +92,8 @@ void 	_SEE_free_debug(struct SEE_interpreter *i, void **memp,
 		_SEE_malloc_string_debug(i,s,__FILE__,__LINE__)
 #define SEE_malloc_finalize(i,s,f,c) \
 		_SEE_malloc_finalize_debug(i,s,f,c,__FILE__,__LINE__)
+#define SEE_malloc_category(i,s,c) \
+		_SEE_malloc_category_debug(i,s,c,__FILE__,__LINE__)
 #define SEE_free(i,p) \
 		_SEE_free_debug(i,p,__FILE__,__LINE__)
 #endif
@@ -82,6 +139,8 @@ void	_SEE_grow_to_debug(struct SEE_interpreter *i,
 #define SEE_NEW_FINALIZE(i, t, f, c) \
 				(t *)SEE_malloc_finalize(i, sizeof (t), f, c)
 #define SEE_NEW_ARRAY(i, t, n)	(t *)SEE_malloc(i, (n) * sizeof (t))
+#define SEE_NEW_CATEGORY(i, t, c) \
+				(t *)SEE_malloc_category(i, sizeof (t), c)
 #define SEE_NEW_STRING_ARRAY(i, t, n) \
 				(t *)SEE_malloc_string(i, (n) * sizeof (t))
 
@@ -53,6 +53,7 @@ void SEE_native_defaultvalue(struct SEE_interpreter *i, struct SEE_object *obj,
 	struct SEE_value *hint, struct SEE_value *res);
 struct SEE_enum *SEE_native_enumerator(struct SEE_interpreter *i, 
 	struct SEE_object *obj);
+void SEE_native_trace(struct SEE_object *obj);
 
 /* Allocate and initialise a new native object, with NULL prototype */
 struct SEE_object *SEE_native_new(struct SEE_interpreter *i);
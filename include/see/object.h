@@ -4,6 +4,8 @@
 #ifndef _SEE_h_object_
 #define _SEE_h_object_
 
+#include <see/type.h>
+
 struct SEE_value;
 struct SEE_object;
 struct SEE_string;
@@ -37,6 +39,7 @@ typedef struct SEE_enum *(*SEE_enumerator_fn_t)(struct SEE_interpreter *i,
 			struct SEE_object *obj);
 typedef void *	(*SEE_get_sec_domain_fn_t)(struct SEE_interpreter *i,
 			struct SEE_object *obj);
+typedef void	(*SEE_trace_fn_t)(struct SEE_object *obj);
 
 /*
  * Object classes: an object insatnce appears as a container of named
@@ -49,6 +52,13 @@ typedef void *	(*SEE_get_sec_domain_fn_t)(struct SEE_interpreter *i,
  * throw a TypeError, and Proptype may be NULL)
  * Optionally, object classes can implement the enumerator, Construct, Call
  * or HasInstance. Unimplemented optional methods are indicated as NULL.
+ *
+ * The optional trace hook is called by SEE's own garbage collector on
+ * objects initialised with SEE_native_init(). It marks everything the
+ * object refers to (see SEE_gc_mark()); the object's storage is not
+ * otherwise scanned. Objects whose class has no trace hook are scanned
+ * conservatively. The hook must not allocate storage or call back into
+ * the interpreter.
  */
 struct SEE_objectclass {
 	const char *		Class;			/* [[Class]] */
@@ -63,6 +73,7 @@ struct SEE_objectclass {
 	SEE_call_fn_t		Call;			/* [[Call]] */
 	SEE_hasinstance_fn_t	HasInstance;		/* [[HasInstance]] */
 	SEE_get_sec_domain_fn_t	get_sec_domain;		/* get_sec_domain */
+	SEE_trace_fn_t		trace;			/* trace */
 };
 
 /*
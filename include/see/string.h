@@ -58,6 +58,8 @@ int	SEE_string_cmp(const struct SEE_string *s1,
 			  const struct SEE_string *s2);
 int	SEE_string_cmp_ascii(const struct SEE_string *s1,
 			  const char *s2);
+int	SEE_string_casecmp(const struct SEE_string *s1,
+			  const struct SEE_string *s2);
 
 struct SEE_string *SEE_string_new(struct SEE_interpreter *i,
 				unsigned int space);
@@ -82,6 +84,44 @@ void	SEE_string_toutf8(struct SEE_interpreter *i, char *buf,
 SEE_size_t SEE_string_utf8_size(struct SEE_interpreter *interp,
 			const struct SEE_string *s);
 
+/*
+ * String buffers.
+ *
+ * A string buffer accumulates UTF-16 text with geometric growth,
+ * so that building a string of n characters by appending costs O(n).
+ * SEE_strbuf_reserve() ensures room for a further 'extra' characters,
+ * after which up to that many characters may be stored directly at
+ * data[length] provided the length is updated to match.
+ * SEE_strbuf_string() hands the buffer's storage over to a new, growable
+ * string without copying it, and leaves the buffer empty for re-use.
+ */
+struct SEE_strbuf {
+	SEE_char_t		*data;
+	unsigned int		 length;
+	unsigned int		 capacity;	/* characters allocated */
+	struct SEE_interpreter	*interpreter;
+};
+
+void	SEE_strbuf_init(struct SEE_interpreter *i, struct SEE_strbuf *sb,
+			unsigned int space);
+void	SEE_strbuf_reserve(struct SEE_strbuf *sb, unsigned int extra);
+void	SEE_strbuf_addch(struct SEE_strbuf *sb, /* SEE_char_t */ int ch);
+void	SEE_strbuf_append(struct SEE_strbuf *sb, const struct SEE_string *s);
+void	SEE_strbuf_append_chars(struct SEE_strbuf *sb, 
+			const SEE_char_t *chars, unsigned int len);
+void	SEE_strbuf_append_ascii(struct SEE_strbuf *sb, const char *ascii);
+void	SEE_strbuf_append_utf8(struct SEE_strbuf *sb, const char *utf8,
+			SEE_size_t len);
+void	SEE_strbuf_append_unicode(struct SEE_strbuf *sb, SEE_unicode_t uch);
+void	SEE_strbuf_append_int(struct SEE_strbuf *sb, int i);
+void	SEE_strbuf_append_number(struct SEE_strbuf *sb, SEE_number_t n);
+struct SEE_string *SEE_strbuf_string(struct SEE_strbuf *sb);
+
+/* Appends a character when room is known to have been reserved */
+#define SEE_STRBUF_PUTCH(sb, ch) \
+	((sb)->data[(sb)->length++] = (SEE_char_t)(ch))
+
 struct SEE_string *_SEE_string_dup_fix(struct SEE_interpreter *,
 	        struct SEE_string *);
+void _SEE_string_trace(void *);
 #endif /* _SEE_h_string_ */
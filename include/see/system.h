@@ -61,6 +61,22 @@ struct SEE_system {
 
 	/* Default regex engine to use (experimental) */
 	const struct SEE_regex_engine *default_regex_engine;
+
+	/* Backtracks allowed per regex match attempt; -1 means no limit */
+	int default_regex_backtrack_limit;	/* default: 10000000 */
+
+	/* Matches before a regex is compiled to native code; -1 never */
+	int default_regex_jit_threshold;	/* default: 100 */
+
+	/* Microseconds per incremental GC slice; 0 stops the world */
+	unsigned int gc_pause_budget;		/* default: 0 */
+
+	/* Per-interpreter memory limits in bytes; 0 means no limit */
+	SEE_size_t default_mem_soft_limit;	/* default: 0 */
+	SEE_size_t default_mem_hard_limit;	/* default: 0 */
+
+	/* Called when an interpreter passes a memory limit; may throw */
+	void (*mem_limit_exceeded)(struct SEE_interpreter *, int hard);
 };
 
 extern struct SEE_system SEE_system;
@@ -72,5 +88,7 @@ void SEE_init(void);	    /* no-op; reserved for API 3.0 */
 /* The following two functions are experimental and may change */
 const char **SEE_regex_engine_list(void);
 const struct SEE_regex_engine *SEE_regex_engine(const char *name);
+void SEE_regex_cache_stats(struct SEE_interpreter *interp,
+	unsigned long *hits, unsigned long *misses);
 
 #endif /* _SEE_h_system_ */
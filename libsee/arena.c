@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2008
+ *      David Leonard.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of David Leonard nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/* $Id$ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#if STDC_HEADERS
+# include <stdlib.h>
+#endif
+
+#if HAVE_STRING_H
+# include <string.h>
+#endif
+
+#include <see/type.h>
+
+#include "arena.h"
+
+/*
+ * Region allocation for request-scoped interpreters.
+ *
+ * An arena is a list of fixed-size chunks that blocks are bumped out
+ * of, plus a list of separately allocated large blocks. Each block is
+ * preceded by a header holding its size and category, and a block
+ * with a finalizer is further preceded by its entry in the arena's
+ * finalizer list:
+ *
+ *	[struct large] [struct fin] struct header  data...
+ *
+ * Freed blocks of the commonest small sizes go onto per-size free
+ * lists for reuse, and the most recent block is simply un-bumped.
+ * The arena's own structure sits at the start of its first chunk.
+ * When an arena is destroyed, its chunks go onto a spare list shared
+ * by all arenas, so that a server creating an interpreter for each
+ * request soon stops calling malloc() for chunks at all.
+ */
+
+#define CHUNK_SIZE	(64 * 1024)
+#define LARGE_SIZE	(CHUNK_SIZE / 8)	/* larger blocks are large */
+#define ALIGN		8			/* block size and alignment */
+#define NRECYCLE	64			/* sizes kept on free lists */
+#define SPARE_MAX	64			/* most spare chunks kept */
+
+#define ROUND(n)	(((n) + ALIGN - 1) & ~(SEE_size_t)(ALIGN - 1))
+
+#define H_CATEGORY	3			/* bits of size_bits */
+#define H_FIN		4
+#define H_SIZE(h)	((h)->size_bits & ~(SEE_uint32_t)(ALIGN - 1))
+
+union chunk {
+	union chunk	*next;
+	double		 align;
+};
+
+struct header {
+	SEE_uint32_t	 size_bits;	/* rounded size | H_FIN | category */
+	SEE_uint32_t	 request;	/* size asked for */
+};
+
+struct fin {
+	struct fin	*next, *prev;
+	void		(*finalizefn)(struct SEE_interpreter *, void *,
+			    void *);
+	void		*closure;
+};
+
+struct large {
+	struct large	*next, *prev;
+};
+
+struct arena {
+	union chunk	*chunks;	/* newest first; the last holds us */
+	char		*next, *end;	/* free space in the newest chunk */
+	struct large	*large;
+	struct fin	*fins;		/* newest first */
+	void		*freelist[NRECYCLE];
+	int		 destroying;
+};
+
+/*
+ * The spare chunks. Interpreters on different threads may create and
+ * destroy arenas at the same time, so the list is guarded by a spin
+ * lock where the compiler provides atomic operations.
+ */
+static union chunk *spare;
+static unsigned int nspare;
+#if defined(__GNUC__)
+static volatile int spare_lock;
+# define LOCK()		while (__sync_lock_test_and_set(&spare_lock, 1)) ;
+# define UNLOCK()	__sync_lock_release(&spare_lock)
+#else
+# define LOCK()		/* nothing */
+# define UNLOCK()	/* nothing */
+#endif
+
+static union chunk *chunk_get(void);
+static void chunk_put(union chunk *);
+static int arena_grow(struct arena *);
+
+/* Returns a spare or new chunk, or NULL if out of memory */
+static union chunk *
+chunk_get()
+{
+	union chunk *c;
+
+	LOCK();
+	if ((c = spare) != NULL) {
+		spare = c->next;
+		nspare--;
+	}
+	UNLOCK();
+	if (!c)
+		c = (union chunk *)malloc(CHUNK_SIZE);
+	return c;
+}
+
+/* Keeps a chunk for reuse, or frees it if enough are kept already */
+static void
+chunk_put(c)
+	union chunk *c;
+{
+	LOCK();
+	if (nspare < SPARE_MAX) {
+		c->next = spare;
+		spare = c;
+		nspare++;
+		c = NULL;
+	}
+	UNLOCK();
+	if (c)
+		free(c);
+}
+
+/* Starts bumping from a new chunk. Returns 0 if out of memory. */
+static int
+arena_grow(arena)
+	struct arena *arena;
+{
+	union chunk *c;
+
+	if (!(c = chunk_get()))
+		return 0;
+	c->next = arena->chunks;
+	arena->chunks = c;
+	arena->next = (char *)(c + 1);
+	arena->end = (char *)c + CHUNK_SIZE;
+	return 1;
+}
+
+struct arena *
+_SEE_arena_new()
+{
+	union chunk *c;
+	struct arena *arena;
+
+	if (!(c = chunk_get()))
+		return NULL;
+	c->next = NULL;
+	arena = (struct arena *)(c + 1);
+	memset(arena, 0, sizeof *arena);
+	arena->chunks = c;
+	arena->next = (char *)arena + ROUND(sizeof *arena);
+	arena->end = (char *)c + CHUNK_SIZE;
+	return arena;
+}
+
+void *
+_SEE_arena_malloc(arena, size, category, finalizefn, closure)
+	struct arena *arena;
+	SEE_size_t size;
+	int category;
+	void (*finalizefn)(struct SEE_interpreter *, void *, void *);
+	void *closure;
+{
+	SEE_size_t rsize, need;
+	struct header *h;
+	struct large *lg;
+	struct fin *f;
+	char *p;
+
+	rsize = ROUND(size);
+	if (rsize < size || rsize > 0xffff0000UL)
+		return NULL;
+	if (!finalizefn && rsize <= NRECYCLE * ALIGN &&
+	    (p = arena->freelist[rsize / ALIGN - 1]) != NULL)
+	{
+		arena->freelist[rsize / ALIGN - 1] = *(void **)p;
+		h = (struct header *)p - 1;
+		h->size_bits = rsize | category;
+		h->request = size;
+		memset(p, 0, rsize);
+		return p;
+	}
+
+	need = (finalizefn ? sizeof *f : 0) + sizeof *h + rsize;
+	if (rsize > LARGE_SIZE) {
+		lg = (struct large *)malloc(sizeof *lg + need);
+		if (!lg)
+			return NULL;
+		lg->prev = NULL;
+		if ((lg->next = arena->large) != NULL)
+			lg->next->prev = lg;
+		arena->large = lg;
+		p = (char *)(lg + 1);
+	} else {
+		if (need > (SEE_size_t)(arena->end - arena->next) &&
+		    !arena_grow(arena))
+			return NULL;
+		p = arena->next;
+		arena->next += need;
+	}
+
+	if (finalizefn) {
+		f = (struct fin *)p;
+		f->finalizefn = finalizefn;
+		f->closure = closure;
+		f->prev = NULL;
+		if ((f->next = arena->fins) != NULL)
+			f->next->prev = f;
+		arena->fins = f;
+		p = (char *)(f + 1);
+	}
+	h = (struct header *)p;
+	h->size_bits = rsize | category | (finalizefn ? H_FIN : 0);
+	h->request = size;
+	memset(h + 1, 0, rsize);
+	return h + 1;
+}
+
+SEE_size_t
+_SEE_arena_free(arena, ptr, categoryp)
+	struct arena *arena;
+	void *ptr;
+	int *categoryp;
+{
+	struct header *h = (struct header *)ptr - 1;
+	SEE_size_t rsize = H_SIZE(h), request = h->request;
+	struct large *lg;
+	struct fin *f;
+	char *start = (char *)h;
+
+	if (arena->destroying)
+		return 0;
+	*categoryp = h->size_bits & H_CATEGORY;
+	if (h->size_bits & H_FIN) {
+		f = (struct fin *)h - 1;
+		if (f->prev)
+			f->prev->next = f->next;
+		else
+			arena->fins = f->next;
+		if (f->next)
+			f->next->prev = f->prev;
+		h->size_bits &= ~H_FIN;
+		start = (char *)f;
+	}
+	if (rsize > LARGE_SIZE) {
+		lg = (struct large *)start - 1;
+		if (lg->prev)
+			lg->prev->next = lg->next;
+		else
+			arena->large = lg->next;
+		if (lg->next)
+			lg->next->prev = lg->prev;
+		free(lg);
+		return request;
+	}
+	if ((char *)ptr + rsize == arena->next)
+		arena->next = start;
+	else if (start == (char *)h && rsize <= NRECYCLE * ALIGN) {
+		*(void **)ptr = arena->freelist[rsize / ALIGN - 1];
+		arena->freelist[rsize / ALIGN - 1] = ptr;
+	}
+	return request;
+}
+
+void
+_SEE_arena_destroy(interp, arena)
+	struct SEE_interpreter *interp;
+	struct arena *arena;
+{
+	struct fin *f;
+	struct large *lg;
+	union chunk *c, *next;
+
+	/* Finalizers may allocate, and may free, but not for long */
+	arena->destroying = 1;
+	while ((f = arena->fins) != NULL) {
+		arena->fins = f->next;
+		(*f->finalizefn)(interp,
+		    (struct header *)(f + 1) + 1, f->closure);
+	}
+	while ((lg = arena->large) != NULL) {
+		arena->large = lg->next;
+		free(lg);
+	}
+	for (c = arena->chunks; c; c = next) {
+		next = c->next;
+		chunk_put(c);
+	}
+}
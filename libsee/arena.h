@@ -0,0 +1,40 @@
+/* Copyright (c) 2008, David Leonard. All rights reserved. */
+/* $Id$ */
+
+#ifndef _SEE_h_arena_
+#define _SEE_h_arena_
+
+#include <see/type.h>
+
+struct SEE_interpreter;
+struct arena;
+
+/*
+ * Arenas hold all the storage of interpreters initialised with
+ * SEE_interpreter_init_arena(), and release it all at once when the
+ * interpreter is destroyed. They are never garbage collected.
+ *
+ * _SEE_arena_new() returns a new, empty arena, or NULL if there is
+ * no memory for it.
+ *
+ * _SEE_arena_malloc() returns size bytes of zeroed storage charged to
+ * the accounting category, or NULL if out of memory. If finalizefn is
+ * not NULL, it is called when the arena is destroyed.
+ *
+ * _SEE_arena_free() releases storage for reuse, cancelling any
+ * finalizer. It returns the size that was allocated and stores its
+ * category through categoryp, or returns 0 while the arena is being
+ * destroyed.
+ *
+ * _SEE_arena_destroy() runs the finalizers, newest first, and then
+ * releases the arena's storage, which takes time in proportion to the
+ * number of chunks and large blocks it holds. Chunks are kept for
+ * reuse by later arenas, up to a limit.
+ */
+struct arena *_SEE_arena_new(void);
+void *_SEE_arena_malloc(struct arena *, SEE_size_t, int,
+	void (*)(struct SEE_interpreter *, void *, void *), void *);
+SEE_size_t _SEE_arena_free(struct arena *, void *, int *);
+void _SEE_arena_destroy(struct SEE_interpreter *, struct arena *);
+
+#endif /* _SEE_h_arena_ */
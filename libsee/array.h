@@ -15,6 +15,8 @@ int	SEE_is_Array(struct SEE_object *a);
 void	SEE_Array_push(struct SEE_interpreter *i, struct SEE_object *a,
 		struct SEE_value *val);
 SEE_uint32_t SEE_Array_length(struct SEE_interpreter *i, struct SEE_object *a);
+struct SEE_value *SEE_Array_dense(struct SEE_interpreter *i,
+		struct SEE_object *a, SEE_uint32_t n);
 int	SEE_to_array_index(struct SEE_string *, SEE_uint32_t *);
 
 
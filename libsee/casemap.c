@@ -0,0 +1,395 @@
+/*
+ * Copyright (c) 2008
+ *      David Leonard.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of David Leonard nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/* $Id$ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#if HAVE_STRING_H
+# include <string.h>
+#endif
+
+#include <see/type.h>
+#include <see/mem.h>
+
+#include "casemap.h"
+#include "unicode.h"
+#include "simd.h"
+#include "gc.h"
+
+/*
+ * Case mapping of ASCII runs.
+ *
+ * A block of text is pure ASCII when none of its code units have any
+ * of the bits 0xff80 set. In such a block, the letters in the range
+ * [first, first+25] are case-mapped by flipping bit 0x20.
+ * The vector kernels return the number of leading code units that they
+ * mapped, stopping at the first block that is not pure ASCII; the
+ * caller then maps a block's worth of code units one at a time before
+ * trying the kernel again.
+ */
+
+#define BLOCK		16	/* code units the scalar fallback maps */
+
+typedef unsigned int (*casemap_fn)(SEE_char_t *, const SEE_char_t *,
+	unsigned int, int);
+
+static unsigned int casemap_resolve(SEE_char_t *, const SEE_char_t *,
+	unsigned int, int);
+static unsigned int casemap_none(SEE_char_t *, const SEE_char_t *,
+	unsigned int, int);
+static void casemap(SEE_char_t *, const SEE_char_t *, unsigned int, int);
+#if SIMD_SSE2
+static unsigned int casemap_sse2(SEE_char_t *, const SEE_char_t *,
+	unsigned int, int);
+#endif
+#if SIMD_AVX2
+static unsigned int casemap_avx2(SEE_char_t *, const SEE_char_t *,
+	unsigned int, int) SIMD_TARGET_AVX2;
+#endif
+
+/* The ASCII block mapper; replaced on first use */
+static casemap_fn casemap_ascii = casemap_resolve;
+
+const unsigned char _SEE_ascii_tolower[128] = {
+	0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,
+	0x08,0x09,0x0a,0x0b,0x0c,0x0d,0x0e,0x0f,
+	0x10,0x11,0x12,0x13,0x14,0x15,0x16,0x17,
+	0x18,0x19,0x1a,0x1b,0x1c,0x1d,0x1e,0x1f,
+	 ' ', '!', '"', '#', '$', '%', '&','\'',
+	 '(', ')', '*', '+', ',', '-', '.', '/',
+	 '0', '1', '2', '3', '4', '5', '6', '7',
+	 '8', '9', ':', ';', '<', '=', '>', '?',
+	 '@', 'a', 'b', 'c', 'd', 'e', 'f', 'g',
+	 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o',
+	 'p', 'q', 'r', 's', 't', 'u', 'v', 'w',
+	 'x', 'y', 'z', '[','\\', ']', '^', '_',
+	 '`', 'a', 'b', 'c', 'd', 'e', 'f', 'g',
+	 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o',
+	 'p', 'q', 'r', 's', 't', 'u', 'v', 'w',
+	 'x', 'y', 'z', '{', '|', '}', '~',0x7f
+};
+
+const unsigned char _SEE_ascii_toupper[128] = {
+	0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,
+	0x08,0x09,0x0a,0x0b,0x0c,0x0d,0x0e,0x0f,
+	0x10,0x11,0x12,0x13,0x14,0x15,0x16,0x17,
+	0x18,0x19,0x1a,0x1b,0x1c,0x1d,0x1e,0x1f,
+	 ' ', '!', '"', '#', '$', '%', '&','\'',
+	 '(', ')', '*', '+', ',', '-', '.', '/',
+	 '0', '1', '2', '3', '4', '5', '6', '7',
+	 '8', '9', ':', ';', '<', '=', '>', '?',
+	 '@', 'A', 'B', 'C', 'D', 'E', 'F', 'G',
+	 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O',
+	 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W',
+	 'X', 'Y', 'Z', '[','\\', ']', '^', '_',
+	 '`', 'A', 'B', 'C', 'D', 'E', 'F', 'G',
+	 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O',
+	 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W',
+	 'X', 'Y', 'Z', '{', '|', '}', '~',0x7f
+};
+
+/*
+ * Selects the fastest available ASCII block mapper and then uses it.
+ */
+static unsigned int
+casemap_resolve(dst, src, len, first)
+	SEE_char_t *dst;
+	const SEE_char_t *src;
+	unsigned int len;
+	int first;
+{
+	casemap_fn fn = casemap_none;
+
+#if SIMD_SSE2
+	fn = casemap_sse2;
+#endif
+#if SIMD_AVX2
+	if (SIMD_CPU_HAS_AVX2())
+		fn = casemap_avx2;
+#endif
+	casemap_ascii = fn;
+	return (*fn)(dst, src, len, first);
+}
+
+/* The portable block mapper leaves all the work to the scalar loop */
+static unsigned int
+casemap_none(dst, src, len, first)
+	SEE_char_t *dst;
+	const SEE_char_t *src;
+	unsigned int len;
+	int first;
+{
+	return 0;
+}
+
+#if SIMD_SSE2
+/* Maps pure ASCII blocks of 16 code units */
+static unsigned int
+casemap_sse2(dst, src, len, first)
+	SEE_char_t *dst;
+	const SEE_char_t *src;
+	unsigned int len;
+	int first;
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i high = _mm_set1_epi16((short)0xff80);
+	const __m128i lo = _mm_set1_epi16((short)(first - 1));
+	const __m128i hi = _mm_set1_epi16((short)(first + 26));
+	const __m128i flip = _mm_set1_epi16(0x20);
+	__m128i a, b;
+	unsigned int i;
+
+	for (i = 0; i + 16 <= len; i += 16) {
+	    a = _mm_loadu_si128((const __m128i *)(src + i));
+	    b = _mm_loadu_si128((const __m128i *)(src + i + 8));
+	    if (_mm_movemask_epi8(_mm_cmpeq_epi16(zero,
+		_mm_and_si128(_mm_or_si128(a, b), high))) != 0xffff)
+		    break;
+	    a = _mm_xor_si128(a, _mm_and_si128(flip, _mm_and_si128(
+		_mm_cmpgt_epi16(a, lo), _mm_cmplt_epi16(a, hi))));
+	    b = _mm_xor_si128(b, _mm_and_si128(flip, _mm_and_si128(
+		_mm_cmpgt_epi16(b, lo), _mm_cmplt_epi16(b, hi))));
+	    _mm_storeu_si128((__m128i *)(dst + i), a);
+	    _mm_storeu_si128((__m128i *)(dst + i + 8), b);
+	}
+	return i;
+}
+#endif
+
+#if SIMD_AVX2
+/* Maps pure ASCII blocks of 32 code units */
+static unsigned int
+casemap_avx2(dst, src, len, first)
+	SEE_char_t *dst;
+	const SEE_char_t *src;
+	unsigned int len;
+	int first;
+{
+	const __m256i high = _mm256_set1_epi16((short)0xff80);
+	const __m256i lo = _mm256_set1_epi16((short)(first - 1));
+	const __m256i hi = _mm256_set1_epi16((short)(first + 26));
+	const __m256i flip = _mm256_set1_epi16(0x20);
+	__m256i a, b;
+	unsigned int i;
+
+	for (i = 0; i + 32 <= len; i += 32) {
+	    a = _mm256_loadu_si256((const __m256i *)(src + i));
+	    b = _mm256_loadu_si256((const __m256i *)(src + i + 16));
+	    if (!_mm256_testz_si256(_mm256_or_si256(a, b), high))
+		break;
+	    a = _mm256_xor_si256(a, _mm256_and_si256(flip, _mm256_and_si256(
+		_mm256_cmpgt_epi16(a, lo), _mm256_cmpgt_epi16(hi, a))));
+	    b = _mm256_xor_si256(b, _mm256_and_si256(flip, _mm256_and_si256(
+		_mm256_cmpgt_epi16(b, lo), _mm256_cmpgt_epi16(hi, b))));
+	    _mm256_storeu_si256((__m256i *)(dst + i), a);
+	    _mm256_storeu_si256((__m256i *)(dst + i + 16), b);
+	}
+	return i;
+}
+#endif
+
+/*
+ * Case maps len code units. The letters [first, first+25] are the
+ * ASCII letters to be mapped: 'A' for lower-casing, 'a' for upper-casing.
+ */
+static void
+casemap(dst, src, len, first)
+	SEE_char_t *dst;
+	const SEE_char_t *src;
+	unsigned int len;
+	int first;
+{
+	const unsigned char *table = first == 'A' 
+		? _SEE_ascii_tolower : _SEE_ascii_toupper;
+	unsigned int i, end;
+	SEE_char_t c;
+
+	i = 0;
+	while (i < len) {
+	    i += (*casemap_ascii)(dst + i, src + i, len - i, first);
+	    end = len - i < BLOCK ? len : i + BLOCK;
+	    for (; i < end; i++) {
+		c = src[i];
+		if (c < 0x80)
+		    dst[i] = table[c];
+		else if (first == 'A')
+		    dst[i] = UNICODE_TOLOWER(c);
+		else
+		    dst[i] = UNICODE_TOUPPER(c);
+	    }
+	}
+}
+
+void
+_SEE_tolower_chars(dst, src, len)
+	SEE_char_t *dst;
+	const SEE_char_t *src;
+	unsigned int len;
+{
+	casemap(dst, src, len, 'A');
+}
+
+void
+_SEE_toupper_chars(dst, src, len)
+	SEE_char_t *dst;
+	const SEE_char_t *src;
+	unsigned int len;
+{
+	casemap(dst, src, len, 'a');
+}
+
+unsigned int
+_SEE_chars_mismatch(a, b, len)
+	const SEE_char_t *a, *b;
+	unsigned int len;
+{
+	unsigned int i = 0;
+#if SIMD_SSE2
+	unsigned int mask;
+
+	for (; i + 8 <= len; i += 8) {
+	    mask = _mm_movemask_epi8(_mm_cmpeq_epi16(
+		_mm_loadu_si128((const __m128i *)(a + i)),
+		_mm_loadu_si128((const __m128i *)(b + i))));
+	    if (mask != 0xffff)
+		return i + SIMD_CTZ(~mask) / 2;
+	}
+#endif
+	for (; i < len; i++)
+	    if (a[i] != b[i])
+		break;
+	return i;
+}
+
+/* Compares code units [i, end) after mapping them to upper case */
+static int
+casecmp_scalar(a, b, i, end)
+	const SEE_char_t *a, *b;
+	unsigned int i, end;
+{
+	SEE_unicode_t ca, cb;
+
+	for (; i < end; i++)
+	    if (a[i] != b[i]) {
+		ca = CASEMAP_TOUPPER(a[i]);
+		cb = CASEMAP_TOUPPER(b[i]);
+		if (ca != cb)
+		    return ca < cb ? -1 : 1;
+	    }
+	return 0;
+}
+
+int
+_SEE_casecmp_chars(a, b, len)
+	const SEE_char_t *a, *b;
+	unsigned int len;
+{
+	unsigned int i = 0;
+#if SIMD_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i high = _mm_set1_epi16((short)0xff80);
+	const __m128i lo = _mm_set1_epi16('a' - 1);
+	const __m128i hi = _mm_set1_epi16('z' + 1);
+	const __m128i flip = _mm_set1_epi16(0x20);
+	__m128i va, vb;
+	unsigned int mask;
+	int cmp;
+
+	/* Pure ASCII blocks of 8 are compared after upper-casing both */
+	for (; i + 8 <= len; i += 8) {
+	    va = _mm_loadu_si128((const __m128i *)(a + i));
+	    vb = _mm_loadu_si128((const __m128i *)(b + i));
+	    if (_mm_movemask_epi8(_mm_cmpeq_epi16(zero,
+		_mm_and_si128(_mm_or_si128(va, vb), high))) != 0xffff)
+	    {
+		if ((cmp = casecmp_scalar(a, b, i, i + 8)) != 0)
+		    return cmp;
+		continue;
+	    }
+	    va = _mm_xor_si128(va, _mm_and_si128(flip, _mm_and_si128(
+		_mm_cmpgt_epi16(va, lo), _mm_cmplt_epi16(va, hi))));
+	    vb = _mm_xor_si128(vb, _mm_and_si128(flip, _mm_and_si128(
+		_mm_cmpgt_epi16(vb, lo), _mm_cmplt_epi16(vb, hi))));
+	    mask = _mm_movemask_epi8(_mm_cmpeq_epi16(va, vb));
+	    if (mask != 0xffff)
+		return casecmp_scalar(a, b, i + SIMD_CTZ(~mask) / 2, i + 8);
+	}
+#endif
+	return casecmp_scalar(a, b, i, len);
+}
+
+/*
+ * The canonical table stores, for each code unit c, the difference
+ * between c and its canonical form, modulo 0x10000. Pages where every
+ * character is already canonical all share one page of zeros, so
+ * only the few dozen pages holding cased letters are allocated.
+ */
+const SEE_char_t *_SEE_canon_page[256];
+unsigned char _SEE_canon_multi[0x10000 / 8];
+
+static const SEE_char_t canon_identity[256];
+static int canon_ready;
+
+void
+_SEE_canon_init()
+{
+	SEE_char_t delta[256], *page;
+	unsigned int p, i, c, u, diff;
+
+	if (canon_ready)
+	    return;
+
+	/* The pages belong to no interpreter; only this table holds them */
+	_SEE_gc_add_root((void *)_SEE_canon_page, sizeof _SEE_canon_page);
+
+	for (p = 0; p < 256; p++) {
+	    diff = 0;
+	    for (i = 0; i < 256; i++) {
+		c = p << 8 | i;
+		delta[i] = (SEE_char_t)(CASEMAP_TOUPPER(c) - c);
+		diff |= delta[i];
+	    }
+	    if (diff) {
+		page = SEE_NEW_STRING_ARRAY(NULL, SEE_char_t, 256);
+		memcpy(page, delta, sizeof delta);
+		_SEE_canon_page[p] = page;
+	    } else
+		_SEE_canon_page[p] = canon_identity;
+	}
+
+	for (c = 0; c < 0x10000; c++) {
+	    u = CASEMAP_CANON(c);
+	    if (c != u && c != CASEMAP_TOLOWER(u))
+		_SEE_canon_multi[u >> 3] |= 1 << (u & 7);
+	}
+	canon_ready = 1;
+}
@@ -0,0 +1,78 @@
+/* Copyright (c) 2008, David Leonard. All rights reserved. */
+/* $Id$ */
+
+#ifndef _SEE_h_casemap_
+#define _SEE_h_casemap_
+
+#include <see/type.h>
+#include "unicode.h"
+
+/*
+ * Bulk case mapping and comparison of UTF-16 text.
+ *
+ * Runs of 7-bit ASCII are mapped through small tables, or in blocks
+ * of 16 (SSE2) or 32 (AVX2) code units at a time with vector
+ * instructions. Other code units are mapped one at a time through
+ * the Unicode case tables (unicase.c).
+ *
+ * _SEE_tolower_chars() and _SEE_toupper_chars() store the case-mapped
+ * text of src[0..len-1] into dst, which may be the same as src.
+ *
+ * _SEE_chars_mismatch() returns the index of the first code unit
+ * where a and b differ, or len if they are the same.
+ *
+ * _SEE_casecmp_chars() compares a and b after mapping each code unit
+ * to upper case (the canonical form used by case-insensitive regular
+ * expressions, 15.10.2.8) and returns -1, 0 or +1.
+ */
+void _SEE_tolower_chars(SEE_char_t *dst, const SEE_char_t *src,
+	unsigned int len);
+void _SEE_toupper_chars(SEE_char_t *dst, const SEE_char_t *src,
+	unsigned int len);
+unsigned int _SEE_chars_mismatch(const SEE_char_t *a, const SEE_char_t *b,
+	unsigned int len);
+int _SEE_casecmp_chars(const SEE_char_t *a, const SEE_char_t *b,
+	unsigned int len);
+
+extern const unsigned char _SEE_ascii_tolower[128];
+extern const unsigned char _SEE_ascii_toupper[128];
+
+/*
+ * Single character mappings with a table lookup for ASCII. The
+ * argument must be a UTF-16 code unit (below 0x10000).
+ */
+#define CASEMAP_TOLOWER(c)					\
+	((c) < 0x80 ? (SEE_unicode_t)_SEE_ascii_tolower[c] :	\
+	 (SEE_unicode_t)UNICODE_TOLOWER(c))
+#define CASEMAP_TOUPPER(c)					\
+	((c) < 0x80 ? (SEE_unicode_t)_SEE_ascii_toupper[c] :	\
+	 (SEE_unicode_t)UNICODE_TOUPPER(c))
+
+/*
+ * Canonical characters for case-insensitive regular expressions
+ * (15.10.2.8), looked up in a two-level table that maps each UTF-16
+ * code unit to its upper case form. _SEE_canon_init() builds the
+ * table on first use; it is then shared by all interpreters.
+ *
+ * CASEMAP_CANON() and CASEMAP_CANON_MULTI() take a UTF-16 code unit;
+ * CASEMAP_UCANON() accepts any SEE_unicode_t and leaves characters
+ * above U+FFFF unchanged.
+ *
+ * CASEMAP_CANON_MULTI(u) is true if the canonical character u is
+ * also the canonical form of some character other than u and
+ * CASEMAP_TOLOWER(u), such as U+0131 (dotless i) for 'I'.
+ */
+void _SEE_canon_init(void);
+
+extern const SEE_char_t *_SEE_canon_page[256];
+extern unsigned char _SEE_canon_multi[0x10000 / 8];
+
+#define CASEMAP_CANON(c)					\
+	((SEE_unicode_t)(SEE_char_t)((c) +			\
+	    _SEE_canon_page[(c) >> 8][(c) & 0xff]))
+#define CASEMAP_UCANON(u)					\
+	((u) < 0x10000 ? CASEMAP_CANON(u) : (u))
+#define CASEMAP_CANON_MULTI(u)					\
+	((_SEE_canon_multi[(u) >> 3] >> ((u) & 7)) & 1)
+
+#endif /* _SEE_h_casemap_ */
@@ -54,6 +54,8 @@
 
 #include "stringdefs.h"
 #include "cfunction_private.h"
+#include "utf8.h"
+#include "gc.h"
 
 /*
  * cfunction
@@ -99,6 +101,7 @@ static struct SEE_string *from_utf8_string(struct SEE_interpreter *,
 	const char *);
 static void *cfunction_get_sec_domain(struct SEE_interpreter *, 
 	struct SEE_object *);
+static void cfunction_trace(struct SEE_object *);
 
 /*
  * CFunction object class
@@ -115,7 +118,8 @@ struct SEE_objectclass SEE_cfunction_class = {
 	NULL,			/* Construct (15) */
 	cfunction_call,		/* Call */
 	NULL,			/* HasInstance */
-	cfunction_get_sec_domain/* get_sec_domain */
+	cfunction_get_sec_domain,/* get_sec_domain */
+	cfunction_trace		/* trace */
 };
 
 /*
@@ -138,10 +142,24 @@ SEE_cfunction_make(interp, func, name, length)
 	f->name = name;
 	f->length = length;
 	f->sec_domain = interp->sec_domain;
+	_SEE_gc_object(&f->object);
 
 	return (struct SEE_object *)f;
 }
 
+/* Garbage collector trace hook for CFunction objects */
+static void
+cfunction_trace(o)
+	struct SEE_object *o;
+{
+	struct cfunction *f = (struct cfunction *)o;
+
+	SEE_gc_mark(o->Prototype);
+	SEE_gc_mark(o->host_data);
+	SEE_gc_mark(f->name);
+	SEE_gc_mark(f->sec_domain);
+}
+
 static struct cfunction *
 tocfunction(interp, o)
 	struct SEE_interpreter *interp;
@@ -308,15 +326,7 @@ from_utf8_string(interp, cp)
 	struct SEE_interpreter *interp;
 	const char *cp;
 {
-	struct SEE_string *s;
-	struct SEE_input *input;
-
-	s = SEE_string_new(interp, 0);
-	input = SEE_input_utf8(interp, cp);
-
-	while (!input->eof) 
-		SEE_string_addch(s, SEE_INPUT_NEXT(input));
-	return s;
+	return _SEE_utf8_to_string(interp, cp, strlen(cp));
 }
 
 void
@@ -58,6 +58,7 @@
 #include "enumerate.h"
 #include "code1.h"
 #include "replace.h"
+#include "gc.h"
 
 struct block {
     enum { BLOCK_ENUM, BLOCK_WITH, BLOCK_TRYC, BLOCK_TRYF, BLOCK_FINALLY } type;
@@ -118,6 +119,7 @@ static unsigned int add_function(struct code1 *code, struct function *f);
 static unsigned int add_var(struct code1 *code, struct SEE_string *ident);
 static void add_byte(struct code1 *code, unsigned int c);
 static unsigned int here(struct code1 *code);
+static void code1_trace(void *);
 
 
 static struct SEE_code_class code1_class = {
@@ -150,6 +152,7 @@ _SEE_code1_alloc(interp)
     struct code1 *co;
     
     co = SEE_NEW(interp, struct code1);
+    _SEE_gc_typed(co, code1_trace);
     co->code.code_class = &code1_class;
     co->code.interpreter = interp;
 
@@ -164,6 +167,32 @@ _SEE_code1_alloc(interp)
     return (struct SEE_code *)co;
 }
 
+/*
+ * Garbage collector tracer for code objects. Each generated array is
+ * in storage of its own; only the literals, the location file names
+ * and the functions refer to other storage.
+ */
+static void
+code1_trace(p)
+    void *p;
+{
+    struct code1 *co = (struct code1 *)p;
+    unsigned int i;
+
+    SEE_gc_mark(co->code.interpreter);
+    _SEE_gc_mark_leaf(co->inst);
+    _SEE_gc_mark_leaf(co->var);
+    _SEE_gc_mark_leaf(co->literal);
+    for (i = 0; i < co->nliteral; i++)
+	SEE_gc_mark_value(&co->literal[i]);
+    _SEE_gc_mark_leaf(co->location);
+    for (i = 0; i < co->nlocation; i++)
+	SEE_gc_mark(co->location[i].filename);
+    _SEE_gc_mark_leaf(co->func);
+    for (i = 0; i < co->nfunc; i++)
+	SEE_gc_mark(co->func[i]);
+}
+
 /* Adds a (unique) literal to the code object, returning its index */
 static unsigned int
 add_literal(code, val)
@@ -1065,7 +1094,7 @@ code1_exec(sco, ctxt, res)
 
 	case INST_REGEXP:
 	    PUSH(vp);	/* obj */
-	    SEE_SET_OBJECT(vp, interp->RegExp);
+	    SEE_SET_OBJECT(vp, SEE_INTERP_REGEXP(interp));
 	    break;
 
 	case INST_REF:
@@ -1477,6 +1506,8 @@ code1_exec(sco, ctxt, res)
 		struct SEE_context context2;
 		memcpy(&context2, ctxt, sizeof context2);
 		context2.scope = scope;
+		/* The code may capture an activation on the frame stack */
+		_SEE_activation_pin(interp, ctxt->activation);
 		if (arg == 0)
 		    SEE_SET_UNDEFINED(vp);
 		else if (SEE_VALUE_GET_TYPE(argv[0]) != SEE_STRING)
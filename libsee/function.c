@@ -48,6 +48,9 @@
 #include "function.h"
 #include "parse.h"
 #include "stringdefs.h"
+#include "gc.h"
+
+static void function_trace(void *);
 
 /*
  * A function is an internal object that embodies executable code, and
@@ -80,6 +83,7 @@ SEE_function_make(interp, name, params, body)
 	struct SEE_object *F;
 
 	f = SEE_NEW(interp, struct function);
+	_SEE_gc_typed(f, function_trace);
 
 	f->body = body;
 	f->sec_domain = interp->sec_domain;
@@ -103,6 +107,8 @@ SEE_function_make(interp, name, params, body)
 	f->next = NULL;
 	f->cache = NULL;
 	f->common = NULL;
+	f->noescape = 0;
+	f->activation = NULL;
 
 	/* 13.2 step 2: make object F */
 	F = SEE_function_inst_create(interp, f, NULL);
@@ -166,3 +172,28 @@ SEE_function_put_args(context, f, argc, argv)
 		i < argc ? argv[i] : &undefv,
 		context->varattr);
 }
+
+/*
+ * Garbage collector tracer for functions. The parameter names are
+ * kept in storage of their own.
+ */
+static void
+function_trace(p)
+	void *p;
+{
+	struct function *f = (struct function *)p;
+	int i;
+
+	if (f->params) {
+	    _SEE_gc_mark_leaf(f->params);
+	    for (i = 0; i < f->nparams; i++)
+		SEE_gc_mark(f->params[i]);
+	}
+	SEE_gc_mark(f->body);
+	SEE_gc_mark(f->name);
+	SEE_gc_mark(f->common);
+	SEE_gc_mark(f->cache);
+	SEE_gc_mark(f->next);
+	SEE_gc_mark(f->activation);
+	SEE_gc_mark(f->sec_domain);
+}
@@ -26,6 +26,8 @@ struct function {
 	struct SEE_object *cache;	/* used by SEE_Function_create() */
 	struct function *next;		/* linked list of functions */
 	int is_empty;			/* true if body is empty */
+	int noescape;			/* activations go on the frame stack */
+	struct SEE_object *activation;	/* innermost running call's */
 	void *sec_domain;		/* security domain active when defined */
 };
 
@@ -37,6 +39,7 @@ void SEE_function_put_args(struct SEE_context *i, struct function *func,
 extern struct SEE_objectclass SEE_activation_class;
 #define IS_ACTIVATION_OBJECT(o) ((o)->objectclass == &SEE_activation_class)
 struct SEE_object *SEE_activation_new(struct SEE_interpreter * i);
+void _SEE_activation_pin(struct SEE_interpreter *, struct SEE_object *);
 
 /* obj_Function.c */
 struct SEE_object *SEE_function_inst_create(struct SEE_interpreter *i,
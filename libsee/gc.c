@@ -0,0 +1,1788 @@
+/*
+ * Copyright (c) 2008
+ *      David Leonard.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of David Leonard nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/* $Id$ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#if STDC_HEADERS
+# include <stdio.h>
+# include <stdlib.h>
+# include <stddef.h>
+#endif
+
+#if HAVE_STRING_H
+# include <string.h>
+#endif
+
+#include <setjmp.h>
+
+#if TIME_WITH_SYS_TIME
+# include <sys/time.h>
+# include <time.h>
+#else
+# if HAVE_SYS_TIME_H
+#  include <sys/time.h>
+# else
+#  include <time.h>
+# endif
+#endif
+
+#include <see/mem.h>
+#include <see/value.h>
+#include <see/object.h>
+#include <see/native.h>
+#include <see/system.h>
+
+#include "dprint.h"
+#include "gc.h"
+
+#if WITH_SEE_GC
+
+#if defined(__GLIBC__)
+extern void *__libc_stack_end;
+#endif
+
+#if defined(__GNUC__)
+# define GC_NOINLINE	__attribute__((noinline))
+#else
+# define GC_NOINLINE
+#endif
+
+/* The conservative scanners read stack memory that ASan poisons */
+#if defined(__SANITIZE_ADDRESS__)
+# define GC_NO_SANITIZE	__attribute__((no_sanitize_address))
+#elif defined(__has_feature)
+# if __has_feature(address_sanitizer)
+#  define GC_NO_SANITIZE __attribute__((no_sanitize_address))
+# endif
+#endif
+#ifndef GC_NO_SANITIZE
+# define GC_NO_SANITIZE
+#endif
+
+#ifndef NDEBUG
+extern int SEE_mem_debug;
+#endif
+
+/*
+ * The heap is a sorted array of chunks obtained from malloc(). Each
+ * chunk is divided into pages, and each page has a descriptor.
+ * A run of one or more consecutive pages holds either equal-sized
+ * blocks of one size class, or a single large block. The descriptor
+ * of the first page of a run describes the whole run, and keeps
+ * bitmaps with one bit per block.
+ */
+#define GC_PAGE_SHIFT	12
+#define GC_PAGE_SIZE	(1 << GC_PAGE_SHIFT)
+#define GC_GRANULE	16			/* block size and alignment unit */
+#define GC_BITWORDS	(GC_PAGE_SIZE / GC_GRANULE / 32)
+#define GC_MAX_SMALL	4096			/* largest size-class block */
+#define GC_CHUNK_MIN	256			/* least pages in a new chunk */
+#define GC_TRIGGER_MIN	(4 * 1024 * 1024)	/* least bytes between GCs */
+#define GC_NURSERY	(1024 * 1024)		/* bytes between minor GCs */
+#define GC_STACK_MAX	(256 * 1024 * 1024)	/* believable stack depth */
+#define GC_SLICE_BYTES	(64 * 1024)		/* bytes between slices */
+#define GC_SLICE_CHECK	64			/* blocks between clock reads */
+#define GC_MAX_TYPES	255			/* distinct block tracers */
+
+#define BIT_TEST(m, i)	((m)[(i) >> 5] & (1U << ((i) & 31)))
+#define BIT_SET(m, i)	((m)[(i) >> 5] |= 1U << ((i) & 31))
+#define BIT_CLEAR(m, i)	((m)[(i) >> 5] &= ~(1U << ((i) & 31)))
+
+/* Why rescan() must look at a run */
+#define REMEMBER_OLD	1		/* has old, unbarriered blocks */
+#define REMEMBER_DIRTY	2		/* has dirty blocks */
+
+/* Collection phases */
+#define PHASE_IDLE	0		/* not collecting incrementally */
+#define PHASE_SWEEP	1		/* finishing the last sweep */
+#define PHASE_MARK	2		/* marking; allocating black */
+
+/* Page kinds */
+#define PAGE_FREE	0		/* unused */
+#define PAGE_SMALL	1		/* first page of a size-class run */
+#define PAGE_LARGE	2		/* first page of a large block */
+#define PAGE_TAIL	3		/* other pages of a run */
+
+struct chunk;
+
+struct page {
+	unsigned char	 kind;
+	unsigned char	 atomic;	/* blocks are never scanned */
+	unsigned char	 unswept;	/* free blocks are still marked 0 */
+	unsigned char	 touched;	/* sweeping may free some blocks */
+	unsigned char	 sc;		/* size class */
+	unsigned char	 remember;	/* REMEMBER_* */
+	unsigned int	 npages;	/* pages in the run */
+	unsigned int	 size;		/* bytes in each block */
+	unsigned int	 nblocks;	/* blocks in the run */
+	SEE_uint32_t	 inv;		/* 2^32 / size, rounded up */
+	char		*base;		/* address of this page */
+	struct chunk	*chunk;		/* chunk holding this page */
+	struct page	*head;		/* first page of the run */
+	struct page	*next;		/* next run waiting to be swept */
+	void		*freelist;	/* free blocks, in swept runs */
+	char		*bump;		/* first never-used block */
+	char		*limit;		/* end of the last block */
+	unsigned short	*tags;		/* accounting tags, or NULL */
+	unsigned char	*types;		/* tracer indices + 1, or NULL */
+	SEE_uint32_t	 alloc[GC_BITWORDS];	/* blocks in use */
+	SEE_uint32_t	 mark[GC_BITWORDS];	/* reachable (or old) blocks */
+	SEE_uint32_t	 object[GC_BITWORDS];	/* blocks with native objects */
+	SEE_uint32_t	 fin[GC_BITWORDS];	/* blocks with finalizers */
+	SEE_uint32_t	 barriered[GC_BITWORDS]; /* stores are noted */
+	SEE_uint32_t	 dirty[GC_BITWORDS];	/* marked blocks stored into */
+};
+
+struct chunk {
+	char		*base;		/* first page; page-aligned */
+	void		*mem;		/* storage from malloc() */
+	unsigned int	 npages;
+	unsigned int	 nfree;		/* free pages */
+	unsigned int	 hint;		/* no free pages below this one */
+	struct page	 pages[1];	/* npages descriptors */
+};
+
+/*
+ * Size classes. Runs of several pages are used where that wastes less
+ * space; 2176 bytes suits struct SEE_native and its common subtypes.
+ */
+static const struct {
+	unsigned short size, npages;
+} sizeclass[] = {
+	{   16, 1 }, {   32, 1 }, {   48, 1 }, {   64, 1 },
+	{   80, 1 }, {   96, 1 }, {  112, 1 }, {  128, 1 },
+	{  160, 1 }, {  192, 1 }, {  224, 1 }, {  256, 1 },
+	{  320, 1 }, {  384, 1 }, {  448, 1 }, {  512, 1 },
+	{  640, 1 }, {  768, 1 }, { 1024, 1 }, { 1360, 1 },
+	{ 2048, 1 }, { 2176, 8 }, { 2720, 2 }, { 4096, 1 }
+};
+#define NCLASSES	(sizeof sizeclass / sizeof sizeclass[0])
+
+/* Information appended to blocks that have finalizers */
+struct finalize_info {
+	struct SEE_interpreter *interp;
+	void (*finalizefn)(struct SEE_interpreter *, void *, void *);
+	void *closure;
+};
+
+struct finalizer {
+	char		*block;
+	SEE_size_t	 offset;	/* of the struct finalize_info */
+};
+
+struct markent {
+	char		*block;
+	struct page	*pg;
+	unsigned int	 index;
+};
+
+struct root {
+	char		*lo, *hi;
+};
+
+/*
+ * The collector state. It is kept in malloc'd storage, which is never
+ * scanned.
+ */
+static struct heap {
+	struct chunk	**chunks;	/* sorted by address */
+	unsigned int	  nchunks, maxchunks;
+	char		 *lo, *hi;	/* bounds of all the chunks */
+	struct chunk	 *last;		/* most recently found chunk */
+	SEE_size_t	  npages;	/* total pages in all chunks */
+
+	struct {
+		struct page *cur;	/* run being allocated from */
+		struct page *unswept;	/* runs waiting to be swept */
+	} class[2][NCLASSES];		/* indexed by [atomic][class] */
+	unsigned char	  class_of[GC_MAX_SMALL / GC_GRANULE + 1];
+
+	struct markent	 *stack;	/* blocks marked but not scanned */
+	unsigned int	  nstack, maxstack;
+	struct root	 *roots;
+	unsigned int	  nroots, maxroots;
+	void		(*tracers[GC_MAX_TYPES])(void *); /* of typed blocks */
+	unsigned int	  ntracers;
+	struct finalizer *fins;		/* registered finalizers */
+	unsigned int	  nfins, maxfins;
+	struct finalizer *ready;	/* finalizers waiting to run */
+	unsigned int	  nready, maxready;
+
+	SEE_size_t	  allocated;	/* bytes allocated since last GC */
+	SEE_size_t	  marked;	/* bytes marked by the current GC */
+	SEE_size_t	  trigger;	/* allocation that triggers a GC */
+#if WITH_GENERATIONAL_GC
+	SEE_size_t	  promoted;	/* bytes promoted since last full GC */
+	SEE_size_t	  full_trigger;	/* promotion that makes a GC full */
+#endif
+	int		  collecting, finalizing;
+	char		 *stack_hint;	/* cold end of the stack, if unknown */
+
+	int		  phase;	/* PHASE_* */
+	SEE_size_t	  cycle_allocated; /* bytes allocated this cycle */
+	SEE_size_t	  cycle_limit;	/* allocation that ends a cycle */
+	unsigned long	  slice_end;	/* clock when the last pause ended */
+	struct SEE_gc_stats stats;
+} *heap;
+
+/* Prototypes */
+static struct heap *gc_init(void);
+static void *gc_grow_array(void *, unsigned int *, SEE_size_t);
+static struct page *find_block(const void *, unsigned int *);
+static void mark(const void *);
+static void push(char *, struct page *, unsigned int);
+static void requeue(struct page *, unsigned int);
+static void scan_range(const char *, const char *) GC_NO_SANITIZE;
+static void scan_block(char *, struct page *, unsigned int);
+static void drain(void);
+static void mark_stack(void) GC_NOINLINE;
+static void mark_stack_from(const char *, SEE_size_t) 
+	GC_NOINLINE GC_NO_SANITIZE;
+static void mark_roots(void);
+static void mark_finalizable(void);
+static void rescan(void);
+static int drain_some(unsigned long, unsigned long);
+static struct chunk *grow_heap(unsigned int);
+static struct page *alloc_run(unsigned int, int);
+static void release_run(struct page *);
+static struct page *new_small_run(unsigned int, int);
+static int sweep_run(struct page *, int);
+static void finish_sweeping(void);
+static void release_chunks(void);
+static void prepare(void);
+static void collect(int);
+static void finish_collection(int);
+static unsigned long gc_clock(void);
+static void note_pause(unsigned long);
+static void start_cycle(void);
+static int slice(unsigned long);
+static void run_finalizers(void);
+static void tag_block(struct page *, unsigned int, unsigned int);
+static void untag_block(struct page *, unsigned int);
+static void *gc_alloc(SEE_size_t, int, unsigned int);
+
+#if WITH_GENERATIONAL_GC
+# define FULL_GC_DUE()	(heap->promoted >= heap->full_trigger)
+#else
+# define FULL_GC_DUE()	1
+#endif
+
+/*------------------------------------------------------------
+ * Bookkeeping
+ */
+
+/* Creates the collector state on first use */
+static struct heap *
+gc_init()
+{
+	unsigned int i, c;
+
+	heap = (struct heap *)calloc(1, sizeof *heap);
+	if (!heap)
+		return NULL;
+	for (i = 0, c = 0; i <= GC_MAX_SMALL / GC_GRANULE; i++) {
+		while (sizeclass[c].size < i * GC_GRANULE)
+			c++;
+		heap->class_of[i] = c;
+	}
+	heap->trigger = GC_TRIGGER_MIN;
+	return heap;
+}
+
+/* Doubles the capacity of a malloc'd array, aborting on failure */
+static void *
+gc_grow_array(array, maxp, elsz)
+	void *array;
+	unsigned int *maxp;
+	SEE_size_t elsz;
+{
+	unsigned int newmax = *maxp ? *maxp * 2 : 64;
+
+	array = realloc(array, newmax * elsz);
+	if (!array)
+		SEE_ABORT(NULL, "gc: out of memory");
+	*maxp = newmax;
+	return array;
+}
+
+/* Finds the run and index of the block containing p, or returns NULL */
+static struct page *
+find_block(p, indexp)
+	const void *p;
+	unsigned int *indexp;
+{
+	const char *cp = (const char *)p;
+	struct chunk *ch = heap->last;
+	struct page *pg;
+	unsigned int lo, hi, mid, i;
+
+	if (cp < heap->lo || cp >= heap->hi)
+		return NULL;
+	if (!ch || cp < ch->base || 
+	    cp >= ch->base + ((SEE_size_t)ch->npages << GC_PAGE_SHIFT))
+	{
+		lo = 0;
+		hi = heap->nchunks;
+		for (;;) {
+			if (lo >= hi)
+				return NULL;
+			mid = (lo + hi) / 2;
+			ch = heap->chunks[mid];
+			if (cp < ch->base)
+				hi = mid;
+			else if (cp >= ch->base + 
+			    ((SEE_size_t)ch->npages << GC_PAGE_SHIFT))
+				lo = mid + 1;
+			else
+				break;
+		}
+		heap->last = ch;
+	}
+	pg = ch->pages[(cp - ch->base) >> GC_PAGE_SHIFT].head;
+	switch (pg ? pg->kind : PAGE_FREE) {
+	case PAGE_SMALL:
+		i = (unsigned int)(((SEE_uint64_t)(cp - pg->base) * pg->inv)
+		    >> 32);
+		if (i >= pg->nblocks)
+			return NULL;
+		*indexp = i;
+		return pg;
+	case PAGE_LARGE:
+		*indexp = 0;
+		return pg;
+	default:
+		return NULL;
+	}
+}
+
+/*------------------------------------------------------------
+ * Marking
+ */
+
+/* Marks the block containing p, and queues it for scanning */
+static void
+mark(p)
+	const void *p;
+{
+	struct page *pg;
+	unsigned int i;
+
+	if (!(pg = find_block(p, &i)))
+		return;
+	if (!BIT_TEST(pg->alloc, i) || BIT_TEST(pg->mark, i))
+		return;
+	BIT_SET(pg->mark, i);
+	heap->marked += pg->size;
+	if (!pg->atomic)
+		push(pg->base + i * pg->size, pg, i);
+}
+
+static void
+push(block, pg, index)
+	char *block;
+	struct page *pg;
+	unsigned int index;
+{
+	struct markent *e;
+
+	if (heap->nstack == heap->maxstack)
+		heap->stack = (struct markent *)gc_grow_array(heap->stack,
+		    &heap->maxstack, sizeof *heap->stack);
+	e = &heap->stack[heap->nstack++];
+	e->block = block;
+	e->pg = pg;
+	e->index = index;
+}
+
+/*
+ * Queues a marked block to be scanned again, because a pointer was
+ * stored into it while marking incrementally. Its dirty bit means it
+ * is queued, until it is scanned.
+ */
+static void
+requeue(pg, index)
+	struct page *pg;
+	unsigned int index;
+{
+	if (pg->atomic || BIT_TEST(pg->dirty, index))
+		return;
+	BIT_SET(pg->dirty, index);
+	push(pg->base + index * pg->size, pg, index);
+}
+
+/* Conservatively marks every word in [lo,hi) that points into the heap */
+static void
+scan_range(lo, hi)
+	const char *lo, *hi;
+{
+	char * const *p;
+	char *q;
+
+	p = (char * const *)(((SEE_size_t)lo + sizeof (void *) - 1) & 
+	    ~(SEE_size_t)(sizeof (void *) - 1));
+	for (; (const char *)(p + 1) <= hi; p++) {
+		q = *p;
+		if (q >= heap->lo && q < heap->hi)
+			mark(q);
+	}
+}
+
+/*
+ * Scans the contents of a block. Native objects whose class has a
+ * trace hook, and blocks given a tracer by _SEE_gc_typed(), are traced
+ * precisely; other blocks are scanned conservatively.
+ */
+static void
+scan_block(block, pg, index)
+	char *block;
+	struct page *pg;
+	unsigned int index;
+{
+	struct SEE_object *obj = (struct SEE_object *)block;
+
+	if (BIT_TEST(pg->object, index) && obj->objectclass &&
+	    obj->objectclass->trace)
+		(*obj->objectclass->trace)(obj);
+	else if (pg->types && pg->types[index])
+		(*heap->tracers[pg->types[index] - 1])(block);
+	else
+		scan_range(block, block + pg->size);
+}
+
+/* Scans queued blocks until there are none left */
+static void
+drain()
+{
+	struct markent e;
+
+	while (heap->nstack) {
+		e = heap->stack[--heap->nstack];
+		BIT_CLEAR(e.pg->dirty, e.index);
+		scan_block(e.block, e.pg, e.index);
+	}
+}
+
+/*
+ * Scans queued blocks until there are none left, or until budget
+ * microseconds have passed since start. Returns true if none are left.
+ */
+static int
+drain_some(start, budget)
+	unsigned long start, budget;
+{
+	struct markent e;
+	unsigned int n = 0;
+
+	while (heap->nstack) {
+		e = heap->stack[--heap->nstack];
+		BIT_CLEAR(e.pg->dirty, e.index);
+		scan_block(e.block, e.pg, e.index);
+		if (++n % GC_SLICE_CHECK == 0 && gc_clock() - start >= budget)
+			return heap->nstack == 0;
+	}
+	return 1;
+}
+
+/* Spills the registers into this frame, then scans the stack */
+static void
+mark_stack()
+{
+	jmp_buf regs;
+
+#if defined(__GNUC__)
+	__builtin_unwind_init();
+#endif
+	memset(regs, 0, sizeof regs);	/* setjmp() may not fill it */
+	setjmp(regs);
+	mark_stack_from((const char *)regs, sizeof regs);
+}
+
+static void
+mark_stack_from(regs, regsize)
+	const char *regs;
+	SEE_size_t regsize;
+{
+	volatile char here;
+	const char *lo = (const char *)&here, *hi = NULL;
+
+#if defined(__GLIBC__)
+	hi = (const char *)__libc_stack_end;
+	if (!(lo < hi && hi - lo < GC_STACK_MAX))
+		hi = NULL;		/* not on the main thread's stack */
+#endif
+	if (!hi)
+		hi = heap->stack_hint;
+	scan_range(regs, regs + regsize);
+	if (hi && lo < hi)
+		scan_range(lo, hi);
+}
+
+/* Marks the roots, the blocks waiting to be finalized, and the stack */
+static void
+mark_roots()
+{
+	unsigned int i;
+
+	for (i = 0; i < heap->nroots; i++) {
+		mark(heap->roots[i].lo);
+		scan_range(heap->roots[i].lo, heap->roots[i].hi);
+	}
+	for (i = 0; i < heap->nready; i++)
+		mark(heap->ready[i].block);
+	mark_stack();
+}
+
+/*
+ * Finalizable blocks that are unreachable are finalized in order: a
+ * block is not finalized while another unreachable finalizable block
+ * refers to it. The blocks to be finalized are kept alive (with all
+ * they refer to) until their finalizers have run.
+ */
+static void
+mark_finalizable()
+{
+	struct finalizer *f;
+	struct page *pg;
+	unsigned int i, j, index;
+
+	for (i = 0; i < heap->nfins; i++) {
+		f = &heap->fins[i];
+		pg = find_block(f->block, &index);
+		if (!BIT_TEST(pg->mark, index)) {
+			scan_block(f->block, pg, index);
+			drain();
+		}
+	}
+
+	for (i = j = 0; i < heap->nfins; i++) {
+		f = &heap->fins[i];
+		pg = find_block(f->block, &index);
+		if (BIT_TEST(pg->mark, index)) {
+			heap->fins[j++] = *f;
+			continue;
+		}
+		BIT_CLEAR(pg->fin, index);
+		if (heap->nready == heap->maxready)
+			heap->ready = (struct finalizer *)gc_grow_array(
+			    heap->ready, &heap->maxready, sizeof *heap->ready);
+		heap->ready[heap->nready++] = *f;
+		mark(f->block);
+		drain();
+	}
+	heap->nfins = j;
+}
+
+/*
+ * Rescans marked blocks that may refer to unmarked ones: the old blocks
+ * in a minor collection, or the blocks that were marked (or allocated)
+ * during an incremental collection. Any such block may have been
+ * stored into, except for barriered blocks, which are looked at only
+ * if the write barrier noted a store into them.
+ */
+static void
+rescan()
+{
+	unsigned int c, i, n, w, index;
+	SEE_uint32_t live;
+	struct chunk *ch;
+	struct page *pg;
+	char *b;
+
+	for (c = 0; c < heap->nchunks; c++) {
+	    ch = heap->chunks[c];
+	    for (i = 0; i < ch->npages; i += n) {
+		pg = &ch->pages[i];
+		n = pg->kind == PAGE_FREE ? 1 : pg->npages;
+		if (pg->kind == PAGE_FREE || pg->kind == PAGE_TAIL ||
+		    pg->atomic || (pg->kind == PAGE_SMALL && !pg->remember))
+			continue;
+		for (w = 0; w < GC_BITWORDS; w++) {
+		    live = pg->alloc[w] & pg->mark[w];
+		    for (index = w * 32; live; index++, live >>= 1) {
+			if (!(live & 1))
+				continue;
+			b = pg->base + index * pg->size;
+			if (!BIT_TEST(pg->barriered, index) ||
+			    BIT_TEST(pg->dirty, index))
+				scan_block(b, pg, index);
+		    }
+		}
+		memset(pg->dirty, 0, sizeof pg->dirty);
+		pg->remember &= ~REMEMBER_DIRTY;
+		drain();
+	    }
+	}
+}
+
+/*------------------------------------------------------------
+ * Pages and runs
+ */
+
+/* Adds a new chunk of at least npages pages to the heap */
+static struct chunk *
+grow_heap(npages)
+	unsigned int npages;
+{
+	struct chunk *ch;
+	unsigned int n, i;
+	void *mem = NULL;
+
+	n = npages;
+	if (n < GC_CHUNK_MIN)
+		n = GC_CHUNK_MIN;
+	if (n < heap->npages / 2)
+		n = heap->npages / 2;
+	if ((((SEE_size_t)n + 1) << GC_PAGE_SHIFT >> GC_PAGE_SHIFT) !=
+	    (SEE_size_t)n + 1)
+		return NULL;
+	while (!(mem = malloc(((SEE_size_t)n + 1) << GC_PAGE_SHIFT)))
+		if (n == npages)
+			return NULL;
+		else
+			n = npages;
+	ch = (struct chunk *)malloc(offsetof(struct chunk, pages) + 
+	    n * sizeof (struct page));
+	if (!ch) {
+		free(mem);
+		return NULL;
+	}
+	if (heap->nchunks == heap->maxchunks)
+		heap->chunks = (struct chunk **)gc_grow_array(heap->chunks,
+		    &heap->maxchunks, sizeof *heap->chunks);
+
+	ch->mem = mem;
+	ch->base = (char *)(((SEE_size_t)mem + GC_PAGE_SIZE - 1) &
+	    ~(SEE_size_t)(GC_PAGE_SIZE - 1));
+	ch->npages = n;
+	ch->nfree = n;
+	ch->hint = 0;
+	memset(ch->pages, 0, n * sizeof (struct page));
+	for (i = 0; i < n; i++) {
+		ch->pages[i].base = ch->base + ((SEE_size_t)i << GC_PAGE_SHIFT);
+		ch->pages[i].chunk = ch;
+	}
+
+	for (i = heap->nchunks; i > 0 && heap->chunks[i - 1]->base > ch->base;
+	    i--)
+		heap->chunks[i] = heap->chunks[i - 1];
+	heap->chunks[i] = ch;
+	heap->nchunks++;
+	if (!heap->lo || ch->base < heap->lo)
+		heap->lo = ch->base;
+	if (ch->base + ((SEE_size_t)n << GC_PAGE_SHIFT) > heap->hi)
+		heap->hi = ch->base + ((SEE_size_t)n << GC_PAGE_SHIFT);
+	heap->npages += n;
+	return ch;
+}
+
+/* Allocates a run of npages free pages, growing the heap if need be */
+static struct page *
+alloc_run(npages, kind)
+	unsigned int npages;
+	int kind;
+{
+	struct chunk *ch = NULL;
+	struct page *pg;
+	unsigned int c, i, j;
+
+	for (c = 0; c < heap->nchunks; c++) {
+		ch = heap->chunks[c];
+		if (ch->nfree < npages)
+			continue;
+		for (i = ch->hint; i + npages <= ch->npages; i += j) {
+			if (ch->pages[i].kind != PAGE_FREE) {
+				j = ch->pages[i].npages;
+				continue;
+			}
+			for (j = 1; j < npages && 
+			    ch->pages[i + j].kind == PAGE_FREE; j++)
+				;
+			if (j == npages)
+				goto found;
+		}
+	}
+	if (!(ch = grow_heap(npages)))
+		return NULL;
+	i = 0;
+    found:
+	if (i == ch->hint)
+		ch->hint = i + npages;
+	ch->nfree -= npages;
+	pg = &ch->pages[i];
+	pg->kind = kind;
+	pg->npages = npages;
+	pg->head = pg;
+	pg->unswept = 0;
+	pg->touched = 0;
+	pg->freelist = NULL;
+	pg->bump = pg->limit = NULL;
+	pg->next = NULL;
+	memset(pg->alloc, 0, sizeof pg->alloc);
+	memset(pg->mark, 0, sizeof pg->mark);
+	memset(pg->object, 0, sizeof pg->object);
+	memset(pg->fin, 0, sizeof pg->fin);
+	memset(pg->barriered, 0, sizeof pg->barriered);
+	memset(pg->dirty, 0, sizeof pg->dirty);
+	pg->remember = 0;
+	for (j = 1; j < npages; j++) {
+		pg[j].kind = PAGE_TAIL;
+		pg[j].head = pg;
+	}
+	return pg;
+}
+
+/* Returns a run's pages to its chunk */
+static void
+release_run(pg)
+	struct page *pg;
+{
+	struct chunk *ch = pg->chunk;
+	unsigned int i, n = pg->npages;
+
+	for (i = 0; i < n; i++) {
+		pg[i].kind = PAGE_FREE;
+		pg[i].head = NULL;
+	}
+	free(pg->tags);
+	pg->tags = NULL;
+	free(pg->types);
+	pg->types = NULL;
+	ch->nfree += n;
+	i = pg - ch->pages;
+	if (i < ch->hint)
+		ch->hint = i;
+}
+
+/*
+ * Allocates a run of blocks of a size class, all of them free.
+ * Its blocks are handed out by bumping a pointer until it is swept.
+ */
+static struct page *
+new_small_run(sc, atomic)
+	unsigned int sc;
+	int atomic;
+{
+	struct page *pg;
+
+	pg = alloc_run(sizeclass[sc].npages, PAGE_SMALL);
+	if (!pg)
+		return NULL;
+	pg->sc = sc;
+	pg->atomic = atomic;
+	pg->size = sizeclass[sc].size;
+	pg->nblocks = (pg->npages << GC_PAGE_SHIFT) / pg->size;
+	pg->inv = (SEE_uint32_t)((((SEE_uint64_t)1 << 32) + pg->size - 1) /
+	    pg->size);
+	pg->bump = pg->base;
+	pg->limit = pg->base + pg->nblocks * pg->size;
+	return pg;
+}
+
+/*
+ * Sweeps a run, collecting its unmarked blocks into its free list.
+ * An empty run is released, unless keep_empty is true. Runs that have
+ * not been allocated from since a minor collection are left as they
+ * are, since all their blocks are old.
+ * Returns true if the run was kept and has free blocks.
+ */
+static int
+sweep_run(pg, keep_empty)
+	struct page *pg;
+	int keep_empty;
+{
+	unsigned int i, nlive = 0;
+	void *list = NULL;
+	char *b;
+
+	pg->unswept = 0;
+	if (!pg->touched)
+		return pg->freelist != NULL || pg->bump != pg->limit;
+	pg->touched = 0;
+	if (pg->tags)
+		for (i = 0; i < pg->nblocks; i++)
+			if (BIT_TEST(pg->alloc, i) && !BIT_TEST(pg->mark, i))
+				untag_block(pg, i);
+	memcpy(pg->alloc, pg->mark, sizeof pg->alloc);
+	for (i = pg->nblocks; i-- > 0; ) {
+		if (BIT_TEST(pg->mark, i)) {
+			nlive++;
+			continue;
+		}
+		BIT_CLEAR(pg->object, i);
+		BIT_CLEAR(pg->barriered, i);
+		if (pg->types)
+			pg->types[i] = 0;
+		b = pg->base + i * pg->size;
+		*(void **)b = list;
+		list = b;
+	}
+	pg->freelist = list;
+	pg->bump = pg->limit;
+	pg->remember &= ~REMEMBER_OLD;
+	if (!pg->atomic)
+		for (i = 0; i < GC_BITWORDS; i++)
+			if (pg->mark[i] & ~pg->barriered[i]) {
+				pg->remember |= REMEMBER_OLD;
+				break;
+			}
+	if (nlive == 0 && !keep_empty) {
+		release_run(pg);
+		return 0;
+	}
+	return list != NULL;
+}
+
+/* Sweeps all the runs that were left unswept by the last GC */
+static void
+finish_sweeping()
+{
+	struct page *pg;
+	unsigned int a, c;
+
+	for (a = 0; a < 2; a++)
+	    for (c = 0; c < NCLASSES; c++) {
+		while ((pg = heap->class[a][c].unswept) != NULL) {
+			heap->class[a][c].unswept = pg->next;
+			sweep_run(pg, 0);
+		}
+	    }
+}
+
+/* Returns all but one of the wholly free chunks to the system */
+static void
+release_chunks()
+{
+	unsigned int c, j;
+	struct chunk *ch;
+
+	for (c = j = 0; c < heap->nchunks; c++) {
+		ch = heap->chunks[c];
+		if (ch->nfree == ch->npages && heap->nchunks - c + j > 1) {
+			heap->npages -= ch->npages;
+			free(ch->mem);
+			free(ch);
+		} else
+			heap->chunks[j++] = ch;
+	}
+	heap->nchunks = j;
+	heap->last = NULL;
+	if (j) {
+		ch = heap->chunks[j - 1];
+		heap->lo = heap->chunks[0]->base;
+		heap->hi = ch->base + ((SEE_size_t)ch->npages << GC_PAGE_SHIFT);
+	}
+}
+
+/*------------------------------------------------------------
+ * Collection
+ */
+
+/* Marks every block as unreachable, for a full collection */
+static void
+prepare()
+{
+	unsigned int c, i, n;
+	struct chunk *ch;
+	struct page *pg;
+
+	for (c = 0; c < heap->nchunks; c++) {
+	    ch = heap->chunks[c];
+	    for (i = 0; i < ch->npages; i += n) {
+		pg = &ch->pages[i];
+		n = pg->kind == PAGE_FREE ? 1 : pg->npages;
+		if (pg->kind == PAGE_FREE)
+			continue;
+		memset(pg->mark, 0, sizeof pg->mark);
+		memset(pg->dirty, 0, sizeof pg->dirty);
+		pg->remember &= ~REMEMBER_DIRTY;
+		pg->touched = 1;
+	    }
+	}
+}
+
+/*
+ * Collects garbage, stopping the world. A minor collection (only
+ * possible in generational mode) frees only blocks allocated since the
+ * last collection. Any incremental collection in progress is abandoned
+ * for a full one.
+ */
+static void
+collect(full)
+	int full;
+{
+	unsigned long start;
+
+	if (heap->collecting)
+		return;
+	heap->collecting = 1;
+	start = gc_clock();
+	if (heap->phase != PHASE_IDLE) {
+		heap->phase = PHASE_IDLE;
+		heap->nstack = 0;
+		full = 1;
+	}
+
+	finish_sweeping();
+	release_chunks();
+	if (full)
+		prepare();
+	heap->marked = 0;
+	mark_roots();
+	drain();
+#if WITH_GENERATIONAL_GC
+	if (!full)
+		rescan();
+#endif
+	finish_collection(full);
+
+	heap->collecting = 0;
+	note_pause(start);
+	run_finalizers();
+}
+
+/*
+ * Completes a collection once everything reachable is marked: finds
+ * the blocks to finalize, frees unmarked large blocks, and leaves the
+ * other runs to be swept.
+ */
+static void
+finish_collection(full)
+	int full;
+{
+	unsigned int c, i, n;
+	struct chunk *ch;
+	struct page *pg;
+
+	mark_finalizable();
+
+	for (c = 0; c < NCLASSES; c++)
+		heap->class[0][c].cur = heap->class[1][c].cur = NULL;
+	for (c = 0; c < heap->nchunks; c++) {
+	    ch = heap->chunks[c];
+	    for (i = 0; i < ch->npages; i += n) {
+		pg = &ch->pages[i];
+		n = pg->kind == PAGE_FREE ? 1 : pg->npages;
+		if (pg->kind == PAGE_LARGE && !pg->mark[0]) {
+			untag_block(pg, 0);
+			release_run(pg);
+		} else if (pg->kind == PAGE_SMALL && (pg->touched ||
+		    pg->freelist || pg->bump != pg->limit))
+		{
+			pg->unswept = 1;
+			pg->next = heap->class[pg->atomic][pg->sc].unswept;
+			heap->class[pg->atomic][pg->sc].unswept = pg;
+		}
+	    }
+	}
+
+	heap->stats.collections++;
+	heap->allocated = 0;
+#if WITH_GENERATIONAL_GC
+	if (full) {
+		heap->promoted = 0;
+		heap->full_trigger = heap->marked > GC_TRIGGER_MIN ? 
+		    heap->marked : GC_TRIGGER_MIN;
+	} else
+		heap->promoted += heap->marked;
+	heap->trigger = GC_NURSERY;
+#else
+	heap->trigger = heap->marked > GC_TRIGGER_MIN ? heap->marked
+						      : GC_TRIGGER_MIN;
+#endif
+	if (full)
+		heap->stats.live_bytes = heap->marked;
+#ifndef NDEBUG
+	if (SEE_mem_debug)
+		dprintf("gc %lu%s: %lu bytes %s, %lu bytes in heap, "
+		    "%u finalizers ready\n", heap->stats.collections,
+		    full ? "" : " (minor)", (unsigned long)heap->marked, 
+		    full ? "reachable" : "promoted",
+		    (unsigned long)heap->npages << GC_PAGE_SHIFT,
+		    heap->nready);
+#endif
+}
+
+/* Returns a clock in microseconds, for timing pauses */
+static unsigned long
+gc_clock()
+{
+#if HAVE_GETTIMEOFDAY
+	struct timeval tv;
+
+	if (gettimeofday(&tv, NULL) == 0)
+		return (unsigned long)tv.tv_sec * 1000000UL + tv.tv_usec;
+#endif
+	return (unsigned long)((double)clock() * 1e6 / CLOCKS_PER_SEC);
+}
+
+/* Records a pause in the statistics */
+static void
+note_pause(start)
+	unsigned long start;
+{
+	unsigned long now = gc_clock(), pause = now - start;
+
+	heap->stats.pauses++;
+	heap->stats.pause_last = pause;
+	heap->stats.pause_total += pause;
+	if (pause > heap->stats.pause_max)
+		heap->stats.pause_max = pause;
+	heap->slice_end = now;
+}
+
+/*
+ * Begins an incremental collection. The runs left from the last
+ * collection are swept first, then the marks are cleared and the roots
+ * marked, and then the queued blocks are scanned a slice at a time.
+ * Blocks allocated meanwhile are marked, and the write barrier marks
+ * the pointers stored into barriered blocks.
+ */
+static void
+start_cycle()
+{
+	heap->phase = PHASE_SWEEP;
+	heap->cycle_allocated = 0;
+	heap->cycle_limit = heap->trigger;
+	heap->allocated = 0;
+	heap->trigger = GC_SLICE_BYTES;
+	heap->stats.cycles++;
+}
+
+/*
+ * Does up to budget microseconds of work on the incremental collection
+ * in progress, except that the final step (rescanning the roots and
+ * the unbarriered blocks, and finalizing) is always completed once
+ * begun. Returns true if the collection is still in progress.
+ */
+static int
+slice(budget)
+	unsigned long budget;
+{
+	unsigned long start;
+	unsigned int a, c, n = 0;
+	struct page *pg;
+
+	if (heap->collecting || heap->phase == PHASE_IDLE)
+		return heap->phase != PHASE_IDLE;
+	heap->collecting = 1;
+	start = gc_clock();
+	heap->stats.slices++;
+
+	if (heap->phase == PHASE_SWEEP) {
+		for (a = 0; a < 2; a++)
+		    for (c = 0; c < NCLASSES; c++)
+			while ((pg = heap->class[a][c].unswept) != NULL) {
+			    heap->class[a][c].unswept = pg->next;
+			    sweep_run(pg, 0);
+			    if (++n % GC_SLICE_CHECK == 0 && 
+				gc_clock() - start >= budget)
+				    goto out;
+			}
+		release_chunks();
+		prepare();
+		heap->marked = 0;
+		heap->phase = PHASE_MARK;
+		mark_roots();
+	}
+	if (!drain_some(start, budget))
+		goto out;
+
+	/* Everything queued has been scanned: finish atomically */
+	mark_roots();
+	drain();
+	rescan();
+	finish_collection(1);
+	heap->phase = PHASE_IDLE;
+
+    out:
+	heap->collecting = 0;
+	note_pause(start);
+	if (heap->phase == PHASE_IDLE)
+		run_finalizers();
+	return heap->phase != PHASE_IDLE;
+}
+
+/* Runs the finalizers of blocks found unreachable */
+static void
+run_finalizers()
+{
+	struct finalizer f;
+	struct finalize_info *info;
+
+	if (heap->finalizing)
+		return;
+	heap->finalizing = 1;
+	while (heap->nready) {
+		f = heap->ready[--heap->nready];
+		info = (struct finalize_info *)(f.block + f.offset);
+		(*info->finalizefn)(info->interp, f.block, info->closure);
+	}
+	heap->finalizing = 0;
+}
+
+/*------------------------------------------------------------
+ * Allocation
+ */
+
+/*
+ * Records the accounting tag of a newly allocated block, and charges
+ * the block to the tagged account. A run only gets an array of tags
+ * once one of its blocks has a tag; if there is no memory for it, the
+ * block goes unaccounted.
+ */
+static void
+tag_block(pg, index, tag)
+	struct page *pg;
+	unsigned int index, tag;
+{
+	if (!pg->tags) {
+		pg->tags = (unsigned short *)calloc(pg->nblocks, 
+		    sizeof *pg->tags);
+		if (!pg->tags)
+			return;
+	}
+	pg->tags[index] = tag;
+	if (tag)
+		_SEE_mem_charge(tag, pg->size);
+}
+
+/* Credits the account of a block that is being freed */
+static void
+untag_block(pg, index)
+	struct page *pg;
+	unsigned int index;
+{
+	if (pg->tags && pg->tags[index]) {
+		_SEE_mem_release(pg->tags[index], pg->size);
+		pg->tags[index] = 0;
+	}
+}
+
+static void *
+gc_alloc(size, atomic, tag)
+	SEE_size_t size;
+	int atomic;
+	unsigned int tag;
+{
+	struct page *pg;
+	unsigned int sc, npages, i;
+	int retried = 0;
+	void *p;
+
+	if (!heap && !gc_init())
+		return NULL;
+	if (heap->allocated >= heap->trigger) {
+		if (heap->phase != PHASE_IDLE) {
+			heap->cycle_allocated += heap->allocated;
+			heap->allocated = 0;
+			if (heap->cycle_allocated >= heap->cycle_limit)
+				slice(~0UL);	/* cannot keep up */
+			else if (gc_clock() - heap->slice_end >= 
+			    SEE_system.gc_pause_budget ||
+			    heap->cycle_allocated >= heap->cycle_limit / 2)
+				slice(SEE_system.gc_pause_budget);
+		} else if (SEE_system.gc_pause_budget && FULL_GC_DUE()) {
+			start_cycle();
+			slice(SEE_system.gc_pause_budget);
+		} else
+			collect(FULL_GC_DUE());
+	}
+
+    retry:
+	if (size <= GC_MAX_SMALL) {
+		sc = heap->class_of[(size + GC_GRANULE - 1) / GC_GRANULE];
+		pg = heap->class[atomic][sc].cur;
+		while (!pg || (!pg->freelist && pg->bump == pg->limit)) {
+			if ((pg = heap->class[atomic][sc].unswept) != NULL) {
+				heap->class[atomic][sc].unswept = pg->next;
+				if (!sweep_run(pg, 1))
+					continue;
+			} else if (!(pg = new_small_run(sc, atomic)))
+				break;
+			heap->class[atomic][sc].cur = pg;
+			pg->touched = 1;
+		}
+		if (!pg)
+			p = NULL;
+		else {
+			if ((p = pg->freelist) != NULL)
+				pg->freelist = *(void **)p;
+			else {
+				p = pg->bump;
+				pg->bump += pg->size;
+			}
+			i = (unsigned int)(((SEE_uint64_t)((char *)p - 
+			    pg->base) * pg->inv) >> 32);
+			BIT_SET(pg->alloc, i);
+			if (heap->phase == PHASE_MARK) {
+				BIT_SET(pg->mark, i);
+				pg->remember |= REMEMBER_OLD;
+			}
+		}
+	} else {
+		if (size > (SEE_size_t)(unsigned int)-1 - GC_PAGE_SIZE)
+			return NULL;
+		npages = (size + GC_PAGE_SIZE - 1) >> GC_PAGE_SHIFT;
+		pg = alloc_run(npages, PAGE_LARGE);
+		if (pg) {
+			pg->atomic = atomic;
+			pg->size = npages << GC_PAGE_SHIFT;
+			pg->nblocks = 1;
+			pg->alloc[0] = 1;
+			if (heap->phase == PHASE_MARK)
+				pg->mark[0] = 1;
+			p = pg->base;
+			i = 0;
+		} else
+			p = NULL;
+	}
+
+	if (!p) {
+		if (retried++ || heap->collecting)
+			return NULL;
+		collect(1);
+		goto retry;
+	}
+	heap->allocated += pg->size;
+	if (heap->phase == PHASE_MARK)
+		heap->marked += pg->size;
+	if (tag || pg->tags)
+		tag_block(pg, i, tag);
+	if (!atomic)
+		memset(p, 0, pg->size);
+	return p;
+}
+
+void *
+_SEE_gc_malloc(interp, size, file, line)
+	struct SEE_interpreter *interp;
+	SEE_size_t size;
+	const char *file;
+	int line;
+{
+	return gc_alloc(size, 0, _SEE_mem_tag(interp, 0));
+}
+
+void *
+_SEE_gc_malloc_string(interp, size, file, line)
+	struct SEE_interpreter *interp;
+	SEE_size_t size;
+	const char *file;
+	int line;
+{
+	return gc_alloc(size, 1, _SEE_mem_tag(interp, 1));
+}
+
+void *
+_SEE_gc_malloc_finalize(interp, size, finalizefn, closure, file, line)
+	struct SEE_interpreter *interp;
+	SEE_size_t size;
+	void (*finalizefn)(struct SEE_interpreter *, void *, void *);
+	void *closure;
+	const char *file;
+	int line;
+{
+	SEE_size_t padsz;
+	struct finalize_info *info;
+	struct page *pg;
+	unsigned int index;
+	char *p;
+
+	/* Round up to align the finalize_info */
+	padsz = size + sizeof (struct finalize_info) - 1;
+	padsz -= padsz % sizeof (struct finalize_info);
+	p = (char *)_SEE_gc_malloc(interp, padsz + 
+	    sizeof (struct finalize_info), file, line);
+	if (!p)
+		return NULL;
+
+	info = (struct finalize_info *)(p + padsz);
+	info->interp = interp;
+	info->finalizefn = finalizefn;
+	info->closure = closure;
+
+	if (heap->nfins == heap->maxfins)
+		heap->fins = (struct finalizer *)gc_grow_array(heap->fins,
+		    &heap->maxfins, sizeof *heap->fins);
+	heap->fins[heap->nfins].block = p;
+	heap->fins[heap->nfins].offset = padsz;
+	heap->nfins++;
+	pg = find_block(p, &index);
+	BIT_SET(pg->fin, index);
+	return p;
+}
+
+/* Releases a block immediately, cancelling any finalizer */
+void
+_SEE_gc_free(interp, ptr, file, line)
+	struct SEE_interpreter *interp;
+	void *ptr;
+	const char *file;
+	int line;
+{
+	struct page *pg;
+	unsigned int index, i;
+
+	/* While marking, the block may be queued to be scanned */
+	if (!heap || heap->collecting || heap->phase == PHASE_MARK ||
+	    !(pg = find_block(ptr, &index)) ||
+	    (char *)ptr != pg->base + index * pg->size)
+		return;
+
+	if (BIT_TEST(pg->fin, index)) {
+		BIT_CLEAR(pg->fin, index);
+		for (i = 0; i < heap->nfins; i++)
+			if (heap->fins[i].block == (char *)ptr) {
+				heap->fins[i] = heap->fins[--heap->nfins];
+				break;
+			}
+	}
+	untag_block(pg, index);
+	BIT_CLEAR(pg->alloc, index);
+	BIT_CLEAR(pg->object, index);
+	BIT_CLEAR(pg->mark, index);
+	BIT_CLEAR(pg->barriered, index);
+	if (pg->types)
+		pg->types[index] = 0;
+	if (pg->kind == PAGE_LARGE)
+		release_run(pg);
+	else if (!pg->unswept) {
+		*(void **)ptr = pg->freelist;
+		pg->freelist = ptr;
+	}
+}
+
+void
+_SEE_gc_gcollect(interp)
+	struct SEE_interpreter *interp;
+{
+	if (heap && !heap->collecting) {
+		collect(1);
+		finish_sweeping();	/* so that the accounts are current */
+	}
+}
+
+/*------------------------------------------------------------
+ * Interfaces for the rest of SEE
+ */
+
+/* Registers size bytes at p to be scanned during every collection */
+void
+_SEE_gc_add_root(p, size)
+	void *p;
+	SEE_size_t size;
+{
+	volatile char here;
+	unsigned int i;
+
+	if (!heap && !gc_init())
+		SEE_ABORT(NULL, "gc: out of memory");
+	if (!heap->stack_hint || (char *)&here > heap->stack_hint)
+		heap->stack_hint = (char *)&here;
+	for (i = 0; i < heap->nroots; i++)
+		if (heap->roots[i].lo == (char *)p) {
+			heap->roots[i].hi = (char *)p + size;
+			return;
+		}
+	if (heap->nroots == heap->maxroots)
+		heap->roots = (struct root *)gc_grow_array(heap->roots,
+		    &heap->maxroots, sizeof *heap->roots);
+	heap->roots[heap->nroots].lo = (char *)p;
+	heap->roots[heap->nroots].hi = (char *)p + size;
+	heap->nroots++;
+}
+
+/* Stops scanning the root registered at p */
+void
+_SEE_gc_remove_root(p)
+	void *p;
+{
+	unsigned int i;
+
+	if (!heap)
+		return;
+	for (i = 0; i < heap->nroots; i++)
+		if (heap->roots[i].lo == (char *)p) {
+			heap->roots[i] = heap->roots[--heap->nroots];
+			return;
+		}
+}
+
+/* Notes that the block at obj holds a native object to be traced */
+void
+_SEE_gc_object(obj)
+	struct SEE_object *obj;
+{
+	struct page *pg;
+	unsigned int index;
+
+	if (heap && (pg = find_block(obj, &index)) && !pg->atomic &&
+	    (char *)obj == pg->base + index * pg->size)
+	{
+		BIT_SET(pg->object, index);
+		/* Initialising a marked object stores its prototype */
+		if (heap->phase == PHASE_MARK)
+			mark(obj->Prototype);
+		else if (BIT_TEST(pg->mark, index)) {
+			BIT_SET(pg->dirty, index);
+			pg->remember |= REMEMBER_DIRTY;
+		}
+	}
+}
+
+/*
+ * Notes that the block at p is to be traced by the function trace,
+ * which marks what the block refers to (see SEE_gc_mark()). Blocks
+ * without a tracer are scanned conservatively, as are blocks whose run
+ * has no memory for the index of their tracer.
+ */
+void
+_SEE_gc_typed(p, trace)
+	const void *p;
+	void (*trace)(void *);
+{
+	struct page *pg;
+	unsigned int index, t;
+
+	if (!heap || !(pg = find_block(p, &index)) || pg->atomic ||
+	    (const char *)p != pg->base + index * pg->size)
+		return;
+	for (t = 0; t < heap->ntracers; t++)
+		if (heap->tracers[t] == trace)
+			break;
+	if (t == heap->ntracers) {
+		if (t == GC_MAX_TYPES)
+			return;
+		heap->tracers[heap->ntracers++] = trace;
+	}
+	if (!pg->types) {
+		pg->types = (unsigned char *)calloc(pg->nblocks, 
+		    sizeof *pg->types);
+		if (!pg->types)
+			return;
+	}
+	pg->types[index] = t + 1;
+}
+
+/*
+ * Notes that stores into the (new) block at p use the write barrier
+ * from now on. Outside of incremental marking, a block that is already
+ * marked is old, and may have been stored into.
+ */
+void
+_SEE_gc_barriered(p)
+	const void *p;
+{
+	struct page *pg;
+	unsigned int index;
+
+	if (heap && (pg = find_block(p, &index)) && !pg->atomic) {
+		BIT_SET(pg->barriered, index);
+		if (heap->phase != PHASE_MARK && BIT_TEST(pg->mark, index)) {
+			BIT_SET(pg->dirty, index);
+			pg->remember |= REMEMBER_DIRTY;
+		}
+	}
+}
+
+/* Marks a block without scanning it; the caller traces its contents */
+void
+_SEE_gc_mark_leaf(p)
+	const void *p;
+{
+	struct page *pg;
+	unsigned int i;
+
+	if (heap && heap->collecting && (pg = find_block(p, &i)) &&
+	    BIT_TEST(pg->alloc, i) && !BIT_TEST(pg->mark, i))
+	{
+		BIT_SET(pg->mark, i);
+		heap->marked += pg->size;
+	}
+}
+
+/**
+ * Marks the storage that p points into as reachable. It is meant to be
+ * called from the trace hook of an object class, and ignores pointers
+ * that are not into storage from SEE's collector.
+ */
+void
+SEE_gc_mark(p)
+	const void *p;
+{
+	if (heap && heap->collecting)
+		mark(p);
+}
+
+/*
+ * Notes that the pointer q was stored into the block containing p.
+ * While marking incrementally, q is marked; otherwise a marked (old)
+ * block is remembered for the next minor collection.
+ */
+void
+_SEE_gc_store(p, q)
+	const void *p, *q;
+{
+#if WITH_GENERATIONAL_GC
+	struct page *pg;
+	unsigned int i;
+#endif
+
+	if (!heap)
+		return;
+	if (heap->phase == PHASE_MARK)
+		mark(q);
+#if WITH_GENERATIONAL_GC
+	else if ((pg = find_block(p, &i)) && BIT_TEST(pg->mark, i)) {
+		BIT_SET(pg->dirty, i);
+		pg->remember |= REMEMBER_DIRTY;
+	}
+#endif
+}
+
+/* Notes that the value v was stored into the block containing p */
+void
+_SEE_gc_store_value(p, v)
+	const void *p;
+	const struct SEE_value *v;
+{
+	if (!heap)
+		return;
+	if (heap->phase != PHASE_MARK) {
+		_SEE_gc_store(p, NULL);
+		return;
+	}
+	switch (SEE_VALUE_GET_TYPE(v)) {
+	case SEE_STRING:
+		mark(v->u.string);
+		break;
+	case SEE_OBJECT:
+		mark(v->u.object);
+		break;
+	case SEE_REFERENCE:
+		mark(v->u.reference.base);
+		mark(v->u.reference.property);
+		break;
+	case SEE_COMPLETION:
+		mark(v->u.completion.value);
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * Notes that a pointer was stored into the struct SEE_native part of
+ * an object other than through SEE_native_put(), such as into its
+ * Prototype or host_data fields; p may point anywhere into the object.
+ * This matters only to the generational and incremental collectors,
+ * which otherwise do not rescan that part of marked objects.
+ */
+void
+SEE_gc_write_barrier(p)
+	const void *p;
+{
+	struct page *pg;
+	unsigned int i;
+
+#if !WITH_GENERATIONAL_GC
+	if (!heap || heap->phase != PHASE_MARK)
+		return;
+#endif
+	if (!heap || !(pg = find_block(p, &i)) || !BIT_TEST(pg->mark, i))
+		return;
+	if (heap->phase == PHASE_MARK)
+		requeue(pg, i);
+	else {
+		BIT_SET(pg->dirty, i);
+		pg->remember |= REMEMBER_DIRTY;
+	}
+}
+
+/**
+ * Registers size bytes at p, outside SEE's storage, to be scanned for
+ * pointers during every collection. SEE's collector does not scan
+ * static variables; hosts that keep storage only in them must register
+ * them.
+ */
+void
+SEE_gc_add_root(p, size)
+	void *p;
+	SEE_size_t size;
+{
+	_SEE_gc_add_root(p, size);
+}
+
+/**
+ * Stops scanning the region registered at p with SEE_gc_add_root().
+ */
+void
+SEE_gc_remove_root(p)
+	void *p;
+{
+	_SEE_gc_remove_root(p);
+}
+
+/**
+ * Does a slice of the incremental collection in progress, if one is
+ * due. Hosts may call this from the SEE_system.periodic hook, or when
+ * idle. Returns true while a collection is in progress.
+ */
+int
+SEE_gc_step(interp)
+	struct SEE_interpreter *interp;
+{
+	if (!heap || heap->phase == PHASE_IDLE)
+		return 0;
+	if (gc_clock() - heap->slice_end < SEE_system.gc_pause_budget)
+		return 1;
+	return slice(SEE_system.gc_pause_budget);
+}
+
+/**
+ * Requests a collection, such as between the requests that a host
+ * serves. If SEE_system.gc_pause_budget is non-zero, an incremental
+ * collection is begun (unless one is in progress) and its first slice
+ * done; SEE_gc_step() and allocation do the rest. Otherwise, the
+ * collection is completed before returning.
+ */
+void
+SEE_gc_request(interp)
+	struct SEE_interpreter *interp;
+{
+	if (!heap)
+		return;
+	if (!SEE_system.gc_pause_budget)
+		collect(1);
+	else {
+		if (heap->phase == PHASE_IDLE)
+			start_cycle();
+		slice(SEE_system.gc_pause_budget);
+	}
+}
+
+/**
+ * Fills in the collector's statistics.
+ */
+void
+SEE_gc_stats(stats)
+	struct SEE_gc_stats *stats;
+{
+	if (!heap) {
+		memset(stats, 0, sizeof *stats);
+		return;
+	}
+	*stats = heap->stats;
+	stats->heap_bytes = (SEE_size_t)heap->npages << GC_PAGE_SHIFT;
+	stats->collecting = heap->phase != PHASE_IDLE;
+	stats->finalizers = heap->nfins + heap->nready;
+}
+
+#else /* !WITH_SEE_GC */
+
+void
+SEE_gc_mark(p)
+	const void *p;
+{
+}
+
+void
+SEE_gc_add_root(p, size)
+	void *p;
+	SEE_size_t size;
+{
+}
+
+void
+SEE_gc_remove_root(p)
+	void *p;
+{
+}
+
+void
+SEE_gc_write_barrier(p)
+	const void *p;
+{
+}
+
+int
+SEE_gc_step(interp)
+	struct SEE_interpreter *interp;
+{
+	return 0;
+}
+
+void
+SEE_gc_request(interp)
+	struct SEE_interpreter *interp;
+{
+	SEE_gcollect(interp);
+}
+
+void
+SEE_gc_stats(stats)
+	struct SEE_gc_stats *stats;
+{
+	memset(stats, 0, sizeof *stats);
+#if !WITH_BOEHM_GC
+	stats->finalizers = _SEE_simple_finalizers();
+#endif
+}
+
+#endif /* !WITH_SEE_GC */
+
+/**
+ * Marks the storage referred to by a value as reachable.
+ */
+void
+SEE_gc_mark_value(v)
+	const struct SEE_value *v;
+{
+	switch (SEE_VALUE_GET_TYPE(v)) {
+	case SEE_STRING:
+		SEE_gc_mark(v->u.string);
+		break;
+	case SEE_OBJECT:
+		SEE_gc_mark(v->u.object);
+		break;
+	case SEE_REFERENCE:
+		SEE_gc_mark(v->u.reference.base);
+		SEE_gc_mark(v->u.reference.property);
+		break;
+	case SEE_COMPLETION:
+		SEE_gc_mark(v->u.completion.value);
+		break;
+	default:
+		break;
+	}
+}
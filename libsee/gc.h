@@ -0,0 +1,130 @@
+/* Copyright (c) 2008, David Leonard. All rights reserved. */
+/* $Id$ */
+
+#ifndef _SEE_h_gc_
+#define _SEE_h_gc_
+
+#include <see/type.h>
+
+struct SEE_interpreter;
+struct SEE_object;
+struct SEE_value;
+
+/*
+ * SEE's own garbage collector, used when SEE is configured with
+ * --enable-builtin-gc and without Boehm GC. Otherwise, or if SEE_NO_GC
+ * is defined, SEE falls back to the system malloc(), which never
+ * releases memory.
+ *
+ * It is a non-moving mark-sweep collector. Blocks are kept in
+ * size-segregated pages, and are swept lazily as the allocator needs
+ * them. Objects set up by SEE_native_init() (and the other objects
+ * registered with _SEE_gc_object()) are traced precisely through the
+ * trace hook of their object class, and the internal blocks given a
+ * tracer by _SEE_gc_typed() through it: scopes, struct function, code
+ * objects, property cells, strings and intern entries. All other
+ * blocks, such as parse trees, compiled regular expressions, enumerators
+ * and host storage, are scanned conservatively, as are the registered
+ * roots and the C stack. Static variables are not scanned: storage held
+ * only by them must be registered with _SEE_gc_add_root() (or, by hosts,
+ * with SEE_gc_add_root()).
+ *
+ *   _SEE_gc_add_root()	  - registers a region outside the heap that is
+ *			    always scanned, such as an interpreter
+ *   _SEE_gc_remove_root() - unregisters a region
+ *   _SEE_gc_object()	  - notes that a block holds a native object
+ *   _SEE_gc_typed()	  - gives a block a function that traces it
+ *   _SEE_gc_mark_leaf()  - marks a block without scanning its contents;
+ *			    only for use by trace hooks
+ *   _SEE_gc_barriered()  - notes that every pointer stored into a
+ *			    (new) block is followed by _SEE_gc_store()
+ *   _SEE_gc_store()	  - notes a pointer stored into a barriered
+ *			    block, or into the struct SEE_native part of
+ *			    an object
+ *   _SEE_gc_store_value() - notes a value stored likewise
+ *
+ * When configured with --enable-generational-gc, blocks that survive
+ * a collection are promoted to the old generation where they stand
+ * (blocks are never moved, because the conservative scans cannot
+ * update the pointers they find). Most collections are then minor:
+ * they trace only from the roots and from the old blocks that may
+ * refer to young ones, and free only young blocks. Old blocks
+ * registered with _SEE_gc_barriered() are skipped unless _SEE_gc_store()
+ * noted a store into them; all other old blocks are traced or scanned
+ * again.
+ *
+ * When SEE_system.gc_pause_budget is non-zero, full collections are
+ * incremental: the marking is done in slices of about that many
+ * microseconds, run as memory is allocated and from SEE_gc_step().
+ * Blocks allocated meanwhile are marked, and the pointers that
+ * _SEE_gc_store() notes are marked as they are stored. A final step,
+ * which is not sliced, rescans the roots and the unbarriered blocks as
+ * a minor collection rescans old blocks. Blocks are registered with
+ * the barrier in every mode, so that the budget may be set at any time.
+ *
+ * Blocks allocated for an interpreter are tagged with its account
+ * (see mem.c), which is credited as they are freed.
+ *
+ * With SEE_NO_GC, the finalizers of blocks allocated by the system
+ * malloc() are run when their interpreter is destroyed, or at exit.
+ *
+ * Interpreters initialised with SEE_interpreter_init_arena() allocate
+ * from an arena (see arena.c) instead. Arena storage is not scanned,
+ * and pointers into it are ignored by the collector.
+ *
+ * The collector is not thread-safe, and only scans the stack of the
+ * thread it runs on (see the notes on threads in doc/USAGE.html).
+ */
+
+#if WITH_BOEHM_GC || defined(SEE_NO_GC)
+# undef WITH_SEE_GC
+#endif
+
+#if WITH_SEE_GC
+void *_SEE_gc_malloc(struct SEE_interpreter *, SEE_size_t,
+	const char *, int);
+void *_SEE_gc_malloc_string(struct SEE_interpreter *, SEE_size_t,
+	const char *, int);
+void *_SEE_gc_malloc_finalize(struct SEE_interpreter *, SEE_size_t,
+	void (*)(struct SEE_interpreter *, void *, void *), void *,
+	const char *, int);
+void  _SEE_gc_free(struct SEE_interpreter *, void *, const char *, int);
+void  _SEE_gc_gcollect(struct SEE_interpreter *);
+
+void  _SEE_gc_add_root(void *, SEE_size_t);
+void  _SEE_gc_remove_root(void *);
+void  _SEE_gc_object(struct SEE_object *);
+void  _SEE_gc_typed(const void *, void (*)(void *));
+void  _SEE_gc_mark_leaf(const void *);
+
+/* Allocation accounting, from mem.c */
+unsigned int _SEE_mem_tag(struct SEE_interpreter *, int);
+void  _SEE_mem_charge(unsigned int, SEE_size_t);
+void  _SEE_mem_release(unsigned int, SEE_size_t);
+#else
+# define _SEE_gc_add_root(p, sz)	/* nothing */
+# define _SEE_gc_remove_root(p)		/* nothing */
+# define _SEE_gc_object(o)		/* nothing */
+# define _SEE_gc_typed(p, trace)	((void)(trace))
+# define _SEE_gc_mark_leaf(p)		/* nothing */
+#endif
+
+#if !WITH_BOEHM_GC && !WITH_SEE_GC
+/* Finalizers of the system malloc() allocator, from system.c */
+void  _SEE_simple_finalize(struct SEE_interpreter *);
+unsigned long _SEE_simple_finalizers(void);
+#else
+# define _SEE_simple_finalize(i)	/* nothing */
+#endif
+
+#if WITH_SEE_GC
+void  _SEE_gc_barriered(const void *);
+void  _SEE_gc_store(const void *, const void *);
+void  _SEE_gc_store_value(const void *, const struct SEE_value *);
+#else
+# define _SEE_gc_barriered(p)		/* nothing */
+# define _SEE_gc_store(p, q)		/* nothing */
+# define _SEE_gc_store_value(p, v)	/* nothing */
+#endif
+
+#endif /* _SEE_h_gc_ */
@@ -60,4 +60,8 @@ void _SEE_module_alloc(struct SEE_interpreter *);
 void _SEE_module_init(struct SEE_interpreter *);
 void _SEE_module_fini(struct SEE_interpreter *);
 
+/* mem.c */
+void _SEE_mem_account_init(struct SEE_interpreter *);
+void _SEE_mem_account_close(struct SEE_interpreter *, int);
+
 #endif /* _SEE_h_init_ */
@@ -49,6 +49,8 @@
 #include <see/interpreter.h>
 
 #include "unicode.h"
+#include "utf8.h"
+#include "replace.h"
 
 /*
  * An input filter for a file, opened with C's standard IO.
@@ -61,6 +63,7 @@
  */
 
 #define LOOKAHEAD_MAX	4
+#define UTF8_BUFSZ	512
 
 struct input_file {
 	struct SEE_input	inp;
@@ -68,9 +71,20 @@ struct input_file {
 	unsigned char	lookahead_buf[LOOKAHEAD_MAX];
 	unsigned char	*lookahead_pos;
 	int		lookahead_len;
+	struct utf8_buf *utf8;		/* allocated by utf8_fill() */
+};
+
+/* UTF-8 files are read and decoded a block at a time */
+struct utf8_buf {
+	unsigned char	bytes[UTF8_BUFSZ];
+	unsigned int	bytepos, bytelen;
+	SEE_unicode_t	chars[UTF8_BUFSZ];
+	unsigned int	charpos, charlen;
+	int		eof;		/* no more bytes in the file */
 };
 
 static int getbyte(struct input_file *);
+static int utf8_fill(struct input_file *);
 static SEE_unicode_t ucs32be_next(struct SEE_input *);
 static SEE_unicode_t ucs32le_next(struct SEE_input *);
 static SEE_unicode_t utf16be_next(struct SEE_input *);
@@ -257,49 +271,70 @@ utf16le_next(inp)
 	return next;
 }
 
+/*
+ * Refills the UTF-8 character buffer. Returns false at the end of the 
+ * file. An incomplete sequence at the end of the file is discarded.
+ */
+static int
+utf8_fill(inpf)
+	struct input_file *inpf;
+{
+	struct utf8_buf *u = inpf->utf8;
+	const unsigned char *p;
+	SEE_size_t n;
+
+	if (!u) {
+	    u = (struct utf8_buf *)SEE_malloc_string(inpf->inp.interpreter,
+		sizeof (struct utf8_buf));
+	    u->bytepos = u->bytelen = 0;
+	    u->charpos = u->charlen = 0;
+	    u->eof = 0;
+	    inpf->utf8 = u;
+	}
+
+	for (;;) {
+	    /* Keep any partial sequence, and refill the rest */
+	    memmove(u->bytes, u->bytes + u->bytepos, u->bytelen - u->bytepos);
+	    u->bytelen -= u->bytepos;
+	    u->bytepos = 0;
+	    while (u->bytelen < UTF8_BUFSZ && inpf->lookahead_len)
+		u->bytes[u->bytelen++] = getbyte(inpf);
+	    if (!u->eof && u->bytelen < UTF8_BUFSZ) {
+		n = fread(u->bytes + u->bytelen, 1, UTF8_BUFSZ - u->bytelen,
+		    inpf->file);
+		if (n == 0)
+		    u->eof = 1;
+		u->bytelen += n;
+	    }
+
+	    /* RFC 2279 */
+	    p = u->bytes;
+	    u->charpos = 0;
+	    u->charlen = _SEE_utf8_decode(inpf->inp.interpreter, &p,
+		u->bytes + u->bytelen, u->chars, UTF8_BUFSZ);
+	    u->bytepos = p - u->bytes;
+	    if (u->charlen)
+		return 1;
+	    if (u->eof)
+		return 0;
+	}
+}
+
 /* UTF-8 */
 static SEE_unicode_t
 utf8_next(inp)
 	struct SEE_input *inp;
 {
 	struct input_file *inpf = (struct input_file *)inp;
-	SEE_unicode_t next, c;
-	int ch, bytes, i;
-
-	static unsigned char mask[] = { 0xc0, 0xe0, 0xf0, 0xf8, 0xfc, 0xfe };
-	static SEE_unicode_t safe[] = { 0, 0x80, 0x800, 0x10000, 0x200000,
-						0x4000000, 0x80000000 };
+	struct utf8_buf *u = inpf->utf8;
+	SEE_unicode_t next;
 
-	/* RFC 2279 */
 	next = inpf->inp.lookahead;
-	ch = getbyte(inpf);
-	if (ch == EOF) {
+	if ((u == NULL || u->charpos == u->charlen) && !utf8_fill(inpf))
 		inpf->inp.eof = 1;
-	} else if ((ch & 0x80) == 0) {
-		inpf->inp.lookahead = ch;
-	} else {
-		for (bytes = 1; bytes < 6; bytes++)
-		    if ((ch & mask[bytes]) == mask[bytes-1])
-			break;
-		if (bytes < 6) {
-		    c = (ch & ~mask[bytes]);
-		    for (i = 0; i < bytes; i++) {
-			ch = getbyte(inpf);
-			if (ch == EOF) {
-			    inpf->inp.eof = 1;
-			    break;
-			}
-			c = (c << 6) | (ch & 0x3f);
-		    }
-		    if (c > _UNICODE_MAX)
-			c = SEE_INPUT_BADCHAR;
-		    else if (c < safe[bytes] && 
-		    	    !(inpf->inp.interpreter->compatibility &
-		                             SEE_COMPAT_UTF_UNSAFE))
-			c = SEE_INPUT_BADCHAR;
-		} else
-		    c = SEE_INPUT_BADCHAR;
-		inpf->inp.lookahead = c;
+	else {
+		u = inpf->utf8;
+		inpf->inp.lookahead = u->chars[u->charpos++];
 	}
 	return next;
 }
@@ -366,6 +401,7 @@ SEE_input_file(interp, file, filename, label)
 
 	inpf->lookahead_len = 0;
 	inpf->lookahead_pos = &inpf->lookahead_buf[0];
+	inpf->utf8 = NULL;
 	inpf->inp.inputclass = &ascii_class;
 
 	if (label && *label) {
@@ -37,12 +37,16 @@
 # include <stdio.h>
 #endif
 
+#if HAVE_STRING_H
+# include <string.h>
+#endif
+
 #include <see/mem.h>
 #include <see/type.h>
 #include <see/input.h>
 #include <see/interpreter.h>
 
-#include "unicode.h"
+#include "utf8.h"
 
 /*
  * An input for UTF8 encoded C strings. (i.e. nul-terminated byte arrays)
@@ -53,7 +57,8 @@
  * Ref: RFC2279
  */
 
-/* A character representing some invalid input; */
+/* Number of characters decoded at a time */
+#define DECODE_MAX	64
 
 static SEE_unicode_t input_utf8_next(struct SEE_input *);
 static void         input_utf8_close(struct SEE_input *);
@@ -66,6 +71,9 @@ static struct SEE_inputclass input_utf8_class = {
 struct input_utf8 {
 	struct SEE_input	inp;
 	const unsigned char *	s;
+	const unsigned char *	end;
+	SEE_unicode_t		buf[DECODE_MAX];
+	unsigned int		pos, len;
 };
 
 static SEE_unicode_t
@@ -73,52 +81,29 @@ input_utf8_next(inp)
 	struct SEE_input *inp;
 {
 	struct input_utf8 *inpu = (struct input_utf8 *)inp;
-	SEE_unicode_t next, c;
-	int i, j, bytes;
-	static unsigned char mask[] = { 0xc0, 0xe0, 0xf0, 0xf8, 0xfc, 0xfe };
-	static SEE_unicode_t safe[] = { 0, 0x80, 0x800, 0x10000, 0x200000, 
-					0x4000000, 0x80000000 };
+	SEE_unicode_t next;
 
 	next = inpu->inp.lookahead;
 
 	/*
-	 * Decode a UTF8 string, returning EOF if we reach a nul character.
-	 * This is a non-strict decoder.
+	 * Decode the UTF8 string in blocks, returning EOF when we reach 
+	 * the nul character. (See utf8.c)
 	 */
-	if (*inpu->s == '\0') {
+	if (inpu->pos == inpu->len) {
+		inpu->pos = 0;
+		inpu->len = _SEE_utf8_decode(inpu->inp.interpreter, &inpu->s,
+			inpu->end, inpu->buf, DECODE_MAX);
+		if (inpu->len == 0 && inpu->s < inpu->end) {
+			/* A sequence was cut short by the nul */
+			inpu->buf[inpu->len++] = SEE_INPUT_BADCHAR;
+			inpu->s = inpu->end;
+		}
+	}
+	if (inpu->pos == inpu->len)
 		inpu->inp.eof = 1;
-	} else if ((*inpu->s & 0x80) == 0) {
-		inpu->inp.lookahead = *inpu->s++;
+	else {
+		inpu->inp.lookahead = inpu->buf[inpu->pos++];
 		inpu->inp.eof = 0;
-	} else {
-		for (bytes = 1; bytes < 6; bytes++)
-		    if ((*inpu->s & mask[bytes]) == mask[bytes - 1])
-			break;
-		if (bytes < 6) {
-		    c = *inpu->s++ & ~mask[bytes];
-		    for (i = bytes, j = 0; i--; j++) {
-			if ((*inpu->s & 0xc0) != 0x80) {
-			     goto bad;
-			}
-			c = (c << 6) | (*inpu->s++ & 0x3f);
-		    }
-		    if (c > _UNICODE_MAX)
-			    inpu->inp.lookahead = SEE_INPUT_BADCHAR;
-		    else if (c < safe[bytes] && 
-		        !(inpu->inp.interpreter->compatibility & 
-			 SEE_COMPAT_UTF_UNSAFE))
-			    inpu->inp.lookahead = SEE_INPUT_BADCHAR;
-		    else
-			    inpu->inp.lookahead = c;
-
-		    inpu->inp.eof = 0;
-		} else {
-		bad:
-		    inpu->inp.lookahead = SEE_INPUT_BADCHAR;
-		    inpu->inp.eof = 0;
-		    while ((*inpu->s & 0x80))
-			inpu->s++;
-		} 
 	}
 	return next;
 }
@@ -144,6 +129,8 @@ SEE_input_utf8(interp, s)
 	inpu->inp.filename = NULL;
 	inpu->inp.first_lineno = 1;
 	inpu->s = (const unsigned char *)s;
+	inpu->end = inpu->s + strlen(s);
+	inpu->pos = inpu->len = 0;
 	SEE_INPUT_NEXT((struct SEE_input *)inpu);	/* prime */
 	return (struct SEE_input *)inpu;
 }
@@ -49,6 +49,7 @@
 
 #include "stringdefs.h"
 #include "dprint.h"
+#include "gc.h"
 
 /*
  * Internalised strings.
@@ -88,6 +89,7 @@ static struct intern ** find(intern_tab_t *, struct SEE_string *,
 static int internalized(struct SEE_interpreter *interp,
 			const struct SEE_string *s);
 static void global_init(void);
+static void intern_trace(void *);
 
 /** System-wide intern table */
 static intern_tab_t	global_intern_tab;
@@ -121,13 +123,26 @@ make(interp, s)
 {
 	struct intern *i;
 
-	i = SEE_NEW(interp, struct intern);
+	i = SEE_NEW_CATEGORY(interp, struct intern, SEE_MEM_STRING);
+	_SEE_gc_barriered(i);
+	_SEE_gc_typed(i, intern_trace);
 	i->string = s;
 	s->flags |= SEE_STRING_FLAG_INTERNED;
 	i->next = NULL;
 	return i;
 }
 
+/** Garbage collector tracer for intern entries */
+static void
+intern_trace(p)
+	void *p;
+{
+	struct intern *i = (struct intern *)p;
+
+	SEE_gc_mark(i->string);
+	SEE_gc_mark(i->next);
+}
+
 /** Compute the hash value of a UTF-16 string */
 static unsigned int
 hash(s)
@@ -223,7 +238,8 @@ _SEE_intern_init(interp)
 	global_intern_tab_locked = 1;
 #endif
 
-	intern_tab = SEE_NEW(interp, intern_tab_t);
+	intern_tab = SEE_NEW_CATEGORY(interp, intern_tab_t,
+	    SEE_MEM_STRING);
 	for (i = 0; i < HASHTABSZ; i++)
 		(*intern_tab)[i] = NULL;
 
@@ -299,6 +315,7 @@ SEE_intern(interp, s)
 		WHERE("local");
 		if (!*x) {
 			*x = make(interp, _SEE_string_dup_fix(interp, s));
+			_SEE_gc_store(x, *x);
 			WHERE("new");
 		}
 	}
@@ -339,7 +356,8 @@ SEE_intern_ascii(interp, s)
 	    WHERE("local");
 	    if (!*x) {
 		WHERE("new");
-		str = SEE_NEW(interp, struct SEE_string);
+		str = SEE_NEW_CATEGORY(interp, struct SEE_string,
+		    SEE_MEM_STRING);
 		str->length = len;
 		str->data = SEE_NEW_STRING_ARRAY(interp, SEE_char_t, len);
 		for (c = str->data, t = s; *t;)
@@ -349,6 +367,7 @@ SEE_intern_ascii(interp, s)
 		str->flags = 0;
 	    	SEE_ASSERT(interp, hash(str) == h);
 		*x = make(interp, str);
+		_SEE_gc_store(x, *x);
 		}
 	    }
 #ifndef NDEBUG
@@ -391,12 +410,17 @@ global_init()
 	if (global_intern_tab_initialized)
 		return;
 
+	/* The collector does not scan static storage */
+	_SEE_gc_add_root(global_intern_tab, sizeof global_intern_tab);
+
 	/* Add all the predefined strings to the global intern table */
 	for (i = 0; i < SEE_nstringtab; i++) {
 		h = hash(STRn(i));
 		x = find(&global_intern_tab, STRn(i), h);
-		if (*x == NULL) 
+		if (*x == NULL) {
 			*x = make(NULL, STRn(i));
+			_SEE_gc_store(x, *x);
+		}
 	}
 	global_intern_tab_initialized = 1;
 }
@@ -427,6 +451,7 @@ SEE_intern_global(s)
 	if (*x) return (*x)->string;
 
 	str = SEE_NEW(NULL, struct SEE_string);
+	_SEE_gc_typed(str, _SEE_string_trace);
 	str->length = len;
 	str->data = SEE_NEW_STRING_ARRAY(NULL, SEE_char_t, len);
 	for (c = str->data, t = s; *t;)
@@ -435,6 +460,7 @@ SEE_intern_global(s)
 	str->stringclass = NULL;
 	str->flags = 0;
 	*x = make(NULL, str);
+	_SEE_gc_store(x, *x);
 	return (*x)->string;
 }
 
@@ -48,6 +48,10 @@
 #include <see/error.h>
 
 #include "init.h"
+#include "gc.h"
+#include "arena.h"
+
+static void interpreter_init(struct SEE_interpreter *, int);
 
 /**
  * Initialises/reinitializes an interpreter structure
@@ -74,6 +78,63 @@ SEE_interpreter_init_compat(interp, compat_flags)
 	struct SEE_interpreter *interp;
 	int compat_flags;
 {
+	interp->arena = NULL;
+	_SEE_gc_add_root(interp, sizeof *interp);
+	interpreter_init(interp, compat_flags);
+}
+
+/**
+ * Initialises an interpreter structure using the given compatibility
+ * flags, so that all the memory it allocates is kept in an arena
+ * of its own instead of the garbage-collected heap. The arena is
+ * never collected; it is released all at once by
+ * SEE_interpreter_destroy(). This suits interpreters that run for a
+ * short while, such as one per request in a server.
+ */
+void
+SEE_interpreter_init_arena(interp, compat_flags)
+	struct SEE_interpreter *interp;
+	int compat_flags;
+{
+	interp->arena = _SEE_arena_new();
+	if (!interp->arena)
+		(*SEE_system.mem_exhausted)(interp);
+	interpreter_init(interp, compat_flags);
+}
+
+/**
+ * Releases an interpreter. For an arena interpreter, the finalizers
+ * of its memory are run, newest first, and then all the memory is
+ * released at once. Otherwise, the collector stops treating the
+ * interpreter structure as a root, and its objects become garbage
+ * once they are no longer referenced from elsewhere (without a
+ * collector, the finalizers of its memory are run instead, newest
+ * first). Either way, the interpreter must not be used again until
+ * it is reinitialised.
+ */
+void
+SEE_interpreter_destroy(interp)
+	struct SEE_interpreter *interp;
+{
+	if (interp->arena) {
+		_SEE_arena_destroy(interp, (struct arena *)interp->arena);
+		interp->arena = NULL;
+		_SEE_mem_account_close(interp, 1);
+	} else {
+		_SEE_simple_finalize(interp);
+		_SEE_gc_remove_root(interp);
+		_SEE_mem_account_close(interp, 0);
+	}
+}
+
+/* Initialises an interpreter once its storage has been chosen */
+static void
+interpreter_init(interp, compat_flags)
+	struct SEE_interpreter *interp;
+	int compat_flags;
+{
+	_SEE_mem_account_init(interp);
+
 	interp->try_context = NULL;
 	interp->try_location = NULL;
 
@@ -85,6 +146,17 @@ SEE_interpreter_init_compat(interp, compat_flags)
 	interp->recursion_limit = SEE_system.default_recursion_limit;
 	interp->sec_domain = NULL;
 	interp->regex_engine = SEE_system.default_regex_engine;
+	interp->string_cache = NULL;
+	interp->regex_backtrack_limit = 
+		SEE_system.default_regex_backtrack_limit;
+	interp->regex_cache = NULL;
+	interp->regex_jit_threshold = SEE_system.default_regex_jit_threshold;
+	interp->regex_backtrack_peak = 0;
+	interp->mem_soft_limit = SEE_system.default_mem_soft_limit;
+	interp->mem_hard_limit = SEE_system.default_mem_hard_limit;
+	interp->frame_stack = NULL;
+	interp->builtins_pending = 
+		SEE_BUILTIN_DATE | SEE_BUILTIN_REGEXP | SEE_BUILTIN_MATH;
 
 	/* Allocate object storage first, since dependencies are complex */
 	SEE_Array_alloc(interp);
@@ -103,21 +175,48 @@ SEE_interpreter_init_compat(interp, compat_flags)
 	/* Initialise the per-interpreter intern table now */
 	_SEE_intern_init(interp);
 
-	/* Initialise the objects; order *shouldn't* matter */
+	/*
+	 * Initialise the objects; order *shouldn't* matter. Those in
+	 * builtins_pending are left until first used: the global object
+	 * holds them already, and initialises them as they are looked up.
+	 */
 	SEE_Array_init(interp);
 	SEE_Boolean_init(interp);
-	SEE_Date_init(interp);
 	SEE_Error_init(interp);
 	SEE_Global_init(interp);
-	SEE_Math_init(interp);
 	SEE_Number_init(interp);
 	SEE_Object_init(interp);
-	SEE_RegExp_init(interp);
 	SEE_String_init(interp);
 	SEE_Function_init(interp);	/* Call late because of parser use */
 	_SEE_module_init(interp);
 }
 
+/**
+ * Initialises the built-in objects named by the SEE_BUILTIN_* bits in
+ * builtins, unless they have been already. This is normally done
+ * when scripts or the SEE_INTERP_*() macros first refer to them.
+ */
+void
+SEE_interpreter_init_builtins(interp, builtins)
+	struct SEE_interpreter *interp;
+	int builtins;
+{
+	int category = interp->mem_category;
+
+	builtins &= interp->builtins_pending;
+	if (!builtins)
+		return;
+	interp->mem_category = SEE_MEM_OBJECT;
+	if (builtins & SEE_BUILTIN_DATE)
+		SEE_Date_init(interp);
+	if (builtins & SEE_BUILTIN_REGEXP)
+		SEE_RegExp_init(interp);
+	if (builtins & SEE_BUILTIN_MATH)
+		SEE_Math_init(interp);
+	interp->builtins_pending &= ~builtins;
+	interp->mem_category = category;
+}
+
 struct SEE_interpreter_state {
 	struct SEE_interpreter *interp;
 	volatile struct SEE_try_context * try_context;
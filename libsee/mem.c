@@ -43,13 +43,22 @@
 # include <string.h>
 #endif
 
+#if STDC_HEADERS
+# include <stdlib.h>
+#endif
+
 #include <see/mem.h>
 #include <see/system.h>
 #include <see/error.h>
 #include <see/string.h>
+#include <see/interpreter.h>
 
 #include "stringdefs.h"
 #include "dprint.h"
+#include "init.h"
+#include "gc.h"
+#include "memprof.h"
+#include "arena.h"
 
 #ifndef NDEBUG
 int SEE_mem_debug = 0;
@@ -58,9 +67,322 @@ int SEE_mem_debug = 0;
 #undef SEE_malloc
 #undef SEE_malloc_finalize
 #undef SEE_malloc_string
+#undef SEE_malloc_category
 #undef SEE_free
 #undef SEE_grow_to
 
+/* Counts an allocation for our caller, when profiling */
+#define PROFILE(interp, size, file, line) do {				\
+	if (_SEE_alloc_profiling)					\
+		_SEE_alloc_profile_record(interp, size,			\
+		    _SEE_ALLOC_CALLER(), file, line);			\
+    } while (0)
+
+/*------------------------------------------------------------
+ * Accounting
+ *
+ * Each interpreter has an account of the memory allocated for it,
+ * kept in system storage so that it outlives the interpreter's own
+ * blocks. SEE's collector tags each block with the account's slot
+ * and the category it was charged to, and credits the account when
+ * it frees the block. Arena interpreters are credited as their
+ * blocks are passed to SEE_free(). Other allocators do not say when
+ * storage is freed, so the counts of interpreters that use them only
+ * grow.
+ *
+ * Interpreters on different threads may open and close accounts at
+ * the same time, so that is done under a spin lock where the compiler
+ * provides atomic operations. The table of accounts is never moved
+ * while it may be read: when it grows, the old table is left behind.
+ */
+
+#define TAG_SHIFT	3			/* bits holding the category */
+#define MAX_ACCOUNTS	((0xffff >> TAG_SHIFT) - 1)
+
+struct account {
+	struct SEE_memstats stats;
+	int		soft_passed;	/* soft limit passed and reported */
+	int		closed;		/* interpreter destroyed */
+};
+
+static struct account **accounts;	/* indexed by slot - 1 */
+static unsigned int naccounts, maxaccounts;
+#if defined(__GNUC__)
+static volatile int accounts_lock;
+# define LOCK()		while (__sync_lock_test_and_set(&accounts_lock, 1)) ;
+# define UNLOCK()	__sync_lock_release(&accounts_lock)
+#else
+# define LOCK()		/* nothing */
+# define UNLOCK()	/* nothing */
+#endif
+
+/* Returns the account of an interpreter, or NULL if it has none */
+#define ACCOUNT(interp)							\
+	((interp) && (interp)->mem_account				\
+	  ? accounts[(SEE_size_t)(interp)->mem_account - 1] : NULL)
+
+static int category_of(struct SEE_interpreter *, int);
+static void account_charge(struct account *, int, SEE_size_t);
+static void account_credit(struct account *, int, SEE_size_t);
+static void charge(struct SEE_interpreter *, void *, int, SEE_size_t);
+static void check_limits(struct SEE_interpreter *, SEE_size_t);
+static void arena_free(struct SEE_interpreter *, void *);
+
+/*
+ * Opens an account for a new interpreter. When there are too many
+ * accounts, or no memory for another, the interpreter goes without.
+ */
+void
+_SEE_mem_account_init(interp)
+	struct SEE_interpreter *interp;
+{
+	struct account *acct, **newaccounts;
+	unsigned int newmax, slot;
+
+	interp->mem_category = SEE_MEM_OBJECT;
+	interp->mem_account = NULL;
+	acct = (struct account *)calloc(1, sizeof *acct);
+	if (!acct)
+		return;
+	LOCK();
+	for (slot = 0; slot < naccounts; slot++)
+		if (!accounts[slot])
+			break;
+	if (slot == maxaccounts) {
+		newmax = maxaccounts ? maxaccounts * 2 : 16;
+		if (newmax > MAX_ACCOUNTS)
+			newmax = MAX_ACCOUNTS;
+		newaccounts = NULL;
+		if (newmax > maxaccounts)
+			newaccounts = (struct account **)malloc(
+			    newmax * sizeof *accounts);
+		if (!newaccounts) {
+			UNLOCK();
+			free(acct);
+			return;
+		}
+		if (maxaccounts)
+			memcpy(newaccounts, accounts,
+			    maxaccounts * sizeof *accounts);
+		accounts = newaccounts;
+		maxaccounts = newmax;
+	}
+	accounts[slot] = acct;
+	if (slot == naccounts)
+		naccounts++;
+	UNLOCK();
+	interp->mem_account = (void *)(SEE_size_t)(slot + 1);
+}
+
+/*
+ * Closes the account of an interpreter being destroyed. If released
+ * is set, all its storage has been freed. Otherwise the account must
+ * outlive the interpreter until SEE's collector has credited it with
+ * every block tagged for it; only then may its slot be reused.
+ */
+void
+_SEE_mem_account_close(interp, released)
+	struct SEE_interpreter *interp;
+	int released;
+{
+	unsigned int slot = (unsigned int)(SEE_size_t)interp->mem_account;
+	struct account *acct = ACCOUNT(interp);
+
+	interp->mem_account = NULL;
+	if (!acct)
+		return;
+#if WITH_SEE_GC
+	if (!released && acct->stats.total_blocks &&
+	    SEE_system.malloc == _SEE_gc_malloc)
+	{
+		acct->closed = 1;
+		return;
+	}
+#endif
+	free(acct);
+	LOCK();
+	accounts[slot - 1] = NULL;
+	UNLOCK();
+}
+
+/* Returns the category an allocation by the interpreter is charged to */
+static int
+category_of(interp, atomic)
+	struct SEE_interpreter *interp;
+	int atomic;
+{
+	/* Atomic storage charged to objects is taken to be string data */
+	if (atomic && interp->mem_category == SEE_MEM_OBJECT)
+		return SEE_MEM_STRING;
+	return interp->mem_category;
+}
+
+/*
+ * Returns the tag that SEE's collector keeps with a block allocated
+ * now for the interpreter, or 0 if the block is not accounted for.
+ */
+unsigned int
+_SEE_mem_tag(interp, atomic)
+	struct SEE_interpreter *interp;
+	int atomic;
+{
+	if (!interp || !interp->mem_account)
+		return 0;
+	return ((unsigned int)(SEE_size_t)interp->mem_account << TAG_SHIFT) |
+	    category_of(interp, atomic);
+}
+
+/* Charges a newly allocated, tagged block to its account */
+void
+_SEE_mem_charge(tag, size)
+	unsigned int tag;
+	SEE_size_t size;
+{
+	account_charge(accounts[(tag >> TAG_SHIFT) - 1],
+	    tag & ((1 << TAG_SHIFT) - 1), size);
+}
+
+/* Credits a freed, tagged block to its account */
+void
+_SEE_mem_release(tag, size)
+	unsigned int tag;
+	SEE_size_t size;
+{
+	unsigned int slot = tag >> TAG_SHIFT;
+	struct account *acct = accounts[slot - 1];
+
+	account_credit(acct, tag & ((1 << TAG_SHIFT) - 1), size);
+	if (acct->closed && !acct->stats.total_blocks) {
+		free(acct);
+		accounts[slot - 1] = NULL;
+	}
+}
+
+static void
+account_charge(acct, category, size)
+	struct account *acct;
+	int category;
+	SEE_size_t size;
+{
+	acct->stats.bytes[category] += size;
+	acct->stats.blocks[category]++;
+	acct->stats.total_bytes += size;
+	acct->stats.total_blocks++;
+	if (acct->stats.total_bytes > acct->stats.peak_bytes)
+		acct->stats.peak_bytes = acct->stats.total_bytes;
+}
+
+static void
+account_credit(acct, category, size)
+	struct account *acct;
+	int category;
+	SEE_size_t size;
+{
+	acct->stats.bytes[category] -= size;
+	acct->stats.blocks[category]--;
+	acct->stats.total_bytes -= size;
+	acct->stats.total_blocks--;
+}
+
+/* Charges an allocation, unless the allocator fn tags its blocks */
+static void
+charge(interp, fn, atomic, size)
+	struct SEE_interpreter *interp;
+	void *fn;
+	int atomic;
+	SEE_size_t size;
+{
+	struct account *acct = ACCOUNT(interp);
+
+	if (!acct)
+		return;
+#if WITH_SEE_GC
+	if (fn == (void *)_SEE_gc_malloc ||
+	    fn == (void *)_SEE_gc_malloc_string ||
+	    fn == (void *)_SEE_gc_malloc_finalize)
+		return;
+#endif
+	account_charge(acct, category_of(interp, atomic), size);
+}
+
+/*
+ * Checks that allocating size more bytes keeps the interpreter within
+ * its memory limits. Before either limit is reported, garbage is
+ * collected (except in arena interpreters, which hold no garbage that
+ * a collection could free); the limit is reported all the same if that
+ * leaves less than a sixteenth of it free.
+ * Passing the soft limit is reported once, until the interpreter's
+ * use falls back below three quarters of it: to the host hook if
+ * there is one, which may throw, or else with a RangeError. Passing
+ * the hard limit always refuses the allocation with a RangeError,
+ * after calling the hook. Limits are not checked outside of a try
+ * context (for instance, while an error is being constructed), where
+ * the RangeError could not be caught.
+ */
+static void
+check_limits(interp, size)
+	struct SEE_interpreter *interp;
+	SEE_size_t size;
+{
+	struct account *acct = ACCOUNT(interp);
+	SEE_size_t soft, hard;
+	int soft_over, hard_over;
+
+	if (!acct || !interp->try_context)
+		return;
+	soft = interp->mem_soft_limit;
+	hard = interp->mem_hard_limit;
+	if (acct->stats.total_bytes < soft - soft / 4)
+		acct->soft_passed = 0;
+	soft_over = soft && acct->stats.total_bytes + size > soft;
+	hard_over = hard && acct->stats.total_bytes + size > hard;
+	if (!hard_over && (!soft_over || acct->soft_passed))
+		return;
+
+	/* A collection that leaves little room only puts off the next */
+	if (!interp->arena) {
+		SEE_gcollect(interp);
+		if (acct->stats.total_bytes < soft - soft / 4)
+			acct->soft_passed = 0;
+		soft_over = soft &&
+		    acct->stats.total_bytes + size > soft - soft / 16;
+		hard_over = hard &&
+		    acct->stats.total_bytes + size > hard - hard / 16;
+		if (!hard_over && (!soft_over || acct->soft_passed))
+			return;
+	}
+
+	if (hard_over)
+		acct->stats.hard_exceeded++;
+	else {
+		acct->stats.soft_exceeded++;
+		acct->soft_passed = 1;
+	}
+	if (SEE_system.mem_limit_exceeded)
+		(*SEE_system.mem_limit_exceeded)(interp, hard_over);
+	if (hard_over || !SEE_system.mem_limit_exceeded)
+		SEE_error_throw_string(interp, interp->RangeError,
+		    hard_over ? STR(mem_hard_limit) : STR(mem_soft_limit));
+}
+
+/**
+ * Reports the memory allocated for an interpreter that is still live.
+ * With SEE's own collector, blocks are counted until they are swept;
+ * SEE_gcollect() sweeps them all.
+ */
+void
+SEE_interpreter_memstats(interp, stats)
+	struct SEE_interpreter *interp;
+	struct SEE_memstats *stats;
+{
+	struct account *acct = ACCOUNT(interp);
+
+	if (acct)
+		*stats = acct->stats;
+	else
+		memset(stats, 0, sizeof *stats);
+}
+
 /*------------------------------------------------------------
  * Wrappers around memory allocators that check for failure
  */
@@ -79,9 +401,19 @@ _SEE_malloc(interp, size, file, line)
 
 	if (size == 0)
 		return NULL;
+	check_limits(interp, size);
+	if (interp && interp->arena) {
+		data = _SEE_arena_malloc((struct arena *)interp->arena, size,
+		    category_of(interp, 0), NULL, NULL);
+		if (data == NULL)
+			(*SEE_system.mem_exhausted)(interp);
+		charge(interp, (void *)_SEE_arena_malloc, 0, size);
+		return data;
+	}
 	data = (*SEE_system.malloc)(interp, size, file, line);
-	if (data == NULL) 
+	if (data == NULL)
 		(*SEE_system.mem_exhausted)(interp);
+	charge(interp, (void *)SEE_system.malloc, 0, size);
 	return data;
 }
 
@@ -90,6 +422,7 @@ SEE_malloc(interp, size)
 	struct SEE_interpreter *interp;
 	SEE_size_t size;
 {
+	PROFILE(interp, size, 0, 0);
 	return _SEE_malloc(interp, size, 0, 0);
 }
 
@@ -111,10 +444,20 @@ _SEE_malloc_finalize(interp, size, finalizefn, closure, file, line)
 
 	if (size == 0)
 		return NULL;
+	check_limits(interp, size);
+	if (interp && interp->arena) {
+		data = _SEE_arena_malloc((struct arena *)interp->arena, size,
+		    category_of(interp, 0), finalizefn, closure);
+		if (data == NULL)
+			(*SEE_system.mem_exhausted)(interp);
+		charge(interp, (void *)_SEE_arena_malloc, 0, size);
+		return data;
+	}
 	data = (*SEE_system.malloc_finalize)(interp, size, finalizefn, closure,
 	    file, line);
-	if (data == NULL) 
+	if (data == NULL)
 		(*SEE_system.mem_exhausted)(interp);
+	charge(interp, (void *)SEE_system.malloc_finalize, 0, size);
 	return data;
 }
 
@@ -125,6 +468,7 @@ SEE_malloc_finalize(interp, size, finalizefn, closure)
 	void (*finalizefn)(struct SEE_interpreter *, void *, void *);
 	void *closure;
 {
+	PROFILE(interp, size, 0, 0);
 	return _SEE_malloc_finalize(interp, size, finalizefn, closure, 0, 0);
 }
 
@@ -145,11 +489,19 @@ _SEE_malloc_string(interp, size, file, line)
 
 	if (size == 0)
 		return NULL;
-	if (SEE_system.malloc_string)
+	check_limits(interp, size);
+	if (interp && interp->arena) {
+		data = _SEE_arena_malloc((struct arena *)interp->arena, size,
+		    category_of(interp, 1), NULL, NULL);
+		charge(interp, (void *)_SEE_arena_malloc, 1, size);
+	} else if (SEE_system.malloc_string) {
 		data = (*SEE_system.malloc_string)(interp, size, 0, 0);
-	else
+		charge(interp, (void *)SEE_system.malloc_string, 1, size);
+	} else {
 		data = (*SEE_system.malloc)(interp, size, 0, 0);
-	if (data == NULL) 
+		charge(interp, (void *)SEE_system.malloc, 0, size);
+	}
+	if (data == NULL)
 		(*SEE_system.mem_exhausted)(interp);
 	return data;
 }
@@ -159,9 +511,61 @@ SEE_malloc_string(interp, size)
 	struct SEE_interpreter *interp;
 	SEE_size_t size;
 {
+	PROFILE(interp, size, 0, 0);
 	return _SEE_malloc_string(interp, size, 0, 0);
 }
 
+/*
+ * Allocates size bytes of garbage-collected storage, charged to the
+ * given accounting category (SEE_MEM_*) instead of the interpreter's
+ * current one.
+ */
+static void *
+_SEE_malloc_category(interp, size, category, file, line)
+	struct SEE_interpreter *interp;
+	SEE_size_t size;
+	int category;
+	const char *file;
+	int line;
+{
+	void *data;
+	int saved;
+
+	if (!interp)
+		return _SEE_malloc(interp, size, file, line);
+	check_limits(interp, size);
+	saved = interp->mem_category;
+	interp->mem_category = category;
+	data = _SEE_malloc(interp, size, file, line);
+	interp->mem_category = saved;
+	return data;
+}
+
+void *
+SEE_malloc_category(interp, size, category)
+	struct SEE_interpreter *interp;
+	SEE_size_t size;
+	int category;
+{
+	PROFILE(interp, size, 0, 0);
+	return _SEE_malloc_category(interp, size, category, 0, 0);
+}
+
+/* Returns a block to its interpreter's arena, crediting its account */
+static void
+arena_free(interp, p)
+	struct SEE_interpreter *interp;
+	void *p;
+{
+	struct account *acct = ACCOUNT(interp);
+	SEE_size_t size;
+	int category;
+
+	size = _SEE_arena_free((struct arena *)interp->arena, p, &category);
+	if (size && acct)
+		account_credit(acct, category, size);
+}
+
 /*
  * Releases memory that the caller *knows* is unreachable.
  */
@@ -173,7 +577,10 @@ _SEE_free(interp, memp, file, line)
 	int line;
 {
 	if (*memp) {
-		(*SEE_system.free)(interp, *memp, 0, 0);
+		if (interp && interp->arena)
+			arena_free(interp, *memp);
+		else
+			(*SEE_system.free)(interp, *memp, 0, 0);
 		*memp = NULL;
 	}
 }
@@ -211,6 +618,7 @@ _SEE_malloc_debug(interp, size, file, line)
 	const char *file;
 	int line;
 {
+	PROFILE(interp, size, file, line);
 	return _SEE_malloc(interp, size, file, line);
 }
 
@@ -223,6 +631,7 @@ _SEE_malloc_finalize_debug(interp, size, finalizefn, closure, file, line)
 	const char *file;
 	int line;
 {
+	PROFILE(interp, size, file, line);
 	return _SEE_malloc_finalize(interp, size, finalizefn, closure,
 	    file, line);
 }
@@ -234,9 +643,22 @@ _SEE_malloc_string_debug(interp, size, file, line)
 	const char *file;
 	int line;
 {
+	PROFILE(interp, size, file, line);
 	return _SEE_malloc_string(interp, size, file, line);
 }
 
+void *
+_SEE_malloc_category_debug(interp, size, category, file, line)
+	struct SEE_interpreter *interp;
+	SEE_size_t size;
+	int category;
+	const char *file;
+	int line;
+{
+	PROFILE(interp, size, file, line);
+	return _SEE_malloc_category(interp, size, category, file, line);
+}
+
 void
 _SEE_free_debug(interp, memp, file, line)
 	struct SEE_interpreter *interp;
@@ -260,6 +682,7 @@ _SEE_malloc_debug(interp, size, file, line)
 
 	if (SEE_mem_debug)
 		dprintf("malloc %u (%s:%d)", size, file, line);
+	PROFILE(interp, size, file, line);
 	data = _SEE_malloc(interp, size, file, line);
 	if (SEE_mem_debug)
 		dprintf(" -> %p\n", data);
@@ -280,6 +703,7 @@ _SEE_malloc_finalize_debug(interp, size, finalizefn, closure, file, line)
 	if (SEE_mem_debug)
 		dprintf("malloc_finalize %u %p(%p) (%s:%d)", 
 		    size, finalizefn, closure, file, line);
+	PROFILE(interp, size, file, line);
 	data = _SEE_malloc_finalize(interp, size, finalizefn, closure,
 	    file, line);
 	if (SEE_mem_debug)
@@ -298,12 +722,33 @@ _SEE_malloc_string_debug(interp, size, file, line)
 
 	if (SEE_mem_debug)
 		dprintf("malloc_string %u (%s:%d)", size, file, line);
+	PROFILE(interp, size, file, line);
 	data = _SEE_malloc_string(interp, size, file, line);
 	if (SEE_mem_debug)
 		dprintf(" -> %p\n", data);
 	return data;
 }
 
+void *
+_SEE_malloc_category_debug(interp, size, category, file, line)
+	struct SEE_interpreter *interp;
+	SEE_size_t size;
+	int category;
+	const char *file;
+	int line;
+{
+	void *data;
+
+	if (SEE_mem_debug)
+		dprintf("malloc_category %u %d (%s:%d)", size, category,
+		    file, line);
+	PROFILE(interp, size, file, line);
+	data = _SEE_malloc_category(interp, size, category, file, line);
+	if (SEE_mem_debug)
+		dprintf(" -> %p\n", data);
+	return data;
+}
+
 void
 _SEE_free_debug(interp, memp, file, line)
 	struct SEE_interpreter *interp;
@@ -331,12 +776,13 @@ _SEE_free_debug(interp, memp, file, line)
 #endif
 
 static void
-_SEE_grow_to(interp, grow, new_len, file, line)
+_SEE_grow_to(interp, grow, new_len, file, line, caller)
 	struct SEE_interpreter *interp;
 	struct SEE_growable *grow;
 	unsigned int new_len;
 	const char *file;
 	int line;
+	const void *caller;
 {
 	SEE_size_t new_alloc;
 	void *new_ptr;
@@ -354,11 +800,13 @@ _SEE_grow_to(interp, grow, new_len, file, line)
 		new_alloc *= 2;
 
 	if (new_alloc > grow->allocated) {
-	    if (grow->is_string)
-		new_ptr = _SEE_malloc_string_debug(interp, new_alloc, 
+	    if (_SEE_alloc_profiling)
+		_SEE_alloc_profile_record(interp, new_alloc, caller,
 		    file, line);
+	    if (grow->is_string)
+		new_ptr = _SEE_malloc_string(interp, new_alloc, file, line);
 	    else
-		new_ptr = _SEE_malloc_debug(interp, new_alloc, file, line);
+		new_ptr = _SEE_malloc(interp, new_alloc, file, line);
 	    if (*grow->length_ptr)
 		memcpy(new_ptr, *grow->data_ptr, 
 		    *grow->length_ptr * grow->element_size);
@@ -381,7 +829,7 @@ SEE_grow_to(interp, grow, new_len)
 	struct SEE_growable *grow;
 	unsigned int new_len;
 {
-	_SEE_grow_to(interp, grow, new_len, 0, 0);
+	_SEE_grow_to(interp, grow, new_len, 0, 0, _SEE_ALLOC_CALLER());
 }
 
 void
@@ -401,7 +849,7 @@ _SEE_grow_to_debug(interp, grow, new_len, file, line)
 		    grow->element_size,
 		    file, line);
 #endif
-	SEE_grow_to(interp, grow, new_len);
+	_SEE_grow_to(interp, grow, new_len, file, line, _SEE_ALLOC_CALLER());
 #ifndef NDEBUG
 	if (SEE_mem_debug)
 		dprintf("\n");
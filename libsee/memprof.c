@@ -0,0 +1,397 @@
+/*
+ * Copyright (c) 2008
+ *      David Leonard.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of David Leonard nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/* $Id$ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#if STDC_HEADERS
+# include <stdio.h>
+# include <stdlib.h>
+#endif
+
+#if HAVE_STRING_H
+# include <string.h>
+#endif
+
+#include <see/type.h>
+#include <see/mem.h>
+#include <see/try.h>
+#include <see/string.h>
+#include <see/debug.h>
+#include <see/interpreter.h>
+
+#include "memprof.h"
+
+/*
+ * Allocation profiler.
+ *
+ * Every allocation made while profiling is counted twice: once against
+ * its C call site, and once against the script location (file and
+ * line) that the interpreter was running. The sites are kept in two
+ * open-addressed hash tables in system storage, so that recording
+ * never allocates from, or is collected by, the heap being profiled.
+ * A call site is its caller's return address where the compiler gives
+ * one, and the __FILE__ and __LINE__ that debugging builds pass down.
+ *
+ * SEE_PrintAllocProfile() prints either a report of the sites sorted
+ * by the bytes they allocated, or the C call sites as a heap profile
+ * in the legacy text format read by pprof.
+ */
+
+struct site {
+	const void	*pc;		/* C caller's return address */
+	const char	*file;		/* C source file */
+	SEE_char_t	*name;		/* script file name */
+	unsigned int	 namelen;
+	int		 line;
+	unsigned int	 hash;
+	unsigned long	 count;
+	unsigned long	 bytes;
+};
+
+struct table {
+	struct site	*sites;
+	unsigned int	 size;		/* power of two, or 0 */
+	unsigned int	 used;
+};
+
+int _SEE_alloc_profiling;
+
+static struct table csites, jssites;
+static unsigned long total_count, total_bytes;
+
+static void table_clear(struct table *);
+static int table_grow(struct table *);
+static struct site *lookup_csite(const void *, const char *, int);
+static struct site *lookup_jssite(struct SEE_throw_location *);
+static int site_cmp(const void *, const void *);
+static struct site **sorted(struct table *);
+static void print_text(FILE *);
+static void print_pprof(FILE *);
+
+/* Empties a table, releasing its storage */
+static void
+table_clear(t)
+	struct table *t;
+{
+	unsigned int i;
+
+	for (i = 0; i < t->size; i++)
+		free(t->sites[i].name);
+	free(t->sites);
+	t->sites = NULL;
+	t->size = t->used = 0;
+}
+
+/* Doubles a table's size. Returns 0 if there is no memory for it. */
+static int
+table_grow(t)
+	struct table *t;
+{
+	struct site *sites, *s;
+	unsigned int i, j, size;
+
+	size = t->size ? t->size * 2 : 256;
+	sites = (struct site *)calloc(size, sizeof *sites);
+	if (!sites)
+		return 0;
+	for (i = 0; i < t->size; i++) {
+		s = &t->sites[i];
+		if (!s->count)
+			continue;
+		for (j = s->hash & (size - 1); sites[j].count;
+		     j = (j + 1) & (size - 1))
+			;
+		sites[j] = *s;
+	}
+	free(t->sites);
+	t->sites = sites;
+	t->size = size;
+	return 1;
+}
+
+/* Finds or adds the entry for a C call site; NULL if out of memory */
+static struct site *
+lookup_csite(pc, file, line)
+	const void *pc;
+	const char *file;
+	int line;
+{
+	struct site *s;
+	unsigned int hash, i;
+
+	hash = (unsigned int)((SEE_size_t)pc >> 2) * 31 +
+	    (unsigned int)((SEE_size_t)file >> 2) * 7 + (unsigned int)line;
+	if (csites.used >= csites.size - csites.size / 4 &&
+	    !table_grow(&csites))
+		return NULL;
+	for (i = hash & (csites.size - 1); ; i = (i + 1) & (csites.size - 1)) {
+		s = &csites.sites[i];
+		if (!s->count)
+			break;
+		if (s->hash == hash && s->pc == pc && s->file == file &&
+		    s->line == line)
+			return s;
+	}
+	s->pc = pc;
+	s->file = file;
+	s->line = line;
+	s->hash = hash;
+	csites.used++;
+	return s;
+}
+
+/*
+ * Finds or adds the entry for a script location; NULL if out of memory.
+ * Entries are keyed on the file name's text, not on the string, which
+ * may be collected and its storage reused.
+ */
+static struct site *
+lookup_jssite(loc)
+	struct SEE_throw_location *loc;
+{
+	struct site *s;
+	unsigned int hash, i, len;
+	const SEE_char_t *name;
+	int line;
+
+	if (loc && loc->filename) {
+		name = loc->filename->data;
+		len = loc->filename->length;
+	} else {
+		name = NULL;
+		len = 0;
+	}
+	line = loc ? loc->lineno : 0;
+	hash = (unsigned int)line;
+	for (i = 0; i < len; i++)
+		hash = hash * 31 + name[i];
+	if (jssites.used >= jssites.size - jssites.size / 4 &&
+	    !table_grow(&jssites))
+		return NULL;
+	for (i = hash & (jssites.size - 1); ; i = (i + 1) & (jssites.size - 1))
+	{
+		s = &jssites.sites[i];
+		if (!s->count)
+			break;
+		if (s->hash == hash && s->line == line && s->namelen == len &&
+		    (len == 0 || memcmp(s->name, name, len * sizeof *name) == 0))
+			return s;
+	}
+	if (len) {
+		s->name = (SEE_char_t *)malloc(len * sizeof *name);
+		if (!s->name)
+			return NULL;
+		memcpy(s->name, name, len * sizeof *name);
+	}
+	s->namelen = len;
+	s->line = line;
+	s->hash = hash;
+	jssites.used++;
+	return s;
+}
+
+/*
+ * Counts an allocation of size bytes for the interpreter, made from
+ * the C call site given by pc, file and line.
+ */
+void
+_SEE_alloc_profile_record(interp, size, pc, file, line)
+	struct SEE_interpreter *interp;
+	SEE_size_t size;
+	const void *pc;
+	const char *file;
+	int line;
+{
+	struct site *s;
+
+	total_count++;
+	total_bytes += size;
+	if ((s = lookup_csite(pc, file, line)) != NULL) {
+		s->count++;
+		s->bytes += size;
+	}
+	if ((s = lookup_jssite(interp ? interp->try_location : NULL)) != NULL)
+	{
+		s->count++;
+		s->bytes += size;
+	}
+}
+
+/**
+ * Starts profiling allocations, discarding any earlier profile, or
+ * stops. The profile is kept after stopping, for
+ * SEE_PrintAllocProfile().
+ */
+void
+SEE_alloc_profile(enable)
+	int enable;
+{
+	if (enable) {
+		table_clear(&csites);
+		table_clear(&jssites);
+		total_count = total_bytes = 0;
+	}
+	_SEE_alloc_profiling = enable;
+}
+
+/* Orders sites by the bytes they allocated, most first */
+static int
+site_cmp(a, b)
+	const void *a, *b;
+{
+	const struct site *sa = *(const struct site * const *)a;
+	const struct site *sb = *(const struct site * const *)b;
+
+	if (sa->bytes != sb->bytes)
+		return sa->bytes < sb->bytes ? 1 : -1;
+	if (sa->count != sb->count)
+		return sa->count < sb->count ? 1 : -1;
+	return 0;
+}
+
+/* Returns a new array of a table's sites, sorted; NULL if none */
+static struct site **
+sorted(t)
+	struct table *t;
+{
+	struct site **list;
+	unsigned int i, n;
+
+	list = (struct site **)malloc((t->used + 1) * sizeof *list);
+	if (!list)
+		return NULL;
+	for (i = n = 0; i < t->size; i++)
+		if (t->sites[i].count)
+			list[n++] = &t->sites[i];
+	qsort(list, n, sizeof *list, site_cmp);
+	list[n] = NULL;
+	return list;
+}
+
+static void
+print_text(f)
+	FILE *f;
+{
+	struct site **list;
+	unsigned int i, j;
+	SEE_char_t c;
+
+	fprintf(f, "%lu allocations, %lu bytes\n", total_count, total_bytes);
+
+	fprintf(f, "\n%12s %10s  %s\n", "bytes", "count", "C call site");
+	if ((list = sorted(&csites)) != NULL) {
+		for (i = 0; list[i]; i++) {
+			fprintf(f, "%12lu %10lu  ", list[i]->bytes,
+			    list[i]->count);
+			if (list[i]->file)
+				fprintf(f, "%s:%d ", list[i]->file,
+				    list[i]->line);
+			if (list[i]->pc)
+				fprintf(f, "%p", list[i]->pc);
+			fprintf(f, "\n");
+		}
+		free(list);
+	}
+
+	fprintf(f, "\n%12s %10s  %s\n", "bytes", "count", "script location");
+	if ((list = sorted(&jssites)) != NULL) {
+		for (i = 0; list[i]; i++) {
+			fprintf(f, "%12lu %10lu  ", list[i]->bytes,
+			    list[i]->count);
+			if (!list[i]->namelen && !list[i]->line) {
+				fprintf(f, "(no script)\n");
+				continue;
+			}
+			for (j = 0; j < list[i]->namelen; j++) {
+				c = list[i]->name[j];
+				if (c >= ' ' && c < 0x7f)
+					putc(c, f);
+				else
+					fprintf(f, "\\u%04x", c);
+			}
+			fprintf(f, ":%d\n", list[i]->line);
+		}
+		free(list);
+	}
+}
+
+/*
+ * Prints the C call sites as a one-frame heap profile. The counts are
+ * of all allocations, so they are given as both in use and allocated.
+ * The process's memory map, where the system provides one, lets pprof
+ * find the symbols for the addresses.
+ */
+static void
+print_pprof(f)
+	FILE *f;
+{
+	struct site **list;
+	unsigned int i;
+	FILE *maps;
+	int ch;
+
+	fprintf(f, "heap profile: %6lu: %8lu [%6lu: %8lu] @ heapprofile\n",
+	    total_count, total_bytes, total_count, total_bytes);
+	if ((list = sorted(&csites)) != NULL) {
+		for (i = 0; list[i]; i++)
+			if (list[i]->pc)
+				fprintf(f, "%6lu: %8lu [%6lu: %8lu] @ %p\n",
+				    list[i]->count, list[i]->bytes,
+				    list[i]->count, list[i]->bytes,
+				    list[i]->pc);
+		free(list);
+	}
+	fprintf(f, "\nMAPPED_LIBRARIES:\n");
+	if ((maps = fopen("/proc/self/maps", "r")) != NULL) {
+		while ((ch = getc(maps)) != EOF)
+			putc(ch, f);
+		fclose(maps);
+	}
+}
+
+/**
+ * Prints the profile recorded since SEE_alloc_profile() last started
+ * it, as a text report (SEE_ALLOC_PROFILE_TEXT) or for pprof
+ * (SEE_ALLOC_PROFILE_PPROF).
+ */
+void
+SEE_PrintAllocProfile(f, format)
+	FILE *f;
+	int format;
+{
+	if (!f) f = stderr;
+	if (format == SEE_ALLOC_PROFILE_PPROF)
+		print_pprof(f);
+	else
+		print_text(f);
+}
@@ -0,0 +1,32 @@
+/* Copyright (c) 2008, David Leonard. All rights reserved. */
+/* $Id$ */
+
+#ifndef _SEE_h_memprof_
+#define _SEE_h_memprof_
+
+#include <see/type.h>
+
+struct SEE_interpreter;
+
+/*
+ * The allocation profiler. While _SEE_alloc_profiling is set, the
+ * SEE_malloc() family calls _SEE_alloc_profile_record() with the
+ * address its caller will return to (or NULL where the compiler
+ * cannot tell), and the C source location passed to the debugging
+ * variants (or NULL). The allocation is counted against that call
+ * site, and against the script location the interpreter is running.
+ *
+ * The profiler is not thread-safe.
+ */
+extern int _SEE_alloc_profiling;
+
+void _SEE_alloc_profile_record(struct SEE_interpreter *, SEE_size_t,
+	const void *, const char *, int);
+
+#if defined(__GNUC__)
+# define _SEE_ALLOC_CALLER()	__builtin_return_address(0)
+#else
+# define _SEE_ALLOC_CALLER()	NULL
+#endif
+
+#endif /* _SEE_h_memprof_ */
@@ -48,6 +48,7 @@
 
 #include "stringdefs.h"
 #include "dprint.h"
+#include "gc.h"
 
 static unsigned int hashfn(struct SEE_string *);
 static struct SEE_property **find(struct SEE_interpreter *,
@@ -56,6 +57,7 @@ static void native_enum_reset(struct SEE_interpreter *,
 	struct SEE_enum *);
 static struct SEE_string *native_enum_next(struct SEE_interpreter *,
 	struct SEE_enum *, int *);
+static void property_trace(void *);
 
 #ifndef NDEBUG
 int SEE_native_debug = 0;
@@ -206,6 +208,7 @@ SEE_native_put(interp, o, ip, val, attr)
 		}
 #endif
 		SEE_VALUE_COPY(&n->lru->value, val);
+		_SEE_gc_store_value(n->lru, val);
 		return;
 	}
 
@@ -226,6 +229,7 @@ SEE_native_put(interp, o, ip, val, attr)
 			SEE_error_throw_string(interp, interp->TypeError, 
 				STR(internal_error));
 		o->Prototype = val->u.object;
+		_SEE_gc_store(o, o->Prototype);
 		return;
 	}
 
@@ -240,15 +244,20 @@ SEE_native_put(interp, o, ip, val, attr)
 	x = find(interp, o, ip);
 	if (!*x) {
 		struct SEE_property *prop;
-		prop = SEE_NEW(interp, struct SEE_property);
+		prop = SEE_NEW_CATEGORY(interp, struct SEE_property,
+		    SEE_MEM_PROPERTY);
+		_SEE_gc_barriered(prop);
+		_SEE_gc_typed(prop, property_trace);
 		prop->next = NULL;
 		prop->name = ip;
 		prop->attr = attr;
 		*x = prop;
+		_SEE_gc_store(x, prop);
 	} else if (attr)
 		(*x)->attr = attr;
 	n->lru = *x;
 	SEE_VALUE_COPY(&(*x)->value, val);
+	_SEE_gc_store_value(*x, val);
 
 #ifndef NDEBUG
 	if (SEE_native_debug) {
@@ -411,6 +420,7 @@ SEE_native_delete(interp, o, ip)
 	if (n->lru == *x)
 	    n->lru = NULL;
 	*x = (*x)->next;
+	_SEE_gc_store(x, *x);
 	return 1;
 }
 
@@ -577,6 +587,8 @@ static struct SEE_objectclass native_class = {
 	NULL,					/* Construct */
 	NULL,					/* Call */
 	NULL,					/* HasInstance */
+	NULL,					/* get_sec_domain */
+	SEE_native_trace			/* trace */
 };
 
 /* Return a new, native object */
@@ -587,6 +599,7 @@ SEE_native_new(interp)
 	struct SEE_native *n;
 
 	n = SEE_NEW(interp, struct SEE_native);
+	_SEE_gc_barriered(n);
 	SEE_native_init(n, interp, &native_class, NULL);
 	return (struct SEE_object *)n;
 }
@@ -607,4 +620,43 @@ SEE_native_init(n, interp, objectclass, prototype)
 	n->lru = NULL;
 	for (i = 0; i < SEE_NATIVE_HASHLEN; i++)
 		n->properties[i] = NULL;
+	_SEE_gc_object(&n->object);
+}
+
+/*
+ * Garbage collector trace hook for native objects. The property
+ * cells are marked and traced here, rather than being queued.
+ */
+void
+SEE_native_trace(o)
+	struct SEE_object *o;
+{
+	struct SEE_native *n = (struct SEE_native *)o;
+	struct SEE_property *prop;
+	int i;
+
+	SEE_gc_mark(o->Prototype);
+	SEE_gc_mark(o->host_data);
+	SEE_gc_mark(n->lru);
+	for (i = 0; i < SEE_NATIVE_HASHLEN; i++)
+	    for (prop = n->properties[i]; prop; prop = prop->next) {
+		_SEE_gc_mark_leaf(prop);
+		SEE_gc_mark(prop->name);
+		SEE_gc_mark_value(&prop->value);
+	    }
+}
+
+/*
+ * Garbage collector tracer for property cells reached other than
+ * through their object, or rescanned after a store.
+ */
+static void
+property_trace(p)
+	void *p;
+{
+	struct SEE_property *prop = (struct SEE_property *)p;
+
+	SEE_gc_mark(prop->next);
+	SEE_gc_mark(prop->name);
+	SEE_gc_mark_value(&prop->value);
 }
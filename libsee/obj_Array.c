@@ -33,12 +33,17 @@
 # include <config.h>
 #endif
 
+#if HAVE_STRING_H
+# include <string.h>
+#endif
+
 #include <see/mem.h>
 #include <see/value.h>
 #include <see/string.h>
 #include <see/object.h>
 #include <see/native.h>
 #include <see/cfunction.h>
+#include <see/system.h>
 #include <see/error.h>
 #include <see/interpreter.h>
 #include <see/debug.h>
@@ -49,18 +54,37 @@
 #include "parse.h"
 #include "init.h"
 #include "nmath.h"
+#include "strcache.h"
+#include "gc.h"
 
 /*
  * The Array object.
  * 15.4 
  */
 
-/* structure of array instances */
+/* Arrays up to this length are joined into an exactly-sized string */
+#define JOIN_DIRECT_MAX		65536
+
+/* Longest string that join() will try to build, in characters */
+#define JOIN_LENGTH_MAX		((unsigned int)-1 / 4)
+
+/*
+ * Structure of array instances.
+ * Elements 0 to ndense-1 are kept in the dense vector, where they are
+ * found without interning or hashing their names. They always have
+ * the default (zero) attributes and are never also native properties.
+ * Any other elements are kept as ordinary native properties.
+ */
 struct array_object {
 	struct SEE_native native;
 	SEE_uint32_t length;
+	struct SEE_value *dense;
+	SEE_uint32_t ndense, maxdense;
 };
 
+/* Smallest dense vector allocated */
+#define DENSE_MIN		8
+
 
 /* Prototypes */
 static void intstr_p(struct SEE_string *, SEE_uint32_t);
@@ -70,6 +94,10 @@ static struct array_object *toarray(struct SEE_interpreter *,
 	struct SEE_object *);
 static void check_too_long(struct SEE_interpreter *, SEE_uint32_t,
 	SEE_uint32_t);
+static void dense_reserve(struct SEE_interpreter *, struct array_object *,
+	SEE_uint32_t);
+static void dense_release(struct SEE_interpreter *, struct array_object *,
+	SEE_uint32_t);
 
 static void array_init(struct array_object *, struct SEE_interpreter *, 
 	unsigned int);
@@ -121,6 +149,11 @@ static int array_hasproperty(struct SEE_interpreter *, struct SEE_object *,
 	struct SEE_string *);
 static int array_delete(struct SEE_interpreter *, struct SEE_object *,
 	struct SEE_string *);
+static int array_canput(struct SEE_interpreter *, struct SEE_object *,
+	struct SEE_string *);
+static struct SEE_enum *array_enumerator(struct SEE_interpreter *,
+	struct SEE_object *);
+static void array_trace(struct SEE_object *);
 
 /* object class for Array constructor */
 static struct SEE_objectclass array_const_class = {
@@ -134,6 +167,9 @@ static struct SEE_objectclass array_const_class = {
 	SEE_native_enumerator,		/* DefaultValue */
 	array_construct,
 	array_construct,
+	NULL,				/* HasInstance */
+	NULL,				/* get_sec_domain */
+	SEE_native_trace		/* trace */
 };
 
 /* object class for array instances */
@@ -141,11 +177,16 @@ static struct SEE_objectclass array_inst_class = {
 	"Array",			/* Class */
 	array_get,			/* Get */
 	array_put,			/* Put */
-	SEE_native_canput,		/* CanPut */
+	array_canput,			/* CanPut */
 	array_hasproperty,		/* HasProperty */
 	array_delete,			/* Delete */
 	SEE_native_defaultvalue,	/* DefaultValue */
-	SEE_native_enumerator		/* enumerator */
+	array_enumerator,		/* enumerator */
+	NULL,				/* Construct */
+	NULL,				/* Call */
+	NULL,				/* HasInstance */
+	NULL,				/* get_sec_domain */
+	array_trace			/* trace */
 };
 
 void
@@ -263,9 +304,10 @@ intstr_p(s, i)
 }
 
 /*
- * If sp is null, allocates a new empty string.
- * Clears the string *sp and puts unsigned integer i into it.
- * Returns an intern'd string
+ * Returns an intern'd string for unsigned integer i.
+ * Small integers come from the interpreter's string cache. Otherwise,
+ * if sp is null, allocates a new empty string, then
+ * clears the string *sp and puts unsigned integer i into it.
  */
 static struct SEE_string *
 intstr(interp, sp, i)
@@ -273,18 +315,8 @@ intstr(interp, sp, i)
 	struct SEE_string **sp;
 	SEE_uint32_t i;
 {
-	switch (i) {
-	case 0: return STR(zero_digit);
-	case 1: return STR(1);
-	case 2: return STR(2);
-	case 3: return STR(3);
-	case 4: return STR(4);
-	case 5: return STR(5);
-	case 6: return STR(6);
-	case 7: return STR(7);
-	case 8: return STR(8);
-	case 9: return STR(9);
-	}
+	if (i < STRCACHE_INTS)
+		return _SEE_string_uint(interp, i);
 
 	if (!*sp)
 		*sp = SEE_string_new(interp, 9);
@@ -326,6 +358,57 @@ SEE_is_Array(o)
 	return o && o->objectclass == &array_inst_class;
 }
 
+/*
+ * Ensures the dense vector has room for n elements.
+ */
+static void
+dense_reserve(interp, ao, n)
+	struct SEE_interpreter *interp;
+	struct array_object *ao;
+	SEE_uint32_t n;
+{
+	struct SEE_value *newdense;
+	SEE_uint32_t newmax;
+
+	if (n <= ao->maxdense)
+	    return;
+	newmax = ao->maxdense < DENSE_MIN ? DENSE_MIN : ao->maxdense;
+	while (newmax < n && newmax * 2 > newmax)
+	    newmax *= 2;
+	if (newmax < n)
+	    newmax = n;
+	/* Only possible where SEE_size_t is no wider than SEE_uint32_t */
+	if ((SEE_size_t)newmax * sizeof (struct SEE_value)
+		/ sizeof (struct SEE_value) != newmax)
+	    SEE_error_throw(interp, interp->RangeError, "array too long");
+	newdense = SEE_NEW_ARRAY(interp, struct SEE_value, newmax);
+	_SEE_gc_barriered(newdense);
+	if (ao->ndense)
+	    memcpy(newdense, ao->dense, ao->ndense * sizeof *newdense);
+	ao->dense = newdense;
+	_SEE_gc_store(ao, newdense);
+	ao->maxdense = newmax;
+}
+
+/*
+ * Moves the dense elements from index 'from' upward into native
+ * properties, so that the dense vector ends just before 'from'.
+ */
+static void
+dense_release(interp, ao, from)
+	struct SEE_interpreter *interp;
+	struct array_object *ao;
+	SEE_uint32_t from;
+{
+	SEE_uint32_t i;
+	struct SEE_string *s = NULL;
+
+	for (i = from; i < ao->ndense; i++)
+	    SEE_native_put(interp, (struct SEE_object *)&ao->native,
+		intstr(interp, &s, i), &ao->dense[i], 0);
+	ao->ndense = from;
+}
+
 /* Fast native array push() */
 void
 SEE_Array_push(interp, o, v)
@@ -338,10 +421,38 @@ SEE_Array_push(interp, o, v)
 
 	a = toarray(interp, o);
 	check_too_long(interp, a->length, 1);
-	SEE_native_put(interp, o, intstr(interp, &s, a->length), v, 0);
+	if (a->ndense == a->length) {
+	    dense_reserve(interp, a, a->ndense + 1);
+	    SEE_VALUE_COPY(&a->dense[a->ndense], v);
+	    _SEE_gc_store_value(a->dense, v);
+	    a->ndense++;
+	} else
+	    SEE_native_put(interp, o, intstr(interp, &s, a->length), v, 0);
 	a->length++;
 }
 
+/*
+ * Gives the empty array o n elements, and returns their (uninitialised)
+ * dense storage for the caller to fill in. This is the quickest way to
+ * build an array whose length is known in advance. The caller must
+ * call _SEE_gc_store_value() on the storage after each element it
+ * stores.
+ */
+struct SEE_value *
+SEE_Array_dense(interp, o, n)
+	struct SEE_interpreter *interp;
+	struct SEE_object *o;
+	SEE_uint32_t n;
+{
+	struct array_object *a;
+
+	a = toarray(interp, o);
+	SEE_ASSERT(interp, a->length == 0);
+	dense_reserve(interp, a, n);
+	a->ndense = a->length = n;
+	return a->dense;
+}
+
 SEE_uint32_t
 SEE_Array_length(interp, o)
 	struct SEE_interpreter *interp;
@@ -358,9 +469,12 @@ array_init(ao, interp, length)
 	struct SEE_interpreter *interp;
 	unsigned int length;
 {
+	_SEE_gc_barriered(ao);
 	SEE_native_init(&ao->native, interp, &array_inst_class, 
 	    interp->Array_prototype);
 	ao->length = length;
+	ao->dense = NULL;
+	ao->ndense = ao->maxdense = 0;
 }
 
 /* 15.4.4.2 */
@@ -375,7 +489,6 @@ array_construct(interp, self, thisobj, argc, argv, res)
 	struct array_object *ao;
 	int i;
 	SEE_uint32_t length;
-	struct SEE_string *s = NULL;
 
 	if (argc == 1 && SEE_VALUE_GET_TYPE(argv[0]) == SEE_NUMBER &&
 		!SEE_COMPAT_JS(interp, ==, JS12))
@@ -389,10 +502,10 @@ array_construct(interp, self, thisobj, argc, argv, res)
 	} else {
 	    ao = SEE_NEW(interp, struct array_object);
 	    array_init(ao, interp, argc);
-	    for (i = 0; i < argc; i++) {
-		SEE_native_put(interp, (struct SEE_object *)&ao->native, 
-			intstr(interp, &s, i), argv[i], 0);
-	    }
+	    dense_reserve(interp, ao, argc);
+	    for (i = 0; i < argc; i++)
+		SEE_VALUE_COPY(&ao->dense[i], argv[i]);
+	    ao->ndense = argc;
 	}
 	SEE_SET_OBJECT(res, (struct SEE_object *)ao);
 }
@@ -407,7 +520,7 @@ array_proto_toString(interp, self, thisobj, argc, argv, res)
 {
 	(void)toarray(interp, thisobj);
 	if (SEE_COMPAT_JS(interp, ==, JS12)) {
-		struct SEE_string *s = SEE_string_new(interp, 0);
+		struct SEE_strbuf sb;
 		struct SEE_string *n = NULL;
 		int lastundef = 0;
 		SEE_uint32_t length, i;
@@ -418,14 +531,13 @@ array_proto_toString(interp, self, thisobj, argc, argv, res)
 		    SEE_error_throw_string(interp, interp->TypeError, 
 		       STR(null_thisobj));
 
-		SEE_string_addch(s, '[');
+		SEE_strbuf_init(interp, &sb, 0);
+		SEE_strbuf_addch(&sb, '[');
 		SEE_OBJECT_GET(interp, thisobj, STR(length), &v);
 		length = SEE_ToUint32(interp, &v);
 		for (i = 0; i < length; i++) {
-		    if (i) {
-		        SEE_string_addch(s, ',');
-		        SEE_string_addch(s, ' ');
-		    }
+		    if (i)
+		        SEE_strbuf_append_ascii(&sb, ", ");
 		    SEE_OBJECT_GET(interp, thisobj, intstr(interp, &n, i), &v);
 		    lastundef = 0;
 		    switch (SEE_VALUE_GET_TYPE(&v)) {
@@ -433,27 +545,25 @@ array_proto_toString(interp, self, thisobj, argc, argv, res)
 		    	lastundef = 1;
 			break;
 		    case SEE_STRING:
-			SEE_string_addch(s, '"');
+			SEE_strbuf_addch(&sb, '"');
 			for (j = 0; j < v.u.string->length; j++) {
 			    if (v.u.string->data[j] == '\"' ||
 				v.u.string->data[j] == '\\')
-				    SEE_string_addch(s, '\\');
-			    SEE_string_addch(s, v.u.string->data[j]);
+				    SEE_strbuf_addch(&sb, '\\');
+			    SEE_strbuf_addch(&sb, v.u.string->data[j]);
 			}
-			SEE_string_addch(s, '"');
+			SEE_strbuf_addch(&sb, '"');
 			break;
 		    default:
 			SEE_ToString(interp, &v, &vs);
-			SEE_string_append(s, vs.u.string);
+			SEE_strbuf_append(&sb, vs.u.string);
 			break;
 		    }
 		}
-	        if (lastundef) {
-		    SEE_string_addch(s, ',');
-		    SEE_string_addch(s, ' ');
-	        }
-		SEE_string_addch(s, ']');
-		SEE_SET_STRING(res, s);
+	        if (lastundef)
+		    SEE_strbuf_append_ascii(&sb, ", ");
+		SEE_strbuf_addch(&sb, ']');
+		SEE_SET_STRING(res, SEE_strbuf_string(&sb));
 	} else
 		array_proto_join(interp, self, thisobj, 0, NULL, res);
 }
@@ -572,7 +682,8 @@ array_proto_join(interp, self, thisobj, argc, argv, res)
 	struct SEE_value **argv, *res;
 {
 	struct SEE_value v, r6, r7;
-	struct SEE_string *separator, *s, *n = NULL;
+	struct SEE_string *separator, *n = NULL;
+	struct SEE_strbuf sb;
 	SEE_uint32_t length, i;
 	int use_comma;
 
@@ -599,21 +710,65 @@ array_proto_join(interp, self, thisobj, argc, argv, res)
 		separator = v.u.string;
 	}
 
-	s = SEE_string_new(interp, 0);
-	if (length) {
+	/*
+	 * Arrays of moderate length are joined in two passes: the
+	 * elements are converted to strings and their lengths summed,
+	 * then the result is allocated at its exact size and filled in.
+	 * Longer arrays are appended to a string buffer as they go.
+	 */
+	if (length <= JOIN_DIRECT_MAX) {
+	    struct SEE_string **parts = NULL;
+	    unsigned int total = 0;
+
+	    if (length)
+		parts = SEE_NEW_ARRAY(interp, struct SEE_string *, length);
+	    for (i = 0; i < length; i++) {
+		if (i) {
+		    if (separator->length > JOIN_LENGTH_MAX - total)
+			SEE_error_throw_string(interp, interp->Error,
+			    STR(string_limit_reached));
+		    total += separator->length;
+		}
+		SEE_OBJECT_GET(interp, thisobj, intstr(interp, &n, i), &r6);
+		if (SEE_VALUE_GET_TYPE(&r6) == SEE_UNDEFINED || 
+		    SEE_VALUE_GET_TYPE(&r6) == SEE_NULL) 
+		{
+		    parts[i] = NULL;
+		    continue;
+		}
+		if (SEE_VALUE_GET_TYPE(&r6) == SEE_STRING)
+		    parts[i] = r6.u.string;
+		else {
+		    SEE_ToString(interp, &r6, &r7);
+		    parts[i] = r7.u.string;
+		}
+		if (parts[i]->length > JOIN_LENGTH_MAX - total)
+		    SEE_error_throw_string(interp, interp->Error,
+			STR(string_limit_reached));
+		total += parts[i]->length;
+	    }
+	    SEE_strbuf_init(interp, &sb, total);
 	    for (i = 0; i < length; i++) {
 		if (i)
-		    SEE_string_append(s, separator);
+		    SEE_strbuf_append(&sb, separator);
+		if (parts[i])
+		    SEE_strbuf_append(&sb, parts[i]);
+	    }
+	} else {
+	    SEE_strbuf_init(interp, &sb, 0);
+	    for (i = 0; i < length; i++) {
+		if (i)
+		    SEE_strbuf_append(&sb, separator);
 		SEE_OBJECT_GET(interp, thisobj, intstr(interp, &n, i), &r6);
 		if (!(SEE_VALUE_GET_TYPE(&r6) == SEE_UNDEFINED || 
 		      SEE_VALUE_GET_TYPE(&r6) == SEE_NULL)) 
 		{
 		    SEE_ToString(interp, &r6, &r7);
-		    SEE_string_append(s, r7.u.string);
+		    SEE_strbuf_append(&sb, r7.u.string);
 		}
 	    }
 	}
-	SEE_SET_STRING(res, s);
+	SEE_SET_STRING(res, SEE_strbuf_string(&sb));
 }
 
 /* 15.4.4.6 */
@@ -1121,6 +1276,8 @@ array_setlength(interp, ao, val)
 	int flags;
 
 	newlen = SEE_ToUint32(interp, val);
+	while (ao->ndense > newlen)
+	    SEE_SET_UNDEFINED(&ao->dense[--ao->ndense]);
 	if (ao->length > newlen) {
 	    e = SEE_OBJECT_ENUMERATOR(interp, 
 	    	(struct SEE_object *)&ao->native);
@@ -1146,9 +1303,12 @@ array_get(interp, o, p, res)
 	struct SEE_value *res;
 {
 	struct array_object *ao = (struct array_object *)o;
+	SEE_uint32_t i;
 
 	if (p == STR(length))
 	    SEE_SET_NUMBER(res, ao->length);
+	else if (ao->ndense && SEE_to_array_index(p, &i) && i < ao->ndense)
+	    SEE_VALUE_COPY(res, &ao->dense[i]);
 	else
 	    SEE_native_get(interp, o, p, res);
 }
@@ -1166,22 +1326,56 @@ array_put(interp, o, p, val, attr)
 
 	if (p == STR(length))
 	    array_setlength(interp, ao, val);
-	else {
+	else if (!SEE_to_array_index(p, &i))
 	    SEE_native_put(interp, o, p, val, attr);
-	    if (SEE_to_array_index(p, &i))
-		if (i >= ao->length)
-		    ao->length = i + 1;
+	else if (i < ao->ndense && !attr) {
+	    SEE_VALUE_COPY(&ao->dense[i], val);
+	    _SEE_gc_store_value(ao->dense, val);
+	} else if (i == ao->ndense && !attr && (ao->ndense == ao->length ||
+		 !SEE_native_hasownproperty(interp, o, p)))
+	{
+	    dense_reserve(interp, ao, i + 1);
+	    SEE_VALUE_COPY(&ao->dense[i], val);
+	    _SEE_gc_store_value(ao->dense, val);
+	    ao->ndense++;
+	    if (i >= ao->length)
+		ao->length = i + 1;
+	} else {
+	    if (i < ao->ndense)
+		dense_release(interp, ao, i);
+	    SEE_native_put(interp, o, p, val, attr);
+	    if (i >= ao->length)
+		ao->length = i + 1;
 	}
 }
 
+static int
+array_canput(interp, o, p)
+	struct SEE_interpreter *interp;
+	struct SEE_object *o;
+	struct SEE_string *p;
+{
+	struct array_object *ao = (struct array_object *)o;
+	SEE_uint32_t i;
+
+	if (ao->ndense && SEE_to_array_index(p, &i) && i < ao->ndense)
+	    return 1;
+	return SEE_native_canput(interp, o, p);
+}
+
 static int
 array_hasproperty(interp, o, p)
 	struct SEE_interpreter *interp;
 	struct SEE_object *o;
 	struct SEE_string *p;
 {
+	struct array_object *ao = (struct array_object *)o;
+	SEE_uint32_t i;
+
 	if (p == STR(length))
 	    return 1;
+	else if (ao->ndense && SEE_to_array_index(p, &i) && i < ao->ndense)
+	    return 1;
 	else
 	    return SEE_native_hasproperty(interp, o, p);
 }
@@ -1192,8 +1386,82 @@ array_delete(interp, o, p)
 	struct SEE_object *o;
 	struct SEE_string *p;
 {
+	struct array_object *ao = (struct array_object *)o;
+	SEE_uint32_t i;
+
 	if (p == STR(length))
 	    return 0;
-	else
+	else if (ao->ndense && SEE_to_array_index(p, &i) && i < ao->ndense) {
+	    dense_release(interp, ao, i + 1);
+	    SEE_SET_UNDEFINED(&ao->dense[i]);
+	    ao->ndense = i;
+	    return 1;
+	} else
 	    return SEE_native_delete(interp, o, p);
 }
+
+/*
+ * Enumerates the dense elements of an array in order, followed by its
+ * native properties.
+ */
+struct array_enum {
+	struct SEE_enum base;
+	struct array_object *ao;
+	SEE_uint32_t next;
+	struct SEE_enum *native;
+};
+
+static struct SEE_string *
+array_enum_next(interp, e, dont_enump)
+	struct SEE_interpreter *interp;
+	struct SEE_enum *e;
+	int *dont_enump;
+{
+	struct array_enum *ae = (struct array_enum *)e;
+	struct SEE_string *s = NULL;
+
+	if (ae->next < ae->ao->ndense) {
+	    if (dont_enump)
+		*dont_enump = 0;
+	    return intstr(interp, &s, ae->next++);
+	}
+	return SEE_ENUM_NEXT(interp, ae->native, dont_enump);
+}
+
+static struct SEE_enumclass array_enumclass = {
+	0,
+	array_enum_next
+};
+
+static struct SEE_enum *
+array_enumerator(interp, o)
+	struct SEE_interpreter *interp;
+	struct SEE_object *o;
+{
+	struct array_enum *ae;
+
+	ae = SEE_NEW(interp, struct array_enum);
+	ae->base.enumclass = &array_enumclass;
+	ae->ao = (struct array_object *)o;
+	ae->next = 0;
+	ae->native = SEE_native_enumerator(interp, o);
+	return (struct SEE_enum *)ae;
+}
+
+/*
+ * Garbage collector trace hook for arrays. Only the first ndense
+ * slots of the dense vector are live; the rest are always written
+ * before ndense grows over them.
+ */
+static void
+array_trace(o)
+	struct SEE_object *o;
+{
+	struct array_object *ao = (struct array_object *)o;
+	SEE_uint32_t i;
+
+	SEE_native_trace(o);
+	_SEE_gc_mark_leaf(ao->dense);
+	for (i = 0; i < ao->ndense; i++)
+		SEE_gc_mark_value(&ao->dense[i]);
+}
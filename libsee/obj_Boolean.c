@@ -83,7 +83,10 @@ static struct SEE_objectclass boolean_const_class = {
 	SEE_native_defaultvalue,	/* DefaultValue */
 	SEE_native_enumerator,		/* DefaultValue */
 	boolean_construct,		/* Construct */
-	boolean_call			/* Call */
+	boolean_call,			/* Call */
+	NULL,				/* HasInstance */
+	NULL,				/* get_sec_domain */
+	SEE_native_trace		/* trace */
 };
 
 /* object class for Boolean.prototype and number instances */
@@ -95,7 +98,12 @@ struct SEE_objectclass _SEE_boolean_inst_class = {
 	SEE_native_hasproperty,		/* HasProperty */
 	SEE_native_delete,		/* Delete */
 	SEE_native_defaultvalue,	/* DefaultValue */
-	SEE_native_enumerator		/* enumerator */
+	SEE_native_enumerator,		/* enumerator */
+	NULL,				/* Construct */
+	NULL,				/* Call */
+	NULL,				/* HasInstance */
+	NULL,				/* get_sec_domain */
+	SEE_native_trace		/* trace */
 };
 
 void
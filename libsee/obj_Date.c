@@ -294,7 +294,10 @@ static struct SEE_objectclass date_const_class = {
 	SEE_native_defaultvalue,	/* DefaultValue */
 	SEE_native_enumerator,		/* DefaultValue */
 	date_construct,			/* Construct */
-	date_call			/* Call */
+	date_call,			/* Call */
+	NULL,				/* HasInstance */
+	NULL,				/* get_sec_domain */
+	SEE_native_trace		/* trace */
 };
 
 /* object class for Date.prototype and date instances */
@@ -306,7 +309,12 @@ static struct SEE_objectclass date_inst_class = {
 	SEE_native_hasproperty,		/* HasProperty */
 	SEE_native_delete,		/* Delete */
 	date_defaultvalue,		/* DefaultValue */
-	SEE_native_enumerator		/* enumerator */
+	SEE_native_enumerator,		/* enumerator */
+	NULL,				/* Construct */
+	NULL,				/* Call */
+	NULL,				/* HasInstance */
+	NULL,				/* get_sec_domain */
+	SEE_native_trace		/* trace */
 };
 
 static SEE_number_t
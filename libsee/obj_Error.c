@@ -91,6 +91,9 @@ static struct SEE_objectclass error_const_class = {
 	SEE_native_enumerator,			/* enumerator */
 	error_construct,			/* Call */
 	error_construct,			/* Construct */
+	NULL,					/* HasInstance */
+	NULL,					/* get_sec_domain */
+	SEE_native_trace			/* trace */
 };
 
 /* object class for Error.prototype */
@@ -103,6 +106,11 @@ static struct SEE_objectclass error_inst_class = {
 	SEE_native_delete,			/* Delete */
 	SEE_native_defaultvalue,		/* DefaultValue */
 	SEE_native_enumerator,			/* enumerator */
+	NULL,					/* Construct */
+	NULL,					/* Call */
+	NULL,					/* HasInstance */
+	NULL,					/* get_sec_domain */
+	SEE_native_trace			/* trace */
 };
 
 /*
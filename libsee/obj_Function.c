@@ -64,6 +64,8 @@
 #include "scope.h"
 #include "init.h"
 #include "nmath.h"
+#include "strcache.h"
+#include "gc.h"
 
 
 /*
@@ -91,17 +93,47 @@ struct activation {
 	struct function   *function;
 	int argc;			/* length of actual parameters */
 	struct SEE_value  *argv;
-	struct SEE_object *arguments;	/* only needed for Netscape compat */
+	struct SEE_object *arguments;	/* the arguments object, once made */
+	struct SEE_object *callee;	/* until 'arguments' is made */
+	int on_frame;			/* on a frame that is reused later */
 };
 
 /* structure of the 'arguments' objects */
 struct arguments {
 	struct SEE_native  native;
 	struct function   *function;
-	struct activation *activation;
+	int argc;			/* the activation's arguments */
+	struct SEE_value  *argv;
 	SEE_boolean_t	  *deleted;
 };
 
+/*
+ * An activation on the frame stack, with its scope record and
+ * (after it, where aligned) its argument values
+ */
+struct frame {
+	struct activation activation;
+	struct SEE_scope  scope;
+};
+
+/* The frame stack is grown in chunks, each starting with this header */
+struct frame_chunk {
+	struct frame_chunk *prev, *next;
+	SEE_size_t	    size, used;	/* in bytes, including the header */
+	int		    pinned;	/* holds a frame that may escape */
+};
+
+/* A saved frame stack top */
+struct frame_mark {
+	struct frame_chunk *chunk;
+	SEE_size_t	    used;
+};
+
+#define FRAME_CHUNK_SIZE	32768
+#define FRAME_ALIGN(n)	\
+	(((n) + sizeof (double) - 1) & ~(SEE_size_t)(sizeof (double) - 1))
+#define FRAME_HEADER	FRAME_ALIGN(sizeof (struct frame_chunk))
+
 /* Prototypes */
 static struct function_inst *tofunction(struct SEE_interpreter *, 
         struct SEE_object *);
@@ -130,13 +162,27 @@ static void function_proto_call(struct SEE_interpreter *,
         struct SEE_object *, struct SEE_object *, int, struct SEE_value **, 
         struct SEE_value *);
 
+static void frame_mark(struct SEE_interpreter *, struct frame_mark *);
+static struct frame *frame_push(struct SEE_interpreter *, SEE_size_t);
+static void frame_pop(struct SEE_interpreter *, struct frame_mark *);
+
+static void activation_init(struct SEE_interpreter *, struct activation *,
+	struct SEE_object *, struct function *, int, struct SEE_value **,
+	struct SEE_value *);
 static struct SEE_object *activation_create(struct SEE_interpreter *,
 	struct SEE_object *, struct function *, int, struct SEE_value **);
+static struct SEE_object *activation_arguments(struct SEE_interpreter *,
+	struct activation *);
+static void activation_detach(struct SEE_interpreter *, struct activation *);
 static int activation_find_index(struct activation *, struct SEE_string *);
 static void activation_get(struct SEE_interpreter *, struct SEE_object *, 
         struct SEE_string *, struct SEE_value *);
 static void activation_put(struct SEE_interpreter *, struct SEE_object *, 
         struct SEE_string *, struct SEE_value *, int);
+static int activation_hasproperty(struct SEE_interpreter *, 
+        struct SEE_object *, struct SEE_string *);
+static int activation_delete(struct SEE_interpreter *, 
+        struct SEE_object *, struct SEE_string *);
 
 static int argument_index(struct arguments *, struct SEE_string *);
 static void arguments_get(struct SEE_interpreter *, struct SEE_object *, 
@@ -162,6 +208,11 @@ static int function_inst_delete(struct SEE_interpreter *,
         struct SEE_object *, struct SEE_string *);
 static struct SEE_enum *function_inst_enumerator(struct SEE_interpreter *, 
         struct SEE_object *);
+static struct activation *function_inst_running(struct SEE_interpreter *,
+	struct SEE_object *, struct SEE_string *);
+static void function_inst_trace(struct SEE_object *);
+static void activation_trace(struct SEE_object *);
+static void arguments_trace(struct SEE_object *);
 
 /* object class for Function constructor */
 static struct SEE_objectclass function_const_class = {
@@ -174,7 +225,10 @@ static struct SEE_objectclass function_const_class = {
 	SEE_native_defaultvalue,		/* DefaultValue */
 	SEE_native_enumerator,			/* Enumerator */
 	function_construct,			/* Construct */
-	function_construct			/* Call */
+	function_construct,			/* Call */
+	NULL,					/* HasInstance */
+	NULL,					/* get_sec_domain */
+	SEE_native_trace			/* trace */
 };
 
 /* object class for function delegate instances */
@@ -190,7 +244,8 @@ static struct SEE_objectclass function_inst_class = {
 	function_inst_construct,		/* Construct */
 	function_inst_call,			/* Call */
 	function_inst_hasinstance,		/* HasInstance */
-	function_inst_get_sec_domain		/* get_sec_domain */
+	function_inst_get_sec_domain,		/* get_sec_domain */
+	function_inst_trace			/* trace */
 };
 
 /* object class for 'arguments' instances */
@@ -202,7 +257,12 @@ static struct SEE_objectclass arguments_class = {
 	SEE_native_hasproperty,			/* HasProperty */
 	arguments_delete,			/* Delete */
 	arguments_defaultvalue,			/* DefaultValue */
-	SEE_native_enumerator			/* enumerator */
+	SEE_native_enumerator,			/* enumerator */
+	NULL,					/* Construct */
+	NULL,					/* Call */
+	NULL,					/* HasInstance */
+	NULL,					/* get_sec_domain */
+	arguments_trace				/* trace */
 };
 
 /* object class for objects created by instance constructs (13.2.2) */
@@ -214,7 +274,12 @@ static struct SEE_objectclass inst_inst_class = {
 	SEE_native_hasproperty,			/* HasProperty */
 	SEE_native_delete,			/* Delete */
 	SEE_native_defaultvalue,		/* DefaultValue */
-	SEE_native_enumerator			/* Enumerator */
+	SEE_native_enumerator,			/* Enumerator */
+	NULL,					/* Construct */
+	NULL,					/* Call */
+	NULL,					/* HasInstance */
+	NULL,					/* get_sec_domain */
+	SEE_native_trace			/* trace */
 };
 
 /* object class for activation objects (10.2.3) */
@@ -223,10 +288,15 @@ struct SEE_objectclass SEE_activation_class = {
 	activation_get,				/* Get */
 	activation_put,				/* Put */
 	SEE_native_canput,			/* CanPut */
-	SEE_native_hasproperty,			/* HasProperty */
-	SEE_native_delete,			/* Delete */
+	activation_hasproperty,			/* HasProperty */
+	activation_delete,			/* Delete */
 	SEE_no_defaultvalue,			/* DefaultValue */
 	SEE_native_enumerator,			/* Enumerator */
+	NULL,					/* Construct */
+	NULL,					/* Call */
+	NULL,					/* HasInstance */
+	NULL,					/* get_sec_domain */
+	activation_trace			/* trace */
 };
 
 void
@@ -329,6 +399,20 @@ function_inst_init(fi, interp, f, scope)
 	fi->object.host_data = NULL;
 	fi->function = f;
 	fi->scope = scope;				/* 13.2(7|19) */
+	_SEE_gc_object(&fi->object);
+}
+
+/* Garbage collector trace hook for function instances */
+static void
+function_inst_trace(o)
+	struct SEE_object *o;
+{
+	struct function_inst *fi = (struct function_inst *)o;
+
+	SEE_gc_mark(o->Prototype);
+	SEE_gc_mark(o->host_data);
+	SEE_gc_mark(fi->function);
+	SEE_gc_mark(fi->scope);
 }
 
 /* 13.2 create (or pull from cache) a function instance with given scope */
@@ -487,13 +571,11 @@ function_inst_call(interp, self, thisobj, argc, argv, res)
 {
 	struct SEE_context context;
 	struct function_inst *fi;
-	struct SEE_object *activation;
-	struct SEE_value v;
+	struct SEE_object *activation, *old_activation;
 	struct SEE_scope *innerscope;
 	SEE_try_context_t ctxt;
-	struct SEE_value old_arguments;
-	int old_arguments_saved = 0;
-	int old_arguments_attr = 0;
+	struct frame * volatile frame = NULL;
+	struct frame_mark mark;
 
 	fi = tofunction(interp, self);
 
@@ -504,59 +586,65 @@ function_inst_call(interp, self, thisobj, argc, argv, res)
 		return;
 	}
 
-	/* 10.1.6 Create an activation object */
-	activation = activation_create(interp, self, fi->function, argc, argv);
-
-	/* 10.2.3 build the right scope chain now */
-	innerscope = SEE_NEW(interp, struct SEE_scope);
-	innerscope->obj = activation;
-	innerscope->next = fi->scope;
-
-	/* 10.2 enter a new execution context */
-	context.interpreter = interp;
-	context.activation = activation;
-	context.variable = activation;	/* see 10.2.3 */
-	context.varattr = SEE_ATTR_DONTDELETE;
-	context.thisobj = thisobj ? thisobj : interp->Global;
-	context.scope = innerscope;
+	/* Activations that cannot escape the call go on the frame stack */
+	if (fi->function->noescape) {
+	    frame_mark(interp, &mark);
+	    frame = frame_push(interp, FRAME_ALIGN(sizeof (struct frame)) +
+		MAX(fi->function->nparams, argc) * sizeof (struct SEE_value));
+	}
 
-	/* 
-	 * Compatibility: set f.arguments to the arguments object too,
-	 * saving the old value (It gets restored later)
+	/*
+	 * Compatibility: f.arguments shows the arguments object of the
+	 * innermost running call, so note the old one (restored later)
 	 */
-	if (SEE_COMPAT_JS(interp, >=, JS11)) { /* EXT:11 */
-	    struct SEE_object *common = 
-	    	(struct SEE_object *)fi->function->common;
-	    if (SEE_OBJECT_HASPROPERTY(interp, common, STR(arguments))) {
-		SEE_OBJECT_GET(interp, common, STR(arguments), &old_arguments);
-		old_arguments_attr = SEE_native_getownattr(interp, common,
-			STR(arguments));
-		old_arguments_saved = 1;
-	    }
-	    SEE_SET_OBJECT(&v, ((struct activation *)activation)->arguments);
-	    SEE_OBJECT_PUT(interp, common, STR(arguments), &v, 
-		SEE_ATTR_DONTDELETE | SEE_ATTR_READONLY | SEE_ATTR_DONTENUM);
-	}
+	old_activation = fi->function->activation;
 
-	/* Run it (adds vars and func decls to context.variable) */
 	SEE_TRY(interp, ctxt) {
-		SEE_eval_functionbody(fi->function, &context, res);
+	    /* 10.1.6 Create an activation object */
+	    if (frame) {
+		activation_init(interp, &frame->activation, self,
+		    fi->function, argc, argv, (struct SEE_value *)
+		    ((char *)frame + FRAME_ALIGN(sizeof (struct frame))));
+		frame->activation.on_frame = 1;
+		activation = (struct SEE_object *)&frame->activation;
+		innerscope = &frame->scope;
+	    } else {
+		activation = activation_create(interp, self, fi->function,
+		    argc, argv);
+		innerscope = _SEE_scope_new(interp);
+	    }
+
+	    /* 10.2.3 build the right scope chain now */
+	    innerscope->obj = activation;
+	    innerscope->next = fi->scope;
+
+	    /* 10.2 enter a new execution context */
+	    context.interpreter = interp;
+	    context.activation = activation;
+	    context.variable = activation;	/* see 10.2.3 */
+	    context.varattr = SEE_ATTR_DONTDELETE;
+	    context.thisobj = thisobj ? thisobj : interp->Global;
+	    context.scope = innerscope;
+
+	    fi->function->activation = activation;	/* EXT:11 */
+
+	    /* Run it (adds vars and func decls to context.variable) */
+	    SEE_eval_functionbody(fi->function, &context, res);
 	}
 
-	/* Restore f.arguments */
-	if (SEE_COMPAT_JS(interp, >=, JS11)) { /* EXT:12 */
-	    struct SEE_object *common = 
-	    	(struct SEE_object *)fi->function->common;
-	    if (old_arguments_saved)
-		SEE_OBJECT_PUT(interp, common, STR(arguments),
-		    &old_arguments, old_arguments_attr);
-	    else {
-		/* XXX kludge to allow us to delete old arguments */
-		SEE_SET_UNDEFINED(&v);
-		SEE_OBJECT_PUT(interp, common, STR(arguments), &v, 
-		    SEE_ATTR_READONLY);
-		SEE_OBJECT_DELETE(interp, common, STR(arguments));
-	    }
+	fi->function->activation = old_activation;	/* EXT:12 */
+
+	if (frame) {
+	    /* An arguments object that was made may outlive the frame */
+	    if (frame->activation.arguments) {
+		SEE_try_context_t ctxt2;
+		SEE_TRY(interp, ctxt2) {
+		    activation_detach(interp, &frame->activation);
+		}
+		frame_pop(interp, &mark);
+		SEE_DEFAULT_CATCH(interp, ctxt2);
+	    } else
+		frame_pop(interp, &mark);
 	}
 
 	SEE_DEFAULT_CATCH(interp, ctxt);
@@ -581,6 +669,7 @@ function_inst_construct(interp, self, thisobj, argc, argv, res)
 	    r1->Prototype = r3.u.object;
 	else
 	    r1->Prototype = interp->Object_prototype;
+	_SEE_gc_store(r1, r1->Prototype);
 	SEE_OBJECT_CALL(interp, self, r1, argc, argv, res);
 	if (SEE_VALUE_GET_TYPE(res) != SEE_OBJECT)
 		SEE_SET_OBJECT(res, r1);
@@ -675,7 +764,7 @@ function_proto_toString(interp, self, thisobj, argc, argv, res)
 
 /*
  * Returns an interned string for integer i. 
- * When i reaches 10, string storage in *sp is re-used.
+ * When i reaches STRCACHE_INTS, string storage in *sp is re-used.
  * Assumes that the caller starts at 0 or 1 and increases i by one each time
  * with the same sp.
  */
@@ -685,20 +774,10 @@ intstr(interp, i, sp)
 	int i;
 	struct SEE_string **sp;
 {
-	switch (i) {
-	case 0: return STR(zero_digit);
-	case 1: return STR(1);
-	case 2: return STR(2);
-	case 3: return STR(3);
-	case 4: return STR(4);
-	case 5: return STR(5);
-	case 6: return STR(6);
-	case 7: return STR(7);
-	case 8: return STR(8);
-	case 9: return STR(9);
-	case 10: 
-	    *sp = SEE_string_new(interp, 5);
-	}
+	if (i < STRCACHE_INTS)
+	    return _SEE_string_uint(interp, i);
+	if (i == STRCACHE_INTS)
+	    *sp = SEE_string_new(interp, 10);
 	(*sp)->length = 0;
 	SEE_string_append_int(*sp, i);
 	return SEE_intern(interp, *sp);
@@ -788,6 +867,101 @@ function_proto_call(interp, self, thisobj, argc, argv, res)
 		argc == 0 ? 0 : argc - 1, argc == 0 ? NULL : argv + 1, res);
 }
 
+/*------------------------------------------------------------
+ * The frame stack
+ *
+ * Calls to functions whose activation the parser found cannot
+ * outlive the call (see struct function's noescape) keep their
+ * activation object and scope record in a per-interpreter stack of
+ * frames, rather than in new storage that would become garbage as
+ * soon as they return. The stack grows in chunks of ordinary,
+ * conservatively scanned storage, which are kept for reuse. Popped
+ * frames are cleared so that they do not keep garbage alive, and
+ * pushed frames are always clear.
+ *
+ * A direct eval can let such an activation escape after all, by
+ * making closures over its scope. The chunk holding the frame is then
+ * pinned (see _SEE_activation_pin()): no more frames are pushed onto
+ * it or cleared from it, and once the stack unwinds past it, it leaves
+ * the stack and is left to the collector.
+ */
+
+/* Saves the top of the frame stack */
+static void
+frame_mark(interp, mark)
+	struct SEE_interpreter *interp;
+	struct frame_mark *mark;
+{
+	struct frame_chunk *chunk = (struct frame_chunk *)interp->frame_stack;
+
+	mark->chunk = chunk;
+	mark->used = chunk ? chunk->used : FRAME_HEADER;
+}
+
+/* Pushes a cleared frame of the given size */
+static struct frame *
+frame_push(interp, size)
+	struct SEE_interpreter *interp;
+	SEE_size_t size;
+{
+	struct frame_chunk *chunk = (struct frame_chunk *)interp->frame_stack;
+	struct frame_chunk *next;
+	struct frame *frame;
+	SEE_size_t chunksize;
+
+	size = FRAME_ALIGN(size);
+	if (!chunk || chunk->pinned || chunk->used + size > chunk->size) {
+	    next = chunk ? chunk->next : NULL;
+	    if (!next || FRAME_HEADER + size > next->size) {
+		chunksize = MAX(FRAME_CHUNK_SIZE, FRAME_HEADER + size);
+		next = (struct frame_chunk *)SEE_malloc(interp, chunksize);
+		memset(next, 0, chunksize);
+		next->size = chunksize;
+		next->prev = chunk;
+		next->next = NULL;
+		if (chunk)
+		    chunk->next = next;
+	    }
+	    next->used = FRAME_HEADER;
+	    chunk = next;
+	    interp->frame_stack = chunk;
+	}
+	frame = (struct frame *)((char *)chunk + chunk->used);
+	chunk->used += size;
+	return frame;
+}
+
+/* Pops frames off the stack, back to the top saved in mark */
+static void
+frame_pop(interp, mark)
+	struct SEE_interpreter *interp;
+	struct frame_mark *mark;
+{
+	struct frame_chunk *chunk = (struct frame_chunk *)interp->frame_stack;
+	struct frame_chunk *prev;
+	SEE_size_t used;
+
+	for (;;) {
+	    used = chunk == mark->chunk || !chunk->prev 
+		? mark->used : FRAME_HEADER;
+	    if (!chunk->pinned)
+		memset((char *)chunk + used, 0, chunk->used - used);
+	    chunk->used = used;
+	    if (chunk == mark->chunk || !chunk->prev)
+		break;
+	    prev = chunk->prev;
+	    if (chunk->pinned) {
+		/* Unlink it; only its escaped frames refer to it now */
+		prev->next = chunk->next;
+		if (chunk->next)
+		    chunk->next->prev = prev;
+		chunk->prev = chunk->next = NULL;
+	    }
+	    chunk = prev;
+	}
+	interp->frame_stack = chunk;
+}
+
 /*------------------------------------------------------------
  * The activation object
  *
@@ -811,35 +985,146 @@ activation_create(interp, callee, function, argc, argv)
 	struct SEE_value **argv;
 {
 	struct activation *activation;
-	int i;
-	struct SEE_value v, undef;
 
 	activation = SEE_NEW(interp, struct activation);
+	activation_init(interp, activation, callee, function, argc, argv,
+		NULL);
+	return (struct SEE_object *)activation;
+}
+
+/*
+ * Initialises an activation. The argument values are kept in vals,
+ * or in new storage if vals is NULL.
+ */
+static void
+activation_init(interp, activation, callee, function, argc, argv, vals)
+	struct SEE_interpreter *interp;
+	struct activation *activation;
+	struct SEE_object *callee;
+	struct function *function;
+	int argc;
+	struct SEE_value **argv;
+	struct SEE_value *vals;
+{
+	int i;
+	struct SEE_value undef;
+
 	SEE_native_init(&activation->native, interp, &SEE_activation_class,
 		NULL);
 	activation->function = function;
 	activation->argc = argc;
-	activation->argv = SEE_NEW_ARRAY(interp, struct SEE_value, 
-		MAX(function->nparams, argc));
+	activation->argv = vals ? vals : SEE_NEW_ARRAY(interp, 
+		struct SEE_value, MAX(function->nparams, argc));
+	activation->arguments = NULL;
+	activation->callee = callee;
+	activation->on_frame = 0;
 
 	for (i = 0; i < argc; i++)
 		SEE_VALUE_COPY(&activation->argv[i], argv[i]);
 	for (; i < function->nparams; i++)
 		SEE_SET_UNDEFINED(&activation->argv[i]);
 
-	/* 10.1.6 Initialize with an 'arguments' property */
-	activation->arguments = arguments_create(interp, activation, callee);
-	SEE_SET_OBJECT(&v, activation->arguments);
-	SEE_native_put(interp, (struct SEE_object *)&activation->native, 
-		STR(arguments), &v, SEE_ATTR_DONTDELETE);
+	/*
+	 * 10.1.6 The 'arguments' property is made when it is first
+	 * looked up (see activation_arguments())
+	 */
 
 	/* Initialise all the formal parameters to undef */
 	SEE_SET_UNDEFINED(&undef);
 	for (i = 0; i < function->nparams; i++)
 	    SEE_native_put(interp, (struct SEE_object *)&activation->native, 
 		    function->params[i], &undef, SEE_ATTR_DONTDELETE);
+}
 
-	return (struct SEE_object *)activation;
+/*
+ * Lets an activation outlive its call. This is needed before a direct
+ * eval runs code in an activation on the frame stack, as that code may
+ * make closures over it. The frame is the top one, since its function
+ * body is running, so the top chunk is pinned.
+ */
+void
+_SEE_activation_pin(interp, o)
+	struct SEE_interpreter *interp;
+	struct SEE_object *o;
+{
+	struct frame_chunk *chunk = (struct frame_chunk *)interp->frame_stack;
+
+	if (!IS_ACTIVATION_OBJECT(o) || !((struct activation *)o)->on_frame)
+	    return;
+	SEE_ASSERT(interp, chunk != NULL &&
+	    (char *)o > (char *)chunk && 
+	    (char *)o < (char *)chunk + chunk->used);
+	chunk->pinned = 1;
+	((struct activation *)o)->on_frame = 0;
+}
+
+/*
+ * Returns the activation's arguments object, first making it and the
+ * 'arguments' property (10.1.6) if that has not been done. Most
+ * function bodies never refer to arguments, and so never pay for it.
+ */
+static struct SEE_object *
+activation_arguments(interp, activation)
+	struct SEE_interpreter *interp;
+	struct activation *activation;
+{
+	struct SEE_value v;
+
+	if (activation->callee) {
+	    activation->arguments = arguments_create(interp, activation, 
+		activation->callee);
+	    activation->callee = NULL;
+	    SEE_SET_OBJECT(&v, activation->arguments);
+	    SEE_native_put(interp, (struct SEE_object *)&activation->native, 
+		    STR(arguments), &v, SEE_ATTR_DONTDELETE);
+	}
+	return activation->arguments;
+}
+
+/*
+ * Moves the argument values of an activation that is leaving the
+ * frame stack to new storage, so that its arguments object may
+ * outlive it.
+ */
+static void
+activation_detach(interp, activation)
+	struct SEE_interpreter *interp;
+	struct activation *activation;
+{
+	struct arguments *a = (struct arguments *)activation->arguments;
+	struct SEE_value *argv;
+	int i;
+
+	if (!a->argc)
+	    return;
+	argv = SEE_NEW_ARRAY(interp, struct SEE_value, a->argc);
+	for (i = 0; i < a->argc; i++)
+	    SEE_VALUE_COPY(&argv[i], &a->argv[i]);
+	a->argv = argv;
+}
+
+/*
+ * Garbage collector trace hook for activations. Only activations that
+ * are not on the frame stack are traced, so the argument values are in
+ * storage of their own, which holds nothing else.
+ */
+static void
+activation_trace(o)
+	struct SEE_object *o;
+{
+	struct activation *activation = (struct activation *)o;
+	int i, n;
+
+	SEE_native_trace(o);
+	SEE_gc_mark(activation->function);
+	SEE_gc_mark(activation->arguments);
+	SEE_gc_mark(activation->callee);
+	if (activation->function && activation->argv) {
+	    _SEE_gc_mark_leaf(activation->argv);
+	    n = MAX(activation->function->nparams, activation->argc);
+	    for (i = 0; i < n; i++)
+		SEE_gc_mark_value(&activation->argv[i]);
+	}
 }
 
 static int
@@ -868,9 +1153,12 @@ activation_get(interp, o, p, res)
 
 	if (i >= 0)
 		SEE_VALUE_COPY(res, &activation->argv[i]);
-	else
+	else {
+		if (ip == STR(arguments) && activation->callee)
+		    activation_arguments(interp, activation);
 		SEE_native_get(interp, 
 		    (struct SEE_object *)&activation->native, ip, res);
+	}
 }
 
 static void
@@ -887,9 +1175,40 @@ activation_put(interp, o, p, val, attr)
 
 	if (i >= 0)
 		SEE_VALUE_COPY(&activation->argv[i], val);
-	else
+	else {
+		if (ip == STR(arguments) && activation->callee)
+		    activation_arguments(interp, activation);
 		SEE_native_put(interp, 
 		    (struct SEE_object *)&activation->native, ip, val, attr);
+	}
+}
+
+static int
+activation_hasproperty(interp, o, p)
+	struct SEE_interpreter *interp;
+	struct SEE_object *o;
+	struct SEE_string *p;
+{
+	struct SEE_string *ip = SEE_intern(interp, p);
+	struct activation *activation = (struct activation *)o;
+
+	if (ip == STR(arguments) && activation->callee)
+		return 1;
+	return SEE_native_hasproperty(interp, o, ip);
+}
+
+static int
+activation_delete(interp, o, p)
+	struct SEE_interpreter *interp;
+	struct SEE_object *o;
+	struct SEE_string *p;
+{
+	struct SEE_string *ip = SEE_intern(interp, p);
+	struct activation *activation = (struct activation *)o;
+
+	if (ip == STR(arguments) && activation->callee)
+		return 0;			/* DontDelete */
+	return SEE_native_delete(interp, o, ip);
 }
 
 
@@ -920,7 +1239,7 @@ argument_index(a, s)
 			return -1;
 	}
 	
-	if (value >= a->activation->argc)
+	if (value >= a->argc)
 		return -1;
 	if (a->deleted[value])
 		return -1;
@@ -952,7 +1271,7 @@ arguments_get(interp, o, p, res)
 	int i = argument_index(a, p);
 
 	if (i != -1)
-		SEE_VALUE_COPY(res, &a->activation->argv[i]);
+		SEE_VALUE_COPY(res, &a->argv[i]);
 	else
 		SEE_native_get(interp, o, p, res);
 }
@@ -969,7 +1288,7 @@ arguments_put(interp, o, p, val, attr)
 	int i = argument_index(a, p);
 
 	if (i != -1)
-		SEE_VALUE_COPY(&a->activation->argv[i], val);
+		SEE_VALUE_COPY(&a->argv[i], val);
 	else
 		SEE_native_put(interp, o, p, val, attr);
 }
@@ -983,24 +1302,20 @@ arguments_defaultvalue(interp, o, hint, res)
 {
 	struct arguments *a = (struct arguments *)o;
 	struct SEE_string *s = SEE_string_new(interp, 0);
-	struct SEE_string *snum = NULL;
 	struct SEE_value vs;
 	int i;
 
 
 	if (SEE_COMPAT_JS(interp, >=, JS11)) { /* EXT:14 */
 	    SEE_string_addch(s, '[');
-	    for (i = 0; i < a->activation->argc; i++) {
+	    for (i = 0; i < a->argc; i++) {
 		if (i) {
 		    SEE_string_addch(s, ',');
 		    SEE_string_addch(s, ' ');
 		}
-	        if (!snum) snum = SEE_string_new(interp, 0);
-	        snum->length = 0;
-	        SEE_string_append_int(snum, i);
-	        SEE_string_append(s, snum);
+	        SEE_string_append(s, _SEE_string_uint(interp, i));
 		SEE_string_addch(s, '=');
-		SEE_ToString(interp, &a->activation->argv[i], &vs);
+		SEE_ToString(interp, &a->argv[i], &vs);
 		SEE_string_append(s, vs.u.string);
 	    }
 	    SEE_string_addch(s, ']');
@@ -1025,7 +1340,8 @@ arguments_create(interp, activation, callee)
 	SEE_native_init(&arguments->native, interp, &arguments_class,
 		interp->Object_prototype);
 
-	arguments->activation = activation;
+	arguments->argc = activation->argc;
+	arguments->argv = activation->argv;
 
 	SEE_SET_OBJECT(&v, callee);
 	SEE_OBJECT_PUT(interp, (struct SEE_object *)arguments, STR(callee), &v,
@@ -1036,11 +1352,11 @@ arguments_create(interp, activation, callee)
 		SEE_ATTR_DONTENUM);
 
 	arguments->deleted = SEE_NEW_ARRAY(interp, SEE_boolean_t, 
-		activation->argc);
+		arguments->argc);
 
-	if (activation->argc) {
+	if (arguments->argc) {
 	    SEE_SET_UNDEFINED(&undef);
-	    for (i = 0; i < activation->argc; i++) {
+	    for (i = 0; i < arguments->argc; i++) {
 		arguments->deleted[i] = 0;
 		SEE_native_put(interp, (struct SEE_object *)&arguments->native,
 			intstr(interp, i, &s), &v, SEE_ATTR_DONTENUM);
@@ -1060,6 +1376,28 @@ arguments_create(interp, activation, callee)
 	return (struct SEE_object *)arguments;
 }
 
+/*
+ * Garbage collector trace hook for arguments objects. The argument
+ * values may still be on the frame stack, whose chunk is then marked
+ * and scanned as a whole.
+ */
+static void
+arguments_trace(o)
+	struct SEE_object *o;
+{
+	struct arguments *arguments = (struct arguments *)o;
+	int i;
+
+	SEE_native_trace(o);
+	SEE_gc_mark(arguments->function);
+	_SEE_gc_mark_leaf(arguments->deleted);
+	if (arguments->argv) {
+	    SEE_gc_mark(arguments->argv);
+	    for (i = 0; i < arguments->argc; i++)
+		SEE_gc_mark_value(&arguments->argv[i]);
+	}
+}
+
 /*------------------------------------------------------------
  * function instance methods
  *  - these simply pass the operations down to the 'common' object
@@ -1072,6 +1410,27 @@ arguments_create(interp, activation, callee)
  *       and this interface separation improves modularity.
  */
 
+/*
+ * Compatibility: while a function runs, f.arguments is a read-only,
+ * undeletable property holding the arguments object of its innermost
+ * call (EXT:11). Rather than store it into the common object on every
+ * call, the hooks below check for it. Returns the activation of that
+ * call if p is "arguments" and the function is running, or NULL.
+ */
+static struct activation *
+function_inst_running(interp, o, p)
+	struct SEE_interpreter *interp;
+	struct SEE_object *o;
+	struct SEE_string *p;
+{
+	struct function *f = tofunction(interp, o)->function;
+
+	if (f->activation && SEE_COMPAT_JS(interp, >=, JS11) &&
+	    SEE_intern(interp, p) == STR(arguments))
+		return (struct activation *)f->activation;
+	return NULL;
+}
+
 static void
 function_inst_get(interp, o, p, res)
 	struct SEE_interpreter *interp;
@@ -1080,7 +1439,13 @@ function_inst_get(interp, o, p, res)
 	struct SEE_value *res;
 {
 	struct SEE_object *common;
+	struct activation *activation;
 
+	activation = function_inst_running(interp, o, p);
+	if (activation) {		/* EXT:11 */
+		SEE_SET_OBJECT(res, activation_arguments(interp, activation));
+		return;
+	}
 	common = (struct SEE_object *)tofunction(interp, o)->function->common;
 	SEE_OBJECT_GET(interp, common, p, res);
 }
@@ -1095,6 +1460,8 @@ function_inst_put(interp, o, p, val, attr)
 {
 	struct SEE_object *common;
 
+	if (function_inst_running(interp, o, p))
+		return;			/* ReadOnly */
 	/* XXX setting __proto__ will ruin things */
 	common = (struct SEE_object *)tofunction(interp, o)->function->common;
 	SEE_OBJECT_PUT(interp, common, p, val, attr);
@@ -1108,6 +1475,8 @@ function_inst_canput(interp, o, p)
 {
 	struct SEE_object *common;
 
+	if (function_inst_running(interp, o, p))
+		return 0;
 	common = (struct SEE_object *)tofunction(interp, o)->function->common;
 	return SEE_OBJECT_CANPUT(interp, common, p);
 }
@@ -1120,6 +1489,8 @@ function_inst_hasproperty(interp, o, p)
 {
 	struct SEE_object *common;
 
+	if (function_inst_running(interp, o, p))
+		return 1;
 	common = (struct SEE_object *)tofunction(interp, o)->function->common;
 	return SEE_OBJECT_HASPROPERTY(interp, common, p);
 }
@@ -1132,6 +1503,8 @@ function_inst_delete(interp, o, p)
 {
 	struct SEE_object *common;
 
+	if (function_inst_running(interp, o, p))
+		return 0;		/* DontDelete */
 	common = (struct SEE_object *)tofunction(interp, o)->function->common;
 	return SEE_OBJECT_DELETE(interp, common, p);
 }
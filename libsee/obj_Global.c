@@ -51,6 +51,7 @@
 #include <see/native.h>
 #include <see/cfunction.h>
 #include <see/error.h>
+#include <see/intern.h>
 #include <see/interpreter.h>
 #include <see/debug.h>
 #include <see/eval.h>
@@ -78,6 +79,8 @@
  * to be reachable.)
  */
 
+static void global_get(struct SEE_interpreter *, struct SEE_object *, 
+        struct SEE_string *, struct SEE_value *);
 static void global_eval(struct SEE_interpreter *, struct SEE_object *, 
         struct SEE_object *, int, struct SEE_value **, struct SEE_value *);
 static void global_parseInt(struct SEE_interpreter *, struct SEE_object *, 
@@ -110,7 +113,7 @@ static void global_writeval(struct SEE_interpreter *, struct SEE_object *,
 #endif
 
 static int is_StrWhiteSpace(int);
-static void AddEscape(struct SEE_interpreter *, struct SEE_string *, 
+static void AddEscape(struct SEE_interpreter *, struct SEE_strbuf *, 
         unsigned int);
 static struct SEE_string *Encode(struct SEE_interpreter *, 
         struct SEE_string *, const unsigned char *);
@@ -122,7 +125,7 @@ static struct SEE_string *Decode(struct SEE_interpreter *,
 /* Note: [[Class]] is not "Global" but "global" for mozilla compatibility */
 static struct SEE_objectclass global_class = {
 	"global",			/* Class */
-	SEE_native_get,			/* Get */
+	global_get,			/* Get */
 	SEE_native_put,			/* Put */
 	SEE_native_canput,		/* CanPut */
 	SEE_native_hasproperty,		/* HasProperty */
@@ -130,9 +133,39 @@ static struct SEE_objectclass global_class = {
 	SEE_native_defaultvalue,	/* DefaultValue */
 	SEE_native_enumerator,		/* DefaultValue */
 	NULL,				/* Construct */
-	NULL				/* Call */
+	NULL,				/* Call */
+	NULL,				/* HasInstance */
+	NULL,				/* get_sec_domain */
+	SEE_native_trace		/* trace */
 };
 
+/*
+ * The global object's properties for the built-in objects that are
+ * initialised on first use (see SEE_interpreter_init_builtins())
+ * refer to their storage from the start. They are initialised here,
+ * when those properties are first read.
+ */
+static void
+global_get(interp, o, p, res)
+	struct SEE_interpreter *interp;
+	struct SEE_object *o;
+	struct SEE_string *p;
+	struct SEE_value *res;
+{
+	struct SEE_string *ip;
+
+	if (interp->builtins_pending) {
+	    ip = SEE_intern(interp, p);
+	    if (ip == STR(Date))
+		SEE_interpreter_init_builtins(interp, SEE_BUILTIN_DATE);
+	    else if (ip == STR(RegExp))
+		SEE_interpreter_init_builtins(interp, SEE_BUILTIN_REGEXP);
+	    else if (ip == STR(Math))
+		SEE_interpreter_init_builtins(interp, SEE_BUILTIN_MATH);
+	}
+	SEE_native_get(interp, o, p, res);
+}
+
 void
 SEE_Global_alloc(interp)
 	struct SEE_interpreter *interp;
@@ -140,7 +173,7 @@ SEE_Global_alloc(interp)
 	interp->Global = 
 		(struct SEE_object *)SEE_NEW(interp, struct SEE_native);
 	interp->Global_scope = 
-		SEE_NEW(interp, struct SEE_scope);
+		_SEE_scope_new(interp);
 
 	/* XXX should properly check that this is never referenced */
 	interp->Global_eval = (struct SEE_object *)1;	
@@ -516,14 +549,15 @@ global_isFinite(interp, self, thisobj, argc, argv, res)
 static void
 AddEscape(interp, R, i)
 	struct SEE_interpreter *interp;
-	struct SEE_string *R;
+	struct SEE_strbuf *R;
 	unsigned int i;		/* promoted unsigned char */
 {
 	char *hexstr = SEE_hexstr_uppercase;
 
-	SEE_string_addch(R, '%');
-	SEE_string_addch(R, hexstr[(i >> 4) & 0xf]);
-	SEE_string_addch(R, hexstr[i & 0xf]);
+	SEE_strbuf_reserve(R, 3);
+	SEE_STRBUF_PUTCH(R, '%');
+	SEE_STRBUF_PUTCH(R, hexstr[(i >> 4) & 0xf]);
+	SEE_STRBUF_PUTCH(R, hexstr[i & 0xf]);
 }
 
 /* 15.1.3 */
@@ -533,11 +567,11 @@ Encode(interp, s, unesc)
 	struct SEE_string *s;
 	const unsigned char *unesc;
 {
-	struct SEE_string *R;
+	struct SEE_strbuf R;
 	int k;
 	SEE_unicode_t C;
 
-	R = SEE_string_new(interp, 0);
+	SEE_strbuf_init(interp, &R, s->length);
 	k = 0;
 	while (k < s->length) {
 	    /*
@@ -559,24 +593,24 @@ Encode(interp, s, unesc)
 
 	    if (C < 0x80) {
 		    if (unesc[(C & 0x7f) >> 3] & (1 << (C & 0x7)))
-			SEE_string_addch(R, C);
+			SEE_strbuf_addch(&R, C);
 		    else
-			AddEscape(interp, R, (unsigned char)(C & 0x7f));
+			AddEscape(interp, &R, (unsigned char)(C & 0x7f));
 	    } else if (C < 0x800) {
-		AddEscape(interp, R, (unsigned char)(0xc0 | (C >>  6 & 0x1f)));
-		AddEscape(interp, R, (unsigned char)(0x80 | (C >>  0 & 0x2f)));
+		AddEscape(interp, &R, (unsigned char)(0xc0 | (C >>  6 & 0x1f)));
+		AddEscape(interp, &R, (unsigned char)(0x80 | (C >>  0 & 0x3f)));
 	    } else if (C < 0x10000) {
-		AddEscape(interp, R, (unsigned char)(0xe0 | (C >> 12 & 0x0f)));
-		AddEscape(interp, R, (unsigned char)(0x80 | (C >>  6 & 0x2f)));
-		AddEscape(interp, R, (unsigned char)(0x80 | (C >>  0 & 0x2f)));
+		AddEscape(interp, &R, (unsigned char)(0xe0 | (C >> 12 & 0x0f)));
+		AddEscape(interp, &R, (unsigned char)(0x80 | (C >>  6 & 0x3f)));
+		AddEscape(interp, &R, (unsigned char)(0x80 | (C >>  0 & 0x3f)));
 	    } else /* if (C < 0x200000) */ {
-		AddEscape(interp, R, (unsigned char)(0xf0 | (C >> 18 & 0x07)));
-		AddEscape(interp, R, (unsigned char)(0x80 | (C >> 12 & 0x2f)));
-		AddEscape(interp, R, (unsigned char)(0x80 | (C >>  6 & 0x2f)));
-		AddEscape(interp, R, (unsigned char)(0x80 | (C >>  0 & 0x2f)));
+		AddEscape(interp, &R, (unsigned char)(0xf0 | (C >> 18 & 0x07)));
+		AddEscape(interp, &R, (unsigned char)(0x80 | (C >> 12 & 0x3f)));
+		AddEscape(interp, &R, (unsigned char)(0x80 | (C >>  6 & 0x3f)));
+		AddEscape(interp, &R, (unsigned char)(0x80 | (C >>  0 & 0x3f)));
 	    }
 	}
-	return R;
+	return SEE_strbuf_string(&R);
 }
 
 static unsigned char hexbitmap[] = 
@@ -790,7 +824,8 @@ global_escape(interp, self, thisobj, argc, argv, res)
 {
 	struct SEE_value v;
 	SEE_char_t c;
-	struct SEE_string *s, *r;
+	struct SEE_string *s;
+	struct SEE_strbuf r;
 	int i;
 	static unsigned char ok[] =
 	{ 0x00,0x00,0x00,0x00,0x00,0xec,0xff,0x03,    /* [A-Za-z0-9@*_+\-./] */
@@ -805,25 +840,26 @@ global_escape(interp, self, thisobj, argc, argv, res)
 	SEE_ToString(interp, argv[0], &v);
 
 	s = v.u.string;
-	r = SEE_string_new(interp, 0);
+	SEE_strbuf_init(interp, &r, s->length);
 	for (i = 0; i < s->length; i++) {
 	    c = s->data[i];
+	    SEE_strbuf_reserve(&r, 6);
 	    if (c < 0x80 && (ok[c >> 3] & (1 << (c & 7))))
-		SEE_string_addch(r, c);
+		SEE_STRBUF_PUTCH(&r, c);
 	    else if (c < 0x100) {
-		SEE_string_addch(r, '%');
-		SEE_string_addch(r, hexstr[(c >> 4) & 0xf]);
-		SEE_string_addch(r, hexstr[c & 0xf]);
+		SEE_STRBUF_PUTCH(&r, '%');
+		SEE_STRBUF_PUTCH(&r, hexstr[(c >> 4) & 0xf]);
+		SEE_STRBUF_PUTCH(&r, hexstr[c & 0xf]);
 	    } else {
-		SEE_string_addch(r, '%');
-		SEE_string_addch(r, 'u');
-		SEE_string_addch(r, hexstr[(c >> 12) & 0xf]);
-		SEE_string_addch(r, hexstr[(c >> 8) & 0xf]);
-		SEE_string_addch(r, hexstr[(c >> 4) & 0xf]);
-		SEE_string_addch(r, hexstr[c & 0xf]);
+		SEE_STRBUF_PUTCH(&r, '%');
+		SEE_STRBUF_PUTCH(&r, 'u');
+		SEE_STRBUF_PUTCH(&r, hexstr[(c >> 12) & 0xf]);
+		SEE_STRBUF_PUTCH(&r, hexstr[(c >> 8) & 0xf]);
+		SEE_STRBUF_PUTCH(&r, hexstr[(c >> 4) & 0xf]);
+		SEE_STRBUF_PUTCH(&r, hexstr[c & 0xf]);
 	    }
 	}
-	SEE_SET_STRING(res, r);
+	SEE_SET_STRING(res, SEE_strbuf_string(&r));
 }
 
 /* Global.unescape - (B.2.2) */
@@ -106,7 +106,10 @@ static struct SEE_objectclass math_class = {
 	SEE_native_defaultvalue,	/* DefaultValue */
 	SEE_native_enumerator,		/* DefaultValue */
 	NULL,				/* Construct */
-	NULL				/* Call */
+	NULL,				/* Call */
+	NULL,				/* HasInstance */
+	NULL,				/* get_sec_domain */
+	SEE_native_trace		/* trace */
 };
 
 void
@@ -98,7 +98,10 @@ static struct SEE_objectclass number_const_class = {
 	SEE_native_defaultvalue,	/* DefaultValue */
 	SEE_native_enumerator,		/* DefaultValue */
 	number_construct,		/* Construct */
-	number_call			/* Call */
+	number_call,			/* Call */
+	NULL,				/* HasInstance */
+	NULL,				/* get_sec_domain */
+	SEE_native_trace		/* trace */
 };
 
 /* object class for Number.prototype and number instances */
@@ -110,7 +113,12 @@ static struct SEE_objectclass number_inst_class = {
 	SEE_native_hasproperty,		/* HasProperty */
 	SEE_native_delete,		/* Delete */
 	SEE_native_defaultvalue,	/* DefaultValue */
-	SEE_native_enumerator		/* enumerator */
+	SEE_native_enumerator,		/* enumerator */
+	NULL,				/* Construct */
+	NULL,				/* Call */
+	NULL,				/* HasInstance */
+	NULL,				/* get_sec_domain */
+	SEE_native_trace		/* trace */
 };
 
 void
@@ -98,6 +98,9 @@ static struct SEE_objectclass object_const_class = {
 	SEE_native_enumerator,			/* enumerator */
 	object_construct,			/* Construct */
 	object_construct,			/* Call */
+	NULL,					/* HasInstance */
+	NULL,					/* get_sec_domain */
+	SEE_native_trace			/* trace */
 };
 
 static struct SEE_objectclass object_inst_class = {
@@ -109,6 +112,11 @@ static struct SEE_objectclass object_inst_class = {
 	SEE_native_delete,			/* Delete */
 	SEE_native_defaultvalue,		/* DefaultValue */
 	SEE_native_enumerator,			/* enumerator */
+	NULL,					/* Construct */
+	NULL,					/* Call */
+	NULL,					/* HasInstance */
+	NULL,					/* get_sec_domain */
+	SEE_native_trace			/* trace */
 };
 
 void
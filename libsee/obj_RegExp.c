@@ -65,6 +65,22 @@ struct regexp_object {
 	struct regex *regex;
 };
 
+/*
+ * Structure of the RegExp constructor. The Netscape "static" properties
+ * ($1, lastMatch, ...) are costly to build after every match, so only
+ * the last match is recorded here, and the properties are set from it
+ * when the constructor is next accessed.
+ */
+struct regexp_ctor {
+	struct SEE_native native;
+	struct SEE_object *exec;	/* original RegExp.prototype.exec */
+	int pending;			/* true if statics need setting */
+	struct SEE_string *input, *source;
+	struct regex *regex;
+	struct capture *captures;
+	unsigned int ncaptures, maxcaptures;
+};
+
 /* Prototypes */
 static struct regexp_object *toregexp(struct SEE_interpreter *, 
         struct SEE_object *);
@@ -86,23 +102,40 @@ static void regexp_proto_toString(struct SEE_interpreter *,
         struct SEE_object *, struct SEE_object *, int, struct SEE_value **, 
         struct SEE_value *);
 
+static void regexp_const_get(struct SEE_interpreter *, struct SEE_object *,
+	struct SEE_string *, struct SEE_value *);
+static void regexp_const_put(struct SEE_interpreter *, struct SEE_object *,
+	struct SEE_string *, struct SEE_value *, int);
+static int regexp_const_hasproperty(struct SEE_interpreter *,
+	struct SEE_object *, struct SEE_string *);
+static int regexp_const_delete(struct SEE_interpreter *,
+	struct SEE_object *, struct SEE_string *);
+static struct SEE_enum *regexp_const_enumerator(struct SEE_interpreter *,
+	struct SEE_object *);
+
 static void regexp_set_static(struct SEE_interpreter *,
 	struct SEE_string *, struct regex *, struct capture *,
 	struct SEE_string *);
+static void regexp_flush_static(struct SEE_interpreter *,
+	struct regexp_ctor *);
+static void regexp_const_trace(struct SEE_object *);
+static void regexp_inst_trace(struct SEE_object *);
 
 /* object class for RegExp constructor */
 static struct SEE_objectclass regexp_const_class = {
 	"RegExpConstructor",		/* Class */
-	SEE_native_get,			/* Get */
-	SEE_native_put,			/* Put */
+	regexp_const_get,		/* Get */
+	regexp_const_put,		/* Put */
 	SEE_native_canput,		/* CanPut */
-	SEE_native_hasproperty,		/* HasProperty */
-	SEE_native_delete,		/* Delete */
+	regexp_const_hasproperty,	/* HasProperty */
+	regexp_const_delete,		/* Delete */
 	SEE_native_defaultvalue,	/* DefaultValue */
-	SEE_native_enumerator,		/* enumerator */
+	regexp_const_enumerator,	/* enumerator */
 	regexp_construct,		/* Construct */
 	regexp_call,			/* Call */
-	regexp_hasinstance		/* HasInstance */
+	regexp_hasinstance,		/* HasInstance */
+	NULL,				/* get_sec_domain */
+	regexp_const_trace		/* trace */
 };
 
 /* object class for RegExp.prototype */
@@ -114,7 +147,12 @@ static struct SEE_objectclass regexp_proto_class = {
 	SEE_native_hasproperty,		/* HasProperty */
 	SEE_native_delete,		/* Delete */
 	SEE_native_defaultvalue,	/* DefaultValue */
-	SEE_native_enumerator		/* enumerator */
+	SEE_native_enumerator,		/* enumerator */
+	NULL,				/* Construct */
+	NULL,				/* Call */
+	NULL,				/* HasInstance */
+	NULL,				/* get_sec_domain */
+	SEE_native_trace		/* trace */
 };
 
 /* object class for regexp instances */
@@ -129,7 +167,9 @@ static struct SEE_objectclass regexp_inst_class = {
 	SEE_native_enumerator,		/* enumerator */
 	NULL,				/* Construct */
 	NULL,				/* Call */
-	NULL				/* HasInstance */
+	NULL,				/* HasInstance */
+	NULL,				/* get_sec_domain */
+	regexp_inst_trace		/* trace */
 };
 
 /* object class for regexp instances */
@@ -144,15 +184,44 @@ static struct SEE_objectclass regexp_JS_inst_class = {
 	SEE_native_enumerator,		/* enumerator */
 	NULL,				/* Construct */
 	regexp_JS_inst_call,		/* Call */
-	NULL				/* HasInstance */
+	NULL,				/* HasInstance */
+	NULL,				/* get_sec_domain */
+	regexp_inst_trace		/* trace */
 };
 
+/* Garbage collector trace hook for the RegExp constructor */
+static void
+regexp_const_trace(o)
+	struct SEE_object *o;
+{
+	struct regexp_ctor *ctor = (struct regexp_ctor *)o;
+
+	SEE_native_trace(o);
+	SEE_gc_mark(ctor->exec);
+	SEE_gc_mark(ctor->input);
+	SEE_gc_mark(ctor->source);
+	SEE_gc_mark(ctor->regex);
+	SEE_gc_mark(ctor->captures);
+}
+
+/* Garbage collector trace hook for regexp instances */
+static void
+regexp_inst_trace(o)
+	struct SEE_object *o;
+{
+	struct regexp_object *ro = (struct regexp_object *)o;
+
+	SEE_native_trace(o);
+	SEE_gc_mark(ro->source);
+	SEE_gc_mark(ro->regex);
+}
+
 void
 SEE_RegExp_alloc(interp)
 	struct SEE_interpreter *interp;
 {
 	interp->RegExp = 
-	    (struct SEE_object *)SEE_NEW(interp, struct SEE_native);
+	    (struct SEE_object *)SEE_NEW(interp, struct regexp_ctor);
 	interp->RegExp_prototype = 
 	    (struct SEE_object *)SEE_NEW(interp, struct SEE_native);
 }
@@ -170,6 +239,9 @@ SEE_RegExp_init(interp)
 
 	SEE_native_init((struct SEE_native *)RegExp, interp,
 		&regexp_const_class, interp->Function_prototype);
+	((struct regexp_ctor *)RegExp)->pending = 0;
+	((struct regexp_ctor *)RegExp)->captures = NULL;
+	((struct regexp_ctor *)RegExp)->maxcaptures = 0;
 
 	SEE_SET_NUMBER(&v, 2);
 	SEE_OBJECT_PUT(interp, RegExp, STR(length), &v,		/* 15.10.5 */
@@ -196,10 +268,67 @@ SEE_RegExp_init(interp)
 		SEE_ATTR_DEFAULT);
 
 	PUTFUNC(exec, 1)			/* 15.10.6.2 */
+	((struct regexp_ctor *)RegExp)->exec = v.u.object;
 	PUTFUNC(test, 1)			/* 15.10.6.3 */
 	PUTFUNC(toString, 0)			/* 15.10.6.4 */
 }
 
+/*
+ * The RegExp constructor's property accessors. These first set any
+ * static properties left pending by the last match.
+ */
+static void
+regexp_const_get(interp, o, p, res)
+	struct SEE_interpreter *interp;
+	struct SEE_object *o;
+	struct SEE_string *p;
+	struct SEE_value *res;
+{
+	regexp_flush_static(interp, (struct regexp_ctor *)o);
+	SEE_native_get(interp, o, p, res);
+}
+
+static void
+regexp_const_put(interp, o, p, val, attrs)
+	struct SEE_interpreter *interp;
+	struct SEE_object *o;
+	struct SEE_string *p;
+	struct SEE_value *val;
+	int attrs;
+{
+	regexp_flush_static(interp, (struct regexp_ctor *)o);
+	SEE_native_put(interp, o, p, val, attrs);
+}
+
+static int
+regexp_const_hasproperty(interp, o, p)
+	struct SEE_interpreter *interp;
+	struct SEE_object *o;
+	struct SEE_string *p;
+{
+	regexp_flush_static(interp, (struct regexp_ctor *)o);
+	return SEE_native_hasproperty(interp, o, p);
+}
+
+static int
+regexp_const_delete(interp, o, p)
+	struct SEE_interpreter *interp;
+	struct SEE_object *o;
+	struct SEE_string *p;
+{
+	regexp_flush_static(interp, (struct regexp_ctor *)o);
+	return SEE_native_delete(interp, o, p);
+}
+
+static struct SEE_enum *
+regexp_const_enumerator(interp, o)
+	struct SEE_interpreter *interp;
+	struct SEE_object *o;
+{
+	regexp_flush_static(interp, (struct regexp_ctor *)o);
+	return SEE_native_enumerator(interp, o);
+}
+
 static struct regexp_object *
 toregexp(interp, o)
 	struct SEE_interpreter *interp;
@@ -389,18 +518,14 @@ regexp_proto_exec(interp, self, thisobj, argc, argv, res)
 	ncaptures = SEE_regex_count_captures(ro->regex);
 	SEE_ASSERT(interp, ncaptures > 0);
 	captures = SEE_STRING_ALLOCA(interp, struct capture, ncaptures);
-	while (!SEE_regex_match(interp, ro->regex, S, i, captures)) {
-		i++;
-		if (i > S->length) {
-		    SEE_SET_NUMBER(&v, 0);
-		    SEE_OBJECT_PUT(interp, thisobj, STR(lastIndex), &v, 0); 
-		    SEE_SET_NULL(res);
-		    for (i = 0; i < ncaptures; i++)
-			captures[i].end = -1;
-		    regexp_set_static(interp, S, ro->regex, captures, 
-		    	ro->source);
-		    return;
-		}
+	if (!SEE_regex_search(interp, ro->regex, S, i, captures)) {
+		SEE_SET_NUMBER(&v, 0);
+		SEE_OBJECT_PUT(interp, thisobj, STR(lastIndex), &v, 0); 
+		SEE_SET_NULL(res);
+		for (i = 0; i < ncaptures; i++)
+		    captures[i].end = -1;
+		regexp_set_static(interp, S, ro->regex, captures, ro->source);
+		return;
 	}
 	regexp_set_static(interp, S, ro->regex, captures, ro->source);
 
@@ -473,6 +598,103 @@ SEE_RegExp_match(interp, obj, text, start, captures)
 	return success;
 }
 
+int
+SEE_RegExp_search(interp, obj, text, start, captures)
+	struct SEE_interpreter *interp;
+	struct SEE_object *obj;
+	struct SEE_string *text;
+	unsigned int start;
+	struct capture *captures;
+{
+	struct regexp_object *ro;
+	int success;
+	unsigned int ncaptures, i;
+
+	ro = toregexp(interp, obj);
+	ncaptures = SEE_regex_count_captures(ro->regex);
+	success = SEE_regex_search(interp, ro->regex, text, start, captures);
+	if (!success)
+	    for (i = 0; i < ncaptures; i++)
+		captures[i].end = -1;
+	regexp_set_static(interp, text, ro->regex, captures, ro->source);
+	return success;
+}
+
+/*
+ * Starts iterating over the matches of a global regexp in text, in the
+ * way that String.prototype.match() and replace() repeatedly call
+ * exec(), but without building a result array for each match.
+ * Returns false (and does nothing) if the regexp's exec method is not
+ * the original RegExp.prototype.exec, in which case the caller must
+ * call exec itself.
+ */
+int
+SEE_RegExp_iter_init(interp, iter, regexp, text)
+	struct SEE_interpreter *interp;
+	struct SEE_RegExp_iter *iter;
+	struct SEE_object *regexp;
+	struct SEE_string *text;
+{
+	struct regexp_ctor *ctor = (struct regexp_ctor *)interp->RegExp;
+	struct regexp_object *ro;
+	struct SEE_value v;
+
+	ro = toregexp(interp, regexp);
+	SEE_OBJECT_GET(interp, regexp, STR(exec), &v);
+	if (SEE_VALUE_GET_TYPE(&v) != SEE_OBJECT || v.u.object != ctor->exec)
+		return 0;
+	iter->regexp = regexp;
+	iter->text = text;
+	iter->index = 0;
+	iter->ncaptures = SEE_regex_count_captures(ro->regex);
+	iter->captures = SEE_NEW_STRING_ARRAY(interp, struct capture,
+		iter->ncaptures);
+	return 1;
+}
+
+/*
+ * Finds the next match, leaving it in iter->captures. Returns false
+ * when there are no more matches. Sets lastIndex and the RegExp
+ * statics just as exec() would.
+ */
+int
+SEE_RegExp_iter_next(interp, iter)
+	struct SEE_interpreter *interp;
+	struct SEE_RegExp_iter *iter;
+{
+	struct regexp_object *ro = (struct regexp_object *)iter->regexp;
+	struct capture *captures = iter->captures;
+	struct SEE_value v;
+	unsigned int i;
+
+	if (iter->index > iter->text->length)
+		goto done;
+	if (!SEE_regex_search(interp, ro->regex, iter->text, iter->index,
+	    captures))
+	{
+		for (i = 0; i < iter->ncaptures; i++)
+		    captures[i].end = -1;
+		regexp_set_static(interp, iter->text, ro->regex, captures,
+		    ro->source);
+		goto done;
+	}
+	regexp_set_static(interp, iter->text, ro->regex, captures,
+	    ro->source);
+	SEE_SET_NUMBER(&v, captures[0].end);
+	SEE_OBJECT_PUT(interp, iter->regexp, STR(lastIndex), &v, 0);
+
+	/* Step over empty matches */
+	iter->index = captures[0].end;
+	if (captures[0].start == captures[0].end)
+		iter->index++;
+	return 1;
+
+    done:
+	SEE_SET_NUMBER(&v, 0);
+	SEE_OBJECT_PUT(interp, iter->regexp, STR(lastIndex), &v, 0);
+	return 0;
+}
+
 /* 15.10.6.3 RegExp.prototype.test() */
 static void
 regexp_proto_test(interp, self, thisobj, argc, argv, res)
@@ -557,9 +779,8 @@ regexp_proto_toString(interp, self, thisobj, argc, argv, res)
 }
 
 /*
- * Sets the static "$" variables of RegExp:
- *  $1...$9,$_,$*,$+,$`,$',global,ignoreCase,input,lastIndex,
- *  lastMatch,lastParen,leftContext,multiline,rightContext,source
+ * Records a match result from which the static "$" variables of RegExp
+ * will later be set by regexp_flush_static().
  */
 static void
 regexp_set_static(interp, S, regex, captures, source)
@@ -568,6 +789,37 @@ regexp_set_static(interp, S, regex, captures, source)
 	struct regex *regex;
         struct capture *captures;
 	struct SEE_string *source;
+{
+	struct regexp_ctor *ctor = (struct regexp_ctor *)interp->RegExp;
+	unsigned int ncaptures;
+
+	/* Only do all this for Netscape compatibility */
+	if (!SEE_COMPAT_JS(interp, >=, JS11))	/* EXT:21 */
+		return;
+
+	ncaptures = SEE_regex_count_captures(regex);
+	if (ncaptures > ctor->maxcaptures) {
+		ctor->captures = SEE_NEW_STRING_ARRAY(interp, struct capture,
+		    ncaptures);
+		ctor->maxcaptures = ncaptures;
+	}
+	memcpy(ctor->captures, captures, ncaptures * sizeof *captures);
+	ctor->ncaptures = ncaptures;
+	ctor->input = S;
+	ctor->regex = regex;
+	ctor->source = source;
+	ctor->pending = 1;
+}
+
+/*
+ * Sets the static "$" variables of RegExp from the last recorded match:
+ *  $1...$9,$_,$*,$+,$`,$',global,ignoreCase,input,lastIndex,
+ *  lastMatch,lastParen,leftContext,multiline,rightContext,source
+ */
+static void
+regexp_flush_static(interp, ctor)
+        struct SEE_interpreter *interp;
+	struct regexp_ctor *ctor;
 {
         struct SEE_string *property;
         int i, flags;
@@ -575,29 +827,34 @@ regexp_set_static(interp, S, regex, captures, source)
 	unsigned int ncaptures;
 	struct SEE_object *RegExp;
 	struct SEE_string *lastParen;
+	struct SEE_string *S, *source;
+        struct capture *captures;
 
-	/* Only do all this for Netscape compatibility */
-	if (!SEE_COMPAT_JS(interp, >=, JS11))	/* EXT:21 */
+	if (!ctor->pending)
 		return;
+	ctor->pending = 0;		/* the PUTs below come back here */
 
-	RegExp = interp->RegExp;
+	RegExp = (struct SEE_object *)ctor;
+	S = ctor->input;
+	source = ctor->source;
+	captures = ctor->captures;
 	lastParen = STR(empty_string);
-	ncaptures = SEE_regex_count_captures(regex);
-	flags = SEE_regex_get_flags(regex);
+	ncaptures = ctor->ncaptures;
+	flags = SEE_regex_get_flags(ctor->regex);
 
         for (i = 0; i < 10; i++) {
 	    switch (i) {
 	    default:
-	    case 0: property = STR(dollar_ampersand);
-	    case 1: property = STR(dollar_1);
-	    case 2: property = STR(dollar_2);
-	    case 3: property = STR(dollar_3);
-	    case 4: property = STR(dollar_4);
-	    case 5: property = STR(dollar_5);
-	    case 6: property = STR(dollar_6);
-	    case 7: property = STR(dollar_7);
-	    case 8: property = STR(dollar_8);
-	    case 9: property = STR(dollar_9);
+	    case 0: property = STR(dollar_ampersand); break;
+	    case 1: property = STR(dollar_1); break;
+	    case 2: property = STR(dollar_2); break;
+	    case 3: property = STR(dollar_3); break;
+	    case 4: property = STR(dollar_4); break;
+	    case 5: property = STR(dollar_5); break;
+	    case 6: property = STR(dollar_6); break;
+	    case 7: property = STR(dollar_7); break;
+	    case 8: property = STR(dollar_8); break;
+	    case 9: property = STR(dollar_9); break;
 	    }
 	    if (i < ncaptures && !CAPTURE_IS_UNDEFINED(captures[i]))
 		SEE_SET_STRING(&v, SEE_string_substr(interp, S, 
@@ -57,6 +57,10 @@
 #include "init.h"
 #include "nmath.h"
 #include "replace.h"
+#include "strsearch.h"
+#include "strcache.h"
+#include "casemap.h"
+#include "gc.h"
 
 /*
  * The String object.
@@ -133,6 +137,7 @@ static void string_proto__ns_nop(struct SEE_interpreter *,
 
 static struct SEE_string *object_to_string(struct SEE_interpreter *,
 	struct SEE_object *);
+static void string_inst_trace(struct SEE_object *);
 
 /* object class for String constructor */
 static struct SEE_objectclass string_const_class = {
@@ -145,7 +150,10 @@ static struct SEE_objectclass string_const_class = {
 	SEE_native_defaultvalue,	/* DefaultValue */
 	SEE_native_enumerator,		/* DefaultValue */
 	string_construct,		/* Construct */
-	string_call			/* Call */
+	string_call,			/* Call */
+	NULL,				/* HasInstance */
+	NULL,				/* get_sec_domain */
+	SEE_native_trace		/* trace */
 };
 
 /* object class for String.prototype and string instances */
@@ -157,7 +165,12 @@ static struct SEE_objectclass string_inst_class = {
 	SEE_native_hasproperty,		/* HasProperty */
 	SEE_native_delete,		/* Delete */
 	SEE_native_defaultvalue,	/* DefaultValue */
-	SEE_native_enumerator		/* enumerator */
+	SEE_native_enumerator,		/* enumerator */
+	NULL,				/* Construct */
+	NULL,				/* Call */
+	NULL,				/* HasInstance */
+	NULL,				/* get_sec_domain */
+	string_inst_trace		/* trace */
 };
 
 /* structure of string instances */
@@ -166,6 +179,15 @@ struct string_object {
 	struct SEE_string *string;	/* Value */
 };
 
+/* Garbage collector trace hook for String.prototype and string instances */
+static void
+string_inst_trace(o)
+	struct SEE_object *o;
+{
+	SEE_native_trace(o);
+	SEE_gc_mark(((struct string_object *)o)->string);
+}
+
 void
 SEE_String_alloc(interp)
 	struct SEE_interpreter *interp;
@@ -332,7 +354,12 @@ string_fromCharCode(interp, self, thisobj, argc, argv, res)
 	struct SEE_string *s;
 	SEE_char_t ch;
 
-	s = SEE_string_new(interp, 0);
+	if (argc == 1) {
+		ch = SEE_ToUint16(interp, argv[0]);
+		SEE_SET_STRING(res, _SEE_string_char(interp, ch));
+		return;
+	}
+	s = SEE_string_new(interp, argc);
 	for (i = 0; i < argc; i++) {
 		ch = SEE_ToUint16(interp, argv[i]);
 		SEE_string_addch(s, ch);
@@ -398,8 +425,8 @@ string_proto_charAt(interp, self, thisobj, argc, argv, res)
 
 	if (SEE_NUMBER_ISFINITE(&vi) && vi.u.number >= 0 &&
 		vi.u.number < s->length)
-	    SEE_SET_STRING(res, SEE_string_substr(interp, s, 
-	    	(unsigned int)vi.u.number, 1));
+	    SEE_SET_STRING(res, _SEE_string_char(interp,
+	    	s->data[(unsigned int)vi.u.number]));
 	else
 	    SEE_SET_STRING(res, STR(empty_string));
 }
@@ -461,7 +488,7 @@ string_proto_indexOf(interp, self, thisobj, argc, argv, res)
 	struct SEE_string *s;
 	struct SEE_value vss, vi;
 	int position;
-	unsigned int k, sslen, slen;
+	unsigned int sslen, slen;
 		
 	s = object_to_string(interp, thisobj);
 	slen = s->length;
@@ -479,16 +506,9 @@ string_proto_indexOf(interp, self, thisobj, argc, argv, res)
 	}
 	if (position < 0) position = 0;
 	if (position > slen) position = slen;
-	
-	if (slen >= sslen)
-	    for (k = (unsigned int)position; k <= slen - sslen; k++)
-	        if (memcmp(&s->data[k], vss.u.string->data,
-		    sslen * sizeof vss.u.string->data[0]) == 0)
-	        {
-		    SEE_SET_NUMBER(res, k);
-		    return;
-	        }
-	SEE_SET_NUMBER(res, -1);
+
+	SEE_SET_NUMBER(res, _SEE_strsearch(s->data, slen,
+	    vss.u.string->data, sslen, (unsigned int)position));
 }
 
 /* 15.5.4.8 String.prototype.lastIndexOf() */
@@ -501,7 +521,6 @@ string_proto_lastIndexOf(interp, self, thisobj, argc, argv, res)
 {
 	struct SEE_string *r1s, *r2s;
 	struct SEE_value r3v, r2v, r4v;
-	int k;
 	unsigned int r5, r6, r7;
 		
 /*1*/	r1s = object_to_string(interp, thisobj);
@@ -528,20 +547,7 @@ string_proto_lastIndexOf(interp, self, thisobj, argc, argv, res)
 
 /*7*/	r7 = r2s->length;
 
-/*8*/
-	if (r5 < r7) {
-		SEE_SET_NUMBER(res, -1);
-		return;
-	}
-
-	for (k = MIN(r6, r5 - r7); k >= 0; k--)
-	    if (memcmp(r1s->data + k, r2s->data, 
-	    	r7 * sizeof (SEE_char_t)) == 0)
-	    {
-		SEE_SET_NUMBER(res, k);
-		return;
-	    }
-	SEE_SET_NUMBER(res, -1);
+/*8*/	SEE_SET_NUMBER(res, _SEE_strrsearch(r1s->data, r5, r2s->data, r7, r6));
 }
 
 /* 15.5.4.9 String.prototype.localeCompare() */
@@ -555,6 +561,7 @@ string_proto_localeCompare(interp, self, thisobj, argc, argv, res)
 	/*
 	 * XXX TODO properly:
 	 * this function should do some unicode canonicalisation.
+	 * Until then, strings are ordered by their UTF-16 code units.
 	 */
 
 	struct SEE_string *s1, *s2;
@@ -564,7 +571,7 @@ string_proto_localeCompare(interp, self, thisobj, argc, argv, res)
 	if (argc < 1) 
 	    SEE_SET_STRING(&v2, STR(undefined));
 	else
-	    SEE_ToString(interp, argv[1], &v2);
+	    SEE_ToString(interp, argv[0], &v2);
 	s2 = v2.u.string;
 
 	SEE_SET_NUMBER(res, SEE_string_cmp(s1, s2));
@@ -579,7 +586,7 @@ regexp_arg(interp, vp)
 	struct SEE_value *args[1], v;
 
 	if (vp == NULL) {
-		SEE_OBJECT_CONSTRUCT(interp, interp->RegExp, NULL, 
+		SEE_OBJECT_CONSTRUCT(interp, SEE_INTERP_REGEXP(interp), NULL, 
 			0, NULL, &v);
 		return v.u.object;
 	} else if (SEE_VALUE_GET_TYPE(vp) == SEE_OBJECT &&
@@ -587,7 +594,7 @@ regexp_arg(interp, vp)
 		return vp->u.object;
 	else {
 		args[0] = vp;
-		SEE_OBJECT_CONSTRUCT(interp, interp->RegExp, NULL,
+		SEE_OBJECT_CONSTRUCT(interp, SEE_INTERP_REGEXP(interp), NULL,
 			1, args, &v);
 		return v.u.object;
 	}
@@ -603,9 +610,10 @@ string_proto_match(interp, self, thisobj, argc, argv, res)
 {
 	struct SEE_object *regexp, *reexec, *a;
 	struct SEE_value v, *vp, *vpv[1];
-	struct SEE_string *s, *nstr;
+	struct SEE_string *s;
 	SEE_boolean_t global;
 	int n, matches = 0;
+	struct SEE_RegExp_iter iter;
 	
 	regexp = regexp_arg(interp, argc < 1 ? NULL : argv[0]);
 
@@ -635,9 +643,16 @@ string_proto_match(interp, self, thisobj, argc, argv, res)
 		SEE_OBJECT_CONSTRUCT(interp, interp->Array, NULL,
 			0, NULL, &v);
 		a = v.u.object;
-		nstr = SEE_string_new(interp, 0);
-
-		for (n = 0; ; n++) {
+		if (SEE_RegExp_iter_init(interp, &iter, regexp, s))
+		    for (n = 0; SEE_RegExp_iter_next(interp, &iter); n++) {
+			SEE_SET_STRING(&v, SEE_string_substr(interp, s,
+			    iter.captures[0].start,
+			    iter.captures[0].end - iter.captures[0].start));
+			SEE_OBJECT_PUT(interp, a, _SEE_intern_uint(interp, n),
+			    &v, 0);
+			matches++;
+		    }
+		else for (n = 0; ; n++) {
 		    struct SEE_value vres;
 
 		    /* Call regexp.exec(s) -> array of strings */
@@ -653,9 +668,8 @@ string_proto_match(interp, self, thisobj, argc, argv, res)
 		    SEE_ASSERT(interp, SEE_VALUE_GET_TYPE(&v) == SEE_STRING);
 
 		    /* a[n] = result string */
-		    nstr->length = 0;
-		    SEE_string_append_int(nstr, n);	/* nstr = String(n) */
-		    SEE_OBJECT_PUT(interp, a, SEE_intern(interp, nstr), &v, 0);
+		    SEE_OBJECT_PUT(interp, a, _SEE_intern_uint(interp, n), 
+			&v, 0);
 		    matches++;
 
 		    if (v.u.string->length == 0) {
@@ -676,63 +690,85 @@ string_proto_match(interp, self, thisobj, argc, argv, res)
 	}
 }
 
-/* Expand replace using array a, appending to out. Updates *previndexp */
+/*
+ * Fetches the nth captured substring of a match for replace_helper().
+ * The captures are taken from the exec result array a if it is not NULL,
+ * otherwise from the capture vector over source.
+ */
 static void
-replace_helper(interp, previndexp, out, a, source, replacev, ncaps)
+replace_capture(interp, a, captures, ncaps, source, n, res)
 	struct SEE_interpreter *interp;
-	unsigned int *previndexp;
 	struct SEE_object *a;
-	struct SEE_string *out, *source;
-	struct SEE_value *replacev;
+	struct capture *captures;
 	int ncaps;
-{
-	struct SEE_value v, v2;
+	struct SEE_string *source;
 	int n;
-	unsigned int index, i, j, k;
-	struct SEE_string *ns = NULL;
-	struct SEE_string *ms = NULL;
-	struct SEE_string *replace;
-
-	/* get the index of the match string */
-	SEE_OBJECT_GET(interp, a, STR(index), &v);
-	index = SEE_ToUint32(interp, &v);
+	struct SEE_value *res;
+{
+	if (a)
+	    SEE_OBJECT_GET(interp, a, _SEE_intern_uint(interp, n), res);
+	else if (n >= ncaps || CAPTURE_IS_UNDEFINED(captures[n]))
+	    SEE_SET_UNDEFINED(res);
+	else
+	    SEE_SET_STRING(res, SEE_string_substr(interp, source,
+		captures[n].start, captures[n].end - captures[n].start));
+}
 
-	/* get the match string */
-	SEE_OBJECT_GET(interp, a, STR(zero_digit), &v);
-	SEE_ASSERT(interp, SEE_VALUE_GET_TYPE(&v) == SEE_STRING);
-	ms = v.u.string;
+/*
+ * A replacement string, parsed once into a sequence of parts that are
+ * either runs of literal text or $ substitutions.
+ */
+struct replace_template {
+	struct SEE_string *replace;
+	unsigned int nparts;
+	struct replace_part {
+	    int kind;			/* REPLACE_* or capture number */
+	    unsigned int start, length;	/* literal text in replace */
+	} *parts;
+};
+#define REPLACE_LITERAL	(-1)		/* literal text */
+#define REPLACE_MATCH	(-2)		/* $& */
+#define REPLACE_LEFT	(-3)		/* $` */
+#define REPLACE_RIGHT	(-4)		/* $' */
 
-	/* Copy the intermediate characters we missed */
-	for (i = *previndexp; i < index; i++)
-	    SEE_string_addch(out, source->data[i]);
-	*previndexp = index + ms->length;
+/* Appends a part to the replacement template */
+static void
+replace_add(tmpl, kind, start, length)
+	struct replace_template *tmpl;
+	int kind;
+	unsigned int start, length;
+{
+	struct replace_part *p = &tmpl->parts[tmpl->nparts];
 
-	if (SEE_VALUE_GET_TYPE(replacev) == SEE_OBJECT) {
-	    struct SEE_value **av, *vp;
-	    av = SEE_ALLOCA(interp, struct SEE_value *, ncaps + 2);
-	    vp = SEE_ALLOCA(interp, struct SEE_value, ncaps + 2);
-	    for (i = 0; i < ncaps + 2; i++)
-		av[i] = &vp[i];
-	    SEE_OBJECT_GET(interp, a, STR(zero_digit), &vp[0]);
-	    for (i = 1; i < ncaps; i++) {
-		if (ns == NULL) ns = SEE_string_new(interp, 0);
-		ns->length = 0;
-		SEE_string_append_int(ns, i);
-		SEE_OBJECT_GET(interp, a, SEE_intern(interp, ns), &vp[i]);
-	    }
-	    SEE_SET_NUMBER(&vp[ncaps], index);
-	    SEE_SET_STRING(&vp[ncaps + 1], source);
-	    SEE_OBJECT_CALL(interp, replacev->u.object, replacev->u.object,
-		ncaps + 2, av, &v);
-	    SEE_ToString(interp, &v, &v2);
-	    SEE_string_append(out, v2.u.string);
-	    return;
+	/* Join adjacent runs of literal text */
+	if (kind == REPLACE_LITERAL && tmpl->nparts &&
+	    p[-1].kind == REPLACE_LITERAL && 
+	    p[-1].start + p[-1].length == start)
+	{
+		p[-1].length += length;
+		return;
 	}
+	p->kind = kind;
+	p->start = start;
+	p->length = length;
+	tmpl->nparts++;
+}
+
+/* Parses the $ patterns in a replacement string (15.5.4.11 table 12) */
+static void
+replace_compile(interp, tmpl, replace)
+	struct SEE_interpreter *interp;
+	struct replace_template *tmpl;
+	struct SEE_string *replace;
+{
+	unsigned int i, j, k;
+	int n;
 
-	SEE_ToString(interp, replacev, &v);
-	replace = v.u.string;
+	tmpl->replace = replace;
+	tmpl->nparts = 0;
+	tmpl->parts = SEE_NEW_STRING_ARRAY(interp, struct replace_part,
+	    replace->length);
 
-	/* Expand the replace text */
 	i = 0;
 	while (i < replace->length)
 	    if (replace->data[i] == '$' && i + 1 < replace->length) {
@@ -740,21 +776,19 @@ replace_helper(interp, previndexp, out, a, source, replacev, ncaps)
 
 		switch (replace->data[i]) {
 		case '$':
-		    SEE_string_addch(out, '$');
+		    replace_add(tmpl, REPLACE_LITERAL, i, 1);
 		    i++;
 		    continue;
 		case '`':
-		    for (k = 0; k < index; k++)
-		        SEE_string_addch(out, source->data[k]);
+		    replace_add(tmpl, REPLACE_LEFT, 0, 0);
 		    i++;
 		    continue;
 		case '\'':
-		    for (k = *previndexp; k < source->length; k++)
-		        SEE_string_addch(out, source->data[k]);
+		    replace_add(tmpl, REPLACE_RIGHT, 0, 0);
 		    i++;
 		    continue;
 		case '&':
-		    SEE_string_append(out, ms);
+		    replace_add(tmpl, REPLACE_MATCH, 0, 0);
 		    i++;
 		    continue;
 		}
@@ -765,25 +799,143 @@ replace_helper(interp, previndexp, out, a, source, replacev, ncaps)
 			n = n * 10 + replace->data[j++] - '0';
 		if (j == i) {
 		    /* Didn't see any digits */
-		    SEE_string_addch(out, '$');
+		    replace_add(tmpl, REPLACE_LITERAL, i - 1, 1);
 		    continue;
 		}
-		/* Build up an index into the capture array  */
-		if (ns == NULL) ns = SEE_string_new(interp, 0);
-		ns->length = 0;
-		SEE_string_append_int(ns, n);
-
-		/* fetch the captured substring */
-		SEE_OBJECT_GET(interp, a, SEE_intern(interp, ns), &v);
-		if (SEE_VALUE_GET_TYPE(&v) != SEE_UNDEFINED) {
-		    SEE_ASSERT(interp, SEE_VALUE_GET_TYPE(&v) == SEE_STRING);
-		    SEE_string_append(out, v.u.string);
-		}
+		replace_add(tmpl, n, 0, 0);
 		i = j;
 	    } else {
-	        SEE_string_addch(out, replace->data[i]);
-	        i++;
+		/* The run of literal text up to the next '$' */
+		for (k = i + 1; k < replace->length; k++)
+		    if (replace->data[k] == '$')
+			break;
+		replace_add(tmpl, REPLACE_LITERAL, i, k - i);
+		i = k;
+	    }
+}
+
+/*
+ * Expand the replacement for the match described by array a (or the
+ * captures vector when a is NULL), appending to the buffer out.
+ * The replacement is the template tmpl, or the function replacev if
+ * tmpl is NULL. Updates *previndexp
+ */
+static void
+replace_helper(interp, previndexp, out, a, captures, source, replacev, tmpl,
+	ncaps)
+	struct SEE_interpreter *interp;
+	unsigned int *previndexp;
+	struct SEE_object *a;
+	struct capture *captures;
+	struct SEE_strbuf *out;
+	struct SEE_string *source;
+	struct SEE_value *replacev;
+	struct replace_template *tmpl;
+	int ncaps;
+{
+	struct SEE_value v, v2;
+	unsigned int index, mlen, i;
+	struct SEE_string *ms = NULL;
+	struct replace_part *p;
+
+	if (a) {
+	    /* get the index of the match string */
+	    SEE_OBJECT_GET(interp, a, STR(index), &v);
+	    index = SEE_ToUint32(interp, &v);
+
+	    /* get the match string */
+	    SEE_OBJECT_GET(interp, a, STR(zero_digit), &v);
+	    SEE_ASSERT(interp, SEE_VALUE_GET_TYPE(&v) == SEE_STRING);
+	    ms = v.u.string;
+	    mlen = ms->length;
+	} else {
+	    index = captures[0].start;
+	    mlen = captures[0].end - captures[0].start;
+	}
+
+	/* Copy the intermediate characters we missed */
+	if (index > *previndexp)
+	    SEE_strbuf_append_chars(out, source->data + *previndexp,
+		index - *previndexp);
+	*previndexp = index + mlen;
+
+	if (!tmpl) {
+	    struct SEE_value **av, *vp;
+	    av = SEE_ALLOCA(interp, struct SEE_value *, ncaps + 2);
+	    vp = SEE_ALLOCA(interp, struct SEE_value, ncaps + 2);
+	    for (i = 0; i < ncaps + 2; i++)
+		av[i] = &vp[i];
+	    if (!ms)
+		ms = SEE_string_substr(interp, source, index, mlen);
+	    SEE_SET_STRING(&vp[0], ms);
+	    for (i = 1; i < ncaps; i++)
+		replace_capture(interp, a, captures, ncaps, source, i, &vp[i]);
+	    SEE_SET_NUMBER(&vp[ncaps], index);
+	    SEE_SET_STRING(&vp[ncaps + 1], source);
+	    SEE_OBJECT_CALL(interp, replacev->u.object, replacev->u.object,
+		ncaps + 2, av, &v);
+	    SEE_ToString(interp, &v, &v2);
+	    SEE_strbuf_append(out, v2.u.string);
+	    return;
+	}
+
+	/* Expand the replace text */
+	for (p = tmpl->parts; p < tmpl->parts + tmpl->nparts; p++)
+	    switch (p->kind) {
+	    case REPLACE_LITERAL:
+		SEE_strbuf_append_chars(out, tmpl->replace->data + p->start,
+		    p->length);
+		break;
+	    case REPLACE_LEFT:
+		SEE_strbuf_append_chars(out, source->data, index);
+		break;
+	    case REPLACE_RIGHT:
+		if (*previndexp < source->length)
+		    SEE_strbuf_append_chars(out, source->data + *previndexp,
+			source->length - *previndexp);
+		break;
+	    case REPLACE_MATCH:
+		if (ms)
+		    SEE_strbuf_append(out, ms);
+		else
+		    SEE_strbuf_append_chars(out, source->data + index, mlen);
+		break;
+	    default:
+		/* Copy the captured substring */
+		if (a) {
+		    replace_capture(interp, a, captures, ncaps, source,
+			p->kind, &v);
+		    if (SEE_VALUE_GET_TYPE(&v) != SEE_UNDEFINED) {
+			SEE_ASSERT(interp, 
+			    SEE_VALUE_GET_TYPE(&v) == SEE_STRING);
+			SEE_strbuf_append(out, v.u.string);
+		    }
+		} else if (p->kind < ncaps &&
+		    !CAPTURE_IS_UNDEFINED(captures[p->kind]))
+		    SEE_strbuf_append_chars(out,
+			source->data + captures[p->kind].start,
+			captures[p->kind].end - captures[p->kind].start);
+	    }
+}
+
+/*
+ * Returns true if the string contains no characters that are special
+ * in a regular expression, i.e. RegExp(s) would only match s itself.
+ */
+static int
+is_literal_pattern(s)
+	struct SEE_string *s;
+{
+	unsigned int i;
+
+	for (i = 0; i < s->length; i++)
+	    switch (s->data[i]) {
+	    case '^': case '$': case '\\': case '.': case '*': case '+':
+	    case '?': case '(': case ')': case '[': case ']': case '{':
+	    case '}': case '|':
+		return 0;
 	    }
+	return 1;
 }
 
 /* 15.5.4.11 String.prototype.replace() */
@@ -796,13 +948,30 @@ string_proto_replace(interp, self, thisobj, argc, argv, res)
 {
 	struct SEE_object *regexp, *reexec;
 	struct SEE_value v, *vp, *vpv[1], v2, *replacev, replv;
-	struct SEE_string *s, *out = NULL;
+	struct SEE_string *s;
+	struct SEE_strbuf out;
 	SEE_boolean_t global;
-	int ncaps;
+	int ncaps = 1, k, matched = 0;
 	unsigned int previndex = 0;
-	
-	regexp = regexp_arg(interp, argc < 1 ? NULL : argv[0]);
-	ncaps = SEE_RegExp_count_captures(interp, regexp);
+	struct capture match;
+	struct SEE_string *pat;
+	struct replace_template template, *tmpl = NULL;
+	struct SEE_RegExp_iter iter;
+
+	/*
+	 * A search string without any pattern characters can be located
+	 * directly instead of compiling it into a regular expression.
+	 * (The JavaScript compatibility modes must still go through
+	 * RegExp.prototype.exec so that the RegExp statics get updated.)
+	 */
+	if (argc > 0 && SEE_VALUE_GET_TYPE(argv[0]) == SEE_STRING &&
+	    !SEE_COMPAT_JS(interp, >=, JS11) &&
+	    is_literal_pattern(argv[0]->u.string))
+		regexp = NULL;
+	else {
+		regexp = regexp_arg(interp, argc < 1 ? NULL : argv[0]);
+		ncaps = SEE_RegExp_count_captures(interp, regexp);
+	}
 
 	/* Convert the replace arg to a string or callable function */
 	if (argc < 2) {
@@ -815,6 +984,30 @@ string_proto_replace(interp, self, thisobj, argc, argv, res)
 		SEE_ToString(interp, argv[1], &replv);
 		replacev = &replv;
 	}
+	if (SEE_VALUE_GET_TYPE(replacev) == SEE_STRING) {
+		replace_compile(interp, &template, replacev->u.string);
+		tmpl = &template;
+	}
+
+	if (!regexp) {
+		s = object_to_string(interp, thisobj);
+		pat = argv[0]->u.string;
+		k = _SEE_strsearch(s->data, s->length, pat->data,
+		    pat->length, 0);
+		if (k < 0) {
+		    SEE_SET_STRING(res, s);
+		    return;
+		}
+		match.start = k;
+		match.end = k + pat->length;
+		SEE_strbuf_init(interp, &out, s->length);
+		replace_helper(interp, &previndex, &out, NULL, &match,
+		    s, replacev, tmpl, 1);
+		SEE_strbuf_append_chars(&out, s->data + previndex,
+		    s->length - previndex);
+		SEE_SET_STRING(res, SEE_strbuf_string(&out));
+		return;
+	}
 
 	/* fetch the regexp's exec method */
 	SEE_OBJECT_GET(interp, regexp, STR(exec), &v);
@@ -836,16 +1029,28 @@ string_proto_replace(interp, self, thisobj, argc, argv, res)
 		if (SEE_VALUE_GET_TYPE(&v2) != SEE_NULL) {
 		    SEE_ASSERT(interp, SEE_VALUE_GET_TYPE(&v2) == SEE_OBJECT
 			&& SEE_is_Array(v2.u.object));
-		    out = SEE_string_new(interp, 0);
-		    replace_helper(interp, &previndex, out, v2.u.object,
-			s, replacev, ncaps);
+		    SEE_strbuf_init(interp, &out, s->length);
+		    matched = 1;
+		    replace_helper(interp, &previndex, &out, v2.u.object,
+			NULL, s, replacev, tmpl, ncaps);
 		}
 	} else {
 		/* regexp.lastIndex = 0 */
 		SEE_SET_NUMBER(&v, 0);
 		SEE_OBJECT_PUT(interp, regexp, STR(lastIndex), &v, 0);
 
-		for (;;) {
+		if (SEE_RegExp_iter_init(interp, &iter, regexp, s))
+		    while (SEE_RegExp_iter_next(interp, &iter)) {
+			if (iter.captures[0].start == iter.captures[0].end)
+			    continue;
+		        if (!matched) {
+			    SEE_strbuf_init(interp, &out, s->length);
+			    matched = 1;
+			}
+			replace_helper(interp, &previndex, &out, NULL,
+			    iter.captures, s, replacev, tmpl, ncaps);
+		    }
+		else for (;;) {
 		    struct SEE_value vres;
 
 		    /* Call regexp.exec(s) -> array of strings */
@@ -863,10 +1068,12 @@ string_proto_replace(interp, self, thisobj, argc, argv, res)
 		    SEE_ASSERT(interp, SEE_VALUE_GET_TYPE(&v) == SEE_STRING);
 
 		    if (v.u.string->length != 0) {
-		        if (out == NULL) 
-			    out = SEE_string_new(interp, 0);
-		        replace_helper(interp, &previndex, out, vres.u.object,
-			    s, replacev, ncaps);
+		        if (!matched) {
+			    SEE_strbuf_init(interp, &out, s->length);
+			    matched = 1;
+			}
+		        replace_helper(interp, &previndex, &out, vres.u.object,
+			    NULL, s, replacev, tmpl, ncaps);
 		    } else {
 			/* Increment the index by one if it matched empty */
 			SEE_OBJECT_GET(interp, regexp, STR(lastIndex), &v);
@@ -878,14 +1085,14 @@ string_proto_replace(interp, self, thisobj, argc, argv, res)
 		}
 	}
 
-	if (out)
+	if (matched) {
 	    /* Copy rest of source text */
-	    while (previndex < s->length)
-		SEE_string_addch(out, s->data[previndex++]);
-	else
-	    out = s;
-
-	SEE_SET_STRING(res, out);
+	    if (previndex < s->length)
+		SEE_strbuf_append_chars(&out, s->data + previndex,
+		    s->length - previndex);
+	    SEE_SET_STRING(res, SEE_strbuf_string(&out));
+	} else
+	    SEE_SET_STRING(res, s);
 }
 
 /* 15.5.4.12 String.prototype.search() */
@@ -900,7 +1107,6 @@ string_proto_search(interp, self, thisobj, argc, argv, res)
 	struct SEE_object *regexp;
 	int ncaps;
 	struct capture *captures;
-	int index;
 
 	s = object_to_string(interp, thisobj);
 	regexp = regexp_arg(interp, argc < 1 ? NULL : argv[0]);
@@ -913,12 +1119,10 @@ string_proto_search(interp, self, thisobj, argc, argv, res)
 	 * it is a perfect candidate for calling the regex 
 	 * engine (nearly) directly.
 	 */
-	for (index = 0; index < s->length; index++)
-	    if (SEE_RegExp_match(interp, regexp, s, index, captures)) {
-		SEE_SET_NUMBER(res, captures[0].start);
-		return;
-	    }
-	SEE_SET_NUMBER(res, -1);
+	if (SEE_RegExp_search(interp, regexp, s, 0, captures))
+	    SEE_SET_NUMBER(res, captures[0].start);
+	else
+	    SEE_SET_NUMBER(res, -1);
 }
 
 /* 15.5.4.13 String.prototype.slice() */
@@ -987,6 +1191,74 @@ SplitMatch(interp, R, S, q, captures)
 		q, captures);
 }
 
+/* Returns the substring of S at p of length len, for split_string() */
+static struct SEE_string *
+split_piece(interp, S, p, len)
+	struct SEE_interpreter *interp;
+	struct SEE_string *S;
+	unsigned int p, len;
+{
+	if (len == 0)
+	    return STR(empty_string);
+	if (len == 1)
+	    return _SEE_string_char(interp, S->data[p]);
+	return SEE_string_substr(interp, S, p, len);
+}
+
+/* Finds the next occurrence of a non-empty separator in S from p */
+#define SPLIT_FIND(S, sep, p)						\
+	((sep)->length == 1						\
+	    ? _SEE_strchr((S)->data, (S)->length, (sep)->data[0], p)	\
+	    : _SEE_strsearch((S)->data, (S)->length, (sep)->data,	\
+		(sep)->length, p))
+
+/*
+ * Splits the non-empty string S by a separator string, as steps 10 to
+ * 30 of String.prototype.split() would. The pieces are counted first,
+ * so that the result array's elements can be stored directly into
+ * storage allocated once.
+ */
+static void
+split_string(interp, A, S, sep, lim)
+	struct SEE_interpreter *interp;
+	struct SEE_object *A;
+	struct SEE_string *S, *sep;
+	SEE_uint32_t lim;
+{
+	unsigned int i, n, p;
+	int k;
+	struct SEE_value *elem;
+
+	if (sep->length == 0) {
+	    /* Each character is a piece */
+	    n = MIN(S->length, lim);
+	    elem = SEE_Array_dense(interp, A, n);
+	    for (i = 0; i < n; i++) {
+		SEE_SET_STRING(&elem[i], split_piece(interp, S, i, 1));
+		_SEE_gc_store_value(elem, &elem[i]);
+	    }
+	    return;
+	}
+
+	for (n = 1, p = 0; n < lim; n++) {
+	    k = SPLIT_FIND(S, sep, p);
+	    if (k < 0)
+		break;
+	    p = k + sep->length;
+	}
+
+	elem = SEE_Array_dense(interp, A, n);
+	for (i = 0, p = 0; i < n; i++) {
+	    k = SPLIT_FIND(S, sep, p);
+	    if (k < 0)
+		k = S->length;
+	    SEE_SET_STRING(&elem[i], split_piece(interp, S, p, k - p));
+	    _SEE_gc_store_value(elem, &elem[i]);
+	    p = k + sep->length;
+	}
+}
+#undef SPLIT_FIND
+
 /* 15.5.4.14 String.prototype.split() */
 static void
 string_proto_split(interp, self, thisobj, argc, argv, res)
@@ -999,7 +1271,7 @@ string_proto_split(interp, self, thisobj, argc, argv, res)
 	struct SEE_object *A;
 	struct SEE_string *S, *T;
 	SEE_uint32_t lim;
-	int p, s, ncap, z, e, q, i;
+	int p, s, ncap, z, e, q, i, k;
 	struct capture *captures = NULL;
 
 /*1*/	S = object_to_string(interp, thisobj);
@@ -1035,7 +1307,7 @@ string_proto_split(interp, self, thisobj, argc, argv, res)
 		SEE_string_addch(wss, '+');
 		SEE_SET_STRING(&a, wss);
 		av[0] = &a;
-		SEE_OBJECT_CONSTRUCT(interp, interp->RegExp, NULL,
+		SEE_OBJECT_CONSTRUCT(interp, SEE_INTERP_REGEXP(interp), NULL,
 			1, av, &separatorv);
 		while (p < s && UNICODE_IS_Zs(S->data[p]))
 		    p++;
@@ -1050,9 +1322,20 @@ string_proto_split(interp, self, thisobj, argc, argv, res)
 		!SEE_GET_JS_COMPAT(interp)))
 	    goto step33;
 /*9*/	if (s == 0) goto step31;
+	if (SEE_VALUE_GET_TYPE(R) == SEE_STRING) {
+	    split_string(interp, A, S, R->u.string, lim);
+	    return;
+	}
 step10:	q = p;
 step11:	if (q == s) goto step28;
-/*12*/	z = SplitMatch(interp, R, S, q, captures);
+/*12*/	if (SEE_VALUE_GET_TYPE(R) != SEE_OBJECT) {
+	    /* Skip ahead to the next occurrence of the separator string */
+	    k = _SEE_strsearch(S->data, s, R->u.string->data,
+		R->u.string->length, q);
+	    if (k < 0) goto step28;
+	    q = k;
+	}
+	z = SplitMatch(interp, R, S, q, captures);
 /*13*/	if (!z) goto step26;
 /*14*/	e = captures[0].end;
 /*15*/	if (e == p) goto step26;
@@ -1170,7 +1453,6 @@ string_proto_toLowerCase(interp, self, thisobj, argc, argv, res)
 	struct SEE_value **argv, *res;
 {
 	struct SEE_string *s, *rs;
-	int i;
 
 	s = object_to_string(interp, thisobj);
 	if (s->length == 0) {
@@ -1179,10 +1461,8 @@ string_proto_toLowerCase(interp, self, thisobj, argc, argv, res)
 	}
 
 	rs = SEE_string_new(interp, s->length);
-	for (i = 0; i < s->length; i++) {
-	    SEE_char_t c = UNICODE_TOLOWER(s->data[i]);
-	    SEE_string_addch(rs, c);
-	}
+	_SEE_tolower_chars(rs->data, s->data, s->length);
+	rs->length = s->length;
 	SEE_SET_STRING(res, rs);
 }
 
@@ -1208,7 +1488,6 @@ string_proto_toUpperCase(interp, self, thisobj, argc, argv, res)
 	struct SEE_value **argv, *res;
 {
 	struct SEE_string *s, *rs;
-	int i;
 
 	s = object_to_string(interp, thisobj);
 	if (s->length == 0) {
@@ -1217,10 +1496,8 @@ string_proto_toUpperCase(interp, self, thisobj, argc, argv, res)
 	}
 
 	rs = SEE_string_new(interp, s->length);
-	for (i = 0; i < s->length; i++) {
-	    SEE_char_t c = UNICODE_TOUPPER(s->data[i]);
-	    SEE_string_addch(rs, c);
-	}
+	_SEE_toupper_chars(rs->data, s->data, s->length);
+	rs->length = s->length;
 	SEE_SET_STRING(res, rs);
 }
 
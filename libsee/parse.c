@@ -321,6 +321,7 @@ struct parser {
 	int 		  noin;	  /* ignore 'in' in RelationalExpression */
 	int		  is_lhs; /* derived LeftHandSideExpression */
 	int		  funcdepth;
+	int		  escapes;  /* activation may outlive the call */
 	struct var	**vars;		    /* list of declared variables */
 	struct labelset	 *labelsets;	    /* list of all labelsets */
 	struct label     *labels;	    /* stack of active labels */
@@ -788,6 +789,10 @@ static struct node *FunctionBody_make(struct SEE_interpreter *,
 	struct node *, int);
 static struct node *FunctionStatement_parse(struct parser *parser);
 static struct function *Program_parse(struct parser *parser);
+static struct function *parse_function(struct SEE_interpreter *,
+	struct SEE_string *, struct SEE_input *, struct SEE_input *);
+static struct function *parse_program(struct SEE_interpreter *,
+	struct SEE_input *);
 static struct node *SourceElements_make1(struct SEE_interpreter *,
 	struct node *);
 static struct node *SourceElements_parse(struct parser *parser);
@@ -1536,6 +1541,7 @@ parser_init(parser, interp, lex)
 	parser->noin = 0;
 	parser->is_lhs = 0;
 	parser->funcdepth = 0;
+	parser->escapes = 0;
 	parser->vars = NULL;
 	parser->labelsets = NULL;
 	parser->labels = NULL;
@@ -2520,8 +2526,8 @@ RegularExpressionLiteral_eval(na, context, res)
 	struct SEE_interpreter *interp = context->interpreter;
 	struct SEE_traceback *tb;
 
-        tb = traceback_enter(interp, interp->RegExp, &n->node.location,
-		SEE_CALLTYPE_CONSTRUCT);
+        tb = traceback_enter(interp, SEE_INTERP_REGEXP(interp), 
+		&n->node.location, SEE_CALLTYPE_CONSTRUCT);
 	TRACE(&na->location, context, SEE_TRACE_CALL);
 	SEE_OBJECT_CONSTRUCT(interp, interp->RegExp, NULL, 
 		2, n->argv, res);
@@ -2754,6 +2760,9 @@ PrimaryExpression_parse(parser)
 		i = NEW_NODE(struct PrimaryExpression_ident_node,
 			&PrimaryExpression_ident_nodeclass);
 		i->string = NEXT_VALUE->u.string;
+		/* eval() can expose the activation */
+		if (i->string == STR(eval))
+			parser->escapes = 1;
 		SKIP;
 		return (struct node *)i;
 	case '[':
@@ -3783,6 +3792,7 @@ CallExpression_eval_common(context, loc, r1, argc, argv, res)
 	TRACE(loc, context, SEE_TRACE_CALL);
 	if (r3.u.object == interp->Global_eval) {
 	    /* The special 'eval' function' */
+	    _SEE_activation_pin(interp, context->activation);
 	    eval(context, r7, argc, argv, res);
 	} else {
 #ifndef NDEBUG
@@ -10573,7 +10583,7 @@ WithStatement_eval(na, context, res)
 	SEE_ToObject(context->interpreter, &r2, &r3);
 
 	/* Insert r3 in front of current scope chain */
-	s = SEE_NEW(context->interpreter, struct SEE_scope);
+	s = _SEE_scope_new(context->interpreter);
 	s->obj = r3.u.object;
 	s->next = context->scope;
 	context->scope = s;
@@ -10651,6 +10661,7 @@ WithStatement_parse(parser)
 	struct Binary_node *n;
 
 	n = NEW_NODE(struct Binary_node, &WithStatement_nodeclass);
+	parser->escapes = 1;
 	EXPECT(tWITH);
 	EXPECT('(');
 	n->a = PARSE(Expression);
@@ -11214,7 +11225,7 @@ TryStatement_catch(n, context, C, res, ctxt)
 
 	r2 = SEE_Object_new(interp);
 	SEE_OBJECT_PUT(interp, r2, n->ident, C, SEE_ATTR_DONTDELETE);
-	s = SEE_NEW(interp, struct SEE_scope);
+	s = _SEE_scope_new(interp);
 	s->obj = r2;
 	s->next = context->scope;
 	context->scope = s;
@@ -11756,6 +11767,7 @@ FunctionDeclaration_parse(parser)
 	struct node *body;
 	struct var *formal;
 	struct SEE_string *name = NULL;
+	int escapes;
 
 	n = NEW_NODE(struct Function_node, &FunctionDeclaration_nodeclass);
 	EXPECT(tFUNCTION);
@@ -11770,12 +11782,16 @@ FunctionDeclaration_parse(parser)
 
 	EXPECT('{');
 	parser->funcdepth++;
+	parser->escapes = 0;
 	body = PARSE(FunctionBody);
+	escapes = parser->escapes;
+	parser->escapes = 1;		/* the enclosing function's too */
 	parser->funcdepth--;
 	EXPECT('}');
 
 	n->function = SEE_function_make(parser->interpreter, 
 		name, formal, make_body(parser->interpreter, body, 0));
+	n->function->noescape = !escapes;
 
 	return (struct node *)n;
 }
@@ -11806,7 +11822,7 @@ FunctionExpression_eval(na, context, res)
 	     */
 	    obj = SEE_Object_new(interp);
 
-	    scope = SEE_NEW(interp, struct SEE_scope);
+	    scope = _SEE_scope_new(interp);
 	    scope->obj = obj;
 	    scope->next = context->scope;
 	    context->scope = scope;
@@ -11886,6 +11902,7 @@ FunctionExpression_parse(parser)
 	int noin_save, is_lhs_save;
 	struct SEE_string *name;
 	struct node *body;
+	int escapes;
 
 	/* Save parser state */
 	noin_save = parser->noin;
@@ -11906,12 +11923,16 @@ FunctionExpression_parse(parser)
 
 	EXPECT('{');
 	parser->funcdepth++;
+	parser->escapes = 0;
 	body = PARSE(FunctionBody);
+	escapes = parser->escapes;
+	parser->escapes = 1;		/* the enclosing function's too */
 	parser->funcdepth--;
 	EXPECT('}');
 
 	n->function = SEE_function_make(parser->interpreter,
 		name, formal, make_body(parser->interpreter, body, 0));
+	n->function->noescape = !escapes;
 
 	/* Restore parser state */
 	parser->noin = noin_save;
@@ -12317,6 +12338,7 @@ SourceElements_make1(interp, statement)
 		&SourceElements_nodeclass); 
 	ss->statements = s;
 	ss->functions = NULL;
+	ss->vars = NULL;
 	return (struct node *)ss;
 }
 
@@ -12393,18 +12415,37 @@ SourceElements_parse(parser)
  * Parses a function declaration in two parts and
  * return a function structure, in a similar way to
  * FunctionDeclaration_parse() when called with the
- * right input.
+ * right input. The storage is charged to code.
  */
 struct function *
 SEE_parse_function(interp, name, paraminp, bodyinp)
 	struct SEE_interpreter *interp;
 	struct SEE_string *name;
 	struct SEE_input *paraminp, *bodyinp;
+{
+	struct function * volatile f = NULL;
+	SEE_try_context_t ctxt;
+	int category = interp->mem_category;
+
+	interp->mem_category = SEE_MEM_CODE;
+	SEE_TRY(interp, ctxt)
+		f = parse_function(interp, name, paraminp, bodyinp);
+	interp->mem_category = category;
+	SEE_DEFAULT_CATCH(interp, ctxt);
+	return f;
+}
+
+static struct function *
+parse_function(interp, name, paraminp, bodyinp)
+	struct SEE_interpreter *interp;
+	struct SEE_string *name;
+	struct SEE_input *paraminp, *bodyinp;
 {
 	struct lex lex;
 	struct parser parservar, *parser = &parservar;
 	struct var *formal;
 	struct node *body;
+	struct function *f;
 
 	if (paraminp) {
 		SEE_lex_init(&lex, SEE_input_lookahead(paraminp, 6));
@@ -12427,8 +12468,10 @@ SEE_parse_function(interp, name, paraminp, bodyinp)
 	parser->funcdepth--;
 	EXPECT_NOSKIP(tEND);
 
-	return SEE_function_make(interp, name, formal, 
+	f = SEE_function_make(interp, name, formal, 
 		make_body(interp, body, 0));
+	f->noescape = !parser->escapes;
+	return f;
 }
 
 /*
@@ -12436,11 +12479,29 @@ SEE_parse_function(interp, name, paraminp, bodyinp)
  * Does not close the input, but may consume up to 6 characters.
  * lookahead. This is not usually a problem, because the input is
  * always read to EOF on normal completion.
+ * The storage is charged to code.
  */
 struct function *
 SEE_parse_program(interp, inp)
 	struct SEE_interpreter *interp;
 	struct SEE_input *inp;
+{
+	struct function * volatile f = NULL;
+	SEE_try_context_t ctxt;
+	int category = interp->mem_category;
+
+	interp->mem_category = SEE_MEM_CODE;
+	SEE_TRY(interp, ctxt)
+		f = parse_program(interp, inp);
+	interp->mem_category = category;
+	SEE_DEFAULT_CATCH(interp, ctxt);
+	return f;
+}
+
+static struct function *
+parse_program(interp, inp)
+	struct SEE_interpreter *interp;
+	struct SEE_input *inp;
 {
 	struct lex lex;
 	struct parser localparse, *parser = &localparse;
@@ -12793,7 +12854,7 @@ eval(context, thisobj, argc, argv, res)
 		 */
 		evalcontext.thisobj = thisobj;
 		evalcontext.variable = thisobj;
-		evalcontext.scope = SEE_NEW(interp, struct SEE_scope);
+		evalcontext.scope = _SEE_scope_new(interp);
 		evalcontext.scope->next = context->scope;
 		evalcontext.scope->obj = thisobj;
 	}
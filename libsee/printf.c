@@ -92,13 +92,13 @@ baselen(n, base)
 }
 
 /*
- * Fills in a given string structure, allocating a new SEE_char_t array
- * containing the format string, with %-expansions.
+ * Appends the format string, with %-expansions, to a string buffer.
+ * The exact space needed is reserved before anything is stored.
  */
 void
-_SEE_vsprintf(interp, s, fmt, ap)
+_SEE_vsprintf(interp, sb, fmt, ap)
     struct SEE_interpreter *interp;
-    struct SEE_string *s;
+    struct SEE_strbuf *sb;
     const char *fmt;
     va_list ap;
 {
@@ -118,8 +118,6 @@ _SEE_vsprintf(interp, s, fmt, ap)
 	if (phase) *out++ = (c); else outlen++; \
     } while (0)
 
-    SEE_ASSERT(interp, s->length == 0);
-
     /*
      * Phase 0: scan fmt to figure out how much buffer space is needed
      * Phase 1: re-scan fmt to fill out the buffer
@@ -136,9 +134,9 @@ _SEE_vsprintf(interp, s, fmt, ap)
 	    	break;
 	    SEE_VA_COPY(ap, ap0);
 	    fmt = fmtstart;
-	    (*s->stringclass->growby)(s, outlen);
-	    s->length = outlen;
-	    out = s->data;
+	    SEE_strbuf_reserve(sb, outlen);
+	    out = sb->data + sb->length;
+	    sb->length += outlen;
 	}
 
 	while (*fmt) {
@@ -3,14 +3,105 @@
 #endif
 
 #include <string.h>
+#include <see/mem.h>
 #include <see/system.h>
 #include <see/error.h>
+#include <see/string.h>
+#include <see/interpreter.h>
+#include <see/try.h>
 #include "regex.h"
 
 #if WITH_PCRE
 extern const struct SEE_regex_engine _SEE_pcre_regex_engine;
 #endif
 
+/*
+ * Cache of recently compiled regexs.
+ * Scripts tend to construct the same few patterns over and over, for
+ * example from regex literals inside functions, or from string
+ * arguments to String.prototype.match(). Compiled regexs are never
+ * modified by matching, so RegExp objects with the same source, flags
+ * and engine can share one. The cache is allocated on first use and
+ * its entries form a most-recently-used list; on a miss, the least
+ * recently used entry is replaced.
+ */
+
+#define REGEX_CACHE_SIZE	32
+
+struct regex_cache_entry {
+	struct SEE_string *pattern;
+	unsigned int hash;
+	int flags;
+	const struct SEE_regex_engine *engine;
+	struct regex *regex;
+	struct regex_cache_entry *prev, *next;
+};
+
+struct regex_cache {
+	struct regex_cache_entry entry[REGEX_CACHE_SIZE];
+	struct regex_cache_entry *head, *tail;	/* most/least recent */
+	unsigned int count;
+	unsigned long hits, misses;
+};
+
+/* Returns a hash of the whole pattern */
+static unsigned int
+pattern_hash(s)
+	const struct SEE_string *s;
+{
+	unsigned int i, h = s->length;
+
+	for (i = 0; i < s->length; i++)
+		h = h * 31 + s->data[i];
+	return h;
+}
+
+/* Moves a cache entry to the head of the list */
+static void
+cache_touch(cache, e)
+	struct regex_cache *cache;
+	struct regex_cache_entry *e;
+{
+	if (cache->head == e)
+		return;
+	if (e->prev)
+		e->prev->next = e->next;
+	if (e->next)
+		e->next->prev = e->prev;
+	else if (cache->tail == e)
+		cache->tail = e->prev;
+	e->prev = NULL;
+	e->next = cache->head;
+	if (cache->head)
+		cache->head->prev = e;
+	cache->head = e;
+	if (!cache->tail)
+		cache->tail = e;
+}
+
+/*
+ * Compiles a pattern with the interpreter's engine, charging the
+ * allocations to SEE_MEM_CODE. The result is returned through regexp
+ * so that no register-held local is live across the SEE_TRY.
+ */
+static void
+regex_compile(interp, pattern, flags, regexp)
+	struct SEE_interpreter *interp;
+	struct SEE_string *pattern;
+	int flags;
+	struct regex **regexp;
+{
+	SEE_try_context_t ctxt;
+	int category;
+
+	category = interp->mem_category;
+	interp->mem_category = SEE_MEM_CODE;
+	SEE_TRY(interp, ctxt)
+	    *regexp = (*interp->regex_engine->parse)(interp, pattern, flags);
+	interp->mem_category = category;
+	SEE_DEFAULT_CATCH(interp, ctxt);
+}
+
 /* Parses a source pattern and returns a regex structure for later use */
 struct regex *
 SEE_regex_parse(interp, pattern, flags)
@@ -18,8 +109,57 @@ SEE_regex_parse(interp, pattern, flags)
 	struct SEE_string *pattern;
 	int flags;
 {
+	struct regex_cache *cache;
+	struct regex_cache_entry *e;
+	struct regex *regex = NULL;
+	unsigned int h;
+
 	SEE_ASSERT(interp, interp->regex_engine != NULL);
-	return (*interp->regex_engine->parse)(interp, pattern, flags);
+
+	cache = (struct regex_cache *)interp->regex_cache;
+	if (!cache) {
+	    cache = SEE_NEW(interp, struct regex_cache);
+	    memset(cache, 0, sizeof *cache);
+	    interp->regex_cache = cache;
+	}
+
+	h = pattern_hash(pattern);
+	for (e = cache->head; e; e = e->next)
+	    if (e->hash == h && e->flags == flags &&
+		e->engine == interp->regex_engine &&
+		SEE_string_cmp(e->pattern, pattern) == 0)
+	    {
+		cache->hits++;
+		cache_touch(cache, e);
+		return e->regex;
+	    }
+
+	cache->misses++;
+	regex_compile(interp, pattern, flags, &regex);
+
+	if (cache->count < REGEX_CACHE_SIZE)
+	    e = &cache->entry[cache->count++];
+	else
+	    e = cache->tail;
+	e->pattern = SEE_string_dup(interp, pattern);
+	e->hash = h;
+	e->flags = flags;
+	e->engine = interp->regex_engine;
+	e->regex = regex;
+	cache_touch(cache, e);
+	return regex;
+}
+
+/* Returns the number of hits and misses in the compiled regex cache */
+void
+SEE_regex_cache_stats(interp, hitsp, missesp)
+	struct SEE_interpreter *interp;
+	unsigned long *hitsp, *missesp;
+{
+	struct regex_cache *cache = (struct regex_cache *)interp->regex_cache;
+
+	*hitsp = cache ? cache->hits : 0;
+	*missesp = cache ? cache->misses : 0;
 }
 
 /* Returns the number of capture parentheses in the compiled regex */
@@ -53,6 +193,30 @@ SEE_regex_match(interp, regex, text, start, captures)
 	return (*regex->engine->match)(interp, regex, text, start, captures);
 }
 
+/*
+ * Executes the regex on the text at each index from start to the
+ * end of the text, stopping at the first successful match.
+ * Returns true if a match was found.
+ */
+int
+SEE_regex_search(interp, regex, text, start, captures)
+	struct SEE_interpreter *interp;
+	struct regex *regex;
+	struct SEE_string *text;
+	unsigned int start;
+	struct capture *captures;
+{
+	unsigned int i;
+
+	if (regex->engine->search)
+	    return (*regex->engine->search)(interp, regex, text, start, 
+	    	captures);
+	for (i = start; i <= text->length; i++)
+	    if ((*regex->engine->match)(interp, regex, text, i, captures))
+		return 1;
+	return 0;
+}
+
 /* 
  * NOTE: Keep regex_name_list[] and regex_engine_list[] in sync!
  */
@@ -60,6 +224,7 @@ SEE_regex_match(interp, regex, text, start, captures)
 /* List of known regex engine names */
 static const char *regex_name_list[] = {
 	"ecma",
+	"nfa",
 #if WITH_PCRE
 	"pcre",
 #endif
@@ -69,6 +234,7 @@ static const char *regex_name_list[] = {
 /* List of known regex engines */
 static const struct SEE_regex_engine *regex_engine_list[] = {
 	&_SEE_ecma_regex_engine,
+	&_SEE_nfa_regex_engine,
 #if WITH_PCRE
 	&_SEE_pcre_regex_engine,
 #endif
@@ -31,9 +31,13 @@ struct SEE_regex_engine {
     int (*match)(struct SEE_interpreter *interp, 
 	    struct regex *regex, struct SEE_string *text, 
 	    unsigned int start, struct capture *captures);
+    int (*search)(struct SEE_interpreter *interp, 	/* optional */
+	    struct regex *regex, struct SEE_string *text, 
+	    unsigned int start, struct capture *captures);
 };
 
 extern const struct SEE_regex_engine _SEE_ecma_regex_engine;
+extern const struct SEE_regex_engine _SEE_nfa_regex_engine;
 
 /* Normal interface to regex operations */
 struct regex *SEE_regex_parse(struct SEE_interpreter *interp,
@@ -43,6 +47,9 @@ int SEE_regex_get_flags(struct regex *regex);
 int SEE_regex_match(struct SEE_interpreter *interp,
 	struct regex *regex, struct SEE_string *text,
 	unsigned int start, struct capture *captures);
+int SEE_regex_search(struct SEE_interpreter *interp,
+	struct regex *regex, struct SEE_string *text,
+	unsigned int start, struct capture *captures);
 
 void SEE_regex_init(void);
 
@@ -51,7 +58,24 @@ int SEE_is_RegExp(struct SEE_object *regexp);
 int SEE_RegExp_match(struct SEE_interpreter *interp, 
 	struct SEE_object *regexp, struct SEE_string *text, 
 	unsigned int start, struct capture *captures);
+int SEE_RegExp_search(struct SEE_interpreter *interp, 
+	struct SEE_object *regexp, struct SEE_string *text, 
+	unsigned int start, struct capture *captures);
 int SEE_RegExp_count_captures(struct SEE_interpreter *interp,
 	struct SEE_object *regexp);
 
+/* Iterator over the successive matches of a global RegExp */
+struct SEE_RegExp_iter {
+	struct SEE_object *regexp;
+	struct SEE_string *text;
+	unsigned int index;		/* where the next search starts */
+	unsigned int ncaptures;
+	struct capture *captures;	/* the current match */
+};
+int SEE_RegExp_iter_init(struct SEE_interpreter *interp,
+	struct SEE_RegExp_iter *iter, struct SEE_object *regexp,
+	struct SEE_string *text);
+int SEE_RegExp_iter_next(struct SEE_interpreter *interp,
+	struct SEE_RegExp_iter *iter);
+
 #endif /* _SEE_h_regex_ */
@@ -53,6 +53,19 @@
 #include "unicode.h"
 #include "stringdefs.h"
 #include "dprint.h"
+#include "casemap.h"
+#include "strsearch.h"
+
+/*
+ * The p-code can be translated into native code on x86-64 Linux.
+ * Defining SEE_NO_JIT leaves only the p-code interpreter.
+ */
+#if !defined(SEE_NO_JIT) && defined(__GNUC__) && defined(__x86_64__) && \
+    defined(__linux__)
+# define WITH_REGEX_JIT 1
+# include <stddef.h>
+# include <sys/mman.h>
+#endif
 
 /*
  * Regular expression engine.
@@ -110,8 +123,16 @@ struct charclassrange {
 
 struct charclass {
 	struct charclassrange *ranges;	/* linked list of character ranges */
+
+	/* Matcher form, built by cc_compile() */
+	unsigned char latin1[32];	/* bitmap of input chars < 0x100 */
+	SEE_unicode_t *bounds;		/* sorted range lo,hi pairs */
+	unsigned int nbounds;
 };
 
+/* Tests if input character ch (< 0x100) is in the compiled charclass */
+#define CC_LATIN1(c, ch)	(((c)->latin1[(ch) >> 3] >> ((ch) & 7)) & 1)
+
 struct ecma_regex {
 	struct regex		regex;
 	int			ncaptures, ncounters, nmarks, maxref;
@@ -123,8 +144,28 @@ struct ecma_regex {
 	unsigned int		cclen;
 	struct SEE_growable	ccgrow;
 	int			flags;
+
+	/* Start position hints computed by optimize_regex() */
+	int			anchor;		/* ANCHOR_* */
+	SEE_char_t	       *prefix;		/* literal prefix */
+	unsigned int		prefixlen;
+	SEE_char_t	       *required;	/* required literal */
+	unsigned int		requiredlen;
+	int			hasfirst;	/* first char must be in firstmap */
+	int			firsthigh;	/* chars >= 0x100 may be first */
+	unsigned char		firstmap[32];	/* possible first chars < 0x100 */
+
+	struct nfa	       *nfa;		/* linear-time matcher, or NULL */
+
+	struct jit_code	       *jit;		/* native code, or NULL */
+	unsigned int		jitruns;	/* matches run before jit */
+	int			jitfailed;	/* p-code can't be translated */
 };
 
+#define ANCHOR_NONE	0		/* match may start anywhere */
+#define ANCHOR_START	1		/* match must start at index 0 */
+#define ANCHOR_LINE	2		/* match must start at a line start */
+
 #define REGEX_CAST(aregex)   ((struct ecma_regex *)(aregex))
 
 struct recontext {
@@ -188,10 +229,13 @@ static void cc_invert(struct recontext *, struct charclass *);
 static void cc_add_cc(struct recontext *, struct charclass *, 
         struct charclass *);
 static int cc_issingle(struct charclass *);
-static SEE_uint32_t cc_count(struct charclass *);
 static int cc_cmp(struct charclass *, struct charclass *);
 static int cc_intern(struct recontext *, struct charclass *);
 static int cc_contains(struct charclass *, SEE_unicode_t);
+static void cc_compile(struct SEE_interpreter *, struct ecma_regex *,
+        struct charclass *);
+static int cc_matches(struct ecma_regex *, struct charclass *, 
+        SEE_unicode_t);
 static struct ecma_regex *regex_new(struct recontext *);
 static void code_add(struct recontext *, int);
 static void code_insert(struct recontext *, int, int);
@@ -220,6 +264,15 @@ static SEE_unicode_t Canonicalize(struct ecma_regex *, SEE_unicode_t);
 static SEE_boolean_t pcode_run(struct SEE_interpreter *, struct ecma_regex *, 
         unsigned int, struct SEE_string *, char *);
 static void optimize_regex(struct SEE_interpreter *, struct ecma_regex *);
+static int ecma_regex_match(struct SEE_interpreter *, struct regex *, 
+        struct SEE_string *, unsigned int, struct capture *);
+static unsigned int pcode_oplen(struct ecma_regex *, unsigned int);
+static unsigned int pcode_target(struct ecma_regex *, unsigned int);
+#if WITH_REGEX_JIT
+static int jit_ready(struct SEE_interpreter *, struct ecma_regex *);
+static SEE_boolean_t jit_run(struct SEE_interpreter *, struct ecma_regex *,
+        struct SEE_string *, char *);
+#endif
 
 /*------------------------------------------------------------
  * charclass
@@ -234,6 +287,8 @@ cc_new(recontext)
 
 	c = NEW1(struct charclass);
 	c->ranges = NULL;
+	c->bounds = NULL;
+	c->nbounds = 0;
 	return c;
 }
 
@@ -329,19 +384,6 @@ cc_issingle(c)
 	       r->lo + 1 == r->hi;
 }
 
-/* Return the number of characters in the class */
-static SEE_uint32_t
-cc_count(c)
-	struct charclass *c;
-{
-	SEE_uint32_t count = 0;
-	struct charclassrange *r;
-
-	for (r = c->ranges; r; r = r->next)
-	    count += r->hi - r->lo;
-	return count;
-}
-
 /* Return 0 if two charclasses are identical */
 static int
 cc_cmp(c1, c2)
@@ -400,6 +442,72 @@ cc_contains(c, ch)
 	return 0;
 }
 
+/*
+ * Compiles a charclass into the form used by the matcher: a bitmap
+ * for input characters below 0x100, and a sorted array of range
+ * bounds searched by bisection for the rest. The bitmap is indexed
+ * by the input character before canonicalization, so that matching
+ * ASCII and Latin-1 text never needs to call Canonicalize().
+ */
+static void
+cc_compile(interp, regex, c)
+	struct SEE_interpreter *interp;
+	struct ecma_regex *regex;
+	struct charclass *c;
+{
+	struct charclassrange *r;
+	SEE_unicode_t ch;
+	unsigned int n;
+
+	memset(c->latin1, 0, sizeof c->latin1);
+	if (regex->flags & FLAG_IGNORECASE) {
+	    for (ch = 0; ch < 0x100; ch++)
+		if (cc_contains(c, Canonicalize(regex, ch)))
+		    c->latin1[ch >> 3] |= 1 << (ch & 7);
+	} else
+	    for (r = c->ranges; r && r->lo < 0x100; r = r->next)
+		for (ch = r->lo; ch < r->hi && ch < 0x100; ch++)
+		    c->latin1[ch >> 3] |= 1 << (ch & 7);
+
+	n = 0;
+	for (r = c->ranges; r; r = r->next)
+	    n += 2;
+	c->bounds = SEE_NEW_STRING_ARRAY(interp, SEE_unicode_t, n);
+	c->nbounds = 0;
+	for (r = c->ranges; r; r = r->next) {
+	    c->bounds[c->nbounds++] = r->lo;
+	    c->bounds[c->nbounds++] = r->hi;
+	}
+}
+
+/*
+ * Returns true if the input character ch is in the compiled charclass.
+ * The ranges are disjoint and sorted, so ch is in the class exactly
+ * when an odd number of bounds are less than or equal to it.
+ */
+static int
+cc_matches(regex, c, ch)
+	struct ecma_regex *regex;
+	struct charclass *c;
+	SEE_unicode_t ch;
+{
+	unsigned int lo, hi, mid;
+
+	if (ch < 0x100)
+	    return CC_LATIN1(c, ch);
+	ch = Canonicalize(regex, ch);
+	lo = 0;
+	hi = c->nbounds;
+	while (lo < hi) {
+	    mid = (lo + hi) / 2;
+	    if (c->bounds[mid] <= ch)
+		lo = mid + 1;
+	    else
+		hi = mid;
+	}
+	return lo & 1;
+}
+
 #ifndef NDEBUG
 /* Print a character in a readable form. */
 static void 
@@ -488,6 +596,17 @@ regex_new(recontext)
 	SEE_GROW_INIT(recontext->interpreter, &regex->ccgrow,
 	    regex->cc, regex->cclen);
 	regex->flags = 0;
+	regex->anchor = ANCHOR_NONE;
+	regex->prefix = NULL;
+	regex->prefixlen = 0;
+	regex->required = NULL;
+	regex->requiredlen = 0;
+	regex->hasfirst = 0;
+	regex->firsthigh = 0;
+	regex->nfa = NULL;
+	regex->jit = NULL;
+	regex->jitruns = 0;
+	regex->jitfailed = 0;
 	return regex;
 }
 
@@ -541,6 +660,7 @@ ecma_regex_parse(interp, source, flags)
 {
 	struct recontext *recontext;
 	struct ecma_regex *regex;
+	unsigned int i;
 
 	recontext = SEE_NEW(interp, struct recontext);
 	recontext->interpreter = interp;
@@ -550,6 +670,8 @@ ecma_regex_parse(interp, source, flags)
 	regex->flags = flags;
 	regex->regex.interp = interp;
 	regex->regex.engine = &_SEE_ecma_regex_engine;
+	if (flags & FLAG_IGNORECASE)
+	    _SEE_canon_init();
 
 	regex->ncaptures = 1;
 	Disjunction_parse(recontext);
@@ -572,6 +694,9 @@ ecma_regex_parse(interp, source, flags)
 		regex->ncounters * sizeof (int) + 
 		regex->nmarks * sizeof (int);
 
+	for (i = 0; i < regex->cclen; i++)
+	    cc_compile(interp, regex, regex->cc[i]);
+
 	optimize_regex(interp, regex);
 
 #ifndef NDEBUG
@@ -1028,6 +1153,9 @@ Atom_parse(recontext)
 		    return;
 		} 
 		c = ClassEscape_parse(recontext);
+		if ((recontext->regex->flags & FLAG_IGNORECASE) &&
+		    cc_issingle(c))
+			c = CanonicalizeClass(recontext, c);
 		break;
 	case '[':
 		c = CharacterClass_parse(recontext);
@@ -1191,9 +1319,10 @@ ClassAtom_parse(recontext)
 }
 
 /*
- * Convert the charclass into a canonicalised version. (SLOW!)
- * !!!Every character in the class has to be individually canonicalized!!!
- * !!!OUCH!!!OUCH!!!I!HATE!YOU!ALL!!!
+ * Convert the charclass into a canonicalised version. Each range is
+ * split into runs of characters whose canonical forms are also
+ * consecutive, so that uncased parts of the class (and every
+ * character beyond the BMP) are copied over as whole ranges.
  */
 static struct charclass *
 CanonicalizeClass(recontext, c)
@@ -1202,29 +1331,20 @@ CanonicalizeClass(recontext, c)
 {
   struct charclass *ccanon;
   struct charclassrange *r;
-  SEE_unicode_t ch, uch;
-
-  if (cc_count(c) > (SEE_uint32_t)~0 / 2) {
-	CC_INVERT(c);
-	ccanon = CanonicalizeClass(recontext, c);
-	CC_INVERT(ccanon);
-	return ccanon;
-  }
-
-  /*
-   * Evil hack: if the charclass range includes ['A'-0xEFFFF], then
-   * there is no need to canonicalize because every uppercase character
-   * is already there.
-   */
-  for (r = c->ranges; r; r = r->next)
-      if (r->lo <= 'A' && r->hi > 0xf0000)
-	return c;
+  SEE_unicode_t lo, hi, ulo;
 
   ccanon = CC_NEW();
   for (r = c->ranges; r; r = r->next)
-     for (ch = r->lo; ch < r->hi; ch++) {
-	uch = UNICODE_TOUPPER(ch);
-	CC_ADDCHAR(ccanon, uch);
+     for (lo = r->lo; lo < r->hi; lo = hi) {
+	if (lo >= 0x10000) {
+	    CC_ADDRANGE(ccanon, lo, r->hi - 1);
+	    break;
+	}
+	ulo = CASEMAP_CANON(lo);
+	for (hi = lo + 1; hi < r->hi && hi < 0x10000 &&
+	    CASEMAP_CANON(hi) == ulo + (hi - lo); hi++)
+	    ;
+	CC_ADDRANGE(ccanon, ulo, ulo + (hi - lo) - 1);
      }
   return ccanon;
 }
@@ -1390,11 +1510,184 @@ Canonicalize(regex, ch)
 	SEE_unicode_t ch;
 {
         if (regex->flags & FLAG_IGNORECASE)
-		return UNICODE_TOUPPER(ch);
+		return CASEMAP_UCANON(ch);
 	else
 		return ch;
 }
 
+/* Tests if a character is a line terminator (7.3) */
+#define IS_LINETERM(ch)							\
+	((ch) == 0x000a || (ch) == 0x000d || (ch) == 0x2028 || (ch) == 0x2029)
+
+/* Tests if text[e] exists and is a word character (15.10.2.6) */
+#define IsWordChar(text, e)	((e) >= 0 && (e) < (int)(text)->length && ( \
+			   ((text)->data[e] >= 'a' && (text)->data[e] <= 'z') \
+			|| ((text)->data[e] >= 'A' && (text)->data[e] <= 'Z') \
+			|| ((text)->data[e] >= '0' && (text)->data[e] <= '9') \
+			|| (text)->data[e] == '_'))
+
+/* Tests the ^ assertion at index (15.10.2.6) */
+static int
+at_line_start(regex, text, index)
+	struct ecma_regex *regex;
+	struct SEE_string *text;
+	unsigned int index;
+{
+	return index == 0 ||
+	       ((regex->flags & FLAG_MULTILINE) &&
+	        IS_LINETERM(text->data[index - 1]));
+}
+
+/* Tests the $ assertion at index (15.10.2.6) */
+static int
+at_line_end(regex, text, index)
+	struct ecma_regex *regex;
+	struct SEE_string *text;
+	unsigned int index;
+{
+	return index == text->length ||
+	       ((regex->flags & FLAG_MULTILINE) &&
+	        IS_LINETERM(text->data[index]));
+}
+
+/* Tests the \b assertion at index (15.10.2.6) */
+static int
+at_word_break(text, index)
+	struct SEE_string *text;
+	unsigned int index;
+{
+	return IsWordChar(text, (int)index - 1) != IsWordChar(text, (int)index);
+}
+
+/*
+ * The matcher is an iterative backtracking machine.
+ *
+ * Choice points (GF, NF) and assertions (AS, AF, GS, NS) push frames
+ * onto a backtrack stack. Each frame remembers the address and text
+ * index to resume at, and the height of the undo log. While there is
+ * any frame on the stack, every change to a capture, counter or mark
+ * first logs the slot's old value, so that backtracking to a frame
+ * restores the state by unwinding the log down to the frame's height.
+ *
+ * An assertion frame marks the start of a sub-match (the assertion
+ * body). When the body reaches SUCCEED, the choice points it left
+ * behind are discarded (assertions are atomic) and the assertion
+ * frame decides how to continue. If the body fails back down to the
+ * assertion frame, the frame decides how to continue instead.
+ *
+ * The number of backtracks per match attempt is limited by the
+ * interpreter's regex_backtrack_limit, so that pathological patterns
+ * raise an Error rather than running forever. The deepest stack of
+ * frames is recorded in the interpreter's regex_backtrack_peak (the
+ * native code below does not update it).
+ */
+
+#define BT_CHOICE	0xff		/* frame kind for a choice point */
+#define BT_INITIAL	32		/* frames/undo entries kept on C stack */
+
+struct btframe {
+	unsigned char kind;		/* BT_CHOICE, OP_AS, OP_AF, OP_GS or OP_NS */
+	unsigned int addr;		/* address to resume at */
+	unsigned int textpos;		/* text index to resume at */
+	unsigned int undo;		/* undo log height */
+	int assertion;			/* enclosing assertion frame, or -1 */
+};
+
+struct btundo {
+	unsigned int slot;		/* offset into state, in ints */
+	int value;			/* old value of the slot */
+};
+
+struct btstack {
+	struct btframe *frame;
+	unsigned int nframe, maxframe;
+	struct btundo *undo;
+	unsigned int nundo, maxundo;
+	struct btframe frame_init[BT_INITIAL];
+	struct btundo undo_init[BT_INITIAL];
+};
+
+/* Doubles the size of a backtrack stack array */
+static void
+bt_grow(interp, datap, maxp, elsz, init)
+	struct SEE_interpreter *interp;
+	void **datap;
+	unsigned int *maxp;
+	SEE_size_t elsz;
+	void *init;
+{
+	void *newdata;
+	unsigned int newmax = *maxp * 2;
+
+	if (newmax < *maxp || newmax > (SEE_size_t)-1 / elsz)
+	    SEE_error_throw_string(interp, interp->Error,
+		STR(regex_limit_reached));
+	newdata = SEE_malloc_string(interp, newmax * elsz);
+	memcpy(newdata, *datap, *maxp * elsz);
+	if (*datap != init)
+	    SEE_free(interp, datap);
+	*datap = newdata;
+	*maxp = newmax;
+}
+
+/* Releases any heap storage held by a backtrack stack */
+static void
+bt_release(interp, bt)
+	struct SEE_interpreter *interp;
+	struct btstack *bt;
+{
+	if (bt->frame != bt->frame_init)
+	    SEE_free(interp, (void **)&bt->frame);
+	if (bt->undo != bt->undo_init)
+	    SEE_free(interp, (void **)&bt->undo);
+}
+
+/* Unwinds the undo log down to the given height */
+static void
+bt_undo(bt, state, height)
+	struct btstack *bt;
+	char *state;
+	unsigned int height;
+{
+	int *slots = (int *)state;
+	struct btundo *u;
+
+	while (bt->nundo > height) {
+	    u = &bt->undo[--bt->nundo];
+	    slots[u->slot] = u->value;
+	}
+}
+
+/* Pushes a frame that resumes at address ra */
+#define BT_PUSH(k, ra) do {						\
+	if (bt.nframe == bt.maxframe)					\
+	    bt_grow(interp, (void **)&bt.frame, &bt.maxframe,		\
+		sizeof (struct btframe), bt.frame_init);		\
+	f = &bt.frame[bt.nframe++];					\
+	if (bt.nframe > interp->regex_backtrack_peak)			\
+	    interp->regex_backtrack_peak = bt.nframe;			\
+	f->kind = (k);							\
+	f->addr = (ra);							\
+	f->textpos = index;						\
+	f->undo = bt.nundo;						\
+	f->assertion = assertion;					\
+	if (SEE_system.periodic)					\
+	    (*SEE_system.periodic)(interp);				\
+    } while (0)
+
+/* Assigns to a state slot, logging its old value if needed */
+#define BT_SET(lv, v) do {						\
+	if (bt.nframe) {						\
+	    if (bt.nundo == bt.maxundo)					\
+		bt_grow(interp, (void **)&bt.undo, &bt.maxundo,		\
+		    sizeof (struct btundo), bt.undo_init);		\
+	    bt.undo[bt.nundo].slot = (int *)&(lv) - (int *)state;	\
+	    bt.undo[bt.nundo].value = (int)(lv);			\
+	    bt.nundo++;							\
+	}								\
+	(lv) = (v);							\
+    } while (0)
+
 static SEE_boolean_t
 pcode_run(interp, regex, addr, text, state)
 	struct SEE_interpreter *interp;
@@ -1403,15 +1696,16 @@ pcode_run(interp, regex, addr, text, state)
 	struct SEE_string *text;
 	char *state;
 {
-	SEE_boolean_t result;
 	int i=0, i2=0, i3=0;
 	unsigned int a=0;
 	unsigned char op;
 	SEE_unicode_t ch;
 	struct capture *capture;
 	int *counter, *mark, statesz;
-	unsigned int newaddr;
-	char *newstate;
+	struct btstack bt;
+	struct btframe *f;
+	int assertion = -1;		/* innermost active assertion frame */
+	int budget = interp->regex_backtrack_limit;
 
 	if (SEE_system.periodic)
 	    (*SEE_system.periodic)(interp);
@@ -1427,7 +1721,12 @@ pcode_run(interp, regex, addr, text, state)
 
 	SEE_ASSERT(interp, statesz == regex->statesz);
 
-	newstate = SEE_STRING_ALLOCA(interp, char, statesz);
+	bt.frame = bt.frame_init;
+	bt.nframe = 0;
+	bt.maxframe = BT_INITIAL;
+	bt.undo = bt.undo_init;
+	bt.nundo = 0;
+	bt.maxundo = BT_INITIAL;
 
 #define index (capture[0].end)
 
@@ -1546,12 +1845,34 @@ pcode_run(interp, regex, addr, text, state)
 
 	    switch (op) {
 
-	    case OP_FAIL:	return 0;
-	    case OP_SUCCEED:	return 1;
+	    case OP_FAIL:	goto fail;
+
+	    /* complete the whole match, or the innermost assertion body */
+	    case OP_SUCCEED:	if (assertion < 0) {
+				    bt_release(interp, &bt);
+				    return 1;
+				}
+				f = &bt.frame[assertion];
+				bt.nframe = assertion;
+				assertion = f->assertion;
+				if (f->kind == OP_AF) {
+				    bt_undo(&bt, state, f->undo);
+				    goto fail;
+				}
+				if (f->kind != OP_AS)
+				    bt_undo(&bt, state, f->undo);
+				index = f->textpos;
+				addr = f->addr;
+				break;
 
 	    /* succeed if current character matches charclass. index++ */
 	    case OP_CHAR:	if (index < text->length) {
 				    ch = text->data[index++];
+				    if (ch < 0x100) {
+					if (!CC_LATIN1(regex->cc[i], ch))
+					    goto fail;
+					break;
+				    }
 				    /* N.B. strings are UTF-16 encoded! */
 				    if ((ch & 0xfc00) == 0xd800 &&
 				      index < text->length &&
@@ -1559,169 +1880,132 @@ pcode_run(interp, regex, addr, text, state)
 					ch = (((ch & 0x3ff) << 10) |
 					      (text->data[index++] & 0x3ff)) +
 					     0x10000;
-				    ch = Canonicalize(regex, ch);
-				    if (!cc_contains(regex->cc[i], ch))
-					return 0;
+				    if (!cc_matches(regex, regex->cc[i], ch))
+					goto fail;
 				} else
-					return 0;
+					goto fail;
 				break;
 
 	    /* reset an iteration counter */
-	    case OP_ZERO:	counter[i] = 0;
+	    case OP_ZERO:	BT_SET(counter[i], 0);
 				break;
 
 	    /* fail if we havent reached a particular count */
 	    case OP_REACH:	if (counter[i] < i2)
-					return 0;
+					goto fail;
 				break;
 
 	    /* fail if we reached a particular count */
 	    case OP_NREACH:	if (counter[i] >= i2)
-					return 0;
+					goto fail;
 				break;
 
 	    /* start a capture group at current index */
-	    case OP_START:	capture[i].start = index; 
-				capture[i].end = -1; 
+	    case OP_START:	BT_SET(capture[i].start, index);
+				BT_SET(capture[i].end, -1);
 				break;
 
 	    /* finish a capture group at current index */
-	    case OP_END:	capture[i].end = index; 
+	    case OP_END:	BT_SET(capture[i].end, index);
 				break;
 
 	    /* reset the given captures - usually done at a loop start */
 	    case OP_UNDEF:	while (i < i2) {
-				   capture[i].start = -1;
-				   capture[i].end = -1;
+				   BT_SET(capture[i].start, -1);
+				   BT_SET(capture[i].end, -1);
 				   i++;
 				}
 				break;
 
 	    /* Set a mark to the current index */
-	    case OP_MARK:	mark[i] = index;
+	    case OP_MARK:	BT_SET(mark[i], index);
 				break;
 
 	    /* fail if we haven't advanced past the mark */
 	    case OP_FDIST:	if (mark[i] == index)
-					return 0;
+					goto fail;
 				break;
 
 	    /* fail if haven't advanced past mark AND counter has reached 
 	     * a limit */
 	    case OP_RDIST:	if (mark[i] == index && counter[i2] >= i3)
-					return 0;
+					goto fail;
 				break;
 
 	    /* increment counter if it is less than n. always branch */
 	    case OP_MNEXT:	if (counter[i] < i2)
-					counter[i]++;
+					BT_SET(counter[i], counter[i] + 1);
 				addr = a;
 				break;
 
 	    /* increment counter. if it is less than n, then branch */
-	    case OP_RNEXT:	counter[i]++;
+	    case OP_RNEXT:	BT_SET(counter[i], counter[i] + 1);
 				if (counter[i] < i2)
 					addr = a;
 				break;
 
 	    case OP_GOTO:	addr = a; break;
 
-	    /* operations that push state and branch for backtracking */
-	    case OP_GS:	/* greedy success */
-	    case OP_NS:	/* non-greedy success */
+	    /* try addr; on failure resume at a */
 	    case OP_GF: /* greedy fail */
-	    case OP_NF: /* greedy fail */
+				BT_PUSH(BT_CHOICE, a);
+				break;
+
+	    /* try a; on failure resume at addr */
+	    case OP_NF: /* non-greedy fail */
+				BT_PUSH(BT_CHOICE, addr);
+				addr = a;
+				break;
+
+	    /* run an assertion body, then continue at a */
+	    case OP_GS:	/* greedy success */
 	    case OP_AS: /* assert success */
 	    case OP_AF: /* assert fail */
-				newaddr = (op == OP_NS || op == OP_NF) 
-					? a : addr;
-				memcpy(newstate, state, statesz);
-				result = pcode_run(interp, regex, newaddr, 
-					text, newstate);
-				if (result) {
-				    if (op == OP_GF || op == OP_NF) {
-					memcpy(state, newstate, statesz);
-					return 1;
-				    }
-				    else if (op == OP_AF)
-					return 0;
-				    else if (op == OP_AS) {
-					int index_save = index;
-					memcpy(state, newstate, statesz);
-					index = index_save;
-					addr = a;
-				    } else if (op == OP_GS)
-					addr = a;
-				} else {
-				    if (op == OP_GS || op == OP_NS || 
-					op == OP_AS)
-					return 0;
-				    else if (op == OP_GF || op == OP_AF)
-					addr = a;
-				}
+				BT_PUSH(op, a);
+				assertion = bt.nframe - 1;
+				break;
+
+	    /* run an assertion body at a, then continue at addr */
+	    case OP_NS:	/* non-greedy success */
+				BT_PUSH(op, addr);
+				assertion = bt.nframe - 1;
+				addr = a;
 				break;
 
 	    /* succeed if we are at the beginning of a line */
-	    /* See 15.10.2.6 */
-	    case OP_BOL:	if (index == 0)			       /* ^ */
-				    ; /* succeed */
-				else if ((regex->flags & FLAG_MULTILINE) == 0)
-				    return 0;
-				else if (text->data[index-1] == 0x000a	/*LF*/
-				      || text->data[index-1] == 0x000d	/*CR*/
-				      || text->data[index-1] == 0x2028	/*LS*/
-				      || text->data[index-1] == 0x2029)	/*PS*/
-				    ; /* succeed */
-				else
-				    return 0;
+	    case OP_BOL:	if (!at_line_start(regex, text, index))
+				    goto fail;
 				break;
 
 	    /* succeed if we are at the end of a line */
-	    case OP_EOL:	if (index == text->length)	       /* $ */
-				    ; /* succeed */
-				else if ((regex->flags & FLAG_MULTILINE) == 0)
-				    return 0;
-				else if (text->data[index] == 0x000a	/*LF*/
-				      || text->data[index] == 0x000d	/*CR*/
-				      || text->data[index] == 0x2028	/*LS*/
-				      || text->data[index] == 0x2029)	/*PS*/
-				    ; /* succeed */
-				else
-				    return 0;
+	    case OP_EOL:	if (!at_line_end(regex, text, index))
+				    goto fail;
 				break;
 
-#define IsWordChar(e)	((e) >= 0 && (e) < text->length && (		  \
-			   (text->data[e] >= 'a' && text->data[e] <= 'z') \
-			|| (text->data[e] >= 'A' && text->data[e] <= 'Z') \
-			|| (text->data[e] >= '0' && text->data[e] <= '9') \
-			|| text->data[e] == '_'))
-
 	    /* succeed if we are at a word break */
-	    case OP_BRK:
-	    case OP_NBRK:
-		{		SEE_boolean_t a, b;
-				a = IsWordChar(index - 1);
-				b = IsWordChar(index);
-				if (op == OP_BRK) {
-				    if (a == b) return 0;
-				} else {
-				    if (a != b) return 0;
-				}
+	    case OP_BRK:	if (!at_word_break(text, index))
+				    goto fail;
+				break;
+
+	    /* succeed if we are not at a word break */
+	    case OP_NBRK:	if (at_word_break(text, index))
+				    goto fail;
 				break;
-		}
 
 	    /* succeed if we match a backreference */
 	    case OP_BACKREF:	if (!CAPTURE_IS_UNDEFINED(capture[i])) {
-				  int x, len, br;
+				  int len, br;
 				  br = capture[i].start;
 				  len = capture[i].end - br;
 				  if (len + index > text->length) 
-					return 0;
-				  for (x = 0; x < len; x++) 
-				    if (Canonicalize(regex, text->data[br+x]) 
-					!= Canonicalize(regex, 
-					      text->data[index+x]))
-				    return 0;
+					goto fail;
+				  if (regex->flags & FLAG_IGNORECASE) {
+				    if (_SEE_casecmp_chars(text->data + br,
+					  text->data + index, len) != 0)
+					goto fail;
+				  } else if (_SEE_chars_mismatch(text->data + br,
+					  text->data + index, len) != (unsigned int)len)
+					goto fail;
 				  index += len;
 	    			}
 				break;
@@ -1731,69 +2015,1788 @@ pcode_run(interp, regex, addr, text, state)
 			        SEE_error_throw_string(interp, interp->Error, 
 			          STR(internal_error));
 	    }
+	    continue;
+
+	fail:
+	    /* Backtrack to the most recent frame */
+	    for (;;) {
+		if (bt.nframe == 0) {
+		    bt_release(interp, &bt);
+		    return 0;
+		}
+		f = &bt.frame[--bt.nframe];
+		bt_undo(&bt, state, f->undo);
+		index = f->textpos;
+		assertion = f->assertion;
+		if (f->kind == BT_CHOICE) {
+		    if (budget >= 0 && budget-- == 0) {
+			bt_release(interp, &bt);
+			SEE_error_throw_string(interp, interp->Error,
+			    STR(regex_limit_reached));
+		    }
+		    addr = f->addr;
+		    break;
+		}
+		/* An assertion body failed */
+		if (f->kind == OP_AF) {
+		    addr = f->addr;
+		    break;
+		}
+	    }
 	}
 }
+#undef BT_SET
+#undef BT_PUSH
 #undef index
 
-/*
- * Executes the regex on the text beginning at index.
- * Returns true of a match was successful.
+#if WITH_REGEX_JIT
+/*------------------------------------------------------------
+ * Native code generation
+ *
+ * Regexs that are matched often are translated from p-code into
+ * x86-64 machine code. The translation follows the p-code one
+ * instruction at a time. Choice points use the same frame and undo
+ * log scheme as pcode_run(), kept in a jit_ctx, except that a frame
+ * resumes at a native code address. Control flow, counters, marks,
+ * captures, choice points and a CHAR on a Latin-1 character are
+ * handled inline. The generated code calls C helpers for the rarer
+ * cases: characters outside Latin-1, line and word assertions,
+ * growing the frame or undo arrays, unwinding the undo log, and
+ * calling the periodic hook.
+ *
+ * Register use in the generated code:
+ *	rbx	struct jit_ctx *
+ *	r12	current text index
+ *	r13	text data
+ *	r14	text length
+ *	r15	state (captures, counters, marks), as ints
+ *
+ * Code is written into read-write pages that are then made read-only
+ * and executable, so no page is ever writable and executable at once.
+ * Assertions and backreferences are not translated; regexs that use
+ * them stay with pcode_run().
  */
-static int
-ecma_regex_match(interp, aregex, text, index, capture_ret)
+
+struct jit_ctx;
+
+struct jit_code {
+	void *mem;			/* executable pages */
+	SEE_size_t size;
+	int (*fn)(struct jit_ctx *, long);
+};
+
+struct jitframe {
+	void *resume;			/* native address to resume at */
+	unsigned int textpos;		/* text index to resume at */
+	unsigned int undo;		/* undo log height */
+};
+
+struct jit_ctx {
+	/* Fields used by the generated code, at offsets below 128 */
+	const SEE_char_t *data;
+	long length;
+	int *state;
+	long index;			/* text index to resume at */
+	struct jitframe *frame;
+	unsigned int nframe, maxframe;
+	struct btundo *undo;
+	unsigned int nundo, maxundo;
+	int budget;
+
 	struct SEE_interpreter *interp;
-	struct regex *aregex;
+	struct ecma_regex *regex;
 	struct SEE_string *text;
-	unsigned int index;
-	struct capture *capture_ret;
+	struct jitframe frame_init[BT_INITIAL];
+	struct btundo undo_init[BT_INITIAL];
+};
+
+#define JIT_COUNTER(regex, c)	(2 * (regex)->ncaptures + (c))
+#define JIT_MARK(regex, m)	(2 * (regex)->ncaptures + 		\
+				 (regex)->ncounters + (m))
+
+/* Releases any heap storage held by a jit context */
+static void
+jit_release(ctx)
+	struct jit_ctx *ctx;
 {
-	struct ecma_regex *regex = REGEX_CAST(aregex);
-	int i, success;
-	char *state = SEE_STRING_ALLOCA(interp, char, regex->statesz);
-	struct capture *capture = (struct capture *)state;
+	if (ctx->frame != ctx->frame_init)
+	    SEE_free(ctx->interp, (void **)&ctx->frame);
+	if (ctx->undo != ctx->undo_init)
+	    SEE_free(ctx->interp, (void **)&ctx->undo);
+}
 
-#ifndef NDEBUG
-	memset(state, 0xd0, regex->statesz);		/* catch bugs */
-#endif
+/* Assigns to a state slot while there are choice points to log for */
+static void
+jit_set(ctx, slot, value)
+	struct jit_ctx *ctx;
+	unsigned int slot;
+	int value;
+{
+	if (ctx->nundo == ctx->maxundo)
+	    bt_grow(ctx->interp, (void **)&ctx->undo, &ctx->maxundo,
+		sizeof (struct btundo), ctx->undo_init);
+	ctx->undo[ctx->nundo].slot = slot;
+	ctx->undo[ctx->nundo].value = ctx->state[slot];
+	ctx->nundo++;
+	ctx->state[slot] = value;
+}
 
-	capture[0].start = index;
-	capture[0].end = index;
-	for (i = 1; i < regex->ncaptures; i++) {
-		capture[i].start = -1;
-		capture[i].end = -1;
+/*
+ * Performs a CHAR on a character of 0x100 or more, or a line or word
+ * assertion. Returns the new text index, or -1 on failure.
+ */
+static long
+jit_step(ctx, index, pc)
+	struct jit_ctx *ctx;
+	long index;
+	unsigned int pc;
+{
+	struct ecma_regex *regex = ctx->regex;
+	SEE_unicode_t ch;
+
+	switch (regex->code[pc]) {
+	case OP_CHAR:
+	    /* The generated code has checked that index < length */
+	    ch = ctx->data[index++];
+	    if ((ch & 0xfc00) == 0xd800 && index < ctx->length &&
+		(ctx->data[index] & 0xfc00) == 0xdc00)
+		ch = (((ch & 0x3ff) << 10) | (ctx->data[index++] & 0x3ff)) +
+		    0x10000;
+	    if (!cc_matches(regex, 
+	    	regex->cc[CODE_MAKEI(regex->code, pc + 1)], ch))
+		return -1;
+	    break;
+	case OP_BOL:
+	    if (!at_line_start(regex, ctx->text, index))
+		return -1;
+	    break;
+	case OP_EOL:
+	    if (!at_line_end(regex, ctx->text, index))
+		return -1;
+	    break;
+	case OP_BRK:
+	    if (!at_word_break(ctx->text, index))
+		return -1;
+	    break;
+	case OP_NBRK:
+	    if (at_word_break(ctx->text, index))
+		return -1;
+	    break;
+	default:
+	    SEE_error_throw_string(ctx->interp, ctx->interp->Error,
+		STR(internal_error));
 	}
-	success = pcode_run(interp, regex, 0, text, state);
-#ifndef NDEBUG
-        if (SEE_regex_debug) 
-		dprintf(". %s\n", success ? "success" : "failure");
-#endif
-	if (success)
-		memcpy(capture_ret, capture, 
-		    regex->ncaptures * sizeof (struct capture));
-	return success;
+	return index;
 }
 
-/*------------------------------------------------------------
- * optimizer
+/* Pushes a choice point, when the inline code can't */
+static void
+jit_push(ctx, index, resume)
+	struct jit_ctx *ctx;
+	long index;
+	void *resume;
+{
+	struct jitframe *f;
+
+	if (ctx->nframe == ctx->maxframe)
+	    bt_grow(ctx->interp, (void **)&ctx->frame, &ctx->maxframe,
+		sizeof (struct jitframe), ctx->frame_init);
+	f = &ctx->frame[ctx->nframe++];
+	f->resume = resume;
+	f->textpos = index;
+	f->undo = ctx->nundo;
+	if (SEE_system.periodic)
+	    (*SEE_system.periodic)(ctx->interp);
+}
+
+/*
+ * Pops the most recent choice point and restores the state, when the
+ * inline code can't. Returns the native address to resume at (with
+ * the text index left in ctx->index), or NULL if there are no choices
+ * left.
  */
+static void *
+jit_backtrack(ctx)
+	struct jit_ctx *ctx;
+{
+	struct jitframe *f;
+	struct btundo *u;
+
+	if (ctx->nframe == 0)
+	    return NULL;
+	f = &ctx->frame[--ctx->nframe];
+	while (ctx->nundo > f->undo) {
+	    u = &ctx->undo[--ctx->nundo];
+	    ctx->state[u->slot] = u->value;
+	}
+	if (ctx->budget >= 0 && ctx->budget-- == 0) {
+	    jit_release(ctx);
+	    SEE_error_throw_string(ctx->interp, ctx->interp->Error,
+		STR(regex_limit_reached));
+	}
+	ctx->index = f->textpos;
+	return f->resume;
+}
 
-static void
-optimize_regex(interp, regex)
+/* Code emission */
+
+#define JIT_FAIL	(-1)		/* fixup target: the fail stub */
+
+struct jit_fixup {
+	unsigned int pos;		/* offset of a rel32 field */
+	int target;			/* p-code address or JIT_FAIL */
+};
+
+struct jit_buf {
 	struct SEE_interpreter *interp;
-	struct ecma_regex *regex;
+	unsigned char *code;
+	unsigned int len;
+	struct SEE_growable grow;
+	struct jit_fixup *fixup;
+	unsigned int nfixup;
+	struct SEE_growable fixupgrow;
+};
+
+/* How jit_emit_set() computes the new value of a slot */
+#define JIT_VAL_INDEX	0		/* the current text index */
+#define JIT_VAL_IMM	1		/* a constant */
+#define JIT_VAL_INC	2		/* the slot's value plus one */
+
+/* Offsets of jit_ctx fields, as 8-bit displacements */
+#define CTX(f)		((SEE_uint64_t)offsetof(struct jit_ctx, f))
+
+static void
+jit_emit(jb, bytes, n)
+	struct jit_buf *jb;
+	const char *bytes;
+	unsigned int n;
 {
-	/*
-	 * (nothing here yet)
-	 *
-	 * possible optimisations include branch short-cuts,
-	 * and compiling the p-code to native machine instructions.
-	 */
+	unsigned int pos = jb->len;
+
+	SEE_GROW_TO(jb->interp, &jb->grow, pos + n);
+	memcpy(jb->code + pos, bytes, n);
 }
 
-const struct SEE_regex_engine _SEE_ecma_regex_engine = {
-	NULL,				/* no init */
-	ecma_regex_parse,
+/* Appends a little-endian value of n bytes */
+static void
+jit_emit_le(jb, v, n)
+	struct jit_buf *jb;
+	SEE_uint64_t v;
+	unsigned int n;
+{
+	char b[8];
+	unsigned int i;
+
+	for (i = 0; i < n; i++, v >>= 8)
+	    b[i] = (char)(v & 0xff);
+	jit_emit(jb, b, n);
+}
+
+#define EMIT(jb, s)		jit_emit(jb, s, sizeof s - 1)
+#define EMIT8(jb, v)		jit_emit_le(jb, v, 1)
+#define EMIT32(jb, v)		jit_emit_le(jb, (SEE_uint32_t)(v), 4)
+
+/* Appends a rel32 field to be resolved later to the target */
+static void
+jit_emit_fixup(jb, target)
+	struct jit_buf *jb;
+	int target;
+{
+	unsigned int n = jb->nfixup;
+
+	SEE_GROW_TO(jb->interp, &jb->fixupgrow, n + 1);
+	jb->fixup[n].pos = jb->len;
+	jb->fixup[n].target = target;
+	EMIT32(jb, 0);
+}
+
+/* Sets a rel32 field to jump to offset to */
+static void
+jit_patch(jb, pos, to)
+	struct jit_buf *jb;
+	unsigned int pos, to;
+{
+	SEE_int32_t rel = (SEE_int32_t)to - (SEE_int32_t)(pos + 4);
+	unsigned int i;
+
+	for (i = 0; i < 4; i++)
+	    jb->code[pos + i] = ((SEE_uint32_t)rel >> (8 * i)) & 0xff;
+}
+
+/* A rel32 field for a forward jump within the code, patched later */
+#define JIT_LOCAL(jb)		(EMIT32(jb, 0), (jb)->len - 4)
+#define JIT_HERE(jb, pos)	jit_patch(jb, pos, (jb)->len)
+
+/* mov rax,fn; call rax */
+static void
+jit_emit_call(jb, fn)
+	struct jit_buf *jb;
+	void *fn;
+{
+	EMIT(jb, "\x48\xb8");
+	jit_emit_le(jb, (SEE_uint64_t)(SEE_size_t)fn, 8);
+	EMIT(jb, "\xff\xd0");
+}
+
+/* Calls jit_step(ctx, index, pc), and fails or updates the index */
+static void
+jit_emit_step(jb, pc)
+	struct jit_buf *jb;
+	unsigned int pc;
+{
+	EMIT(jb, "\x48\x89\xdf\x4c\x89\xe6\xba");	/* mov rdi,rbx; */
+	EMIT32(jb, pc);					/* mov rsi,r12; mov edx */
+	jit_emit_call(jb, (void *)jit_step);
+	EMIT(jb, "\x48\x85\xc0\x0f\x88");		/* test rax,rax; js */
+	jit_emit_fixup(jb, JIT_FAIL);
+	EMIT(jb, "\x49\x89\xc4");			/* mov r12,rax */
+}
+
+/*
+ * Assigns to a state slot. The slot is stored into directly when there
+ * are no choice points; otherwise jit_set() logs the old value.
+ */
+static void
+jit_emit_set(jb, slot, how, imm)
+	struct jit_buf *jb;
+	unsigned int slot;
+	int how, imm;
+{
+	unsigned int logged, done;
+
+	EMIT(jb, "\x83\x7b"); EMIT8(jb, CTX(nframe));	/* cmp [rbx+d],0 */
+	EMIT(jb, "\x00\x0f\x85");			/* jne logged */
+	logged = JIT_LOCAL(jb);
+	switch (how) {
+	case JIT_VAL_INDEX:
+	    EMIT(jb, "\x45\x89\xa7");			/* mov [r15+d],r12d */
+	    EMIT32(jb, slot * sizeof (int));
+	    break;
+	case JIT_VAL_IMM:
+	    EMIT(jb, "\x41\xc7\x87");			/* mov [r15+d],imm */
+	    EMIT32(jb, slot * sizeof (int));
+	    EMIT32(jb, imm);
+	    break;
+	case JIT_VAL_INC:
+	    EMIT(jb, "\x41\xff\x87");			/* inc [r15+d] */
+	    EMIT32(jb, slot * sizeof (int));
+	    break;
+	}
+	EMIT(jb, "\xe9");				/* jmp done */
+	done = JIT_LOCAL(jb);
+
+	JIT_HERE(jb, logged);
+	EMIT(jb, "\x48\x89\xdf\xbe");			/* mov rdi,rbx; */
+	EMIT32(jb, slot);				/* mov esi,slot */
+	switch (how) {
+	case JIT_VAL_INDEX:
+	    EMIT(jb, "\x44\x89\xe2");			/* mov edx,r12d */
+	    break;
+	case JIT_VAL_IMM:
+	    EMIT(jb, "\xba");				/* mov edx,imm */
+	    EMIT32(jb, imm);
+	    break;
+	case JIT_VAL_INC:
+	    EMIT(jb, "\x41\x8b\x97");			/* mov edx,[r15+d] */
+	    EMIT32(jb, slot * sizeof (int));
+	    EMIT(jb, "\x83\xc2\x01");			/* add edx,1 */
+	    break;
+	}
+	jit_emit_call(jb, (void *)jit_set);
+	JIT_HERE(jb, done);
+}
+
+/* Compares a counter with n: cmp dword [r15+d],n */
+static void
+jit_emit_cmp_counter(jb, regex, c, n)
+	struct jit_buf *jb;
+	struct ecma_regex *regex;
+	int c, n;
+{
+	EMIT(jb, "\x41\x81\xbf");
+	EMIT32(jb, JIT_COUNTER(regex, c) * sizeof (int));
+	EMIT32(jb, n);
+}
+
+/* Compares a mark with the index: cmp [r15+d],r12d */
+static void
+jit_emit_cmp_mark(jb, regex, m)
+	struct jit_buf *jb;
+	struct ecma_regex *regex;
+	int m;
+{
+	EMIT(jb, "\x45\x39\xa7");
+	EMIT32(jb, JIT_MARK(regex, m) * sizeof (int));
+}
+
+/* Pushes a choice point that resumes at p-code address resume */
+static void
+jit_emit_push(jb, resume)
+	struct jit_buf *jb;
+	unsigned int resume;
+{
+	unsigned int slow, slow2, done;
+
+	EMIT(jb, "\x48\xb8");				/* mov rax,&periodic */
+	jit_emit_le(jb, (SEE_uint64_t)(SEE_size_t)&SEE_system.periodic, 8);
+	EMIT(jb, "\x48\x83\x38\x00\x0f\x85");		/* cmp [rax],0; jne */
+	slow = JIT_LOCAL(jb);
+	EMIT(jb, "\x8b\x43"); EMIT8(jb, CTX(nframe));	/* mov eax,nframe */
+	EMIT(jb, "\x3b\x43"); EMIT8(jb, CTX(maxframe)); /* cmp eax,maxframe */
+	EMIT(jb, "\x0f\x83");				/* jae slow */
+	slow2 = JIT_LOCAL(jb);
+	EMIT(jb, "\x48\x8b\x4b"); EMIT8(jb, CTX(frame));/* mov rcx,frame */
+	EMIT(jb, "\x89\xc2\x48\xc1\xe2\x04");		/* rcx += eax * 16 */
+	EMIT(jb, "\x48\x01\xd1");
+	EMIT(jb, "\x48\x8d\x15");			/* lea rdx,[resume] */
+	jit_emit_fixup(jb, resume);
+	EMIT(jb, "\x48\x89\x11");			/* mov [rcx],rdx */
+	EMIT(jb, "\x44\x89\x61");			/* mov [rcx+d],r12d */
+	EMIT8(jb, offsetof(struct jitframe, textpos));
+	EMIT(jb, "\x8b\x53"); EMIT8(jb, CTX(nundo));	/* mov edx,nundo */
+	EMIT(jb, "\x89\x51");				/* mov [rcx+d],edx */
+	EMIT8(jb, offsetof(struct jitframe, undo));
+	EMIT(jb, "\xff\xc0\x89\x43"); EMIT8(jb, CTX(nframe)); /* nframe++ */
+	EMIT(jb, "\xe9");
+	done = JIT_LOCAL(jb);
+
+	JIT_HERE(jb, slow);
+	JIT_HERE(jb, slow2);
+	EMIT(jb, "\x48\x89\xdf\x4c\x89\xe6");		/* mov rdi,rbx; */
+	EMIT(jb, "\x48\x8d\x15");			/* mov rsi,r12; */
+	jit_emit_fixup(jb, resume);			/* lea rdx,[resume] */
+	jit_emit_call(jb, (void *)jit_push);
+	JIT_HERE(jb, done);
+}
+
+/* pop r15; pop r14; pop r13; pop r12; pop rbx; ret */
+#define EMIT_EPILOGUE(jb)	EMIT(jb, "\x41\x5f\x41\x5e\x41\x5d\x41\x5c\x5b\xc3")
+
+/*
+ * Emits the fail stub. The most recent choice point is popped inline
+ * when it has nothing to undo and the backtrack budget is not used up.
+ */
+static void
+jit_emit_fail(jb)
+	struct jit_buf *jb;
+{
+	unsigned int none, slow, slow2, nodec, none2;
+
+	EMIT(jb, "\x8b\x43"); EMIT8(jb, CTX(nframe));	/* mov eax,nframe */
+	EMIT(jb, "\x85\xc0\x0f\x84");			/* test eax,eax; jz */
+	none = JIT_LOCAL(jb);
+	EMIT(jb, "\xff\xc8");				/* dec eax */
+	EMIT(jb, "\x48\x8b\x4b"); EMIT8(jb, CTX(frame));/* mov rcx,frame */
+	EMIT(jb, "\x89\xc2\x48\xc1\xe2\x04");		/* rcx += eax * 16 */
+	EMIT(jb, "\x48\x01\xd1");
+	EMIT(jb, "\x8b\x51");				/* mov edx,[rcx+d] */
+	EMIT8(jb, offsetof(struct jitframe, undo));
+	EMIT(jb, "\x3b\x53"); EMIT8(jb, CTX(nundo));	/* cmp edx,nundo */
+	EMIT(jb, "\x0f\x85");				/* jne slow */
+	slow = JIT_LOCAL(jb);
+	EMIT(jb, "\x8b\x73"); EMIT8(jb, CTX(budget));	/* mov esi,budget */
+	EMIT(jb, "\x85\xf6\x0f\x84");			/* test esi,esi; jz */
+	slow2 = JIT_LOCAL(jb);
+	EMIT(jb, "\x0f\x88");				/* js nodec */
+	nodec = JIT_LOCAL(jb);
+	EMIT(jb, "\xff\xce\x89\x73"); EMIT8(jb, CTX(budget)); /* budget-- */
+	JIT_HERE(jb, nodec);
+	EMIT(jb, "\x89\x43"); EMIT8(jb, CTX(nframe));	/* mov nframe,eax */
+	EMIT(jb, "\x44\x8b\x61");			/* mov r12d,[rcx+d] */
+	EMIT8(jb, offsetof(struct jitframe, textpos));
+	EMIT(jb, "\xff\x21");				/* jmp [rcx] */
+
+	JIT_HERE(jb, slow);
+	JIT_HERE(jb, slow2);
+	EMIT(jb, "\x48\x89\xdf");			/* mov rdi,rbx */
+	jit_emit_call(jb, (void *)jit_backtrack);
+	EMIT(jb, "\x48\x85\xc0\x0f\x84");		/* test rax,rax; jz */
+	none2 = JIT_LOCAL(jb);
+	EMIT(jb, "\x4c\x8b\x63"); EMIT8(jb, CTX(index)); /* mov r12,index */
+	EMIT(jb, "\xff\xe0");				/* jmp rax */
+
+	JIT_HERE(jb, none);
+	JIT_HERE(jb, none2);
+	EMIT(jb, "\x31\xc0");				/* xor eax,eax */
+	EMIT_EPILOGUE(jb);
+}
+
+/* Releases the executable pages when the regex is collected */
+static void
+jit_finalize(interp, p, closure)
+	struct SEE_interpreter *interp;
+	void *p, *closure;
+{
+	struct jit_code *jc = (struct jit_code *)p;
+
+	if (jc->mem)
+	    munmap(jc->mem, jc->size);
+	jc->mem = NULL;
+}
+
+/* Translates the regex's p-code into native code, or returns NULL */
+static struct jit_code *
+jit_compile(interp, regex)
+	struct SEE_interpreter *interp;
+	struct ecma_regex *regex;
+{
+	struct jit_buf jb;
+	struct jit_code *jc;
+	unsigned int *label, addr, next, i, pos, slow;
+	unsigned char *code = regex->code;
+	int a = 0, i1, i2, i3;
+	SEE_size_t pagesz = 4096;
+	void *mem;
+
+	for (addr = 0; addr < regex->codelen; addr += pcode_oplen(regex, addr))
+	    switch (code[addr]) {
+	    case OP_AS: case OP_AF: case OP_GS: case OP_NS: case OP_BACKREF:
+		return NULL;
+	    }
+
+	jb.interp = interp;
+	SEE_GROW_INIT(interp, &jb.grow, jb.code, jb.len);
+	jb.grow.is_string = 1;
+	SEE_GROW_INIT(interp, &jb.fixupgrow, jb.fixup, jb.nfixup);
+	jb.fixupgrow.is_string = 1;
+	label = SEE_NEW_STRING_ARRAY(interp, unsigned int, regex->codelen + 1);
+
+	/* push rbx,r12,r13,r14,r15; load the registers from the context */
+	EMIT(&jb, "\x53\x41\x54\x41\x55\x41\x56\x41\x57");
+	EMIT(&jb, "\x48\x89\xfb\x49\x89\xf4");
+	EMIT(&jb, "\x4c\x8b\x6b"); EMIT8(&jb, CTX(data));
+	EMIT(&jb, "\x4c\x8b\x73"); EMIT8(&jb, CTX(length));
+	EMIT(&jb, "\x4c\x8b\x7b"); EMIT8(&jb, CTX(state));
+
+	for (addr = 0; addr < regex->codelen; addr = next) {
+	    label[addr] = jb.len;
+	    next = addr + pcode_oplen(regex, addr);
+	    i1 = i2 = i3 = 0;
+	    if (next > addr + 1)
+		i1 = CODE_MAKEI(code, addr + 1);
+	    if (next > addr + 1 + CODE_SZI)
+		i2 = CODE_MAKEI(code, addr + 1 + CODE_SZI);
+	    if (code[addr] == OP_RDIST)
+		i3 = CODE_MAKEI(code, addr + 1 + 2 * CODE_SZI);
+	    switch (code[addr]) {
+	    case OP_GOTO: case OP_GF: case OP_NF: case OP_MNEXT: case OP_RNEXT:
+		a = pcode_target(regex, addr);
+		break;
+	    }
+
+	    switch (code[addr]) {
+	    case OP_FAIL:
+		EMIT(&jb, "\xe9");			/* jmp fail */
+		jit_emit_fixup(&jb, JIT_FAIL);
+		break;
+
+	    case OP_SUCCEED:
+		EMIT(&jb, "\x45\x89\x67");		/* mov [r15+d],r12d */
+		EMIT8(&jb, offsetof(struct capture, end));
+		EMIT(&jb, "\xb8\x01\x00\x00\x00");	/* mov eax,1 */
+		EMIT_EPILOGUE(&jb);
+		break;
+
+	    case OP_CHAR:
+		EMIT(&jb, "\x4d\x39\xf4\x0f\x83");	/* cmp r12,r14; jae */
+		jit_emit_fixup(&jb, JIT_FAIL);
+		/* movzx eax,word [r13+r12*2]; cmp eax,0x100; jae slow */
+		EMIT(&jb, "\x43\x0f\xb7\x44\x65\x00"
+			  "\x3d\x00\x01\x00\x00\x0f\x83");
+		slow = JIT_LOCAL(&jb);
+		EMIT(&jb, "\x48\xb9");			/* mov rcx,bitmap */
+		jit_emit_le(&jb, (SEE_uint64_t)(SEE_size_t)
+		    regex->cc[i1]->latin1, 8);
+		EMIT(&jb, "\x0f\xa3\x01\x0f\x83");	/* bt [rcx],eax; jnc */
+		jit_emit_fixup(&jb, JIT_FAIL);
+		EMIT(&jb, "\x49\xff\xc4\xe9");		/* inc r12; jmp */
+		pos = JIT_LOCAL(&jb);
+		JIT_HERE(&jb, slow);
+		jit_emit_step(&jb, addr);
+		JIT_HERE(&jb, pos);
+		break;
+
+	    case OP_ZERO:
+		jit_emit_set(&jb, JIT_COUNTER(regex, i1), JIT_VAL_IMM, 0);
+		break;
+
+	    case OP_REACH:
+	    case OP_NREACH:
+		jit_emit_cmp_counter(&jb, regex, i1, i2);
+		if (code[addr] == OP_REACH)
+		    EMIT(&jb, "\x0f\x8c");		/* jl fail */
+		else
+		    EMIT(&jb, "\x0f\x8d");		/* jge fail */
+		jit_emit_fixup(&jb, JIT_FAIL);
+		break;
+
+	    case OP_START:
+		jit_emit_set(&jb, 2 * i1, JIT_VAL_INDEX, 0);
+		jit_emit_set(&jb, 2 * i1 + 1, JIT_VAL_IMM, -1);
+		break;
+
+	    case OP_END:
+		jit_emit_set(&jb, 2 * i1 + 1, JIT_VAL_INDEX, 0);
+		break;
+
+	    case OP_UNDEF:
+		for (; i1 < i2; i1++) {
+		    jit_emit_set(&jb, 2 * i1, JIT_VAL_IMM, -1);
+		    jit_emit_set(&jb, 2 * i1 + 1, JIT_VAL_IMM, -1);
+		}
+		break;
+
+	    case OP_MARK:
+		jit_emit_set(&jb, JIT_MARK(regex, i1), JIT_VAL_INDEX, 0);
+		break;
+
+	    case OP_FDIST:
+		jit_emit_cmp_mark(&jb, regex, i1);
+		EMIT(&jb, "\x0f\x84");			/* je fail */
+		jit_emit_fixup(&jb, JIT_FAIL);
+		break;
+
+	    case OP_RDIST:
+		jit_emit_cmp_mark(&jb, regex, i1);
+		EMIT(&jb, "\x0f\x85");			/* jne ok */
+		pos = JIT_LOCAL(&jb);
+		jit_emit_cmp_counter(&jb, regex, i2, i3);
+		EMIT(&jb, "\x0f\x8d");			/* jge fail */
+		jit_emit_fixup(&jb, JIT_FAIL);
+		JIT_HERE(&jb, pos);
+		break;
+
+	    case OP_MNEXT:
+		jit_emit_cmp_counter(&jb, regex, i1, i2);
+		EMIT(&jb, "\x0f\x8d");			/* jge a */
+		jit_emit_fixup(&jb, a);
+		jit_emit_set(&jb, JIT_COUNTER(regex, i1), JIT_VAL_INC, 0);
+		EMIT(&jb, "\xe9");			/* jmp a */
+		jit_emit_fixup(&jb, a);
+		break;
+
+	    case OP_RNEXT:
+		jit_emit_set(&jb, JIT_COUNTER(regex, i1), JIT_VAL_INC, 0);
+		jit_emit_cmp_counter(&jb, regex, i1, i2);
+		EMIT(&jb, "\x0f\x8c");			/* jl a */
+		jit_emit_fixup(&jb, a);
+		break;
+
+	    case OP_GOTO:
+		EMIT(&jb, "\xe9");
+		jit_emit_fixup(&jb, a);
+		break;
+
+	    case OP_GF:
+		jit_emit_push(&jb, a);
+		break;
+
+	    case OP_NF:
+		jit_emit_push(&jb, next);
+		EMIT(&jb, "\xe9");
+		jit_emit_fixup(&jb, a);
+		break;
+
+	    case OP_BOL: case OP_EOL: case OP_BRK: case OP_NBRK:
+		jit_emit_step(&jb, addr);
+		break;
+
+	    default:
+		SEE_error_throw_string(interp, interp->Error,
+		    STR(internal_error));
+	    }
+	}
+
+	label[regex->codelen] = jb.len;
+	jit_emit_fail(&jb);
+
+	for (i = 0; i < jb.nfixup; i++)
+	    jit_patch(&jb, jb.fixup[i].pos, label[jb.fixup[i].target ==
+		JIT_FAIL ? regex->codelen : (unsigned int)jb.fixup[i].target]);
+
+	/* Copy into fresh pages, then make them executable */
+	jc = SEE_NEW_FINALIZE(interp, struct jit_code, jit_finalize, NULL);
+	jc->mem = NULL;
+	jc->size = (jb.len + pagesz - 1) / pagesz * pagesz;
+	mem = mmap(NULL, jc->size, PROT_READ | PROT_WRITE, 
+	    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mem == MAP_FAILED)
+	    return NULL;
+	memcpy(mem, jb.code, jb.len);
+	if (mprotect(mem, jc->size, PROT_READ | PROT_EXEC) != 0) {
+	    munmap(mem, jc->size);
+	    return NULL;
+	}
+	jc->mem = mem;
+	jc->fn = (int (*)(struct jit_ctx *, long))mem;
+
+	SEE_free(interp, (void **)&jb.code);
+	if (jb.fixup)
+	    SEE_free(interp, (void **)&jb.fixup);
+	SEE_free(interp, (void **)&label);
+	return jc;
+}
+
+/*
+ * Returns true if the regex should be matched with native code,
+ * translating it once it has been matched often enough.
+ */
+static int
+jit_ready(interp, regex)
+	struct SEE_interpreter *interp;
+	struct ecma_regex *regex;
+{
+	if (interp->regex_jit_threshold < 0)
+	    return 0;
+#ifndef NDEBUG
+	if (SEE_regex_debug)
+	    return 0;
+#endif
+	if (regex->jit)
+	    return 1;
+	if (regex->jitfailed || 
+	    regex->jitruns++ < (unsigned int)interp->regex_jit_threshold)
+	    return 0;
+	regex->jit = jit_compile(interp, regex);
+	if (!regex->jit)
+	    regex->jitfailed = 1;
+	return regex->jit != NULL;
+}
+
+/* Runs the native code for the regex, like pcode_run() from address 0 */
+static SEE_boolean_t
+jit_run(interp, regex, text, state)
+	struct SEE_interpreter *interp;
+	struct ecma_regex *regex;
+	struct SEE_string *text;
+	char *state;
+{
+	struct jit_ctx ctx;
+	int success;
+
+	if (SEE_system.periodic)
+	    (*SEE_system.periodic)(interp);
+
+	ctx.data = text->data;
+	ctx.length = text->length;
+	ctx.state = (int *)state;
+	ctx.interp = interp;
+	ctx.regex = regex;
+	ctx.text = text;
+	ctx.budget = interp->regex_backtrack_limit;
+	ctx.frame = ctx.frame_init;
+	ctx.nframe = 0;
+	ctx.maxframe = BT_INITIAL;
+	ctx.undo = ctx.undo_init;
+	ctx.nundo = 0;
+	ctx.maxundo = BT_INITIAL;
+
+	success = (*regex->jit->fn)(&ctx, 
+	    ((struct capture *)state)[0].end);
+	jit_release(&ctx);
+	return success;
+}
+#endif /* WITH_REGEX_JIT */
+
+/*
+ * Executes the regex on the text beginning at index.
+ * Returns true of a match was successful.
+ */
+static int
+ecma_regex_match(interp, aregex, text, index, capture_ret)
+	struct SEE_interpreter *interp;
+	struct regex *aregex;
+	struct SEE_string *text;
+	unsigned int index;
+	struct capture *capture_ret;
+{
+	struct ecma_regex *regex = REGEX_CAST(aregex);
+	int i, success;
+	char *state = SEE_STRING_ALLOCA(interp, char, regex->statesz);
+	struct capture *capture = (struct capture *)state;
+
+#ifndef NDEBUG
+	memset(state, 0xd0, regex->statesz);		/* catch bugs */
+#endif
+
+	capture[0].start = index;
+	capture[0].end = index;
+	for (i = 1; i < regex->ncaptures; i++) {
+		capture[i].start = -1;
+		capture[i].end = -1;
+	}
+#if WITH_REGEX_JIT
+	if (jit_ready(interp, regex))
+	    success = jit_run(interp, regex, text, state);
+	else
+#endif
+	success = pcode_run(interp, regex, 0, text, state);
+#ifndef NDEBUG
+        if (SEE_regex_debug) 
+		dprintf(". %s\n", success ? "success" : "failure");
+#endif
+	if (success)
+		memcpy(capture_ret, capture, 
+		    regex->ncaptures * sizeof (struct capture));
+	return success;
+}
+
+/*------------------------------------------------------------
+ * optimizer
+ *
+ * The optimizer analyses the p-code to find where a match could
+ * possibly start, so that ecma_regex_search() can skip over the start
+ * positions where pcode_run() would certainly fail:
+ *
+ *   anchor   - every match starts at index 0 (or at a line start
+ *              when the 'm' flag is given)
+ *   prefix   - a literal string that every match starts with
+ *   first    - a set of characters that every match starts with
+ *   required - a literal string that every match contains
+ *
+ * With the 'i' flag, the literals are canonical characters and are
+ * found with _SEE_strcasesearch().
+ *
+ * The analyses walk the 'top-level' control flow graph of the p-code.
+ * Assertion bodies are not part of the graph: an assertion is treated
+ * as a branch straight to its continuation.
+ */
+
+#define OPTIMIZE_MAXCODE 4096	/* largest p-code searched for literals */
+
+/* Results from a walk visitor */
+#define WALK_NEXT	0	/* follow the successors of this instruction */
+#define WALK_STOP	1	/* don't follow this path any further */
+#define WALK_ABORT	2	/* abandon the walk */
+
+struct walk {
+	struct ecma_regex *regex;
+	unsigned char *seen;		/* instructions already visited */
+	unsigned int *work;		/* instructions still to visit */
+	unsigned int from;		/* instruction to start walking from */
+	unsigned int avoid;		/* instruction that blocks paths */
+};
+
+/* Returns the length of the instruction at addr */
+static unsigned int
+pcode_oplen(regex, addr)
+	struct ecma_regex *regex;
+	unsigned int addr;
+{
+	switch (regex->code[addr]) {
+	case OP_CHAR:	case OP_ZERO:	case OP_START:	case OP_END:
+	case OP_MARK:	case OP_FDIST:	case OP_BACKREF:
+		return 1 + CODE_SZI;
+	case OP_REACH:	case OP_NREACH:	case OP_UNDEF:
+		return 1 + 2 * CODE_SZI;
+	case OP_RDIST:
+		return 1 + 3 * CODE_SZI;
+	case OP_MNEXT:	case OP_RNEXT:
+		return 1 + 2 * CODE_SZI + CODE_SZA;
+	case OP_GOTO:	case OP_GS:	case OP_NS:	case OP_GF:
+	case OP_NF:	case OP_AS:	case OP_AF:
+		return 1 + CODE_SZA;
+	default:
+		return 1;
+	}
+}
+
+/* Returns the branch address of the instruction at addr */
+static unsigned int
+pcode_target(regex, addr)
+	struct ecma_regex *regex;
+	unsigned int addr;
+{
+	if (regex->code[addr] == OP_MNEXT || regex->code[addr] == OP_RNEXT)
+		addr += 2 * CODE_SZI;
+	return CODE_MAKEA(regex->code, addr + 1);
+}
+
+/*
+ * Calls visit() once for each instruction reachable from w->from
+ * along the top-level paths. Returns false if the walk was abandoned.
+ */
+static int
+pcode_walk(w, visit, closure)
+	struct walk *w;
+	int (*visit)(struct walk *, unsigned int, void *);
+	void *closure;
+{
+	struct ecma_regex *regex = w->regex;
+	unsigned int nwork = 0, addr;
+
+#define WALK_PUSH(a) do {						\
+	unsigned int _a = (a);						\
+	if (_a < regex->codelen && !w->seen[_a]) {			\
+	    w->seen[_a] = 1;						\
+	    w->work[nwork++] = _a;					\
+	}								\
+    } while (0)
+
+	memset(w->seen, 0, regex->codelen);
+	WALK_PUSH(w->from);
+	while (nwork) {
+	    addr = w->work[--nwork];
+	    switch ((*visit)(w, addr, closure)) {
+	    case WALK_ABORT:	return 0;
+	    case WALK_STOP:	continue;
+	    }
+	    switch (regex->code[addr]) {
+	    case OP_FAIL:
+	    case OP_SUCCEED:
+		break;
+	    case OP_GOTO:
+	    case OP_MNEXT:
+	    case OP_AS:
+	    case OP_AF:
+		WALK_PUSH(pcode_target(regex, addr));
+		break;
+	    case OP_GF:
+	    case OP_NF:
+	    case OP_RNEXT:
+		WALK_PUSH(addr + pcode_oplen(regex, addr));
+		WALK_PUSH(pcode_target(regex, addr));
+		break;
+	    case OP_GS:
+	    case OP_NS:
+		return 0;		/* not generated by the parser */
+	    default:
+		WALK_PUSH(addr + pcode_oplen(regex, addr));
+	    }
+	}
+	return 1;
+#undef WALK_PUSH
+}
+
+/* Visitor that aborts on any path that can start without a ^ */
+static int
+anchor_visit(w, addr, closure)
+	struct walk *w;
+	unsigned int addr;
+	void *closure;
+{
+	switch (w->regex->code[addr]) {
+	case OP_BOL:
+	case OP_FAIL:
+		return WALK_STOP;
+	case OP_CHAR:
+	case OP_BACKREF:
+	case OP_SUCCEED:
+		return WALK_ABORT;
+	default:
+		return WALK_NEXT;
+	}
+}
+
+/* Visitor that collects the first characters of all paths */
+static int
+first_visit(w, addr, closure)
+	struct walk *w;
+	unsigned int addr;
+	void *closure;
+{
+	struct ecma_regex *regex = w->regex;
+	struct charclass *c;
+	struct charclassrange *r;
+	unsigned int i;
+	SEE_unicode_t ch;
+
+	switch (regex->code[addr]) {
+	case OP_FAIL:
+		return WALK_STOP;
+	case OP_CHAR:
+		c = regex->cc[CODE_MAKEI(regex->code, addr + 1)];
+		for (i = 0; i < sizeof regex->firstmap; i++)
+		    regex->firstmap[i] |= c->latin1[i];
+		for (r = c->ranges; r; r = r->next)
+		    if (r->hi > 0x100)
+			regex->firsthigh = 1;
+		/* Some chars >= 0x100 canonicalize to Latin-1 ones */
+		if (regex->flags & FLAG_IGNORECASE)
+		    for (r = c->ranges; r && r->lo < 0x100; r = r->next)
+			for (ch = r->lo; ch < r->hi && ch < 0x100; ch++)
+			    if (CASEMAP_CANON_MULTI(ch))
+				regex->firsthigh = 1;
+		return WALK_STOP;
+	case OP_BACKREF:
+	case OP_SUCCEED:
+		return WALK_ABORT;
+	default:
+		return WALK_NEXT;
+	}
+}
+
+/* Visitor that aborts if it can reach success without passing avoid */
+static int
+avoid_visit(w, addr, closure)
+	struct walk *w;
+	unsigned int addr;
+	void *closure;
+{
+	if (addr == w->avoid)
+		return WALK_STOP;
+	if (w->regex->code[addr] == OP_SUCCEED)
+		return WALK_ABORT;
+	return WALK_NEXT;
+}
+
+/*
+ * Returns the literal character matched by the instruction at addr,
+ * or -1 if it is not an OP_CHAR for a single UTF-16 code unit.
+ * When ignoring case, the literal is the canonical character that
+ * the canonical form of the input must equal.
+ */
+static int
+literal_char(regex, addr)
+	struct ecma_regex *regex;
+	unsigned int addr;
+{
+	struct charclass *c;
+
+	if (regex->code[addr] != OP_CHAR)
+		return -1;
+	c = regex->cc[CODE_MAKEI(regex->code, addr + 1)];
+	if (!cc_issingle(c) || c->ranges->lo >= 0x10000 || 
+	    (c->ranges->lo & 0xf800) == 0xd800)
+		return -1;
+	return c->ranges->lo;
+}
+
+/* Tests if an instruction can sit between literals without effect */
+#define LITERAL_GAP(op)	((op) == OP_START || (op) == OP_END || (op) == OP_MARK)
+
+/*
+ * Finds the longest run of literal characters that every successful
+ * match must pass through. A run may not contain a branch target,
+ * so that executing its first instruction implies executing the rest.
+ */
+static void
+find_required(interp, w)
+	struct SEE_interpreter *interp;
+	struct walk *w;
+{
+	struct ecma_regex *regex = w->regex;
+	unsigned char *target;
+	unsigned int addr, a, runaddr, runlen, bestaddr = 0, bestlen = 0;
+	unsigned char op;
+
+	/* Mark all the branch targets */
+	target = SEE_NEW_STRING_ARRAY(interp, unsigned char, regex->codelen);
+	memset(target, 0, regex->codelen);
+	for (addr = 0; addr < regex->codelen; addr += pcode_oplen(regex, addr))
+	    switch (regex->code[addr]) {
+	    case OP_GOTO: case OP_GS: case OP_NS: case OP_GF: case OP_NF:
+	    case OP_AS: case OP_AF: case OP_MNEXT: case OP_RNEXT:
+		a = pcode_target(regex, addr);
+		if (a < regex->codelen)
+		    target[a] = 1;
+	    }
+
+	for (addr = 0; addr < regex->codelen; ) {
+	    if (literal_char(regex, addr) < 0) {
+		addr += pcode_oplen(regex, addr);
+		continue;
+	    }
+	    runaddr = addr;
+	    runlen = 0;
+	    for (;;) {
+		op = regex->code[addr];
+		if (literal_char(regex, addr) >= 0)
+		    runlen++;
+		else if (!LITERAL_GAP(op))
+		    break;
+		addr += pcode_oplen(regex, addr);
+		if (addr >= regex->codelen || target[addr])
+		    break;
+	    }
+	    if (runlen > bestlen) {
+		w->avoid = runaddr;
+		if (pcode_walk(w, avoid_visit, NULL)) {
+		    bestaddr = runaddr;
+		    bestlen = runlen;
+		}
+	    }
+	}
+
+	/* Not worth it if the prefix is searched for anyway */
+	if (bestlen == 0 || bestlen <= regex->prefixlen)
+	    return;
+	regex->required = SEE_NEW_STRING_ARRAY(interp, SEE_char_t, bestlen);
+	for (addr = bestaddr; regex->requiredlen < bestlen; 
+	     addr += pcode_oplen(regex, addr))
+	    if (literal_char(regex, addr) >= 0)
+		regex->required[regex->requiredlen++] = 
+		    literal_char(regex, addr);
+}
+
+static void
+optimize_regex(interp, regex)
+	struct SEE_interpreter *interp;
+	struct ecma_regex *regex;
+{
+	struct walk w;
+	unsigned int addr, len;
+	int ch;
+
+	w.regex = regex;
+	w.seen = SEE_NEW_STRING_ARRAY(interp, unsigned char, regex->codelen);
+	w.work = SEE_NEW_STRING_ARRAY(interp, unsigned int, regex->codelen);
+	w.from = 0;
+
+	if (pcode_walk(&w, anchor_visit, NULL))
+	    regex->anchor = (regex->flags & FLAG_MULTILINE)
+	    	? ANCHOR_LINE : ANCHOR_START;
+
+	/* Literal prefix: the leading straight-line literal characters */
+	len = 0;
+	for (addr = 0; addr < regex->codelen; addr += pcode_oplen(regex, addr))
+	    if (literal_char(regex, addr) >= 0)
+		len++;
+	    else if (!LITERAL_GAP(regex->code[addr]))
+		break;
+	if (len) {
+	    regex->prefix = SEE_NEW_STRING_ARRAY(interp, SEE_char_t, len);
+	    for (addr = 0; regex->prefixlen < len; 
+	         addr += pcode_oplen(regex, addr))
+		if ((ch = literal_char(regex, addr)) >= 0)
+		    regex->prefix[regex->prefixlen++] = ch;
+	}
+
+	/* First character set; redundant if there is a prefix */
+	if (!regex->prefixlen) {
+	    memset(regex->firstmap, 0, sizeof regex->firstmap);
+	    regex->hasfirst = pcode_walk(&w, first_visit, NULL);
+	}
+
+	if (regex->codelen <= OPTIMIZE_MAXCODE)
+	    find_required(interp, &w);
+
+#ifndef NDEBUG
+	if (SEE_regex_debug) {
+	    dprintf("optimize: anchor=%d prefixlen=%u requiredlen=%u "
+	        "hasfirst=%d\n", regex->anchor, regex->prefixlen,
+		regex->requiredlen, regex->hasfirst);
+	}
+#endif
+}
+
+/* Finds a literal string in the text, ignoring case if the regex does */
+#define LITERAL_SEARCH(regex, text, lit, litlen, i)			\
+	((regex)->flags & FLAG_IGNORECASE				\
+	    ? _SEE_strcasesearch((text)->data, (text)->length, lit, litlen, i) \
+	    : _SEE_strsearch((text)->data, (text)->length, lit, litlen, i))
+
+/* Tests if ch may be the first character of a match */
+#define FIRST_OK(regex, ch)						\
+	((ch) >= 0x100 ? (regex)->firsthigh				\
+		       : (regex)->firstmap[(ch) >> 3] & (1 << ((ch) & 7)))
+
+/*
+ * Returns the first index at or after i where a match could start,
+ * or -1 if the optimizer's hints rule out every remaining index.
+ * *reqpos caches the position of the required literal, and should
+ * initially be -1.
+ */
+static int
+next_start(regex, text, i, reqpos)
+	struct ecma_regex *regex;
+	struct SEE_string *text;
+	unsigned int i;
+	int *reqpos;
+{
+	unsigned int len = text->length;
+	int k;
+
+	if (regex->anchor == ANCHOR_START)
+	    return i == 0 ? 0 : -1;
+
+	for (; i <= len; i++) {
+	    if (regex->prefixlen) {
+		k = LITERAL_SEARCH(regex, text, regex->prefix,
+		    regex->prefixlen, i);
+		if (k < 0)
+		    return -1;
+		i = k;
+	    } else if (regex->hasfirst) {
+		while (i < len && !FIRST_OK(regex, text->data[i]))
+		    i++;
+		if (i == len)
+		    return -1;
+	    }
+	    if (regex->anchor == ANCHOR_LINE && i > 0 && 
+	        !IS_LINETERM(text->data[i - 1]))
+		continue;
+	    if (regex->requiredlen && *reqpos < (int)i) {
+		*reqpos = LITERAL_SEARCH(regex, text, regex->required,
+		    regex->requiredlen, i);
+		if (*reqpos < 0)
+		    return -1;
+	    }
+	    return i;
+	}
+	return -1;
+}
+
+/*
+ * Executes the regex at each index from start onwards, returning
+ * true at the first successful match. Start positions that the
+ * optimizer has shown cannot match are skipped.
+ */
+static int
+ecma_regex_search(interp, aregex, text, start, capture_ret)
+	struct SEE_interpreter *interp;
+	struct regex *aregex;
+	struct SEE_string *text;
+	unsigned int start;
+	struct capture *capture_ret;
+{
+	struct ecma_regex *regex = REGEX_CAST(aregex);
+	int k, reqpos = -1;
+
+	for (k = next_start(regex, text, start, &reqpos); k >= 0;
+	     k = next_start(regex, text, k + 1, &reqpos))
+	    if (ecma_regex_match(interp, aregex, text, k, capture_ret))
+		return 1;
+	return 0;
+}
+
+const struct SEE_regex_engine _SEE_ecma_regex_engine = {
+	NULL,				/* no init */
+	ecma_regex_parse,
+	ecma_regex_count_captures,
+	ecma_regex_get_flags,
+	ecma_regex_match,
+	ecma_regex_search
+};
+
+/*------------------------------------------------------------
+ * Linear-time matcher
+ *
+ * The 'nfa' engine uses the same parser and p-code, but runs the
+ * p-code as a Pike VM. All the threads of a match move through the
+ * text together, one character at a time, so the running time is
+ * bounded by the text length times the number of thread states.
+ *
+ * A thread's future depends only on its address, its counters and,
+ * for each loop mark, whether any text has been consumed since the
+ * mark was set. Two threads that reach the same state at the same
+ * text position can be merged, keeping the one with the higher
+ * priority. Threads are kept in priority order (the order in which
+ * the backtracking matcher would try them). The results are the
+ * same leftmost, first-alternative matches and captures as
+ * pcode_run() gives.
+ *
+ * Marks are only tracked for loop bodies that may match the empty
+ * string. Patterns with backreferences or lookahead, or with too
+ * many states, fall back to pcode_run().
+ */
+
+#define NFA_MAXSTATES	65536	/* limit on addresses x counter values */
+#define NFA_PERIODIC	1024	/* characters between periodic calls */
+
+struct nfa {
+	unsigned int *radix;		/* number of values of each variable */
+	unsigned int nvars;		/* counters and marks */
+	unsigned int nstates;		/* codelen x product of radixes */
+	unsigned int tsz;		/* ints per thread */
+};
+
+/*
+ * A list of threads. Each thread is tsz ints: the address, then the
+ * counters, then the mark flags, then the start and end of each
+ * capture. A mark flag is 1 once text has been consumed after the
+ * mark; untracked marks are always 0.
+ */
+struct nfa_list {
+	int *t;
+	unsigned int n, max;
+};
+
+struct nfa_run {
+	struct SEE_interpreter *interp;
+	struct ecma_regex *regex;
+	struct SEE_string *text;
+	unsigned int tsz;
+	unsigned int *stamp;		/* generation each state was seen */
+	struct nfa_list stack;		/* closure work stack */
+};
+
+#define NFA_COUNTER(t, c)	(t)[1 + (c)]
+#define NFA_MARK(run, t, k)	(t)[1 + (run)->regex->ncounters + (k)]
+#define NFA_CAPTURE(run, t)	((t) + 1 + (run)->regex->nfa->nvars)
+
+/* Visitor that aborts if a loop body can reach its end without input */
+static int
+nullable_visit(w, addr, closure)
+	struct walk *w;
+	unsigned int addr;
+	void *closure;
+{
+	struct ecma_regex *regex = w->regex;
+
+	switch (regex->code[addr]) {
+	case OP_CHAR:
+		return WALK_STOP;
+	case OP_FDIST:
+	case OP_RDIST:
+		if (CODE_MAKEI(regex->code, addr + 1) == *(int *)closure)
+		    return WALK_ABORT;
+		/* FALLTHROUGH */
+	default:
+		return WALK_NEXT;
+	}
+}
+
+/*
+ * Checks if the regex can run on the linear-time matcher, and
+ * computes the radixes of the counters and marks if it can.
+ */
+static struct nfa *
+nfa_compile(interp, regex)
+	struct SEE_interpreter *interp;
+	struct ecma_regex *regex;
+{
+	struct nfa *nfa;
+	struct walk w;
+	unsigned int addr, n;
+	int c, mark;
+
+	nfa = SEE_NEW(interp, struct nfa);
+	nfa->nvars = regex->ncounters + regex->nmarks;
+	nfa->radix = SEE_NEW_STRING_ARRAY(interp, unsigned int, nfa->nvars);
+	for (c = 0; c < (int)nfa->nvars; c++)
+	    nfa->radix[c] = 1;
+
+	w.regex = regex;
+	w.seen = SEE_NEW_STRING_ARRAY(interp, unsigned char, regex->codelen);
+	w.work = SEE_NEW_STRING_ARRAY(interp, unsigned int, regex->codelen);
+
+	for (addr = 0; addr < regex->codelen; addr += pcode_oplen(regex, addr))
+	    switch (regex->code[addr]) {
+	    case OP_BACKREF:
+	    case OP_AS:	case OP_AF:
+	    case OP_GS:	case OP_NS:
+		return NULL;
+	    case OP_MARK:
+		w.from = addr + pcode_oplen(regex, addr);
+		mark = CODE_MAKEI(regex->code, addr + 1);
+		if (!pcode_walk(&w, nullable_visit, &mark))
+		    nfa->radix[regex->ncounters + mark] = 2;
+		break;
+	    case OP_REACH: case OP_NREACH: case OP_MNEXT: case OP_RNEXT:
+		c = CODE_MAKEI(regex->code, addr + 1);
+		n = CODE_MAKEI(regex->code, addr + 1 + CODE_SZI);
+		if (nfa->radix[c] < n + 1)
+		    nfa->radix[c] = n + 1;
+		break;
+	    }
+
+	nfa->nstates = regex->codelen;
+	for (c = 0; c < (int)nfa->nvars; c++) {
+	    if (nfa->nstates > NFA_MAXSTATES / nfa->radix[c])
+		return NULL;
+	    nfa->nstates *= nfa->radix[c];
+	}
+	nfa->tsz = 1 + nfa->nvars + 2 * regex->ncaptures;
+	return nfa;
+}
+
+/* Makes room for one more thread at the end of a list */
+static int *
+nfa_list_add(run, l)
+	struct nfa_run *run;
+	struct nfa_list *l;
+{
+	if (l->max == 0) {
+	    l->max = 16;
+	    l->t = SEE_NEW_STRING_ARRAY(run->interp, int, l->max * run->tsz);
+	} else if (l->n == l->max)
+	    bt_grow(run->interp, (void **)&l->t, &l->max, 
+	        run->tsz * sizeof (int), NULL);
+	return l->t + run->tsz * l->n++;
+}
+
+/*
+ * Adds thread t, and every thread reachable from it without consuming
+ * input, to the list in priority order. Only threads waiting to match
+ * a character, or that have succeeded, are added. States already seen
+ * in generation gen are skipped.
+ */
+static void
+nfa_add(run, list, t, pos, gen)
+	struct nfa_run *run;
+	struct nfa_list *list;
+	int *t;
+	unsigned int pos, gen;
+{
+	struct ecma_regex *regex = run->regex;
+	struct nfa *nfa = regex->nfa;
+	unsigned int tsz = run->tsz, pc, key, mult, a;
+	int *w, *cap, c, i, i2;
+
+	memcpy(nfa_list_add(run, &run->stack), t, tsz * sizeof (int));
+	while (run->stack.n) {
+	    w = run->stack.t + tsz * (run->stack.n - 1);
+	    for (;;) {
+		pc = w[0];
+		key = pc;
+		mult = regex->codelen;
+		for (c = 0; c < (int)nfa->nvars; c++) {
+		    key += NFA_COUNTER(w, c) * mult;
+		    mult *= nfa->radix[c];
+		}
+		if (run->stamp[key] == gen)
+		    break;
+		run->stamp[key] = gen;
+
+		cap = NFA_CAPTURE(run, w);
+		switch (regex->code[pc]) {
+		case OP_CHAR:
+		case OP_SUCCEED:
+		    memcpy(nfa_list_add(run, list), w, tsz * sizeof (int));
+		    goto done;
+		case OP_GOTO:
+		    w[0] = pcode_target(regex, pc);
+		    continue;
+		case OP_GF:
+		case OP_NF:
+		    /* Leave the lower priority branch on the stack */
+		    w = nfa_list_add(run, &run->stack);
+		    memcpy(w, w - tsz, tsz * sizeof (int));
+		    a = pcode_target(regex, pc);
+		    if (regex->code[pc] == OP_GF) {
+			(w - tsz)[0] = a;
+			w[0] = pc + pcode_oplen(regex, pc);
+		    } else {
+			(w - tsz)[0] = pc + pcode_oplen(regex, pc);
+			w[0] = a;
+		    }
+		    continue;
+		case OP_START:
+		    i = CODE_MAKEI(regex->code, pc + 1);
+		    cap[2 * i] = pos;
+		    cap[2 * i + 1] = -1;
+		    break;
+		case OP_END:
+		    i = CODE_MAKEI(regex->code, pc + 1);
+		    cap[2 * i + 1] = pos;
+		    break;
+		case OP_UNDEF:
+		    i = CODE_MAKEI(regex->code, pc + 1);
+		    i2 = CODE_MAKEI(regex->code, pc + 1 + CODE_SZI);
+		    for (; i < i2; i++)
+			cap[2 * i] = cap[2 * i + 1] = -1;
+		    break;
+		case OP_ZERO:
+		    NFA_COUNTER(w, CODE_MAKEI(regex->code, pc + 1)) = 0;
+		    break;
+		case OP_REACH:
+		    if (NFA_COUNTER(w, CODE_MAKEI(regex->code, pc + 1)) <
+			CODE_MAKEI(regex->code, pc + 1 + CODE_SZI))
+			goto done;
+		    break;
+		case OP_NREACH:
+		    if (NFA_COUNTER(w, CODE_MAKEI(regex->code, pc + 1)) >=
+			CODE_MAKEI(regex->code, pc + 1 + CODE_SZI))
+			goto done;
+		    break;
+		case OP_MNEXT:
+		    c = CODE_MAKEI(regex->code, pc + 1);
+		    if (NFA_COUNTER(w, c) < 
+		        CODE_MAKEI(regex->code, pc + 1 + CODE_SZI))
+			NFA_COUNTER(w, c)++;
+		    w[0] = pcode_target(regex, pc);
+		    continue;
+		case OP_RNEXT:
+		    c = CODE_MAKEI(regex->code, pc + 1);
+		    if (++NFA_COUNTER(w, c) < 
+		        CODE_MAKEI(regex->code, pc + 1 + CODE_SZI))
+		    {
+			w[0] = pcode_target(regex, pc);
+			continue;
+		    }
+		    break;
+		case OP_MARK:
+		    NFA_MARK(run, w, CODE_MAKEI(regex->code, pc + 1)) = 0;
+		    break;
+		case OP_FDIST:
+		    if (nfa->radix[regex->ncounters + 
+		    	CODE_MAKEI(regex->code, pc + 1)] == 2 &&
+			!NFA_MARK(run, w, CODE_MAKEI(regex->code, pc + 1)))
+			goto done;
+		    break;
+		case OP_RDIST:
+		    if (nfa->radix[regex->ncounters + 
+		    	CODE_MAKEI(regex->code, pc + 1)] == 2 &&
+			!NFA_MARK(run, w, CODE_MAKEI(regex->code, pc + 1)) &&
+			NFA_COUNTER(w, CODE_MAKEI(regex->code, pc + 1 + 
+			    CODE_SZI)) >= CODE_MAKEI(regex->code, 
+			    pc + 1 + 2 * CODE_SZI))
+			goto done;
+		    break;
+		case OP_BOL:
+		    if (!at_line_start(regex, run->text, pos))
+			goto done;
+		    break;
+		case OP_EOL:
+		    if (!at_line_end(regex, run->text, pos))
+			goto done;
+		    break;
+		case OP_BRK:
+		    if (!at_word_break(run->text, pos))
+			goto done;
+		    break;
+		case OP_NBRK:
+		    if (at_word_break(run->text, pos))
+			goto done;
+		    break;
+		case OP_FAIL:
+		    goto done;
+		default:
+		    SEE_error_throw_string(run->interp, run->interp->Error,
+			STR(internal_error));
+		}
+		w[0] = pc + pcode_oplen(regex, pc);
+	    }
+    done:   run->stack.n--;
+	}
+}
+
+/*
+ * Advances the threads in clist over the character ch of width w
+ * (0 at the end of the text), adding the survivors to nlist. Returns
+ * true if a thread succeeded, after copying its captures; threads of
+ * lower priority are then dropped.
+ */
+static int
+nfa_step(run, clist, nlist, pos, ch, w, gen, capture_ret)
+	struct nfa_run *run;
+	struct nfa_list *clist, *nlist;
+	unsigned int pos, w, gen;
+	SEE_unicode_t ch;
+	struct capture *capture_ret;
+{
+	struct ecma_regex *regex = run->regex;
+	struct nfa *nfa = regex->nfa;
+	unsigned int i;
+	int *t, *cap, c;
+
+	for (i = 0; i < clist->n; i++) {
+	    t = clist->t + run->tsz * i;
+	    if (regex->code[t[0]] == OP_SUCCEED) {
+		cap = NFA_CAPTURE(run, t);
+		for (c = 0; c < regex->ncaptures; c++) {
+		    capture_ret[c].start = cap[2 * c];
+		    capture_ret[c].end = cap[2 * c + 1];
+		}
+		capture_ret[0].end = pos;
+		return 1;
+	    }
+	    if (w && cc_matches(regex, 
+	        regex->cc[CODE_MAKEI(regex->code, t[0] + 1)], ch))
+	    {
+		t[0] += 1 + CODE_SZI;
+		for (c = regex->ncounters; c < (int)nfa->nvars; c++)
+		    t[1 + c] = nfa->radix[c] - 1;
+		nfa_add(run, nlist, t, pos + w, gen);
+	    }
+	}
+	return 0;
+}
+
+/*
+ * Runs the linear-time matcher from index start. If anchored is true,
+ * only matches starting at start are found; otherwise the leftmost
+ * match at or after start is found.
+ */
+static int
+nfa_match(interp, regex, text, start, anchored, capture_ret)
+	struct SEE_interpreter *interp;
+	struct ecma_regex *regex;
+	struct SEE_string *text;
+	unsigned int start;
+	int anchored;
+	struct capture *capture_ret;
+{
+	struct nfa *nfa = regex->nfa;
+	struct nfa_run run;
+	struct nfa_list lists[3], *clist, *nlist, *tmp;
+	unsigned int pos, w, gen, cgen, ngen, len = text->length, steps = 0;
+	int matched = 0, cand = -1, reqpos = -1, nomore = 0;
+	int *t0, c;
+	SEE_unicode_t ch;
+
+	run.interp = interp;
+	run.regex = regex;
+	run.text = text;
+	run.tsz = nfa->tsz;
+	run.stamp = SEE_NEW_STRING_ARRAY(interp, unsigned int, nfa->nstates);
+	memset(run.stamp, 0, nfa->nstates * sizeof (unsigned int));
+	run.stack.t = NULL;
+	run.stack.n = run.stack.max = 0;
+	for (c = 0; c < 3; c++) {
+	    lists[c].t = NULL;
+	    lists[c].n = lists[c].max = 0;
+	}
+	clist = &lists[0];
+	nlist = &lists[1];
+
+	/* The initial thread */
+	t0 = SEE_STRING_ALLOCA(interp, int, run.tsz);
+	t0[0] = 0;
+	for (c = 0; c < (int)nfa->nvars; c++)
+	    NFA_COUNTER(t0, c) = 0;
+	for (c = 0; c < 2 * regex->ncaptures; c++)
+	    NFA_CAPTURE(&run, t0)[c] = -1;
+
+	if (SEE_system.periodic)
+	    (*SEE_system.periodic)(interp);
+
+	gen = cgen = 1;
+	pos = start;
+	for (;;) {
+	    /* Start a new thread of the lowest priority at pos */
+	    if (!matched && !nomore && (!anchored || pos == start)) {
+		if (anchored)
+		    cand = pos;
+		else if (cand < (int)pos) {
+		    cand = next_start(regex, text, pos, &reqpos);
+		    if (cand < 0)
+			nomore = 1;
+		}
+		if (!nomore && clist->n == 0 && cand > (int)pos) {
+		    pos = cand;
+		    cgen = ++gen;
+		}
+		if (cand == (int)pos) {
+		    NFA_CAPTURE(&run, t0)[0] = pos;
+		    nfa_add(&run, clist, t0, pos, cgen);
+		}
+	    }
+	    if (clist->n == 0) {
+		/* Nothing can match from here; try the next start */
+		if (matched || anchored || nomore || pos >= len)
+		    break;
+		pos++;
+		cgen = ++gen;
+		continue;
+	    }
+
+	    if (++steps % NFA_PERIODIC == 0 && SEE_system.periodic)
+		(*SEE_system.periodic)(interp);
+
+	    /* Read the next character, combining surrogate pairs */
+	    w = 0;
+	    ch = 0;
+	    if (pos < len) {
+		ch = text->data[pos];
+		w = 1;
+		if ((ch & 0xfc00) == 0xd800 && pos + 1 < len &&
+		    (text->data[pos + 1] & 0xfc00) == 0xdc00)
+		{
+		    ch = (((ch & 0x3ff) << 10) | 
+		    	(text->data[pos + 1] & 0x3ff)) + 0x10000;
+		    w = 2;
+		}
+	    }
+
+	    ngen = ++gen;
+	    nlist->n = 0;
+	    if (nfa_step(&run, clist, nlist, pos, ch, w, ngen, capture_ret))
+		matched = 1;
+
+	    /*
+	     * A match starting on the low half of a surrogate pair sees
+	     * it as a character of its own, and rejoins the others after.
+	     */
+	    if (w == 2 && !matched && !anchored && !nomore) {
+		if (cand < (int)pos + 1) {
+		    cand = next_start(regex, text, pos + 1, &reqpos);
+		    if (cand < 0)
+			nomore = 1;
+		}
+		if (cand == (int)pos + 1) {
+		    lists[2].n = 0;
+		    NFA_CAPTURE(&run, t0)[0] = pos + 1;
+		    nfa_add(&run, &lists[2], t0, pos + 1, ++gen);
+		    if (nfa_step(&run, &lists[2], nlist, pos + 1, 
+		        text->data[pos + 1], 1, ngen, capture_ret))
+			matched = 1;
+		}
+	    }
+
+	    if (w == 0)
+		break;
+	    pos += w;
+	    cgen = ngen;
+	    tmp = clist; clist = nlist; nlist = tmp;
+	}
+
+	SEE_free(interp, (void **)&run.stamp);
+	if (run.stack.t)
+	    SEE_free(interp, (void **)&run.stack.t);
+	for (c = 0; c < 3; c++)
+	    if (lists[c].t)
+		SEE_free(interp, (void **)&lists[c].t);
+	return matched;
+}
+
+/* Parses a regex for the 'nfa' engine */
+static struct regex *
+nfa_regex_parse(interp, source, flags)
+	struct SEE_interpreter *interp;
+	struct SEE_string *source;
+	int flags;
+{
+	struct ecma_regex *regex;
+
+	regex = REGEX_CAST(ecma_regex_parse(interp, source, flags));
+	regex->regex.engine = &_SEE_nfa_regex_engine;
+	regex->nfa = nfa_compile(interp, regex);
+	return &regex->regex;
+}
+
+/* Matches at exactly index, falling back to pcode_run() if needed */
+static int
+nfa_regex_match(interp, aregex, text, index, capture_ret)
+	struct SEE_interpreter *interp;
+	struct regex *aregex;
+	struct SEE_string *text;
+	unsigned int index;
+	struct capture *capture_ret;
+{
+	struct ecma_regex *regex = REGEX_CAST(aregex);
+
+	if (!regex->nfa)
+	    return ecma_regex_match(interp, aregex, text, index, capture_ret);
+	if (index > text->length)
+	    return 0;
+	return nfa_match(interp, regex, text, index, 1, capture_ret);
+}
+
+/* Finds the leftmost match at or after start */
+static int
+nfa_regex_search(interp, aregex, text, start, capture_ret)
+	struct SEE_interpreter *interp;
+	struct regex *aregex;
+	struct SEE_string *text;
+	unsigned int start;
+	struct capture *capture_ret;
+{
+	struct ecma_regex *regex = REGEX_CAST(aregex);
+
+	if (!regex->nfa)
+	    return ecma_regex_search(interp, aregex, text, start, capture_ret);
+	if (start > text->length)
+	    return 0;
+	return nfa_match(interp, regex, text, start, 0, capture_ret);
+}
+
+const struct SEE_regex_engine _SEE_nfa_regex_engine = {
+	NULL,				/* no init */
+	nfa_regex_parse,
 	ecma_regex_count_captures,
 	ecma_regex_get_flags,
-	ecma_regex_match
+	nfa_regex_match,
+	nfa_regex_search
 };
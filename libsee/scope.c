@@ -39,9 +39,13 @@
 #include <see/debug.h>
 #include <see/string.h>
 #include <see/eval.h>
+#include <see/mem.h>
 
 #include "scope.h"
 #include "dprint.h"
+#include "gc.h"
+
+static void scope_trace(void *);
 
 #ifndef NDEBUG
 int SEE_scope_debug = 0;
@@ -129,3 +133,27 @@ SEE_scope_eq(s1, s2)
 	return s1 == s2;
 }
 
+/*
+ * Allocates an element of a scope chain, for the caller to fill in.
+ */
+struct SEE_scope *
+_SEE_scope_new(interp)
+	struct SEE_interpreter *interp;
+{
+	struct SEE_scope *scope;
+
+	scope = SEE_NEW(interp, struct SEE_scope);
+	_SEE_gc_typed(scope, scope_trace);
+	return scope;
+}
+
+/* Garbage collector tracer for scope chain elements */
+static void
+scope_trace(p)
+	void *p;
+{
+	struct SEE_scope *scope = (struct SEE_scope *)p;
+
+	SEE_gc_mark(scope->next);
+	SEE_gc_mark(scope->obj);
+}
@@ -12,6 +12,7 @@ struct SEE_scope;
 void SEE_scope_lookup(struct SEE_interpreter *interp, struct SEE_scope *scope,
 	struct SEE_string *name, struct SEE_value *res);
 int SEE_scope_eq(struct SEE_scope *scope1, struct SEE_scope *scope2);
+struct SEE_scope *_SEE_scope_new(struct SEE_interpreter *interp);
 
 
 #endif /* _SEE_h_scope_ */
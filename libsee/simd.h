@@ -0,0 +1,38 @@
+/* Copyright (c) 2008, David Leonard. All rights reserved. */
+/* $Id$ */
+
+#ifndef _SEE_h_simd_
+#define _SEE_h_simd_
+
+/*
+ * Compile-time selection of vector instruction kernels.
+ *
+ *   SIMD_SSE2	- SSE2 is part of the compilation target and can be
+ *		  used unconditionally (always true on x86-64)
+ *   SIMD_AVX2	- AVX2 kernels can be compiled with SIMD_TARGET_AVX2,
+ *		  but must only be called when SIMD_CPU_HAS_AVX2() is true
+ *
+ * Defining SEE_NO_SIMD disables all of the vector kernels, leaving only
+ * the portable C code.
+ */
+
+#if !defined(SEE_NO_SIMD) && defined(__GNUC__) && defined(__SSE2__) && \
+    (defined(__x86_64__) || defined(__i386__))
+# define SIMD_SSE2 1
+# include <emmintrin.h>
+#endif
+
+#if SIMD_SSE2 && (defined(__clang__) || __GNUC__ >= 5)
+# define SIMD_AVX2 1
+# include <immintrin.h>
+# define SIMD_TARGET_AVX2	__attribute__((target("avx2")))
+# define SIMD_CPU_HAS_AVX2()	(__builtin_cpu_init(), \
+				 __builtin_cpu_supports("avx2"))
+#endif
+
+#if SIMD_SSE2
+# define SIMD_CTZ(x)		__builtin_ctz(x)
+# define SIMD_POPCOUNT(x)	__builtin_popcount(x)
+#endif
+
+#endif /* _SEE_h_simd_ */
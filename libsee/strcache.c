@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2008
+ *      David Leonard.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of David Leonard nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/* $Id$ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#if HAVE_STRING_H
+# include <string.h>
+#endif
+
+#include <see/type.h>
+#include <see/mem.h>
+#include <see/string.h>
+#include <see/intern.h>
+#include <see/interpreter.h>
+
+#include "strcache.h"
+
+/*
+ * Caches of interned strings for small integers and Latin-1 characters.
+ * Array indices, property names built from numbers and single
+ * character strings are converted so often that it is worth keeping
+ * the results around. The cache is allocated on first use, and each
+ * entry is filled in when first asked for.
+ */
+
+struct strcache {
+	struct SEE_string *ints[STRCACHE_INTS];
+	struct SEE_string *chars[256];
+};
+
+static struct strcache *get_cache(struct SEE_interpreter *);
+static struct SEE_string *uint_string(struct SEE_interpreter *, 
+	SEE_uint32_t);
+
+/* Returns the interpreter's cache, creating it if needed */
+static struct strcache *
+get_cache(interp)
+	struct SEE_interpreter *interp;
+{
+	struct strcache *cache;
+	unsigned int i;
+
+	cache = (struct strcache *)interp->string_cache;
+	if (!cache) {
+	    cache = SEE_NEW(interp, struct strcache);
+	    for (i = 0; i < STRCACHE_INTS; i++)
+		cache->ints[i] = NULL;
+	    for (i = 0; i < 256; i++)
+		cache->chars[i] = NULL;
+	    interp->string_cache = cache;
+	}
+	return cache;
+}
+
+/* Returns a new string containing the decimal form of n */
+static struct SEE_string *
+uint_string(interp, n)
+	struct SEE_interpreter *interp;
+	SEE_uint32_t n;
+{
+	SEE_char_t buf[10], *p = buf + 10;
+	struct SEE_string *s;
+	unsigned int len;
+
+	do {
+		*--p = '0' + n % 10;
+		n /= 10;
+	} while (n);
+	len = buf + 10 - p;
+	s = SEE_string_new(interp, len);
+	memcpy(s->data, p, len * sizeof (SEE_char_t));
+	s->length = len;
+	return s;
+}
+
+struct SEE_string *
+_SEE_string_uint(interp, n)
+	struct SEE_interpreter *interp;
+	SEE_uint32_t n;
+{
+	struct strcache *cache;
+
+	if (n >= STRCACHE_INTS)
+		return uint_string(interp, n);
+	cache = get_cache(interp);
+	if (!cache->ints[n])
+		cache->ints[n] = SEE_intern(interp, uint_string(interp, n));
+	return cache->ints[n];
+}
+
+struct SEE_string *
+_SEE_intern_uint(interp, n)
+	struct SEE_interpreter *interp;
+	SEE_uint32_t n;
+{
+	if (n >= STRCACHE_INTS)
+		return SEE_intern(interp, uint_string(interp, n));
+	return _SEE_string_uint(interp, n);
+}
+
+struct SEE_string *
+_SEE_string_char(interp, c)
+	struct SEE_interpreter *interp;
+	SEE_char_t c;
+{
+	struct strcache *cache = NULL;
+	struct SEE_string *s;
+
+	if (c < 256) {
+	    cache = get_cache(interp);
+	    if (cache->chars[c])
+		return cache->chars[c];
+	}
+	s = SEE_string_new(interp, 1);
+	s->data[0] = c;
+	s->length = 1;
+	if (c < 256)
+	    s = cache->chars[c] = SEE_intern(interp, s);
+	return s;
+}
@@ -0,0 +1,30 @@
+/* Copyright (c) 2008, David Leonard. All rights reserved. */
+/* $Id$ */
+
+#ifndef _SEE_h_strcache_
+#define _SEE_h_strcache_
+
+#include <see/type.h>
+
+struct SEE_interpreter;
+struct SEE_string;
+
+/*
+ * Per-interpreter caches of small, frequently converted strings.
+ *
+ * _SEE_string_uint() returns the decimal form of n. The result is
+ * shared and interned if n is below STRCACHE_INTS, otherwise it is
+ * a new string.
+ * _SEE_intern_uint() is the same, but always returns an interned string.
+ * _SEE_string_char() returns a one-character string. The result is
+ * shared and interned if c is below 256.
+ *
+ * Shared strings must not be modified or freed by the caller.
+ */
+#define STRCACHE_INTS	1024
+
+struct SEE_string *_SEE_string_uint(struct SEE_interpreter *, SEE_uint32_t);
+struct SEE_string *_SEE_intern_uint(struct SEE_interpreter *, SEE_uint32_t);
+struct SEE_string *_SEE_string_char(struct SEE_interpreter *, SEE_char_t);
+
+#endif /* _SEE_h_strcache_ */
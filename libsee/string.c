@@ -42,6 +42,12 @@
 # include <string.h>
 #endif
 
+#if HAVE_LIMITS_H
+# include <limits.h>
+#else
+# define UINT_MAX (~(unsigned int)0)
+#endif
+
 #include <see/mem.h>
 #include <see/type.h>
 #include <see/string.h>
@@ -54,6 +60,9 @@
 
 #include "stringdefs.h"
 #include "printf.h"
+#include "utf8.h"
+#include "casemap.h"
+#include "gc.h"
 
 static void growby(struct SEE_string *s, unsigned int extra);
 static void simple_growby(struct SEE_string *s, unsigned int extra);
@@ -122,9 +131,12 @@ _SEE_string_dup_fix(interp, s)
 	    return s;
 	if (!s->length)
 	    return STR(empty_string);
-	cp = SEE_NEW(interp, struct SEE_string);
+	cp = SEE_NEW_CATEGORY(interp, struct SEE_string, SEE_MEM_STRING);
+	_SEE_gc_barriered(cp);
+	_SEE_gc_typed(cp, _SEE_string_trace);
 	cp->length = s->length;
 	cp->data = SEE_NEW_STRING_ARRAY(interp, SEE_char_t, cp->length);
+	_SEE_gc_store(cp, cp->data);
 	memcpy(cp->data, s->data, sizeof *cp->data * cp->length);
 	cp->interpreter = interp;
 	cp->flags = 0;
@@ -144,6 +156,20 @@ SEE_string_fix(s)
 	return _SEE_string_dup_fix(NULL, s);
 }
 
+/*
+ * Garbage collector tracer for strings. The data of a substring
+ * points into that of another string, which is marked whole.
+ */
+void
+_SEE_string_trace(p)
+	void *p;
+{
+	struct SEE_string *s = (struct SEE_string *)p;
+
+	SEE_gc_mark(s->data);
+	SEE_gc_mark(s->interpreter);
+}
+
 /*
  * Creates a new (ungrowable) string that is a substring of another.
  * Raises an error if the substring indixies are out of bounds.
@@ -163,7 +189,9 @@ SEE_string_substr(interp, s, start, len)
 	 || (unsigned int)(start + len) > s->length)
 		SEE_error_throw_string(interp, interp->Error, STR(bad_arg));
 
-	subs = SEE_NEW(interp, struct SEE_string);
+	subs = SEE_NEW_CATEGORY(interp, struct SEE_string,
+	    SEE_MEM_STRING);
+	_SEE_gc_typed(subs, _SEE_string_trace);
 	subs->length = len;
 	subs->data = s->data + start;
 	subs->interpreter = interp;
@@ -183,7 +211,7 @@ SEE_string_cmp(a, b)
 	const struct SEE_string *a, *b;
 {
 	const SEE_char_t *ap, *bp;
-	unsigned int alen, blen;
+	unsigned int alen, blen, i;
 
 	if (a == b)
 		return 0;
@@ -191,20 +219,38 @@ SEE_string_cmp(a, b)
 	ap = a->data; alen = a->length;
 	bp = b->data; blen = b->length;
 
-	while (alen && blen && *ap == *bp) {
-		alen--;
-		blen--;
-		ap++;
-		bp++;
-	}
-	if (!alen) {
-		if (!blen)
+	i = _SEE_chars_mismatch(ap, bp, alen < blen ? alen : blen);
+	if (i == alen) {
+		if (i == blen)
 			return 0;
 		return -1;
 	}
-	if (!blen)
+	if (i == blen)
 		return 1;
-	return (*ap < *bp) ? -1 : 1;
+	return (ap[i] < bp[i]) ? -1 : 1;
+}
+
+/*
+ * Compares two strings lexicographically, ignoring case. Characters
+ * are compared after conversion to upper case, as done by
+ * case-insensitive regular expressions. Returns -1, 0 or +1 just like
+ * SEE_string_cmp().
+ */
+int
+SEE_string_casecmp(a, b)
+	const struct SEE_string *a, *b;
+{
+	int cmp;
+
+	if (a == b)
+		return 0;
+	cmp = _SEE_casecmp_chars(a->data, b->data, 
+	    a->length < b->length ? a->length : b->length);
+	if (cmp)
+		return cmp;
+	if (a->length == b->length)
+		return 0;
+	return a->length < b->length ? -1 : 1;
 }
 
 /*
@@ -337,43 +383,18 @@ SEE_string_fputs(s, f)
 	const struct SEE_string *s;
 	FILE *f;
 {
-	unsigned int i;
-	SEE_char_t ch, ch2;
+	unsigned int i, n;
+	char buf[256], *p;
 	struct SEE_interpreter *interp = s->interpreter;
 
-#define OUTPUT(c) do { if (fputc(c, f) == EOF) goto error; } while (0)
-
-	for (i = 0; i < s->length; i++) {
-		ch = s->data[i];
-		if ((ch & 0xff80) == 0) 
-		    OUTPUT(ch & 0x7f);
-		else if ((ch & 0xf800) == 0) {
-		    OUTPUT(0xc0 | ((ch >> 6) & 0x1f));
-		    OUTPUT(0x80 | (ch & 0x3f));
-		} else if ((ch & 0xfc00) != 0xd800) {
-		    OUTPUT(0xe0 | ((ch >> 12) & 0x0f));
-		    OUTPUT(0x80 | ((ch >> 6) & 0x3f));
-		    OUTPUT(0x80 | (ch & 0x3f));
-		} else {
-		    if (i == s->length - 1)
-			SEE_error_throw_string(interp, interp->Error, 
-				STR(bad_utf16_string));
-		    ch2 = s->data[++i];
-		    if ((ch2 & 0xfc00) != 0xdc00)
-			SEE_error_throw_string(interp, interp->Error, 
-				STR(bad_utf16_string));
-		    ch = (ch & 0x03ff) + 0x0040;
-		    OUTPUT(0xf0 | ((ch >> 8) & 0x07));
-		    OUTPUT(0x80 | ((ch >> 2) & 0x3f));
-		    OUTPUT(0x80 | ((ch & 0x3) << 4) |
-				 ((ch2 & 0x03c0) >> 6));
-		    OUTPUT(0x80 | (ch2 & 0x3f));
-		}
+	for (i = 0; i < s->length; i += n) {
+		p = buf;
+		n = _SEE_utf8_encode(interp, &p, buf + sizeof buf,
+			s->data + i, s->length - i);
+		if (fwrite(buf, 1, p - buf, f) != p - buf)
+			return EOF;
 	}
 	return 0;
-    error:
-	return EOF;
-#undef OUTPUT
 }
 
 /*------------------------------------------------------------
@@ -403,6 +424,7 @@ simple_growby(s, extra)
 	 */
 	len_save = ss->string.length;
 	SEE_grow_to(s->interpreter, &ss->grow, ss->string.length + extra);
+	_SEE_gc_store(ss, ss->string.data);
 	ss->string.length = len_save;
 }
 
@@ -420,8 +442,11 @@ SEE_string_new(interp, space)
 	struct SEE_interpreter *interp;
 	unsigned int space;
 {
-	struct simple_string *ss = SEE_NEW(interp, struct simple_string);
+	struct simple_string *ss = SEE_NEW_CATEGORY(interp,
+	    struct simple_string, SEE_MEM_STRING);
 
+	_SEE_gc_barriered(ss);
+	_SEE_gc_typed(ss, _SEE_string_trace);
 	ss->string.interpreter = interp;
 	ss->string.flags = 0;
 	SEE_GROW_INIT(interp, &ss->grow, ss->string.data, ss->string.length);
@@ -441,11 +466,11 @@ SEE_string_vsprintf(interp, fmt, ap)
 	const char *fmt;
 	va_list ap;
 {
-	struct simple_string *ss;
+	struct SEE_strbuf sb;
 	
-	ss = (struct simple_string *)SEE_string_new(interp, 0);
-	_SEE_vsprintf(interp, &ss->string, fmt, ap);
-	return (struct SEE_string *)ss;
+	SEE_strbuf_init(interp, &sb, 0);
+	_SEE_vsprintf(interp, &sb, fmt, ap);
+	return SEE_strbuf_string(&sb);
 }
 
 /*
@@ -463,6 +488,227 @@ SEE_string_sprintf(struct SEE_interpreter *interp, const char *fmt, ...)
 	return s;
 }
 
+/*------------------------------------------------------------
+ * String buffers
+ */
+
+#define STRBUF_INITIAL	16	/* smallest allocation, in characters */
+#define STRBUF_MAXIMUM	((UINT_MAX - 128) / sizeof (SEE_char_t))
+
+/*
+ * Initialises an empty string buffer, with storage pre-allocated for
+ * 'space' characters.
+ */
+void
+SEE_strbuf_init(interp, sb, space)
+	struct SEE_interpreter *interp;
+	struct SEE_strbuf *sb;
+	unsigned int space;
+{
+	sb->data = NULL;
+	sb->length = 0;
+	sb->capacity = 0;
+	sb->interpreter = interp;
+	if (space)
+	    SEE_strbuf_reserve(sb, space);
+}
+
+/*
+ * Ensures that the buffer has room for at least extra more characters.
+ * The capacity at least doubles each time the buffer is reallocated.
+ * The old storage is left for the garbage collector, because it may
+ * still be referenced by a string taken from the buffer.
+ */
+void
+SEE_strbuf_reserve(sb, extra)
+	struct SEE_strbuf *sb;
+	unsigned int extra;
+{
+	struct SEE_interpreter *interp = sb->interpreter;
+	unsigned int need, cap;
+	SEE_char_t *data;
+
+	if (extra <= sb->capacity - sb->length)
+	    return;
+	if (extra > STRBUF_MAXIMUM - sb->length)
+	    SEE_error_throw_string(interp, interp->Error,
+		STR(string_limit_reached));
+	need = sb->length + extra;
+	if (sb->capacity < STRBUF_INITIAL / 2)
+	    cap = STRBUF_INITIAL;
+	else if (sb->capacity >= STRBUF_MAXIMUM / 2)
+	    cap = STRBUF_MAXIMUM;
+	else
+	    cap = sb->capacity * 2;
+	if (cap < need)
+	    cap = need;
+	data = SEE_NEW_STRING_ARRAY(interp, SEE_char_t, cap);
+	if (sb->length)
+	    memcpy(data, sb->data, sb->length * sizeof (SEE_char_t));
+	sb->data = data;
+	sb->capacity = cap;
+}
+
+/*
+ * Appends a UTF-16 character to the buffer.
+ */
+void
+SEE_strbuf_addch(sb, c)
+	struct SEE_strbuf *sb;
+	int c;				/* promoted SEE_char_t */
+{
+	if (sb->length == sb->capacity)
+	    SEE_strbuf_reserve(sb, 1);
+	SEE_STRBUF_PUTCH(sb, c);
+}
+
+/*
+ * Appends len UTF-16 characters to the buffer.
+ */
+void
+SEE_strbuf_append_chars(sb, chars, len)
+	struct SEE_strbuf *sb;
+	const SEE_char_t *chars;
+	unsigned int len;
+{
+	if (len) {
+	    SEE_strbuf_reserve(sb, len);
+	    memcpy(sb->data + sb->length, chars, len * sizeof (SEE_char_t));
+	    sb->length += len;
+	}
+}
+
+/*
+ * Appends the content of string s to the buffer.
+ */
+void
+SEE_strbuf_append(sb, s)
+	struct SEE_strbuf *sb;
+	const struct SEE_string *s;
+{
+	SEE_strbuf_append_chars(sb, s->data, s->length);
+}
+
+/*
+ * Appends a 7-bit ASCII string to the buffer.
+ */
+void
+SEE_strbuf_append_ascii(sb, ascii)
+	struct SEE_strbuf *sb;
+	const char *ascii;
+{
+	SEE_size_t len = strlen(ascii);
+
+	SEE_strbuf_reserve(sb, len);
+	for (; *ascii; ascii++) {
+	    SEE_ASSERT(sb->interpreter, !(*ascii & 0x80));
+	    SEE_STRBUF_PUTCH(sb, *ascii);
+	}
+}
+
+/*
+ * Appends len bytes of UTF-8 text, converted to UTF-16.
+ * Malformed sequences are replaced with U+FFFD.
+ */
+void
+SEE_strbuf_append_utf8(sb, utf8, len)
+	struct SEE_strbuf *sb;
+	const char *utf8;
+	SEE_size_t len;
+{
+	/* UTF-16 never needs more units than UTF-8 needs bytes */
+	SEE_strbuf_reserve(sb, len);
+	sb->length += _SEE_utf8_to_utf16(sb->interpreter, 
+	    sb->data + sb->length, utf8, len);
+}
+
+/*
+ * Appends a unicode codepoint to the buffer, as a surrogate pair if
+ * necessary.
+ */
+void
+SEE_strbuf_append_unicode(sb, c)
+	struct SEE_strbuf *sb;
+	SEE_unicode_t c;
+{
+	SEE_strbuf_reserve(sb, 2);
+	if (c < 0x10000)
+	    SEE_STRBUF_PUTCH(sb, c & 0xffff);
+	else {
+	    /* RFC2781: UTF-16 encoding */
+	    c -= 0x10000;
+	    SEE_STRBUF_PUTCH(sb, 0xd800 | (c >> 10 & 0x3ff));
+	    SEE_STRBUF_PUTCH(sb, 0xdc00 | (c       & 0x3ff));
+	}
+}
+
+/*
+ * Appends a signed integer in decimal.
+ */
+void
+SEE_strbuf_append_int(sb, i)
+	struct SEE_strbuf *sb;
+	int i;
+{
+	char buf[12], *p = buf + sizeof buf;
+	unsigned int u = i < 0 ? -(unsigned int)i : (unsigned int)i;
+
+	do
+	    *--p = '0' + u % 10;
+	while ((u /= 10) != 0);
+	if (i < 0)
+	    *--p = '-';
+	SEE_strbuf_reserve(sb, buf + sizeof buf - p);
+	while (p < buf + sizeof buf)
+	    SEE_STRBUF_PUTCH(sb, *p++);
+}
+
+/*
+ * Appends a number, formatted as by ToString (9.8.1).
+ */
+void
+SEE_strbuf_append_number(sb, n)
+	struct SEE_strbuf *sb;
+	SEE_number_t n;
+{
+	struct SEE_value v, r;
+
+	SEE_SET_NUMBER(&v, n);
+	SEE_ToString(sb->interpreter, &v, &r);
+	SEE_strbuf_append(sb, r.u.string);
+}
+
+/*
+ * Returns a new string holding the buffer's content. The buffer's
+ * storage becomes the string's storage, and the buffer is reset to empty.
+ */
+struct SEE_string *
+SEE_strbuf_string(sb)
+	struct SEE_strbuf *sb;
+{
+	struct SEE_interpreter *interp = sb->interpreter;
+	struct simple_string *ss = SEE_NEW_CATEGORY(interp,
+	    struct simple_string, SEE_MEM_STRING);
+
+	_SEE_gc_barriered(ss);
+	_SEE_gc_typed(ss, _SEE_string_trace);
+	ss->string.interpreter = interp;
+	ss->string.flags = 0;
+	SEE_GROW_INIT(interp, &ss->grow, ss->string.data, ss->string.length);
+	ss->grow.is_string = 1;
+	ss->string.stringclass = &simple_stringclass;
+	if (sb->length) {
+	    ss->string.data = sb->data;
+	    _SEE_gc_store(ss, ss->string.data);
+	    ss->string.length = sb->length;
+	    ss->grow.allocated = sb->capacity * sizeof (SEE_char_t);
+	}
+	sb->data = NULL;
+	sb->length = 0;
+	sb->capacity = 0;
+	return (struct SEE_string *)ss;
+}
+
 /**
  * Returns a quoted, escaped string, suitable for lexical analysis.
  */
@@ -552,31 +798,7 @@ SEE_string_utf8_size(interp, s)
 	struct SEE_interpreter *interp;
 	const struct SEE_string *s;
 {
-	SEE_size_t len;
-	unsigned int i;
-	SEE_char_t ch, ch2;
-
-	len = 0;
-	for (i = 0; i < s->length; i++) {
-		ch = s->data[i];
-		if ((ch & 0xff80) == 0)
-		    len += 1;
-		else if ((ch & 0xf800) == 0)
-		    len += 2;
-		else if ((ch & 0xfc00) != 0xd800)
-		    len += 3;
-		else {
-		    if (i == s->length - 1)
-			SEE_error_throw_string(interp, interp->Error, 
-				STR(bad_utf16_string));
-		    ch2 = s->data[++i];
-		    if ((ch2 & 0xfc00) != 0xdc00)
-			SEE_error_throw_string(interp, interp->Error, 
-				STR(bad_utf16_string));
-		    len += 4;
-		}
-	}
-	return len;
+	return _SEE_utf8_size(interp, s->data, s->length);
 }
 
 /*
@@ -592,52 +814,12 @@ SEE_string_toutf8(interp, buf, buflen, s)
 	SEE_size_t buflen;
 	const struct SEE_string *s;
 {
-	unsigned int i;
-	SEE_char_t ch, ch2;
-
-#define OUTPUT(c) do { 				\
-	if (buflen <= 1) goto toolong; 		\
-	*buf++ = (c); 				\
-	buflen--; 				\
-    } while (0)
-
-	for (i = 0; i < s->length; i++) {
-		ch = s->data[i];
-		if ((ch & 0xff80) == 0) 
-		    OUTPUT(ch & 0x7f);
-		else if ((ch & 0xf800) == 0) {
-		    OUTPUT(0xc0 | ((ch >> 6) & 0x1f));
-		    OUTPUT(0x80 | (ch & 0x3f));
-		} else if ((ch & 0xfc00) != 0xd800) {
-		    OUTPUT(0xe0 | ((ch >> 12) & 0x0f));
-		    OUTPUT(0x80 | ((ch >> 6) & 0x3f));
-		    OUTPUT(0x80 | (ch & 0x3f));
-		} else {
-		    if (i == s->length - 1)
-			SEE_error_throw_string(interp, interp->Error, 
-				STR(bad_utf16_string));
-		    ch2 = s->data[++i];
-		    if ((ch2 & 0xfc00) != 0xdc00)
-			SEE_error_throw_string(interp, interp->Error, 
-				STR(bad_utf16_string));
-		    ch = (ch & 0x03ff) + 0x0040;
-		    OUTPUT(0xf0 | ((ch >> 8) & 0x07));
-		    OUTPUT(0x80 | ((ch >> 2) & 0x3f));
-		    OUTPUT(0x80 | ((ch & 0x3) << 4) |
-				 ((ch2 & 0x03c0) >> 6));
-		    OUTPUT(0x80 | (ch2 & 0x3f));
-		}
-	}
-
-	if (buflen < 1) goto toolong;
+	if (buflen < 1 || _SEE_utf8_encode(interp, &buf, buf + buflen - 1,
+	    s->data, s->length) < s->length)
+		SEE_error_throw_string(interp, interp->RangeError, 
+			STR(string_limit_reached));
 	*buf = '\0';
-	return;
-
-    toolong:
-	SEE_error_throw_string(interp, interp->RangeError, 
-		STR(string_limit_reached));
 }
-#undef OUTPUT
 
 /*
  * Extends a string, marking the original string as ungrowable.
@@ -651,8 +833,12 @@ simple_concat(interp, a, b)
 	struct simple_string *cp;
 
 	/* Copy a to cp, carefully moving the SEE_growable structure  */
-	cp = SEE_NEW(interp, struct simple_string);
+	cp = SEE_NEW_CATEGORY(interp, struct simple_string,
+	    SEE_MEM_STRING);
+	_SEE_gc_barriered(cp);
+	_SEE_gc_typed(cp, _SEE_string_trace);
 	memcpy(cp, a, sizeof (struct simple_string));
+	_SEE_gc_store(cp, cp->string.data);
 	cp->grow.data_ptr = /* (void**) */&cp->string.data;
 	cp->grow.length_ptr = &cp->string.length;
 
@@ -0,0 +1,403 @@
+/*
+ * Copyright (c) 2008
+ *      David Leonard.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of David Leonard nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/* $Id$ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#if HAVE_STRING_H
+# include <string.h>
+#endif
+
+#include <see/type.h>
+
+#include "strsearch.h"
+#include "casemap.h"
+#include "simd.h"
+#include "replace.h"
+
+/*
+ * Substring search.
+ *
+ * Short patterns are found by a 'first and last character' filter:
+ * every candidate position k is tested for text[k] == pat[0] and
+ * text[k+m-1] == pat[m-1] before the rest of the pattern is compared.
+ * With SSE2 (or AVX2) the filter is applied to 8 (or 16) candidate
+ * positions at once. The AVX2 kernel is chosen at run time, on the
+ * first search, if the CPU supports it.
+ *
+ * Long patterns are found with the Boyer-Moore-Horspool algorithm,
+ * using a skip table indexed by the low 8 bits of each UTF-16 unit.
+ *
+ * Single characters are found by comparing 8 units at a time with
+ * SSE2, as memchr() would.
+ *
+ * Case-insensitive search compares canonical characters (see
+ * casemap.h). With SSE2, the first and last character filter is
+ * applied 8 positions at a time by comparing the text with the upper
+ * and lower case forms of the pattern's characters; when a character
+ * also has other forms, every non-ASCII text character passes.
+ */
+
+#define LONG_PATTERN	32	/* patterns this long use Horspool */
+
+typedef int (*search_fn)(const SEE_char_t *, unsigned int,
+	const SEE_char_t *, unsigned int, unsigned int);
+
+static int search_scalar(const SEE_char_t *, unsigned int,
+	const SEE_char_t *, unsigned int, unsigned int);
+static int search_horspool(const SEE_char_t *, unsigned int,
+	const SEE_char_t *, unsigned int, unsigned int);
+static int search_resolve(const SEE_char_t *, unsigned int,
+	const SEE_char_t *, unsigned int, unsigned int);
+static int rsearch_scalar(const SEE_char_t *, const SEE_char_t *,
+	unsigned int, unsigned int);
+#if SIMD_SSE2
+static int search_sse2(const SEE_char_t *, unsigned int,
+	const SEE_char_t *, unsigned int, unsigned int);
+static int rsearch_sse2(const SEE_char_t *, const SEE_char_t *,
+	unsigned int, unsigned int);
+#endif
+#if SIMD_AVX2
+static int search_avx2(const SEE_char_t *, unsigned int,
+	const SEE_char_t *, unsigned int, unsigned int) SIMD_TARGET_AVX2;
+#endif
+
+/* The short pattern searcher; replaced on first use */
+static search_fn pair_search = search_resolve;
+
+/* Tests if the middle of the pattern matches at text position k */
+#define MIDDLE_MATCHES(text, k, pat, m)				\
+	((m) <= 2 || memcmp((text) + (k) + 1, (pat) + 1, 	\
+		((m) - 2) * sizeof (SEE_char_t)) == 0)
+
+/*
+ * Selects the fastest available short pattern searcher and then
+ * performs the search.
+ */
+static int
+search_resolve(text, n, pat, m, start)
+	const SEE_char_t *text, *pat;
+	unsigned int n, m, start;
+{
+	search_fn fn = search_scalar;
+
+#if SIMD_SSE2
+	fn = search_sse2;
+#endif
+#if SIMD_AVX2
+	if (SIMD_CPU_HAS_AVX2())
+		fn = search_avx2;
+#endif
+	pair_search = fn;
+	return (*fn)(text, n, pat, m, start);
+}
+
+/* Portable first/last character filter search. Requires 0 < m <= n */
+static int
+search_scalar(text, n, pat, m, start)
+	const SEE_char_t *text, *pat;
+	unsigned int n, m, start;
+{
+	unsigned int k;
+	SEE_char_t first = pat[0], last = pat[m - 1];
+
+	for (k = start; k <= n - m; k++)
+	    if (text[k] == first && text[k + m - 1] == last &&
+		MIDDLE_MATCHES(text, k, pat, m))
+		    return k;
+	return -1;
+}
+
+/* Boyer-Moore-Horspool search. Requires 0 < m <= n */
+static int
+search_horspool(text, n, pat, m, start)
+	const SEE_char_t *text, *pat;
+	unsigned int n, m, start;
+{
+	unsigned int skip[256];
+	unsigned int i, k, last = m - 1;
+	SEE_char_t ch;
+
+	for (i = 0; i < 256; i++)
+	    skip[i] = m;
+	for (i = 0; i < last; i++)
+	    skip[pat[i] & 0xff] = last - i;
+
+	for (k = start; k <= n - m; k += skip[ch & 0xff]) {
+	    ch = text[k + last];
+	    if (ch == pat[last] &&
+		memcmp(text + k, pat, last * sizeof (SEE_char_t)) == 0)
+		    return k;
+	}
+	return -1;
+}
+
+/* Searches backwards from position k-1 to 0. Requires 0 < m */
+static int
+rsearch_scalar(text, pat, m, k)
+	const SEE_char_t *text, *pat;
+	unsigned int m, k;
+{
+	SEE_char_t first = pat[0], last = pat[m - 1];
+
+	while (k--)
+	    if (text[k] == first && text[k + m - 1] == last &&
+		MIDDLE_MATCHES(text, k, pat, m))
+		    return k;
+	return -1;
+}
+
+#if SIMD_SSE2
+/* SSE2 first/last character filter search. Requires 0 < m <= n */
+static int
+search_sse2(text, n, pat, m, start)
+	const SEE_char_t *text, *pat;
+	unsigned int n, m, start;
+{
+	const __m128i first = _mm_set1_epi16((short)pat[0]);
+	const __m128i last = _mm_set1_epi16((short)pat[m - 1]);
+	__m128i a, b;
+	unsigned int k, mask, bit;
+
+	for (k = start; k + m - 1 + 8 <= n; k += 8) {
+	    a = _mm_loadu_si128((const __m128i *)(text + k));
+	    b = _mm_loadu_si128((const __m128i *)(text + k + m - 1));
+	    mask = _mm_movemask_epi8(_mm_and_si128(
+		_mm_cmpeq_epi16(a, first), _mm_cmpeq_epi16(b, last)));
+	    while (mask) {
+		bit = SIMD_CTZ(mask);
+		if (MIDDLE_MATCHES(text, k + bit / 2, pat, m))
+		    return k + bit / 2;
+		mask &= ~(3u << bit);
+	    }
+	}
+	return search_scalar(text, n, pat, m, k);
+}
+
+/* SSE2 backwards search from position k-1 to 0. Requires 0 < m */
+static int
+rsearch_sse2(text, pat, m, k)
+	const SEE_char_t *text, *pat;
+	unsigned int m, k;
+{
+	const __m128i first = _mm_set1_epi16((short)pat[0]);
+	const __m128i last = _mm_set1_epi16((short)pat[m - 1]);
+	__m128i a, b;
+	unsigned int mask, bit;
+
+	for (; k >= 8; k -= 8) {
+	    a = _mm_loadu_si128((const __m128i *)(text + k - 8));
+	    b = _mm_loadu_si128((const __m128i *)(text + k - 8 + m - 1));
+	    mask = _mm_movemask_epi8(_mm_and_si128(
+		_mm_cmpeq_epi16(a, first), _mm_cmpeq_epi16(b, last)));
+	    while (mask) {
+		bit = 30 - (__builtin_clz(mask) & ~1);
+		if (MIDDLE_MATCHES(text, k - 8 + bit / 2, pat, m))
+		    return k - 8 + bit / 2;
+		mask &= ~(3u << bit);
+	    }
+	}
+	return rsearch_scalar(text, pat, m, k);
+}
+#endif
+
+#if SIMD_AVX2
+/* AVX2 first/last character filter search. Requires 0 < m <= n */
+static int
+search_avx2(text, n, pat, m, start)
+	const SEE_char_t *text, *pat;
+	unsigned int n, m, start;
+{
+	const __m256i first = _mm256_set1_epi16((short)pat[0]);
+	const __m256i last = _mm256_set1_epi16((short)pat[m - 1]);
+	__m256i a, b;
+	unsigned int k, mask, bit;
+
+	for (k = start; k + m - 1 + 16 <= n; k += 16) {
+	    a = _mm256_loadu_si256((const __m256i *)(text + k));
+	    b = _mm256_loadu_si256((const __m256i *)(text + k + m - 1));
+	    mask = (unsigned int)_mm256_movemask_epi8(_mm256_and_si256(
+		_mm256_cmpeq_epi16(a, first), _mm256_cmpeq_epi16(b, last)));
+	    while (mask) {
+		bit = SIMD_CTZ(mask);
+		if (MIDDLE_MATCHES(text, k + bit / 2, pat, m))
+		    return k + bit / 2;
+		mask &= ~(3u << bit);
+	    }
+	}
+	return search_scalar(text, n, pat, m, k);
+}
+#endif
+
+int
+_SEE_strsearch(text, textlen, pat, patlen, start)
+	const SEE_char_t *text, *pat;
+	unsigned int textlen, patlen, start;
+{
+	if (start > textlen)
+		start = textlen;
+	if (patlen == 0)
+		return start;
+	if (patlen > textlen || start > textlen - patlen)
+		return -1;
+	if (patlen >= LONG_PATTERN)
+		return search_horspool(text, textlen, pat, patlen, start);
+	return (*pair_search)(text, textlen, pat, patlen, start);
+}
+
+int
+_SEE_strchr(text, textlen, ch, start)
+	const SEE_char_t *text;
+	unsigned int textlen, start;
+	SEE_char_t ch;
+{
+	unsigned int k = start;
+#if SIMD_SSE2
+	const __m128i c = _mm_set1_epi16((short)ch);
+	unsigned int mask;
+
+	for (; k + 8 <= textlen; k += 8) {
+	    mask = _mm_movemask_epi8(_mm_cmpeq_epi16(
+		_mm_loadu_si128((const __m128i *)(text + k)), c));
+	    if (mask)
+		return k + SIMD_CTZ(mask) / 2;
+	}
+#endif
+	for (; k < textlen; k++)
+	    if (text[k] == ch)
+		return k;
+	return -1;
+}
+
+/* Tests if the canonical pattern occurs at text position k */
+static int
+casematch(text, k, pat, m)
+	const SEE_char_t *text, *pat;
+	unsigned int k, m;
+{
+	unsigned int j;
+
+	for (j = 0; j < m; j++)
+	    if (CASEMAP_CANON(text[k + j]) != pat[j])
+		return 0;
+	return 1;
+}
+
+#if SIMD_SSE2
+/*
+ * A filter for the text characters that may have the canonical form
+ * u: those equal to u or to its lower case form and, if u has other
+ * forms, those that are not ASCII.
+ */
+struct casefilter {
+	__m128i upper, lower, other;
+};
+
+static int
+casefilter_init(f, u)
+	struct casefilter *f;
+	SEE_char_t u;
+{
+	if (u >= 0x80 && CASEMAP_CANON_MULTI(u))
+	    return 0;
+	f->upper = _mm_set1_epi16((short)u);
+	f->lower = _mm_set1_epi16((short)CASEMAP_TOLOWER(u));
+	f->other = _mm_set1_epi16(CASEMAP_CANON_MULTI(u) ? (short)0xff80 : 0);
+	return 1;
+}
+
+#define CASEFILTER(f, t)						\
+	_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi16(t, (f)->upper),	\
+				  _mm_cmpeq_epi16(t, (f)->lower)),	\
+	    _mm_andnot_si128(_mm_cmpeq_epi16(_mm_and_si128(t, (f)->other), \
+		_mm_setzero_si128()), _mm_set1_epi16(-1)))
+#endif
+
+int
+_SEE_strcasesearch(text, textlen, pat, patlen, start)
+	const SEE_char_t *text, *pat;
+	unsigned int textlen, patlen, start;
+{
+	unsigned int k, n = textlen, m = patlen;
+#if SIMD_SSE2
+	struct casefilter first, last;
+	__m128i a, b;
+	unsigned int mask, bit;
+#endif
+
+	if (start > textlen)
+		start = textlen;
+	if (patlen == 0)
+		return start;
+	if (patlen > textlen || start > textlen - patlen)
+		return -1;
+
+	k = start;
+#if SIMD_SSE2
+	if (casefilter_init(&first, pat[0]) &&
+	    casefilter_init(&last, pat[m - 1]))
+	    for (; k + m - 1 + 8 <= n; k += 8) {
+		a = _mm_loadu_si128((const __m128i *)(text + k));
+		b = _mm_loadu_si128((const __m128i *)(text + k + m - 1));
+		mask = _mm_movemask_epi8(_mm_and_si128(
+		    CASEFILTER(&first, a), CASEFILTER(&last, b)));
+		while (mask) {
+		    bit = SIMD_CTZ(mask);
+		    if (casematch(text, k + bit / 2, pat, m))
+			return k + bit / 2;
+		    mask &= ~(3u << bit);
+		}
+	    }
+#endif
+	for (; k <= n - m; k++)
+	    if (CASEMAP_CANON(text[k]) == pat[0] && casematch(text, k, pat, m))
+		return k;
+	return -1;
+}
+
+int
+_SEE_strrsearch(text, textlen, pat, patlen, start)
+	const SEE_char_t *text, *pat;
+	unsigned int textlen, patlen, start;
+{
+	if (patlen > textlen)
+		return -1;
+	if (start > textlen - patlen)
+		start = textlen - patlen;
+	if (patlen == 0)
+		return start;
+#if SIMD_SSE2
+	return rsearch_sse2(text, pat, patlen, start + 1);
+#else
+	return rsearch_scalar(text, pat, patlen, start + 1);
+#endif
+}
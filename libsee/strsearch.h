@@ -0,0 +1,33 @@
+/* Copyright (c) 2008, David Leonard. All rights reserved. */
+/* $Id$ */
+
+#ifndef _SEE_h_strsearch_
+#define _SEE_h_strsearch_
+
+#include <see/type.h>
+
+/*
+ * Substring search over UTF-16 text.
+ *
+ * _SEE_strsearch() returns the smallest index k >= start where pat
+ * occurs in text, or -1 if there is none.
+ * _SEE_strrsearch() returns the largest index k <= start where pat
+ * occurs in text, or -1 if there is none.
+ * An empty pattern matches at the (clamped) start position.
+ * _SEE_strchr() returns the smallest index k >= start where the
+ * character ch occurs in text, or -1 if there is none.
+ * _SEE_strcasesearch() is like _SEE_strsearch(), but compares the
+ * canonical form of each text character (see casemap.h) with pat,
+ * which must already be canonical. _SEE_canon_init() must have been
+ * called.
+ */
+int _SEE_strsearch(const SEE_char_t *text, unsigned int textlen,
+	const SEE_char_t *pat, unsigned int patlen, unsigned int start);
+int _SEE_strrsearch(const SEE_char_t *text, unsigned int textlen,
+	const SEE_char_t *pat, unsigned int patlen, unsigned int start);
+int _SEE_strcasesearch(const SEE_char_t *text, unsigned int textlen,
+	const SEE_char_t *pat, unsigned int patlen, unsigned int start);
+int _SEE_strchr(const SEE_char_t *text, unsigned int textlen,
+	SEE_char_t ch, unsigned int start);
+
+#endif /* _SEE_h_strsearch_ */
@@ -62,6 +62,7 @@
 #include "platform.h"
 #include "code.h"
 #include "regex.h"
+#include "gc.h"
 
 /* Prototypes */
 static unsigned int simple_random_seed(void);
@@ -77,7 +78,7 @@ static void simple_gc_free(struct SEE_interpreter *, void *,
 	const char *, int);
 static void simple_gc_finalizer(void *, void *);
 static void simple_gc_gcollect(struct SEE_interpreter *);
-#else
+#elif !WITH_SEE_GC
 static void *simple_malloc(struct SEE_interpreter *, SEE_size_t,
 	const char *, int);
 static void *simple_malloc_finalize(struct SEE_interpreter *, SEE_size_t,
@@ -112,6 +113,13 @@ struct SEE_system SEE_system = {
 	simple_gc_free,			/* free */
 	simple_mem_exhausted,		/* mem_exhausted */
 	simple_gc_gcollect,		/* gcollect */
+#elif WITH_SEE_GC
+	_SEE_gc_malloc,			/* malloc */
+	_SEE_gc_malloc_finalize,	/* malloc_finalize */
+	_SEE_gc_malloc_string,		/* malloc_string */
+	_SEE_gc_free,			/* free */
+	simple_mem_exhausted,		/* mem_exhausted */
+	_SEE_gc_gcollect,		/* gcollect */
 #else
 	simple_malloc,			/* malloc */
 	simple_malloc_finalize,		/* malloc_finalize */
@@ -123,7 +131,13 @@ struct SEE_system SEE_system = {
 	NULL,				/* transit_sec_domain */
 	_SEE_code1_alloc,		/* code_alloc */
 	NULL,				/* object_construct */
-	&_SEE_ecma_regex_engine		/* default_regex_engine */
+	&_SEE_ecma_regex_engine,	/* default_regex_engine */
+	10000000,			/* default_regex_backtrack_limit */
+	100,				/* default_regex_jit_threshold */
+	0,				/* gc_pause_budget */
+	0,				/* default_mem_soft_limit */
+	0,				/* default_mem_hard_limit */
+	NULL				/* mem_limit_exceeded */
 };
 
 /*
@@ -263,7 +277,7 @@ simple_gc_gcollect(interp)
 	GC_gcollect();
 }
 
-#else /* !WITH_BOEHM_GC */
+#elif !WITH_SEE_GC
 
 
 /*
@@ -271,7 +285,21 @@ simple_gc_gcollect(interp)
  * Note: most mallocs do not get freed! 
  * System strongly assumes a garbage collector.
  * This is a stub function.
+ *
+ * Each block is preceded by a header that holds the index of its
+ * entry in the finalizer table (plus one), or zero if it has no
+ * finalizer, so that freeing a block cancels its finalizer without a
+ * search.
  */
+union simple_header {
+	unsigned int index;
+	double	align_d;		/* (for alignment) */
+	void   *align_p;
+	long	align_l;
+};
+
+#define HEADER(ptr)	((union simple_header *)(ptr) - 1)
+
 static void *
 simple_malloc(interp, size, file, line)
 	struct SEE_interpreter *interp;
@@ -279,6 +307,7 @@ simple_malloc(interp, size, file, line)
 	const char *file;
 	int line;
 {
+	union simple_header *h;
 #ifndef NDEBUG
 	static int warning_printed = 0;
 
@@ -288,38 +317,127 @@ simple_malloc(interp, size, file, line)
 	}
 
 #endif
-	return malloc(size);
+	h = (union simple_header *)malloc(sizeof *h + size);
+	if (!h)
+	    return NULL;
+	h->index = 0;
+	return h + 1;
 }
 
-/* Linked list of all finalizers to run on exit */
-static struct finalize_entry {
+/*
+ * The finalizer table. Entries are kept in chunks of a fixed size, so
+ * that they never move, and are addressed by index. Cancelled entries
+ * are kept on a free list (threaded through their next fields) for
+ * reuse.
+ */
+#define FINALIZE_CHUNK	256
+
+struct finalize_entry {
 	struct SEE_interpreter *interp;
 	void *ptr;
 	void (*finalizefn)(struct SEE_interpreter *, void *, void *);
 	void *closure;
-	struct finalize_entry *next;
-} *simple_finalize_list;
+	unsigned int next;		/* next free index + 1, or 0 */
+};
+
+static struct {
+	struct finalize_entry **chunks;
+	unsigned int nchunks;
+	unsigned int used;		/* entries ever handed out */
+	unsigned int free;		/* first free index + 1, or 0 */
+	unsigned long pending;		/* entries in use */
+} simple_fin;
+
+#define ENTRY(i) \
+	(&simple_fin.chunks[(i) / FINALIZE_CHUNK][(i) % FINALIZE_CHUNK])
+
+/* Returns the index of an unused entry, or -1 if out of memory */
+static int
+simple_finalize_entry()
+{
+	struct finalize_entry **chunks;
+	unsigned int i, n;
+
+	if (simple_fin.free) {
+	    i = simple_fin.free - 1;
+	    simple_fin.free = ENTRY(i)->next;
+	    return i;
+	}
+	if (simple_fin.used == simple_fin.nchunks * FINALIZE_CHUNK) {
+	    n = simple_fin.nchunks + 1;
+	    chunks = (struct finalize_entry **)realloc(simple_fin.chunks,
+		n * sizeof *chunks);
+	    if (!chunks)
+		return -1;
+	    simple_fin.chunks = chunks;
+	    chunks[n - 1] = (struct finalize_entry *)malloc(
+		FINALIZE_CHUNK * sizeof (struct finalize_entry));
+	    if (!chunks[n - 1])
+		return -1;
+	    simple_fin.nchunks = n;
+	}
+	return simple_fin.used++;
+}
+
+/* Cancels the finalizer entry with index i */
+static void
+simple_finalize_cancel(i)
+	unsigned int i;
+{
+	struct finalize_entry *entry = ENTRY(i);
+
+	entry->interp = NULL;
+	entry->ptr = NULL;
+	entry->finalizefn = NULL;
+	entry->closure = NULL;
+	entry->next = simple_fin.free;
+	simple_fin.free = i + 1;
+	simple_fin.pending--;
+}
+
+/*
+ * Runs the finalizers of the blocks allocated for the interpreter, or
+ * of all blocks if interp is NULL, newest first. Each is cancelled
+ * before it is run, so that a block that its finalizer frees is not
+ * finalized twice.
+ */
+void
+_SEE_simple_finalize(interp)
+	struct SEE_interpreter *interp;
+{
+	struct finalize_entry *entry, e;
+	unsigned int i;
+
+	for (i = simple_fin.used; i-- > 0 && simple_fin.pending; ) {
+	    entry = ENTRY(i);
+	    if (!entry->finalizefn || (interp && entry->interp != interp))
+		continue;
+	    e = *entry;
+	    HEADER(e.ptr)->index = 0;
+	    simple_finalize_cancel(i);
+	    (*e.finalizefn)(e.interp, e.ptr, e.closure);
+	}
+}
+
+/* Returns the number of finalizers waiting to run */
+unsigned long
+_SEE_simple_finalizers()
+{
+	return simple_fin.pending;
+}
 
 /* Runs all the finalizers */
 static void
 simple_finalize_all()
 {
-	struct finalize_entry *entry;
 #ifndef NDEBUG
 	extern int SEE_mem_debug;
-#endif
 
-#ifndef NDEBUG
 	if (SEE_mem_debug)
 	    dprintf("Running finalizers\n");
 #endif
 
-	while (simple_finalize_list) {
-	    entry = simple_finalize_list;
-	    simple_finalize_list = entry->next;
-	    (*entry->finalizefn)(entry->interp, entry->ptr, entry->closure);
-	    free(entry);
-	}
+	_SEE_simple_finalize(NULL);
 }
 
 static void *
@@ -334,33 +452,39 @@ simple_malloc_finalize(interp, size, finalizefn, closure, file, line)
 	static int called = 0;
 	struct finalize_entry *entry;
 	void *ptr;
+	int i;
 
-	ptr = malloc(size);
+	ptr = simple_malloc(interp, size, file, line);
 	if (!ptr)
 	    return NULL;
 
 	/* Record the finalization function to call at exit */
-	entry = (struct finalize_entry *)malloc(sizeof *entry);
-	if (entry) {
-	    entry->interp = interp;
-	    entry->ptr = ptr;
-	    entry->finalizefn = finalizefn;
-	    entry->closure = closure;
-	    /* Insert at head of list */
-	    entry->next = simple_finalize_list;
-	    simple_finalize_list = entry;
-	    /* Set up finalizers to be run during exit() */
-	    if (!called) {
-		called = 1;
-		atexit(simple_finalize_all);
-	    }
+	i = simple_finalize_entry();
+	if (i < 0) {
+	    free(HEADER(ptr));
+	    return NULL;
+	}
+	entry = ENTRY(i);
+	entry->interp = interp;
+	entry->ptr = ptr;
+	entry->finalizefn = finalizefn;
+	entry->closure = closure;
+	entry->next = 0;
+	simple_fin.pending++;
+	HEADER(ptr)->index = i + 1;
+
+	/* Set up finalizers to be run during exit() */
+	if (!called) {
+	    called = 1;
+	    atexit(simple_finalize_all);
 	}
 
 	return ptr;
 }
 
 /*
- * Memory deallocator using system free().
+ * Memory deallocator using system free(). Freeing a block cancels its
+ * finalizer.
  */
 static void
 simple_free(interp, ptr, file, line)
@@ -369,10 +493,14 @@ simple_free(interp, ptr, file, line)
 	const char *file;
 	int line;
 {
-	free(ptr);
+	union simple_header *h = HEADER(ptr);
+
+	if (h->index)
+	    simple_finalize_cancel(h->index - 1);
+	free(h);
 }
 
-#endif /* !WITH_BOEHM_GC */
+#endif /* !WITH_BOEHM_GC && !WITH_SEE_GC */
 
 
 /* Reserved for future use */
@@ -0,0 +1,105 @@
+#include "test.inc"
+#include <see/see.h>
+
+/*
+ * Checks that arena interpreters run scripts, that the finalizers of
+ * their memory run when they are destroyed (unless the memory was
+ * freed first), that freed memory is reused, and that memory is
+ * accounted for.
+ */
+
+static void obj_finalize(struct SEE_interpreter *i, void *p, void *closure);
+
+struct obj {
+	struct obj *next;
+	char pad[56];
+};
+
+static unsigned int finalized = 0;
+static int wrong_interp = 0;
+
+static void
+obj_finalize(i, p, closure)
+	struct SEE_interpreter *i;
+	void *p;
+	void *closure;
+{
+	if (i != (struct SEE_interpreter *)closure)
+	    wrong_interp++;
+	finalized++;
+}
+
+void
+test()
+{
+	struct SEE_interpreter interp_storage, *interp = &interp_storage;
+	struct SEE_input *input;
+	SEE_try_context_t try_ctxt;
+	struct SEE_value result;
+	struct SEE_memstats mem;
+	struct obj *o, *p, *q;
+	unsigned int i;
+	int pass;
+	char *program_text =
+	    "var keep = [], ok = true;\n"
+	    "for (var i = 0; i < 20000; i++) {\n"
+	    "  var o = { n: i, s: 'x' + i, a: [i, i + 1] };\n"
+	    "  if (i % 100 == 0) keep.push(o);\n"
+	    "}\n"
+	    "for (var j = 0; j < keep.length; j++)\n"
+	    "  if (keep[j].n != j * 100 || keep[j].s != 'x' + j * 100 ||\n"
+	    "      keep[j].a[1] != j * 100 + 1) ok = false;\n"
+	    "ok && keep.length == 200";
+
+	TEST_DESCRIBE("arena interpreters");
+
+	/* The second pass reuses the chunks released by the first */
+	for (pass = 0; pass < 2; pass++) {
+	    SEE_interpreter_init_arena(interp, SEE_system.default_compat_flags);
+
+	    input = SEE_input_utf8(interp, program_text);
+	    SEE_TRY(interp, try_ctxt) {
+		SEE_Global_eval(interp, input, &result);
+		TEST_EQ_INT(SEE_VALUE_GET_TYPE(&result), SEE_BOOLEAN);
+		TEST(result.u.boolean);
+	    }
+	    SEE_INPUT_CLOSE(input);
+	    TEST_NULL(SEE_CAUGHT(try_ctxt));
+
+	    SEE_interpreter_memstats(interp, &mem);
+	    TEST(mem.total_bytes > 0);
+	    TEST(mem.bytes[SEE_MEM_OBJECT] > 0);
+	    TEST(mem.bytes[SEE_MEM_STRING] > 0);
+	    TEST(mem.bytes[SEE_MEM_CODE] > 0);
+
+	    /* Freed memory is credited and reused */
+	    o = q = SEE_NEW(interp, struct obj);
+	    SEE_interpreter_memstats(interp, &mem);
+	    i = mem.total_blocks;
+	    SEE_free(interp, (void **)&o);
+	    SEE_interpreter_memstats(interp, &mem);
+	    TEST_EQ_INT(mem.total_blocks, i - 1);
+	    p = SEE_NEW(interp, struct obj);
+	    TEST_EQ_PTR(p, q);
+
+	    /* Freeing memory cancels its finalizer */
+	    finalized = 0;
+	    for (i = 0; i < 1000; i++) {
+		o = SEE_NEW_FINALIZE(interp, struct obj, obj_finalize, interp);
+		if (i % 2)
+		    SEE_free(interp, (void **)&o);
+	    }
+	    /* Large blocks are kept apart from the chunks */
+	    o = (struct obj *)SEE_malloc_finalize(interp, 100000,
+		obj_finalize, interp);
+	    o->pad[0] = 1;
+
+	    SEE_interpreter_destroy(interp);
+	    TEST_EQ_INT(finalized, 501);
+	    TEST_EQ_INT(wrong_interp, 0);
+	}
+
+	/* Collected interpreters may be destroyed as well */
+	SEE_interpreter_init(interp);
+	SEE_interpreter_destroy(interp);
+}
@@ -3,6 +3,15 @@
 
 static void obj_finalize(struct SEE_interpreter *i, void *p, void *closure);
 
+/*
+ * Keep setup() out of line, so that test() is not left with a pointer
+ * into the chain in some register for the collector to find.
+ */
+#if defined(__GNUC__)
+static void setup(struct SEE_interpreter *, unsigned int, void **)
+	__attribute__((noinline));
+#endif
+
 struct obj {
 	struct SEE_interpreter *interp;
 	struct obj *chain;
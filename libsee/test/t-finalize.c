@@ -0,0 +1,84 @@
+#include "test.inc"
+#include <see/see.h>
+
+/*
+ * Checks that finalizers are counted as they are registered, that
+ * freeing memory cancels its finalizer, and (without a collector)
+ * that destroying the interpreter runs the rest, newest first.
+ */
+
+static void obj_finalize(struct SEE_interpreter *i, void *p, void *closure);
+
+#define NOBJS	1000
+
+struct obj {
+	unsigned int n;
+	char pad[60];
+};
+
+static struct obj *objs[NOBJS];
+static unsigned int finalized = 0;
+static int wrong = 0;
+
+static void
+obj_finalize(i, p, closure)
+	struct SEE_interpreter *i;
+	void *p;
+	void *closure;
+{
+	struct obj *o = (struct obj *)p;
+
+	/* Only odd objects are left, and they run in reverse */
+	if (i != (struct SEE_interpreter *)closure || o->n % 2 == 0 ||
+	    o->n != NOBJS - 1 - 2 * finalized)
+		wrong++;
+	finalized++;
+}
+
+void
+test()
+{
+	struct SEE_interpreter interp_storage, *interp = &interp_storage;
+	struct SEE_gc_stats stats;
+	unsigned long base;
+	unsigned int i;
+
+	TEST_DESCRIBE("finalizer registration and cancellation");
+
+	SEE_interpreter_init(interp);
+	SEE_gc_add_root(objs, sizeof objs);	/* statics are not scanned */
+	SEE_gc_stats(&stats);
+	base = stats.finalizers;
+
+	for (i = 0; i < NOBJS; i++) {
+	    objs[i] = SEE_NEW_FINALIZE(interp, struct obj, obj_finalize,
+		interp);
+	    objs[i]->n = i;
+	}
+	SEE_gc_stats(&stats);
+	if (stats.finalizers == 0)	/* Boehm's collector doesn't count */
+	    TEST_EXIT_IGNORE();
+	TEST_EQ_INT(stats.finalizers, base + NOBJS);
+
+	/* Freeing memory cancels its finalizer */
+	for (i = 0; i < NOBJS; i += 2)
+	    SEE_free(interp, (void **)&objs[i]);
+	SEE_gc_stats(&stats);
+	TEST_EQ_INT(stats.finalizers, base + NOBJS / 2);
+	TEST_EQ_INT(finalized, 0);
+
+	if (SEE_system.gcollect) {
+	    /* A collector finalizes garbage, not the destroyed interpreter */
+	    SEE_gc_remove_root(objs);
+	    SEE_interpreter_destroy(interp);
+	    return;
+	}
+
+	/* Without a collector, they run when the interpreter goes */
+	SEE_gc_remove_root(objs);
+	SEE_interpreter_destroy(interp);
+	TEST_EQ_INT(finalized, NOBJS / 2);
+	TEST_EQ_INT(wrong, 0);
+	SEE_gc_stats(&stats);
+	TEST_EQ_INT(stats.finalizers, base);
+}
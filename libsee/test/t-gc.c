@@ -0,0 +1,177 @@
+#include "test.inc"
+#include <see/see.h>
+
+/*
+ * Checks that the collector runs on its own as memory is allocated,
+ * and that it does not reclaim objects that scripts still refer to,
+ * both stopping the world and incrementally. Also checks that the
+ * interpreter's memory is accounted for, that its hard limit is
+ * enforced, and that storage held only by a registered static variable
+ * is kept.
+ */
+
+static void obj_finalize(struct SEE_interpreter *i, void *p, void *closure);
+
+#if defined(__GNUC__)
+static void churn(struct SEE_interpreter *, unsigned int)
+	__attribute__((noinline));
+static void keep(struct SEE_interpreter *, unsigned int)
+	__attribute__((noinline));
+#endif
+
+struct obj {
+	struct obj *next;
+	char pad[56];
+};
+
+static unsigned int finalized = 0;
+static unsigned int kept_finalized = 0;
+static struct obj *kept;
+
+static void
+obj_finalize(i, p, closure)
+	struct SEE_interpreter *i;
+	void *p;
+	void *closure;
+{
+	finalized++;
+}
+
+static void
+kept_finalize(i, p, closure)
+	struct SEE_interpreter *i;
+	void *p;
+	void *closure;
+{
+	kept_finalized++;
+}
+
+/* Allocates a chain of n objects that only the variable kept holds */
+static void
+keep(interp, n)
+	struct SEE_interpreter *interp;
+	unsigned int n;
+{
+	struct obj *o;
+
+	while (n--) {
+	    o = SEE_NEW_FINALIZE(interp, struct obj, kept_finalize, 0);
+	    o->next = kept;
+	    kept = o;
+	}
+}
+
+/* Allocates and immediately drops n finalizable objects */
+static void
+churn(interp, n)
+	struct SEE_interpreter *interp;
+	unsigned int n;
+{
+	struct obj *o;
+
+	while (n--) {
+	    o = SEE_NEW_FINALIZE(interp, struct obj, obj_finalize, 0);
+	    o->next = 0;
+	}
+}
+
+void
+test()
+{
+	struct SEE_interpreter interp_storage, *interp = &interp_storage;
+	struct SEE_input * volatile input;
+	SEE_try_context_t try_ctxt;
+	struct SEE_value result;
+	struct SEE_gc_stats stats;
+	struct SEE_memstats mem;
+	struct obj *o;
+	int pass, n;
+	char *program_text =
+	    "var keep = [], ok = true;\n"
+	    "for (var i = 0; i < 100000; i++) {\n"
+	    "  var o = { n: i, s: 'x' + i, a: [i, i + 1] };\n"
+	    "  if (i % 100 == 0) keep.push(o);\n"
+	    "}\n"
+	    "for (var j = 0; j < keep.length; j++)\n"
+	    "  if (keep[j].n != j * 100 || keep[j].s != 'x' + j * 100 ||\n"
+	    "      keep[j].a[1] != j * 100 + 1) ok = false;\n"
+	    "ok && keep.length == 1000";
+	char *greedy_text =
+	    "var a = [];\n"
+	    "try { for (;;) a.push('y' + a.length); }\n"
+	    "catch (e) { if (e.name != 'RangeError') throw e; }\n"
+	    "a = null; true";
+
+	TEST_DESCRIBE("garbage is collected without SEE_gcollect()");
+
+	/* Only works if we have a GC */
+	if (!SEE_system.gcollect)
+	    TEST_EXIT_IGNORE();
+
+	SEE_interpreter_init(interp);
+
+	/* 200000 objects is more than enough to trigger collections */
+	churn(interp, 200000);
+	TEST(finalized > 0);
+
+	for (pass = 0; pass < 2; pass++) {
+	    if (pass == 1) {
+		/* Our own collector reports its statistics; Boehm's doesn't */
+		SEE_gc_stats(&stats);
+		if (!stats.collections)
+		    break;
+		SEE_system.gc_pause_budget = 100;
+	    }
+	    input = SEE_input_utf8(interp, program_text);
+	    SEE_TRY(interp, try_ctxt) {
+		SEE_Global_eval(interp, input, &result);
+		TEST_EQ_INT(SEE_VALUE_GET_TYPE(&result), SEE_BOOLEAN);
+		TEST(result.u.boolean);
+	    }
+	    SEE_INPUT_CLOSE(input);
+	    TEST_NULL(SEE_CAUGHT(try_ctxt));
+	}
+
+	if (pass == 2) {
+	    /* Finish the cycle in progress, then check it was sliced */
+	    while (SEE_gc_step(interp))
+		;
+	    SEE_gc_stats(&stats);
+	    TEST(stats.cycles > 0);
+	    TEST(stats.slices > stats.cycles);
+	    TEST(!stats.collecting);
+	    SEE_system.gc_pause_budget = 0;
+	}
+
+	SEE_interpreter_memstats(interp, &mem);
+	TEST(mem.total_bytes > 0);
+	TEST(mem.peak_bytes >= mem.total_bytes);
+	TEST(mem.bytes[SEE_MEM_OBJECT] > 0);
+	TEST(mem.bytes[SEE_MEM_STRING] > 0);
+	TEST(mem.bytes[SEE_MEM_CODE] > 0);
+
+	/* Only our own collector credits freed blocks back */
+	if (pass == 2) {
+	    interp->mem_hard_limit = mem.total_bytes + 1000000;
+	    input = SEE_input_utf8(interp, greedy_text);
+	    SEE_TRY(interp, try_ctxt) {
+		SEE_Global_eval(interp, input, &result);
+		TEST_EQ_INT(SEE_VALUE_GET_TYPE(&result), SEE_BOOLEAN);
+	    }
+	    SEE_INPUT_CLOSE(input);
+	    TEST_NULL(SEE_CAUGHT(try_ctxt));
+	    SEE_interpreter_memstats(interp, &mem);
+	    TEST(mem.hard_exceeded > 0);
+	    TEST(mem.total_bytes <= interp->mem_hard_limit);
+
+	    /* Static variables are only scanned once registered */
+	    SEE_gc_add_root(&kept, sizeof kept);
+	    keep(interp, 1000);
+	    SEE_gcollect(interp);
+	    for (n = 0, o = kept; o; o = o->next)
+		n++;
+	    TEST_EQ_INT(n, 1000);
+	    TEST_EQ_INT(kept_finalized, 0);
+	    SEE_gc_remove_root(&kept);
+	}
+}
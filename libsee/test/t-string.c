@@ -6,7 +6,9 @@ test()
 {
 	struct SEE_interpreter interp_storage, *interp = &interp_storage;
 	struct SEE_string *s1, *s2;
-	int val;
+	struct SEE_strbuf sb;
+	SEE_char_t *data;
+	int val, i;
 
 	TEST_DESCRIBE("string tests");
 
@@ -42,4 +44,71 @@ test()
 	TEST_EQ_INT(val, +1);
 	val = SEE_string_cmp(s1, SEE_intern_ascii(interp, "helloo"));
 	TEST_EQ_INT(val, -1);
+
+	/* String buffers */
+	SEE_strbuf_init(interp, &sb, 0);
+	SEE_strbuf_append_ascii(&sb, "x=");
+	SEE_strbuf_append_int(&sb, -42);
+	SEE_strbuf_addch(&sb, ' ');
+	SEE_strbuf_append_number(&sb, 1.5);
+	SEE_strbuf_addch(&sb, ' ');
+	SEE_strbuf_append(&sb, s1);
+	SEE_strbuf_append_utf8(&sb, " \xc3\xa9", 3);
+	SEE_strbuf_append_unicode(&sb, 0x1f600);
+	TEST_EQ_INT(sb.length, 19);
+	TEST_EQ_INT(sb.data[16], 0xe9);
+	TEST_EQ_INT(sb.data[17], 0xd83d);
+	TEST_EQ_INT(sb.data[18], 0xde00);
+	data = sb.data;
+	s2 = SEE_strbuf_string(&sb);
+	TEST_EQ_PTR(s2->data, data);		/* handed over without a copy */
+	TEST_EQ_INT(s2->length, 19);
+	TEST_EQ_INT(sb.length, 0);
+	s2->length = 16;
+	val = SEE_string_cmp_ascii(s2, "x=-42 1.5 hello ");
+	TEST_EQ_INT(val, 0);
+
+	/* The handed-over string is still growable */
+	SEE_string_append_ascii(s2, "!");
+	TEST_EQ_INT(s2->data[16], '!');
+
+	/* Reserved space can be filled directly */
+	SEE_strbuf_init(interp, &sb, 0);
+	for (i = 0; i < 1000; i++)
+		SEE_strbuf_addch(&sb, 'a' + i % 26);
+	TEST_EQ_INT(sb.length, 1000);
+	TEST_EQ_INT(sb.capacity >= 1000, 1);
+	SEE_strbuf_reserve(&sb, 5);
+	TEST_EQ_INT(sb.capacity - sb.length >= 5, 1);
+	SEE_STRBUF_PUTCH(&sb, 'z');
+	TEST_EQ_INT(sb.data[999], 'l');
+	TEST_EQ_INT(sb.data[1000], 'z');
+
+	/* An empty buffer yields an empty string */
+	SEE_strbuf_init(interp, &sb, 0);
+	s2 = SEE_strbuf_string(&sb);
+	TEST_EQ_INT(s2->length, 0);
+
+	s2 = SEE_string_sprintf(interp, "%d-%s", 7, "up");
+	val = SEE_string_cmp_ascii(s2, "7-up");
+	TEST_EQ_INT(val, 0);
+
+	/* Case-insensitive comparison */
+	s1 = SEE_string_sprintf(interp, "Content-Type: text/plain%C", 0xe9);
+	s2 = SEE_string_sprintf(interp, "content-type: TEXT/PLAIN%C", 0xc9);
+	val = SEE_string_casecmp(s1, s2);
+	TEST_EQ_INT(val, 0);
+	val = SEE_string_cmp(s1, s2);
+	TEST_EQ_INT(val, -1);
+	s2->length--;
+	val = SEE_string_casecmp(s1, s2);
+	TEST_EQ_INT(val, 1);
+	val = SEE_string_casecmp(s2, s1);
+	TEST_EQ_INT(val, -1);
+	s2 = SEE_string_sprintf(interp, "content-type: text/plaiz");
+	val = SEE_string_casecmp(s1, s2);
+	TEST_EQ_INT(val, -1);
+	s2 = SEE_string_sprintf(interp, "CONTENT-TYPE: [");
+	val = SEE_string_casecmp(s1, s2);	/* 'T' < '[' */
+	TEST_EQ_INT(val, -1);
 }
@@ -0,0 +1,85 @@
+#include "test.inc"
+#include <see/see.h>
+
+/* Text long enough to use the block converters, with 1-4 byte chars */
+static const char test_utf8[] =
+	"The quick brown fox jumps over the lazy dog "	/* 44 */
+	"\xc3\xa9"					/* U+00E9 */
+	"\xe2\x82\xac"					/* U+20AC */
+	"\xf0\x9f\x98\x80"				/* U+1F600 */
+	" 0123456789abcdefghij";			/* 21 */
+
+/* Decodes a UTF-8 C string into at most max code points */
+static int
+decode(interp, s, out, max)
+	struct SEE_interpreter *interp;
+	const char *s;
+	SEE_unicode_t *out;
+	int max;
+{
+	struct SEE_input *inp;
+	int n = 0;
+
+	inp = SEE_input_utf8(interp, s);
+	while (!inp->eof && n < max)
+		out[n++] = SEE_INPUT_NEXT(inp);
+	SEE_INPUT_CLOSE(inp);
+	return n;
+}
+
+void
+test()
+{
+	struct SEE_interpreter interp_storage, *interp = &interp_storage;
+	struct SEE_string *s;
+	SEE_unicode_t u[100];
+	char buf[100];
+	int i, n;
+
+	TEST_DESCRIBE("UTF-8 conversion tests");
+
+	SEE_interpreter_init(interp);
+
+	/* Decoding */
+	n = decode(interp, test_utf8, u, 100);
+	TEST_EQ_INT(n, 44 + 3 + 21);
+	TEST_EQ_INT(u[0], 'T');
+	TEST_EQ_INT(u[43], ' ');
+	TEST_EQ_INT(u[44], 0xe9);
+	TEST_EQ_INT(u[45], 0x20ac);
+	TEST_EQ_INT(u[46], 0x1f600);
+	TEST_EQ_INT(u[47], ' ');
+	TEST_EQ_INT(u[67], 'j');
+
+	/* Overlong form */
+	n = decode(interp, "a\xc0\xafz", u, 100);
+	TEST_EQ_INT(n, 3);
+	TEST_EQ_INT(u[1], SEE_INPUT_BADCHAR);
+	TEST_EQ_INT(u[2], 'z');
+
+	/* Missing continuation byte */
+	n = decode(interp, "a\xe2\x82z", u, 100);
+	TEST_EQ_INT(n, 3);
+	TEST_EQ_INT(u[1], SEE_INPUT_BADCHAR);
+	TEST_EQ_INT(u[2], 'z');
+
+	/* Truncated by the nul */
+	n = decode(interp, "ab\xe2\x82", u, 100);
+	TEST_EQ_INT(n, 3);
+	TEST_EQ_INT(u[2], SEE_INPUT_BADCHAR);
+
+	/* Encoding */
+	s = SEE_string_new(interp, 0);
+	for (i = 0; i < 44; i++)
+		SEE_string_addch(s, test_utf8[i]);
+	SEE_string_addch(s, 0xe9);
+	SEE_string_addch(s, 0x20ac);
+	SEE_string_addch(s, 0xd83d);
+	SEE_string_addch(s, 0xde00);
+	for (i = 0; i < 21; i++)
+		SEE_string_addch(s, test_utf8[44 + 2 + 3 + 4 + i]);
+
+	TEST_EQ_INT(SEE_string_utf8_size(interp, s), sizeof test_utf8 - 1);
+	SEE_string_toutf8(interp, buf, sizeof buf, s);
+	TEST_EQ_STR(buf, test_utf8);
+}
@@ -0,0 +1,371 @@
+/*
+ * Copyright (c) 2008
+ *      David Leonard.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of David Leonard nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/* $Id$ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <see/type.h>
+#include <see/mem.h>
+#include <see/string.h>
+#include <see/input.h>
+#include <see/error.h>
+#include <see/interpreter.h>
+
+#include "stringdefs.h"
+#include "unicode.h"
+#include "utf8.h"
+#include "simd.h"
+
+/*
+ * UTF-8 transcoding (RFC 2279, RFC 2781).
+ *
+ * Each conversion loop first tries to convert a block of 16 ASCII
+ * characters at once. If the block contains a non-ASCII character,
+ * the block is converted one character at a time instead.
+ */
+
+#define REPLACEMENT_CHAR	0xfffd
+
+static unsigned int decode_seq(struct SEE_interpreter *,
+	const unsigned char *, const unsigned char *, SEE_unicode_t *,
+	SEE_unicode_t);
+static unsigned int char_size(struct SEE_interpreter *,
+	const SEE_char_t *, unsigned int, unsigned int *);
+
+/*
+ * Decodes the multibyte sequence at s into *cpp, returning the number
+ * of bytes consumed. Malformed sequences are decoded as the
+ * character bad. Returns 0 if the sequence is cut short by end.
+ * This is a non-strict decoder: surrogate code points and (with
+ * SEE_COMPAT_UTF_UNSAFE) overlong forms are passed through.
+ */
+static unsigned int
+decode_seq(interp, s, end, cpp, bad)
+	struct SEE_interpreter *interp;
+	const unsigned char *s, *end;
+	SEE_unicode_t *cpp, bad;
+{
+	static const unsigned char mask[] = 
+		{ 0xc0, 0xe0, 0xf0, 0xf8, 0xfc, 0xfe };
+	static const SEE_unicode_t safe[] = 
+		{ 0, 0x80, 0x800, 0x10000, 0x200000, 0x4000000 };
+	unsigned int bytes, i;
+	SEE_unicode_t c;
+
+	if (*s < 0x80) {
+		*cpp = *s;
+		return 1;
+	}
+	for (bytes = 1; bytes < 6; bytes++)
+	    if ((*s & mask[bytes]) == mask[bytes - 1])
+		break;
+	if (bytes == 6) {
+		*cpp = bad;
+		return 1;
+	}
+	c = *s & ~mask[bytes];
+	for (i = 1; i <= bytes; i++) {
+	    if (s + i == end)
+		return 0;
+	    if ((s[i] & 0xc0) != 0x80) {
+		*cpp = bad;
+		return i;
+	    }
+	    c = (c << 6) | (s[i] & 0x3f);
+	}
+	if (c > _UNICODE_MAX)
+		c = bad;
+	else if (c < safe[bytes] && 
+	    !(interp->compatibility & SEE_COMPAT_UTF_UNSAFE))
+		c = bad;
+	*cpp = c;
+	return bytes + 1;
+}
+
+unsigned int
+_SEE_utf8_decode(interp, srcp, srcend, dst, dstlen)
+	struct SEE_interpreter *interp;
+	const unsigned char **srcp, *srcend;
+	SEE_unicode_t *dst;
+	unsigned int dstlen;
+{
+	const unsigned char *s = *srcp;
+	unsigned int n = 0, k;
+#if SIMD_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	__m128i v, lo, hi;
+	unsigned int mask;
+#endif
+
+	while (s < srcend && n < dstlen) {
+#if SIMD_SSE2
+	    if (srcend - s >= 16 && dstlen - n >= 16) {
+		v = _mm_loadu_si128((const __m128i *)s);
+		mask = _mm_movemask_epi8(v);
+		if (mask == 0) {
+		    lo = _mm_unpacklo_epi8(v, zero);
+		    hi = _mm_unpackhi_epi8(v, zero);
+		    _mm_storeu_si128((__m128i *)(dst + n),
+			_mm_unpacklo_epi16(lo, zero));
+		    _mm_storeu_si128((__m128i *)(dst + n + 4),
+			_mm_unpackhi_epi16(lo, zero));
+		    _mm_storeu_si128((__m128i *)(dst + n + 8),
+			_mm_unpacklo_epi16(hi, zero));
+		    _mm_storeu_si128((__m128i *)(dst + n + 12),
+			_mm_unpackhi_epi16(hi, zero));
+		    s += 16;
+		    n += 16;
+		    continue;
+		}
+		/* Copy the ASCII characters before the first non-ASCII */
+		for (k = SIMD_CTZ(mask); k; k--)
+		    dst[n++] = *s++;
+	    }
+#endif
+	    if (*s < 0x80) {
+		dst[n++] = *s++;
+		continue;
+	    }
+	    k = decode_seq(interp, s, srcend, &dst[n], SEE_INPUT_BADCHAR);
+	    if (!k)
+		break;
+	    s += k;
+	    n++;
+	}
+	*srcp = s;
+	return n;
+}
+
+unsigned int
+_SEE_utf8_to_utf16(interp, dst, src, srclen)
+	struct SEE_interpreter *interp;
+	SEE_char_t *dst;
+	const char *src;
+	SEE_size_t srclen;
+{
+	const unsigned char *s = (const unsigned char *)src;
+	const unsigned char *end = s + srclen;
+	SEE_char_t *d = dst;
+	SEE_unicode_t c;
+	unsigned int k;
+#if SIMD_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	__m128i v;
+	unsigned int mask;
+#endif
+
+	while (s < end) {
+#if SIMD_SSE2
+	    if (end - s >= 16) {
+		v = _mm_loadu_si128((const __m128i *)s);
+		mask = _mm_movemask_epi8(v);
+		if (mask == 0) {
+		    _mm_storeu_si128((__m128i *)d, _mm_unpacklo_epi8(v, zero));
+		    _mm_storeu_si128((__m128i *)(d + 8),
+			_mm_unpackhi_epi8(v, zero));
+		    s += 16;
+		    d += 16;
+		    continue;
+		}
+		for (k = SIMD_CTZ(mask); k; k--)
+		    *d++ = *s++;
+	    }
+#endif
+	    if (*s < 0x80) {
+		*d++ = *s++;
+		continue;
+	    }
+	    k = decode_seq(interp, s, end, &c, REPLACEMENT_CHAR);
+	    if (!k) {
+		*d++ = REPLACEMENT_CHAR;
+		break;
+	    }
+	    s += k;
+	    if (c >= 0x10000) {
+		c -= 0x10000;
+		*d++ = 0xd800 | (c >> 10);
+		*d++ = 0xdc00 | (c & 0x3ff);
+	    } else
+		*d++ = c;
+	}
+	return d - dst;
+}
+
+struct SEE_string *
+_SEE_utf8_to_string(interp, src, srclen)
+	struct SEE_interpreter *interp;
+	const char *src;
+	SEE_size_t srclen;
+{
+	struct SEE_string *str;
+
+	/* UTF-16 never needs more units than UTF-8 needs bytes */
+	str = SEE_string_new(interp, srclen);
+	str->length = _SEE_utf8_to_utf16(interp, str->data, src, srclen);
+	return str;
+}
+
+/*
+ * Returns the UTF-8 size of the character at src[*ip], advancing *ip 
+ * past it.
+ */
+static unsigned int
+char_size(interp, src, srclen, ip)
+	struct SEE_interpreter *interp;
+	const SEE_char_t *src;
+	unsigned int srclen, *ip;
+{
+	SEE_char_t ch = src[(*ip)++];
+
+	if ((ch & 0xff80) == 0)
+		return 1;
+	if ((ch & 0xf800) == 0)
+		return 2;
+	if ((ch & 0xfc00) != 0xd800)
+		return 3;
+	if (*ip == srclen || (src[*ip] & 0xfc00) != 0xdc00)
+		SEE_error_throw_string(interp, interp->Error, 
+			STR(bad_utf16_string));
+	(*ip)++;
+	return 4;
+}
+
+SEE_size_t
+_SEE_utf8_size(interp, src, srclen)
+	struct SEE_interpreter *interp;
+	const SEE_char_t *src;
+	unsigned int srclen;
+{
+	SEE_size_t len = 0;
+	unsigned int i = 0, lim;
+#if SIMD_SSE2
+	const __m128i m80 = _mm_set1_epi16((short)0xff80);
+	const __m128i m800 = _mm_set1_epi16((short)0xf800);
+	const __m128i sur = _mm_set1_epi16((short)0xd800);
+	const __m128i zero = _mm_setzero_si128();
+	__m128i v, hi;
+	unsigned int narrow, single;
+#endif
+
+	while (i < srclen) {
+	    lim = srclen;
+#if SIMD_SSE2
+	    if (srclen - i >= 8) {
+		v = _mm_loadu_si128((const __m128i *)(src + i));
+		hi = _mm_and_si128(v, m800);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi16(hi, sur)) == 0) {
+		    /* No surrogates: 1, 2 or 3 bytes for each unit */
+		    single = _mm_movemask_epi8(_mm_cmpeq_epi16(
+			_mm_and_si128(v, m80), zero));
+		    narrow = _mm_movemask_epi8(_mm_cmpeq_epi16(hi, zero));
+		    len += 3 * 8 - (SIMD_POPCOUNT(single) + 
+			SIMD_POPCOUNT(narrow)) / 2;
+		    i += 8;
+		    continue;
+		}
+		lim = i + 8;
+	    }
+#endif
+	    while (i < lim)
+		len += char_size(interp, src, srclen, &i);
+	}
+	return len;
+}
+
+unsigned int
+_SEE_utf8_encode(interp, dstp, dstend, src, srclen)
+	struct SEE_interpreter *interp;
+	char **dstp, *dstend;
+	const SEE_char_t *src;
+	unsigned int srclen;
+{
+	unsigned char *d = (unsigned char *)*dstp;
+	unsigned char *end = (unsigned char *)dstend;
+	unsigned int i = 0, j, lim, size;
+	SEE_unicode_t c;
+#if SIMD_SSE2
+	const __m128i m80 = _mm_set1_epi16((short)0xff80);
+	const __m128i zero = _mm_setzero_si128();
+	__m128i a, b;
+#endif
+
+	while (i < srclen) {
+	    lim = srclen;
+#if SIMD_SSE2
+	    if (srclen - i >= 16) {
+		a = _mm_loadu_si128((const __m128i *)(src + i));
+		b = _mm_loadu_si128((const __m128i *)(src + i + 8));
+		if (end - d >= 16 && _mm_movemask_epi8(_mm_cmpeq_epi16(
+		    _mm_and_si128(_mm_or_si128(a, b), m80), zero)) == 0xffff)
+		{
+		    _mm_storeu_si128((__m128i *)d, _mm_packus_epi16(a, b));
+		    d += 16;
+		    i += 16;
+		    continue;
+		}
+		lim = i + 16;
+	    }
+#endif
+	    while (i < lim) {
+		j = i;
+		size = char_size(interp, src, srclen, &j);
+		if (end - d < size)
+		    goto out;
+		c = src[i];
+		switch (size) {
+		case 1:
+		    *d++ = c;
+		    break;
+		case 2:
+		    *d++ = 0xc0 | (c >> 6);
+		    *d++ = 0x80 | (c & 0x3f);
+		    break;
+		case 3:
+		    *d++ = 0xe0 | (c >> 12);
+		    *d++ = 0x80 | ((c >> 6) & 0x3f);
+		    *d++ = 0x80 | (c & 0x3f);
+		    break;
+		case 4:
+		    c = 0x10000 + ((c & 0x3ff) << 10) + (src[i + 1] & 0x3ff);
+		    *d++ = 0xf0 | (c >> 18);
+		    *d++ = 0x80 | ((c >> 12) & 0x3f);
+		    *d++ = 0x80 | ((c >> 6) & 0x3f);
+		    *d++ = 0x80 | (c & 0x3f);
+		    break;
+		}
+		i = j;
+	    }
+	}
+    out:
+	*dstp = (char *)d;
+	return i;
+}
@@ -0,0 +1,52 @@
+/* Copyright (c) 2008, David Leonard. All rights reserved. */
+/* $Id$ */
+
+#ifndef _SEE_h_utf8_
+#define _SEE_h_utf8_
+
+#include <see/type.h>
+
+struct SEE_interpreter;
+struct SEE_string;
+
+/*
+ * UTF-8 <-> UTF-16 transcoding, shared by the string output functions,
+ * the UTF-8 inputs and the cfunction argument converters. Runs of
+ * 7-bit ASCII are converted in blocks with vector instructions.
+ *
+ * _SEE_utf8_decode() decodes UTF-8 at *srcp into at most dstlen
+ * code points, advancing *srcp. Malformed sequences decode as
+ * SEE_INPUT_BADCHAR; overlong forms are malformed unless the
+ * interpreter has SEE_COMPAT_UTF_UNSAFE. Decoding stops early,
+ * leaving *srcp at its lead byte, if a sequence is cut off by srcend.
+ * Returns the number of code points stored.
+ *
+ * _SEE_utf8_to_utf16() decodes srclen bytes of UTF-8 into dst, which
+ * must have room for srclen units, and returns the number of units
+ * stored. Malformed or truncated sequences become U+FFFD.
+ * _SEE_utf8_to_string() does the same into a new string.
+ *
+ * _SEE_utf8_size() returns the number of bytes needed to encode
+ * UTF-16 text as UTF-8, not including any terminating nul.
+ *
+ * _SEE_utf8_encode() encodes as many whole characters as will fit
+ * between *dstp and dstend, advancing *dstp, and returns the number
+ * of UTF-16 units consumed.
+ *
+ * The encoding functions throw an Error if the UTF-16 text has a high
+ * surrogate that is not followed by a low surrogate.
+ */
+unsigned int _SEE_utf8_decode(struct SEE_interpreter *interp,
+	const unsigned char **srcp, const unsigned char *srcend,
+	SEE_unicode_t *dst, unsigned int dstlen);
+unsigned int _SEE_utf8_to_utf16(struct SEE_interpreter *interp,
+	SEE_char_t *dst, const char *src, SEE_size_t srclen);
+struct SEE_string *_SEE_utf8_to_string(struct SEE_interpreter *interp,
+	const char *src, SEE_size_t srclen);
+SEE_size_t _SEE_utf8_size(struct SEE_interpreter *interp,
+	const SEE_char_t *src, unsigned int srclen);
+unsigned int _SEE_utf8_encode(struct SEE_interpreter *interp,
+	char **dstp, char *dstend, const SEE_char_t *src, 
+	unsigned int srclen);
+
+#endif /* _SEE_h_utf8_ */
@@ -55,6 +55,7 @@
 #include "stringdefs.h"
 #include "dtoa.h"
 #include "nmath.h"
+#include "strcache.h"
 
 /*
  * Value type-converters and some numeric constants.
@@ -279,13 +280,21 @@ SEE_ToString(interp, val, res)
 			SEE_SET_STRING(res, STR(NaN));
 		} else if (val->u.number == 0) {
 			SEE_SET_STRING(res, STR(zero_digit));
+		} else if (val->u.number > 0 && 
+		    val->u.number <= 4294967295.0 &&
+		    val->u.number == (SEE_uint32_t)val->u.number)
+		{
+			/* Integers don't need dtoa; small ones are cached */
+			SEE_SET_STRING(res, _SEE_string_uint(interp,
+			    (SEE_uint32_t)val->u.number));
 		} else if (val->u.number < 0) {
 			struct SEE_value neg, negstr;
 			SEE_SET_NUMBER(&neg, -(val->u.number));
 			SEE_ToString(interp, &neg, &negstr);
 			SEE_SET_STRING(res, SEE_string_concat(interp,
 			    STR(minus), negstr.u.string));
-			SEE_string_free(interp, &negstr.u.string);
+			if (!(negstr.u.string->flags & SEE_STRING_FLAG_INTERNED))
+			    SEE_string_free(interp, &negstr.u.string);
 		} else if (SEE_NUMBER_ISPINF(val)) {
 			SEE_SET_STRING(res, STR(Infinity));
 		} else {
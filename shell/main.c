@@ -54,8 +54,12 @@ static void run_file(struct SEE_interpreter *, char *);
 static void run_interactive(struct SEE_interpreter *);
 static void run_html(struct SEE_interpreter *, char *);
 static void run_string(struct SEE_interpreter *, char *);
+static void profile_allocs(char *, int);
+static void write_alloc_profile(void);
 
 static struct debug *debugger;
+static char *alloc_profile_file;
+static int alloc_profile_format;
 
 /* 
  * Enables the debugging flag given by character c.
@@ -139,6 +143,40 @@ trace_enable()
 	}
 }
 
+/*
+ * Starts profiling memory allocations, arranging for the profile to be
+ * written to the named file (or "-" for stderr) in the given format
+ * when the shell exits.
+ */
+static void
+profile_allocs(file, format)
+	char *file;
+	int format;
+{
+	if (!alloc_profile_file)
+	    atexit(write_alloc_profile);
+	alloc_profile_file = file;
+	alloc_profile_format = format;
+	SEE_alloc_profile(1);
+}
+
+static void
+write_alloc_profile()
+{
+	FILE *f;
+
+	SEE_alloc_profile(0);
+	if (strcmp(alloc_profile_file, "-") == 0)
+	    f = stderr;
+	else if ((f = fopen(alloc_profile_file, "w")) == NULL) {
+	    perror(alloc_profile_file);
+	    return;
+	}
+	SEE_PrintAllocProfile(f, alloc_profile_format);
+	if (f != stderr)
+	    fclose(f);
+}
+
 /*
  * Runs the input given by inp, printing any exceptions
  * to stderr.
@@ -467,8 +505,16 @@ main(argc, argv)
 	}						\
   } while (0)
 
-	while (!error && (ch = getopt(argc, argv, "c:d:e:f:gh:il:r:V")) != -1)
+	while (!error && (ch = getopt(argc, argv, "A:a:c:d:e:f:gh:il:r:V")) != -1)
 	    switch (ch) {
+	    case 'a':
+		profile_allocs(optarg, SEE_ALLOC_PROFILE_TEXT);
+		break;
+
+	    case 'A':
+		profile_allocs(optarg, SEE_ALLOC_PROFILE_PPROF);
+		break;
+
 	    case 'c':
 		if (compat_tovalue(optarg, &SEE_system.default_compat_flags)
 			== -1)
@@ -502,8 +548,11 @@ main(argc, argv)
 
 	    case 'g':
 		INIT_INTERP_ONCE;
-	    	if (!debugger)
+	    	if (!debugger) {
+			/* The collector does not scan static variables */
+			SEE_gc_add_root(&debugger, sizeof debugger);
 			debugger = debug_new(&interp);
+		}
 		break;
 
 	    case 'h':
@@ -553,6 +602,7 @@ main(argc, argv)
 	    fprintf(stderr, "usage: %s\n", argv[0]);
 	    fprintf(stderr, "       [-Vg] [-c flag]\n");
 	    fprintf(stderr, "       [-r maxrecurs]\n");
+	    fprintf(stderr, "       [-a profile.txt | -A profile.heap]\n");
 #ifndef NDEBUG
 	    fprintf(stderr, "       [-d[ETcelmnprsv]]\n");
 #endif
@@ -163,7 +163,9 @@ static struct SEE_objectclass file_inst_class = {
         SEE_native_enumerator,          /* DefaultValue */
         NULL,                           /* Construct */
         NULL,                           /* Call */
-        NULL                            /* HasInstance */
+        NULL,                           /* HasInstance */
+        NULL,                           /* get_sec_domain */
+        SEE_native_trace                /* trace */
 };
 
 /*
@@ -183,7 +185,10 @@ static struct SEE_objectclass file_constructor_class = {
         SEE_native_defaultvalue,        /* DefaultValue */
         SEE_native_enumerator,          /* DefaultValue */
         file_construct,                 /* Construct */
-        NULL                            /* Call */
+        NULL,                           /* Call */
+        NULL,                           /* HasInstance */
+        NULL,                           /* get_sec_domain */
+        SEE_native_trace                /* trace */
 };
 
 /*
@@ -17,6 +17,14 @@
  *  Shell.gcdump - calls GC_dump(), if available
  *  Shell.regex_engines - returns array of regex engines
  *  Shell.regex_engine  - sets/gets the current interp's regex engine
+ *  Shell.regex_cache_stats - returns compiled regex cache hits and misses
+ *  Shell.regex_jit     - sets/gets the regex native code threshold
+ *  Shell.regex_backtrack_peak - returns and resets the deepest regex
+ *			  backtrack stack
+ *  Shell.gc_pause	- sets/gets the incremental GC pause budget (usec)
+ *  Shell.gc_stats	- returns the garbage collector's statistics
+ *  Shell.mem_limit	- sets the interpreter's soft and hard memory limits
+ *  Shell.memstats	- returns the interpreter's memory use
  *
  * In HTML mode the following objects are provided:
  *
@@ -76,6 +84,28 @@ static void shell_regex_engines_fn(struct SEE_interpreter *,
 static void shell_regex_engine_fn(struct SEE_interpreter *, 
 	struct SEE_object *, struct SEE_object *, int, struct SEE_value **, 
 	struct SEE_value *);
+static void shell_regex_cache_stats_fn(struct SEE_interpreter *, 
+	struct SEE_object *, struct SEE_object *, int, struct SEE_value **, 
+	struct SEE_value *);
+static void shell_regex_jit_fn(struct SEE_interpreter *, 
+	struct SEE_object *, struct SEE_object *, int, struct SEE_value **, 
+	struct SEE_value *);
+static void shell_regex_backtrack_peak_fn(struct SEE_interpreter *, 
+	struct SEE_object *, struct SEE_object *, int, struct SEE_value **, 
+	struct SEE_value *);
+static void shell_periodic(struct SEE_interpreter *);
+static void shell_gc_pause_fn(struct SEE_interpreter *, 
+	struct SEE_object *, struct SEE_object *, int, struct SEE_value **, 
+	struct SEE_value *);
+static void shell_gc_stats_fn(struct SEE_interpreter *, 
+	struct SEE_object *, struct SEE_object *, int, struct SEE_value **, 
+	struct SEE_value *);
+static void shell_mem_limit_fn(struct SEE_interpreter *, 
+	struct SEE_object *, struct SEE_object *, int, struct SEE_value **, 
+	struct SEE_value *);
+static void shell_memstats_fn(struct SEE_interpreter *, 
+	struct SEE_object *, struct SEE_object *, int, struct SEE_value **, 
+	struct SEE_value *);
 
 /*
  * Adds useful symbols into the interpreter's internal symbol table. 
@@ -102,6 +132,15 @@ shell_strings()
 	SEE_intern_global("abort");
 	SEE_intern_global("regex_engines");
 	SEE_intern_global("regex_engine");
+	SEE_intern_global("regex_cache_stats");
+	SEE_intern_global("hits");
+	SEE_intern_global("misses");
+	SEE_intern_global("regex_jit");
+	SEE_intern_global("regex_backtrack_peak");
+	SEE_intern_global("gc_pause");
+	SEE_intern_global("gc_stats");
+	SEE_intern_global("mem_limit");
+	SEE_intern_global("memstats");
 }
 
 /*
@@ -361,6 +400,190 @@ shell_regex_engine_fn(interp, self, thisobj, argc, argv, res)
 	    *names ? *names : "?"));
 }
 
+/*
+ * Return an object with the compiled regex cache's hits and misses
+ */
+static void
+shell_regex_cache_stats_fn(interp, self, thisobj, argc, argv, res)
+        struct SEE_interpreter *interp;
+        struct SEE_object *self, *thisobj;
+        int argc;
+        struct SEE_value **argv, *res;
+{
+	unsigned long hits, misses;
+	struct SEE_object *stats;
+	struct SEE_value v;
+
+	SEE_regex_cache_stats(interp, &hits, &misses);
+	stats = SEE_Object_new(interp);
+	SEE_SET_NUMBER(&v, hits);
+	SEE_OBJECT_PUTA(interp, stats, "hits", &v, SEE_ATTR_DEFAULT);
+	SEE_SET_NUMBER(&v, misses);
+	SEE_OBJECT_PUTA(interp, stats, "misses", &v, SEE_ATTR_DEFAULT);
+	SEE_SET_OBJECT(res, stats);
+}
+
+/*
+ * Set the number of matches before a regex is compiled to native code
+ * (-1 means never), and return the previous setting
+ */
+static void
+shell_regex_jit_fn(interp, self, thisobj, argc, argv, res)
+        struct SEE_interpreter *interp;
+        struct SEE_object *self, *thisobj;
+        int argc;
+        struct SEE_value **argv, *res;
+{
+	struct SEE_value v;
+
+	SEE_SET_NUMBER(res, interp->regex_jit_threshold);
+	if (argc > 0 && SEE_VALUE_GET_TYPE(argv[0]) != SEE_UNDEFINED) {
+		SEE_ToNumber(interp, argv[0], &v);
+		interp->regex_jit_threshold = (int)v.u.number;
+	}
+}
+
+/*
+ * Return the deepest regex backtrack stack seen since the last call
+ */
+static void
+shell_regex_backtrack_peak_fn(interp, self, thisobj, argc, argv, res)
+        struct SEE_interpreter *interp;
+        struct SEE_object *self, *thisobj;
+        int argc;
+        struct SEE_value **argv, *res;
+{
+	SEE_SET_NUMBER(res, interp->regex_backtrack_peak);
+	interp->regex_backtrack_peak = 0;
+}
+
+/*
+ * Called before each statement while incremental collection is on
+ */
+static void
+shell_periodic(interp)
+	struct SEE_interpreter *interp;
+{
+	SEE_gc_step(interp);
+}
+
+/*
+ * Set the incremental garbage collection pause budget in microseconds
+ * (0 means stop-the-world collection), and return the previous setting
+ */
+static void
+shell_gc_pause_fn(interp, self, thisobj, argc, argv, res)
+        struct SEE_interpreter *interp;
+        struct SEE_object *self, *thisobj;
+        int argc;
+        struct SEE_value **argv, *res;
+{
+	struct SEE_value v;
+
+	SEE_SET_NUMBER(res, SEE_system.gc_pause_budget);
+	if (argc > 0 && SEE_VALUE_GET_TYPE(argv[0]) != SEE_UNDEFINED) {
+		SEE_ToNumber(interp, argv[0], &v);
+		SEE_system.gc_pause_budget = 
+		    v.u.number > 0 ? (unsigned int)v.u.number : 0;
+		if (SEE_system.gc_pause_budget && !SEE_system.periodic)
+			SEE_system.periodic = shell_periodic;
+	}
+}
+
+/*
+ * Return an object with the garbage collector's statistics
+ */
+static void
+shell_gc_stats_fn(interp, self, thisobj, argc, argv, res)
+        struct SEE_interpreter *interp;
+        struct SEE_object *self, *thisobj;
+        int argc;
+        struct SEE_value **argv, *res;
+{
+	struct SEE_gc_stats st;
+	struct SEE_object *stats;
+	struct SEE_value v;
+
+	SEE_gc_stats(&st);
+	stats = SEE_Object_new(interp);
+#define STAT(name) do {						\
+	SEE_SET_NUMBER(&v, st.name);					\
+	SEE_OBJECT_PUTA(interp, stats, #name, &v, SEE_ATTR_DEFAULT);	\
+    } while (0)
+	STAT(collections);
+	STAT(cycles);
+	STAT(slices);
+	STAT(pauses);
+	STAT(pause_last);
+	STAT(pause_max);
+	STAT(pause_total);
+	STAT(live_bytes);
+	STAT(heap_bytes);
+#undef STAT
+	SEE_SET_BOOLEAN(&v, st.collecting);
+	SEE_OBJECT_PUTA(interp, stats, "collecting", &v, SEE_ATTR_DEFAULT);
+	SEE_SET_OBJECT(res, stats);
+}
+
+/*
+ * Set the interpreter's soft and hard memory limits in bytes (0 means
+ * no limit); an undefined argument leaves that limit alone
+ */
+static void
+shell_mem_limit_fn(interp, self, thisobj, argc, argv, res)
+        struct SEE_interpreter *interp;
+        struct SEE_object *self, *thisobj;
+        int argc;
+        struct SEE_value **argv, *res;
+{
+	struct SEE_value v;
+
+	if (argc > 0 && SEE_VALUE_GET_TYPE(argv[0]) != SEE_UNDEFINED) {
+		SEE_ToNumber(interp, argv[0], &v);
+		interp->mem_soft_limit = 
+		    v.u.number > 0 ? (SEE_size_t)v.u.number : 0;
+	}
+	if (argc > 1 && SEE_VALUE_GET_TYPE(argv[1]) != SEE_UNDEFINED) {
+		SEE_ToNumber(interp, argv[1], &v);
+		interp->mem_hard_limit = 
+		    v.u.number > 0 ? (SEE_size_t)v.u.number : 0;
+	}
+	SEE_SET_UNDEFINED(res);
+}
+
+/*
+ * Return an object describing the interpreter's live memory
+ */
+static void
+shell_memstats_fn(interp, self, thisobj, argc, argv, res)
+        struct SEE_interpreter *interp;
+        struct SEE_object *self, *thisobj;
+        int argc;
+        struct SEE_value **argv, *res;
+{
+	struct SEE_memstats st;
+	struct SEE_object *stats;
+	struct SEE_value v;
+
+	SEE_interpreter_memstats(interp, &st);
+	stats = SEE_Object_new(interp);
+#define STAT(name, value) do {						\
+	SEE_SET_NUMBER(&v, value);					\
+	SEE_OBJECT_PUTA(interp, stats, name, &v, SEE_ATTR_DEFAULT);	\
+    } while (0)
+	STAT("objects", st.bytes[SEE_MEM_OBJECT]);
+	STAT("strings", st.bytes[SEE_MEM_STRING]);
+	STAT("code", st.bytes[SEE_MEM_CODE]);
+	STAT("properties", st.bytes[SEE_MEM_PROPERTY]);
+	STAT("total_bytes", st.total_bytes);
+	STAT("total_blocks", st.total_blocks);
+	STAT("peak_bytes", st.peak_bytes);
+	STAT("soft_exceeded", st.soft_exceeded);
+	STAT("hard_exceeded", st.hard_exceeded);
+#undef STAT
+	SEE_SET_OBJECT(res, stats);
+}
+
 static void
 add_methods(interp, object, methods)
 	struct SEE_interpreter *interp;
@@ -399,6 +622,13 @@ shell_add_globals(interp)
 		{ "abort",		shell_abort_fn,		1 },
 		{ "regex_engines",	shell_regex_engines_fn,	0 },
 		{ "regex_engine",	shell_regex_engine_fn,	1 },
+		{ "regex_cache_stats",	shell_regex_cache_stats_fn, 0 },
+		{ "regex_jit",		shell_regex_jit_fn,	1 },
+		{ "regex_backtrack_peak", shell_regex_backtrack_peak_fn, 0 },
+		{ "gc_pause",		shell_gc_pause_fn,	1 },
+		{ "gc_stats",		shell_gc_stats_fn,	0 },
+		{ "mem_limit",		shell_mem_limit_fn,	2 },
+		{ "memstats",		shell_memstats_fn,	0 },
 		{0}
 	};
 
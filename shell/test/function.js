@@ -29,4 +29,50 @@ test("i1.constructor", foo)
 test("(function(){123;})()", undefined);
 test("123", 123);
 
+// Functions whose activation cannot escape keep it on a frame stack
+function depth(n) { var a = [n]; return n == 0 ? 0 : 1 + depth(n - 1); }
+test("depth(300)", 300)
+function unwind(n) { var s = "x" + n; if (n == 0) throw s; unwind(n - 1); }
+test("(function(){try{unwind(50)}catch(e){return e}})()", "x0")
+test("depth(10) + depth(20)", 30)
+var indirect_eval = eval;
+var local = "global";
+function call_indirect() { var local = "local"; return indirect_eval("local"); }
+test("call_indirect()", "local")
+function eval_via(ev) { var local = "local"; return ev("local"); }
+test("eval_via(eval)", "local")
+function capture_indirect(n) { return indirect_eval("(function(){return n})"); }
+var captured = [capture_indirect(1), capture_indirect(2)];
+test("depth(10) + depth(20)", 30)
+test("captured[0]() + captured[1]()", 3)
+function call_direct() { var local = "local"; return eval("local"); }
+test("call_direct()", "local")
+
+// The arguments object is made when first used
+function args_return(a, b) { return arguments; }
+var returned_args = args_return(5, 6, 7);
+for (var i = 0; i < 100; i++) depth(10);
+test("returned_args.length", 3)
+test("returned_args[0] + returned_args[2]", 12)
+test("(function(a){ arguments[0] = 9; return a; })(1)", 9)
+test("(function(a){ a = 9; return arguments[0]; })(1)", 9)
+test("(function(){ return eval('arguments.length'); })(1, 2)", 2)
+test("(function(){ return delete arguments; })()", false)
+test("(function(){ arguments = 3; return arguments; })()", 3)
+test("(function(arguments){ return arguments; })(4)", 4)
+test("(function(){ var arguments; return typeof arguments; })()", "object")
+
+compat('js11')
+var args_running = new Function("x", "return args_running.arguments[0]");
+test("args_running(8)", 8)
+test("args_running.arguments", null)
+test("delete args_running.arguments", false)
+function args_getter() { return args_setter.arguments; }
+function args_setter(a, b) { var t = a + b; return args_getter(); }
+var saved_args = args_setter(3, 4);
+for (var i = 0; i < 100; i++) depth(10);
+test("saved_args[0] + saved_args[1]", 7)
+test("saved_args.length", 2)
+compat('')
+
 finish()
@@ -0,0 +1,49 @@
+
+describe("Array object tests")
+
+/* An array too long to be joined in two passes */
+var big = [], i;
+for (i = 0; i < 70000; i++) big[i] = i % 10;
+
+/* 15.4.4.2 */
+test("[1,2,3].toString()", "1,2,3")
+test("[].toString()", "")
+
+/* 15.4.4.5 */
+test("[].join()", "")
+test("[1].join('-')", "1")
+test("['a','b','c'].join()", "a,b,c")
+test("['a','b','c'].join('')", "abc")
+test("['a','b','c'].join(undefined)", "a,b,c")
+test("['ab','cd'].join('::')", "ab::cd")
+test("[1,null,undefined,'x',true].join()", "1,,,x,true")
+test("[1,2.5,{toString:function(){return 'o'}}].join('|')", "1|2.5|o")
+test("var a = []; a.length = 4; a.join('-')", "---")
+test("[[1,2],[3]].join(';')", "1,2;3")
+test("['\\u1234','\\uabcd'].join('\\u0000').length", 3)
+test("big.join('').length", 70000)
+test("big.join().length", 139999)
+test("big.join('').substring(0, 12)", "012345678901")
+
+/* join() converts each element once, in index order */
+var order = "";
+function tracer(c) { return { toString: function() { order += c; return c } } }
+test("[tracer('a'), tracer('b'), tracer('c')].join()", "a,b,c")
+test("order", "abc")
+
+/* Elements held densely behave like any others */
+function show(a) {
+	var s = [];
+	for (var i = 0; i < a.length; i++)
+		s.push(i in a ? a[i] : "_");
+	return a.length + ":" + s.join();
+}
+var d = [1,2,3,4,5];
+test("delete d[2]; show(d)", "5:1,2,_,4,5")
+test("d[2] = 3; show(d)", "5:1,2,3,4,5")
+test("d.length = 2; d[4] = 5; show(d)", "5:1,2,_,_,5")
+test("d[2] = 3; d[3] = 4; show(d)", "5:1,2,3,4,5")
+test("var k = []; for (var i in d) k.push(i); k.sort().join()", "0,1,2,3,4")
+test("show('a,b,c'.split(',').concat(['d']).reverse())", "4:d,c,b,a")
+
+finish()
@@ -127,5 +127,19 @@ test("encodeURIComponent(reserved)", hex(reserved))
 test("encodeURIComponent('#')", hex('#'))
 test("encodeURIComponent(unescaped)", unescaped)
 test("encodeURIComponent(other)", hex(other))
+test("encodeURI('\\u00f0\\u07ff')", "%C3%B0%DF%BF")
+test("encodeURI('\\u20ac\\ud83d\\ude00')", "%E2%82%AC%F0%9F%98%80")
+test("decodeURI(encodeURI('\\u00f0\\u3fff'))", "\u00f0\u3fff")
+test("escape('a b\\u00ff\\u1234')", "a%20b%ff%u1234")
+
+/* Built-in objects initialised on first use */
+test("this.Math.floor(Math.E)", 2)
+test("typeof Date.prototype.getTime", "function")
+var SavedRegExp = RegExp;
+RegExp = null;
+test("/b+/.exec('abbc')[0]", "bb")
+test("'abbc'.replace('b', 'x')", "axbc")
+test("/b/.constructor === SavedRegExp", true)
+RegExp = SavedRegExp;
 
 finish()
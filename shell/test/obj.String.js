@@ -0,0 +1,135 @@
+
+describe("String object tests")
+
+/* Long strings that exercise the vectorised and long pattern searches */
+var ls = "", i;
+for (i = 0; i < 200; i++) ls += "abcdefghij".charAt(i % 10);
+var longpat = ls.substring(3, 60);
+var wide = "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx\u1234y";
+
+/* 15.5.1.1 (9.8.1) */
+test("String(7)", "7")
+test("String(1023) + String(1024)", "10231024")
+test("String(-7)", "-7")
+test("String(-0)", "0")
+test("String(4294967295)", "4294967295")
+test("String(4294967296)", "4294967296")
+test("String(7.5)", "7.5")
+test("String(1e21)", "1e+21")
+test("var o = {}; o[3] = 'x'; o['3']", "x")
+
+/* 15.5.3.2 */
+test("String.fromCharCode(65)", "A")
+test("String.fromCharCode(0x20ac).charCodeAt(0)", 0x20ac)
+test("String.fromCharCode(65, 66, 67)", "ABC")
+test("String.fromCharCode()", "")
+
+/* 15.5.4.4 */
+test("'abc'.charAt(1)", "b")
+test("'abc'.charAt(3)", "")
+test("'a\\u1234'.charAt(1).charCodeAt(0)", 0x1234)
+
+/* 15.5.4.7 */
+test("'abcabc'.indexOf('c')", 2)
+test("'abcabc'.indexOf('c', 3)", 5)
+test("'abcabc'.indexOf('ca')", 2)
+test("'abcabc'.indexOf('cab', 3)", -1)
+test("'abcabc'.indexOf('')", 0)
+test("'abcabc'.indexOf('', 4)", 4)
+test("'abcabc'.indexOf('', 99)", 6)
+test("'abc'.indexOf('abcd')", -1)
+test("'abc'.indexOf('a', -5)", 0)
+test("'aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaab'.indexOf('ab')", 36)
+test("'aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaab'.indexOf('aab', 20)", 35)
+test("wide.indexOf('\\u1234y')", 35)
+test("wide.indexOf('\\u3434y')", -1)
+test("ls.indexOf('jab', 100)", 109)
+test("ls.indexOf(longpat)", 3)
+test("ls.indexOf(longpat, 4)", 13)
+test("ls.indexOf(longpat + 'x')", -1)
+test("ls.indexOf('ghij', 197)", -1)
+test("ls.indexOf('ghij', 196)", 196)
+
+/* 15.5.4.8 */
+test("'abcabc'.lastIndexOf('c')", 5)
+test("'abcabc'.lastIndexOf('c', 4)", 2)
+test("'abcabc'.lastIndexOf('abc', 99)", 3)
+test("'abcabc'.lastIndexOf('')", 6)
+test("'abcabc'.lastIndexOf('', 2)", 2)
+test("'abcabc'.lastIndexOf('a', -1)", 0)
+test("'abcabc'.lastIndexOf('x')", -1)
+test("'abc'.lastIndexOf('abcd')", -1)
+test("ls.lastIndexOf('jab')", 189)
+test("ls.lastIndexOf('jab', 100)", 99)
+test("ls.lastIndexOf('abc', 2)", 0)
+test("ls.lastIndexOf(longpat)", 143)
+
+/* 15.5.4.11 */
+test("'aXbXc'.replace('X', '-')", "a-bXc")
+test("'aXbXc'.replace('Y', '-')", "aXbXc")
+test("'abc'.replace('', '-')", "-abc")
+test("'abc'.replace('b', '[$&$`$\\'$$]')", "a[bac$]c")
+test("'abc'.replace('b', '$1')", "ac")
+test("'a.c'.replace('.', '-')", "-.c")
+test("'abc'.replace('.', '-')", "-bc")
+test("'abcabc'.replace('bc', function(m, i, s) { return m+i+s })",
+	"abc1abcabcabc")
+test("ls.replace(longpat, '').length", 200 - longpat.length)
+test("'a1b22c'.replace(/(\\d+)/g, '<$1>')", "a<1>b<22>c")
+test("'x-y'.replace(/(-)/, '$`$$$\\'$2')", "xx$yy")
+test("'abc'.replace(/b/, '$')", "a$c")
+test("'a1b22c'.replace(/(\\d)(\\d*)/g, '[$2|$&|$`|$\\'|$$|$x|$3]')",
+	"a[|1|a|b22c|$|$x|]b[2|22|a1b|c|$|$x|]c")
+test("'xaxbx'.replace(/x/g, function(m, i) { return i })", "0a2b4")
+test("'aXbX'.replace(/X*/g, '-')", "a-b-")
+var r = /a/g; r.exec = function() { return null };
+test("'aaa'.replace(r, 'b')", "aaa")
+
+/* JavaScript 1.1 RegExp statics, set by replace() */
+compat('js15')
+test("'ab'.replace(/(a)/g, function() { return RegExp.$1 + RegExp.lastMatch" +
+	" + RegExp.rightContext })", "aabb")
+test("/(b)(c)/.exec('abcd'), [RegExp.$1, RegExp.$2, RegExp.$3, " +
+	"RegExp.lastParen, RegExp.leftContext].join()", "b,c,,c,a")
+compat('')
+
+/* 15.5.4.14 */
+test("'a,b,,c'.split(',').length", 4)
+test("'a,b,,c'.split(',').join('|')", "a|b||c")
+test("'a,b,,c'.split(',', 2).join('|')", "a|b")
+test("'a::b::c'.split('::').join('|')", "a|b|c")
+test("'abc'.split('').join('|')", "a|b|c")
+test("'abc'.split('x').join('|')", "abc")
+test("'abc'.split('abc').length", 2)
+test("''.split(',').length", 1)
+test("''.split('').length", 0)
+test("ls.split('j').length", 21)
+test("ls.split(longpat).length", 4)
+test("'a,b,,c,'.split(',').join('|')", "a|b||c|")
+test("',a'.split(',', 1).join('|')", "")
+test("'a,b,c'.split(',', 2).join('|')", "a|b")
+test("'aaa'.split('aa').join('|')", "|a")
+test("'abc'.split('', 2).join('|')", "a|b")
+test("'a\u0100b\u0100'.split('\u0100').join('|')", "a|b|")
+test("''.split(',').length", 1)
+
+/* 15.5.4.16-19 Case mapping of long and mixed ASCII/non-ASCII text */
+var mixed = "Hello, World! \u00c9T\u00c9 0123456789 abcdefghijklmnopqrstuvwxyz" +
+	    " ABCDEFGHIJKLMNOPQRSTUVWXYZ [@`{] \u0391\u03b2";
+test("mixed.toLowerCase()", "hello, world! \u00e9t\u00e9 0123456789 " +
+	"abcdefghijklmnopqrstuvwxyz abcdefghijklmnopqrstuvwxyz [@`{] " +
+	"\u03b1\u03b2")
+test("mixed.toUpperCase()", "HELLO, WORLD! \u00c9T\u00c9 0123456789 " +
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZ ABCDEFGHIJKLMNOPQRSTUVWXYZ [@`{] " +
+	"\u0391\u0392")
+test("ls.toUpperCase().toLowerCase() == ls", true)
+test("ls.toUpperCase().charAt(199)", "J")
+test("''.toUpperCase()", "")
+
+/* 15.5.4.9 */
+test("'a'.localeCompare('b') < 0", true)
+test("'b'.localeCompare('a') > 0", true)
+test("'abc'.localeCompare('abc')", 0)
+test("ls.localeCompare(ls + 'x') < 0", true)
+
+finish()
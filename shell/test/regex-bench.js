@@ -0,0 +1,197 @@
+/*
+ * Regular expression benchmark and differential test. Not run by
+ * 'make check'; use 'make bench', or for example:
+ *	see-shell -f regex-bench.js
+ *	see-shell -e 'benchtime=1000' -f regex-bench.js
+ *
+ * Every pattern in the corpus is run over its input text under each
+ * registered regex engine (and, for "ecma", also as native code).
+ * For each run the throughput is printed as matches per second and
+ * characters per second, along with the deepest backtrack stack that
+ * the p-code interpreter needed. The matches found by the engines are
+ * compared with each other, and any difference is reported as a
+ * MISMATCH; the script throws an error at the end if there were any.
+ *
+ * Finally, each pattern without the 'i' flag is timed again with it,
+ * under the default engine, to show what ignoring case costs.
+ */
+
+/* Minimum milliseconds spent timing each pattern on each engine */
+if (typeof benchtime == "undefined")
+	var benchtime = 200;
+
+function repeat(s, n) {
+	return new Array(n + 1).join(s);
+}
+
+/* Input texts */
+var prose = repeat("The quick brown fox, id=1234; jumps over <b>the</b> " +
+	"lazy dog at 12:34:56. Nothing is running; everything is waiting " +
+	"for the morning.\n", 400);
+var html = repeat("<div class=\"item\"><a href=\"http://example.com/" +
+	"page?id=42&amp;q=x\">Example link</a> <span title='t'>text" +
+	"</span><br/></div>\n", 300);
+var log = repeat("2008-03-14 12:34:56.789 INFO  [main] server.Listener - " +
+	"accepted connection from 192.168.0.17:51234 user=david\n" +
+	"2008-03-14 12:34:57.002 ERROR [pool-2] db.Query - timeout " +
+	"after 3000ms: SELECT * FROM t WHERE k='abc'\n", 200);
+var csv = repeat("1042,\"Smith, John\",john@example.com,+1 555 0100," +
+	"2008-01-02,19.95\n", 500);
+var intl = repeat("Caf\u00e9 cr\u00e8me br\u00fbl\u00e9e, \u00c9T\u00c9 " +
+	"\u00e0 la fa\u00e7on de Ren\u00e9e; \u0391\u03b8\u03ae\u03bd\u03b1 " +
+	"\u041c\u043e\u0441\u043a\u0432\u0430 \u6771\u4eac\n", 300);
+var as = repeat("a", 24);
+
+var words = ["alpha", "bravo", "charlie", "delta", "echo", "foxtrot",
+	"golf", "hotel", "india", "juliet", "kilo", "lima", "mike",
+	"november", "oscar", "papa", "quebec", "romeo", "sierra", "tango",
+	"uniform", "victor", "whiskey", "xray", "yankee", "zulu", "running",
+	"morning", "waiting", "nothing", "example", "connection", "timeout"];
+
+/* The corpus: [name, source, flags, text] */
+var corpus = [
+	["time",	"\\d+:\\d+:\\d+",		"g",	prose],
+	["words",	"\\b[a-z]+\\b",			"g",	prose],
+	["ing-words",	"\\b\\w+ing\\b",		"g",	prose],
+	["alternation",	"(?:quick|lazy|slow) \\w+",	"g",	prose],
+	["lines",	"^.*dog.*$",			"mg",	prose],
+	["backref",	"<(\\w+)>[^<]*<\\/\\1>",	"g",	prose],
+	["tags",	"<(\\w+)(?:\\s+[\\w-]+=(?:\"[^\"]*\"|'[^']*'))*\\s*\\/?>",
+							"g",	html],
+	["urls",	"https?:\\/\\/[^\\s\"<>]+",	"g",	html],
+	["entities",	"&(?:#\\d+|\\w+);",		"g",	html],
+	["log-level",	"^\\S+ \\S+ (ERROR|WARN)\\s+\\[([^\\]]+)\\]",
+							"mg",	log],
+	["ipv4",	"\\b(?:\\d{1,3}\\.){3}\\d{1,3}\\b", "g",	log],
+	["sql",		"SELECT\\s+(.*?)\\s+FROM\\s+(\\w+)", "gi",	log],
+	["csv-field",	"(?:^|,)(\"(?:[^\"]|\"\")*\"|[^,\\n]*)", "mg",	csv],
+	["email",	"[\\w.+-]+@[\\w-]+(?:\\.[\\w-]+)+", "g",	csv],
+	["ci-class",	"[a-z\\u00e0-\\u00ff]+e\\b",	"gi",	intl],
+	["ci-literal",	"caf\\u00c9|ATHENS|\\u00e9t\\u00e9", "gi",	intl],
+	["non-latin",	"[\\u0391-\\u03c9\\u0400-\\u04ff]+", "g",	intl],
+	["long-alt",	"\\b(?:" + words.join("|") + ")\\b", "g",	prose],
+	["long-alt-ci",	"\\b(?:" + words.join("|") + ")\\b", "gi",	log],
+	/* pathological */
+	["nested-plus",	"^(a+)+b",			"",	as],
+	["nested-star",	"(a*)*b",			"",	as + "!b"],
+	["nested-alt",	"^(?:a|aa)+$",			"",	as + "b"],
+	["overlap",	"(?:x+x+)+y",			"",
+							repeat("x", 20) + "!y"],
+	["lazy-dot",	"<b>.*?<\\/b>.*?\\.",		"g",	prose]
+];
+
+/* Engine configurations: [label, engine name, jit threshold] */
+var configs = [];
+var engines = Shell.regex_engines();
+for (var i = 0; i < engines.length; i++) {
+	configs.push([engines[i], engines[i], -1]);
+	if (engines[i] == "ecma")
+		configs.push(["ecma+native", "ecma", 0]);
+}
+
+/* Runs the regex over the text, returning a list of its matches */
+function matches(re, text) {
+	var result = [], m;
+
+	re.lastIndex = 0;
+	while ((m = re.exec(text))) {
+		result.push(m.index + ":" + m.join("\u0000"));
+		if (!re.global)
+			break;
+		if (m[0].length == 0)
+			re.lastIndex++;
+	}
+	return result;
+}
+
+/* Returns the mean milliseconds taken by matches() over benchtime ms */
+function timed(re, text) {
+	var rounds = 0, elapsed, start = new Date();
+
+	do {
+		matches(re, text);
+		rounds++;
+		elapsed = new Date() - start;
+	} while (elapsed < benchtime);
+	return elapsed / rounds;
+}
+
+/* Formats a rate as a number with a k or M suffix */
+function rate(n, ms) {
+	var r = n * 1000 / Math.max(ms, 0.001);
+	if (r >= 1e6) return (r / 1e6).toFixed(1) + "M";
+	if (r >= 1e3) return (r / 1e3).toFixed(1) + "k";
+	return r.toFixed(0);
+}
+
+function pad(s, n) {
+	s = String(s);
+	while (s.length < n)
+		s += " ";
+	return s;
+}
+
+var oldengine = Shell.regex_engine();
+var oldjit = Shell.regex_jit();
+var mismatches = 0;
+
+print(pad("pattern", 13) + pad("engine", 13) + pad("matches", 9) +
+	pad("match/s", 10) + pad("char/s", 10) + "peak");
+for (var p = 0; p < corpus.length; p++) {
+    var name = corpus[p][0], text = corpus[p][3];
+    var reference = undefined, refconfig;
+
+    for (var c = 0; c < configs.length; c++) {
+	var line = pad(c ? "" : name, 13) + pad(configs[c][0], 13);
+	var re, result, ms, peak, failed = null;
+
+	Shell.regex_engine(configs[c][1]);
+	Shell.regex_jit(configs[c][2]);
+	try {
+	    re = new RegExp(corpus[p][1], corpus[p][2]);
+	    Shell.regex_backtrack_peak();
+	    result = matches(re, text);
+	    peak = Shell.regex_backtrack_peak();
+	    ms = timed(re, text);
+	} catch (e) {
+	    failed = e.message;
+	}
+	if (failed) {
+	    print(line + failed);
+	    continue;
+	}
+
+	print(line + pad(result.length, 9) +
+	    pad(rate(result.length, ms), 10) +
+	    pad(rate(text.length, ms), 10) +
+	    (configs[c][2] < 0 ? peak : "-"));
+
+	if (reference === undefined) {
+	    reference = result.join("\n");
+	    refconfig = configs[c][0];
+	} else if (result.join("\n") != reference) {
+	    print("MISMATCH: " + name + " differs between " +
+		refconfig + " and " + configs[c][0]);
+	    mismatches++;
+	}
+    }
+}
+
+Shell.regex_engine(oldengine);
+Shell.regex_jit(oldjit);
+
+print("");
+print(pad("pattern", 13) + pad("char/s", 10) + pad("char/s /i", 12) + "ratio");
+for (var p = 0; p < corpus.length; p++) {
+	var flags = corpus[p][2], text = corpus[p][3], plain, folded;
+
+	if (flags.indexOf("i") >= 0 || /^(?:nested|overlap)/.test(corpus[p][0]))
+		continue;
+	plain = timed(new RegExp(corpus[p][1], flags), text);
+	folded = timed(new RegExp(corpus[p][1], flags + "i"), text);
+	print(pad(corpus[p][0], 13) + pad(rate(text.length, plain), 10) +
+	    pad(rate(text.length, folded), 12) + (folded / plain).toFixed(2));
+}
+
+if (mismatches)
+	throw new Error(mismatches + " mismatches between regex engines");
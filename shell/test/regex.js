@@ -19,4 +19,148 @@ test("'$1,$2'.replace(/(\\$(\\d))/g, '$$1-$1$2')", "$1-$11,$1-$22");
 test("String('ab'.split(/a*?/))", "a,b");
 test("String('ab'.split(/a*/))", ",b");
 
+/* Case-insensitive matching (15.10.2.8 Canonicalize) */
+test("/hello world/i.test('HeLLo WoRLD')", true);
+test("/[a-c]+/i.exec('xxABCabcD')[0]", "ABCabc");
+test("/(\\w+) \\1/i.exec('Abcdefghijkl ABCDEFGHIJKL')[1]", "Abcdefghijkl");
+test("/(\\w+) \\1/.test('Abcdefghijkl ABCDEFGHIJKL')", false);
+test("/(\\w+) \\1/.test('Abcdefghijkl Abcdefghijkl')", true);
+test("/(.)\\1/i.test('\\u00e9\\u00c9')", true);
+
+
+
+/* Character classes */
+test("/[A-Za-z0-9_]+/.exec('  foo_Bar9 !')[0]", "foo_Bar9");
+test("/\\w+/.exec('\\u00e9t\\u00e9 summer')[0]", "t");
+test("/[^a-z]+/.exec('abcDEF1ghi')[0]", "DEF1");
+test("/[^\\u0100]/.test('\\u0100')", false);
+test("/[\\u0100-\\uffff]/.test('\\u00ff')", false);
+test("/[\\u0100-\\uffff]+/.exec('a\\u0100\\u4e00\\uffffb')[0].length", 3);
+test("/[^x]/.exec('\\u2028x')[0]", "\u2028");
+test("/./.exec('\\ud835\\udc00')[0].length", 2);
+test("/[\\u00e0-\\u00ff]+/i.exec('x\\u00c0\\u00e9\\u00ffy')[0]", "\u00c0\u00e9\u00ff");
+test("/[\\u0391-\\u03a9]+/i.exec('x\\u03b1\\u03b2\\u0393y')[0]", "\u03b1\u03b2\u0393");
+test("/[^a-c]+/i.exec('aBcDeF')[0]", "DeF");
+
+/* Start positions are skipped using prefixes, first chars and anchors */
+test("/needle/.exec('haystack with a needle in it').index", 16);
+test("/(ne)(e)dle/.exec('needneedle').join()", "needle,ne,e");
+test("/needle/.test('haystack')", false);
+test("/[xyz]+q/.exec('abcxxaxyq').index", 6);
+test("/(?:foo|bar)baz/.exec('foobar barbaz').index", 7);
+test("/(?:foo|bar)?baz/.exec('xxbaz').index", 2);
+test("/a*b/.exec('cccab').index", 3);
+test("/x*/.exec('abc').index", 0);
+test("/^b/.test('ab')", false);
+test("/^b/m.exec('a\\nb').index", 2);
+test("/^b/m.exec('a\\u2028b').index", 2);
+test("/^(?:a|b)c/m.exec('xbc\\nbc').index", 4);
+test("/\\w+@example\\.com/.exec('mail me: joe@example.com').index", 9);
+test("/\\w+@example\\.com/.test('mail me: joe@example.org')", false);
+test("/\\d+(?:px|em)/.exec('width: 10pt 12em')[0]", "12em");
+test("/(?=a)[a-c]/.exec('xxcab').index", 3);
+test("/(?!a)[a-c]/.exec('aab').index", 2);
+test("/[\\u0100-\\uffff]/.exec('abc\\u0101').index", 3);
+test("/NEEDLE/i.exec('haystack with a needle in it').index", 16);
+test("/[k-l]/i.exec('abcLk').index", 3);
+test("/\\x61B/i.exec('xAb').index", 1);
+test("/[\\u0000-`b-\\uffff]/i.test('A')", true);
+test("/[\\u0100-\\uffff]+/i.exec('ab\\u0101\\u0100c')[0]", "\u0101\u0100");
+test("'a long haystack with a nEeDlE in it'.search(/NEEDLE/i)", 23);
+test("'xxxxxxxx \\u0131x'.search(/ix/i)", 9);
+test("'xxxxxxxx \\u017fx'.search(/Sx/i)", 9);
+test("/\\u017f/i.test('\\u017f') && /\\u017f/i.test('s')", true);
+test("'\\u03b1\\u03b8\\u03ae\\u03bd\\u03b1 \\u0398\\u0389\\u039d'.search(/\\u03b8\\u03ae\\u03bd/gi)", 1);
+test("/(?:\\u03c9|x)\\u03c9/i.exec('abc\\u03a9\\u03c9')[0]", "\u03a9\u03c9");
+test("/(a)\\1b/.exec('aab aaab').index", 0);
+test("/(a)?b/.exec('cb')[0]", "b");
+test("/$/.exec('abc').index", 3);
+test("'haystack with a needle'.search(/needle/)", 16);
+test("'abc'.search(/$/)", 3);
+test("'abc'.search(/d/)", -1);
+test("var r = /o/g; r.lastIndex = 5; r.exec('foo boo').index", 5);
+
+/* Long subjects are matched without deep recursion */
+var longab = new Array(100001).join("ab");
+test("/^(a|b)*$/.test(longab)", true);
+test("/^(?:ab)+$/.test(longab)", true);
+test("/^.*$/.exec(longab)[0].length", 200000);
+test("/^(?:(a)|(b))*$/.exec(longab).slice(1).join()", ",b");
+test("/^(?:a|b)*?c/.test(longab)", false);
+
+/* Runaway backtracking is stopped with a catchable Error */
+test("/^(a+)+b$/.test(new Array(41).join('a'))", Exception(Error));
+test("/^(a+)+b$/.test(new Array(11).join('a') + 'b')", true);
+
+/* The linear-time 'nfa' engine gives the same results as 'ecma' */
+function nfa_agrees(expr) {
+	var old = Shell.regex_engine("ecma"), a, b;
+	try {
+		a = String(eval(expr));
+		Shell.regex_engine("nfa");
+		b = String(eval(expr));
+	} finally {
+		Shell.regex_engine(old);
+	}
+	return a == b || a + " != " + b;
+}
+test("nfa_agrees('/a|ab/.exec(\"abc\")')", true);
+test("nfa_agrees('/((a)|(ab))((c)|(bc))/.exec(\"abc\")')", true);
+test("nfa_agrees('/(z)((a+)?(b+)?(c))*/.exec(\"zaacbbbcac\")')", true);
+test("nfa_agrees('/(aa|aabaac|ba|b|c)*/.exec(\"aabaac\")')", true);
+test("nfa_agrees('/a[a-z]{2,4}?/.exec(\"abcdefghi\")')", true);
+test("nfa_agrees('/(.)*?x/.exec(\"abcx\")')", true);
+test("nfa_agrees('\"ab\\\\nbc\".match(/^b|c$/mg)')", true);
+test("nfa_agrees('\"a foo, b foo\".replace(/\\\\bfoo\\\\b/g, \"bar\")')", true);
+test("nfa_agrees('/(?:ab){2,}c/.exec(\"xabababc\")')", true);
+test("nfa_agrees('/(a*)*b/.exec(\"aab\")')", true);
+test("nfa_agrees('/(($))/.exec(\"xa\")')", true);
+test("nfa_agrees('/(a|)+?b/.exec(\"aab\")')", true);
+test("nfa_agrees('/.b/.exec(\"\\\\ud835\\\\udc00b\")')", true);
+test("nfa_agrees('/\\\\udc00b/.exec(\"\\\\ud835\\\\udc00b\")')", true);
+test("nfa_agrees('/(a)\\\\1/.exec(\"baab\")')", true);	/* backtracks */
+test("nfa_agrees('/a(?=b)/.exec(\"aab\")')", true);	/* backtracks */
+Shell.regex_engine("nfa");
+test("/^(a+)+b$/.test(new Array(41).join('a'))", false);
+test("/^(a|b)*$/.test(longab)", true);
+Shell.regex_engine("ecma");
+
+/* Native code gives the same results as the p-code interpreter */
+function jit_agrees(expr) {
+	var old = Shell.regex_jit(-1), a, b;
+	try {
+		a = String(eval(expr));
+		Shell.regex_jit(0);
+		b = String(eval(expr));
+	} finally {
+		Shell.regex_jit(old);
+	}
+	return a == b || a + " != " + b;
+}
+test("jit_agrees('/((a)|(ab))((c)|(bc))/.exec(\"abc\")')", true);
+test("jit_agrees('/(z)((a+)?(b+)?(c))*/.exec(\"zaacbbbcac\")')", true);
+test("jit_agrees('/a[a-z]{2,4}?/.exec(\"abcdefghi\")')", true);
+test("jit_agrees('/(a*)*b|(x{2,3})+$/.exec(\"aabxxxxxx\")')", true);
+test("jit_agrees('\"ab\\\\nbc\".match(/^b|c$/mg)')", true);
+test("jit_agrees('\"a foo, b foo\".replace(/\\\\bfoo\\\\b/gi, \"bar\")')", true);
+test("jit_agrees('/[\\\\u0100-\\\\uffff]+.b/.exec(\"a\\\\u0101\\\\u4e00\\\\ud835\\\\udc00b\")')", true);
+test("jit_agrees('/^(?:a|b)*$/.test(longab)')", true);
+test("jit_agrees('/(a)\\\\1(?=b)/.exec(\"baab\")')", true);	/* not translated */
+var oldjit = Shell.regex_jit(0);
+test("/^(a+)+b$/.test(new Array(41).join('a'))", Exception(Error));
+Shell.regex_jit(oldjit);
+
+/* Compiled regexs are cached by source, flags and engine */
+function cache_misses(f) {
+	var before = Shell.regex_cache_stats().misses;
+	f();
+	return Shell.regex_cache_stats().misses - before;
+}
+test("cache_misses(function () { for (var i = 0; i < 10; i++) /q+z/.test('x') })", 1);
+test("cache_misses(function () { for (var i = 0; i < 10; i++) 'qz'.match('q[z]') })", 1);
+test("cache_misses(function () { new RegExp('q+z'); new RegExp('q+z', 'i') })", 1);
+test("cache_misses(function () { Shell.regex_engine('nfa'); try { new RegExp('q+z') } finally { Shell.regex_engine('ecma') } })", 1);
+test("var r1 = /y/g, r2 = /y/g; r1.exec('yy'); r2.lastIndex", 0);
+test("cache_misses(function () { try { new RegExp('(') } catch (e) {} })", 1);
+
 finish()
@@ -5,7 +5,6 @@
 #include <see/see.h>
 #include "httpd.h"
 #include "ssp.h"
-#include "pool.h"
 
 /*
  * An input stream around a SSP file.
@@ -38,7 +37,6 @@ struct ssp_input {
  */
 struct ssp_state {
 	FILE *fp;
-	struct pool *pool;
 	int headers_sent;		/* true if HTTP header sent */
 	int raw;			/* true if raw JS to be sent */
 	int response_code;		/* usually 200 */
@@ -51,20 +49,23 @@ static struct SEE_input *ssp_input_new(struct SEE_interpreter *interp,
 	const char *filename);
 static SEE_unicode_t ssp_next(struct SEE_input *input);
 static void ssp_close(struct SEE_input *input);
-static void *ssp_malloc(struct SEE_interpreter *, SEE_size_t);
-static void  ssp_free(struct SEE_interpreter *, void *);
+static void *ssp_malloc(struct SEE_interpreter *, SEE_size_t,
+	const char *, int);
+static void  ssp_free(struct SEE_interpreter *, void *, const char *, int);
 static struct SEE_object *make_headers_object(struct SEE_interpreter *,
 	struct header *);
 
 static struct SEE_inputclass ssp_inputclass = { ssp_next, ssp_close };
 
 /*
- * Sets up SEE so that it uses a per-interpreter allocator.
- * Our allocators remember what mallocs were performed, and
- * when a request is complete, we can simply dump all memory
- * associated with that interpreter. This is not a good approach
- * for long-running scripts, but for web-based applications it
- * is probably sufficient.
+ * Sets up SEE for interpreters that keep their memory in arenas.
+ * Each request's interpreter allocates from its own arena, and when
+ * the request is complete, we simply dump all memory associated
+ * with that interpreter. This is not a good approach for
+ * long-running scripts, but for web-based applications it is
+ * probably sufficient. The few blocks that SEE allocates for no
+ * interpreter come from the system malloc(), as SEE's collector
+ * is not thread-safe.
  */
 void
 ssp_init()
@@ -77,29 +78,29 @@ ssp_init()
 }
 
 /*
- * Allocates storage for an interpreter. Allocated blocks
- * are wrapped in a linked list rooted in the interpreter's ssp_state.
+ * Allocates storage that belongs to no interpreter.
  */
 static void *
-ssp_malloc(interp, size)
+ssp_malloc(interp, size, file, line)
 	struct SEE_interpreter *interp;
 	SEE_size_t size;
+	const char *file;
+	int line;
 {
-	if (!interp)
-		return malloc(size);
-	return pool_malloc(SSP_STATE(interp)->pool, size);
+	return malloc(size);
 }
 
 /*
- * Sometimes SEE calls free(). It can be safely ignored.
+ * Releases storage that belongs to no interpreter.
  */
 static void 
-ssp_free(interp, ptr)
+ssp_free(interp, ptr, file, line)
 	struct SEE_interpreter *interp;
 	void *ptr;
+	const char *file;
+	int line;
 {
-	if (!interp)
-		free(ptr);
+	free(ptr);
 }
 
 /* Reads text up until EOF or "<%". Returns -1 if EOF was immediately 
@@ -432,11 +433,10 @@ process_request(fp, method, uri, headers)
 	ssp_state.headers_sent = 0;
 	ssp_state.raw = strcmp(query_string, "raw") == 0;
 	ssp_state.response_code = 200;
-	ssp_state.pool = pool_new();
 
-	/* Create an interpreter instance that uses our memory allocator */
+	/* Create an interpreter instance that keeps its memory in an arena */
 	interp.host_data = &ssp_state;
-	SEE_interpreter_init(&interp);
+	SEE_interpreter_init_arena(&interp, SEE_system.default_compat_flags);
 
 	/* Insert the print() function into the interpreter context */
 	SEE_CFUNCTION_PUTA(&interp, interp.Global, "print", print_fn, 1, 0);
@@ -484,7 +484,7 @@ process_request(fp, method, uri, headers)
 
 
 	/* Release memory */
-	pool_destroy(SSP_STATE(&interp)->pool);
+	SEE_interpreter_destroy(&interp);
 }
 
 